@@ -33,8 +33,6 @@
 
 #include "border_agent.hpp"
 
-#include <stdexcept>
-
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -45,6 +43,7 @@
 #include "common/types.hpp"
 #include "common/tlv.hpp"
 #include "common/code_utils.hpp"
+#include "common/time.hpp"
 #include "dtls.hpp"
 #include "ncp.hpp"
 #include "uris.hpp"
@@ -69,8 +68,7 @@ enum
  */
 enum
 {
-    kCoapUdpPort        = 61631, ///< Thread management UDP port.
-    kBorderAgentUdpPort = 49191, ///< Thread commissioning port.
+    kCoapUdpPort = 61631, ///< Thread management UDP port.
 };
 
 /**
@@ -83,6 +81,27 @@ enum
 };
 
 
+static Metrics::Counter   sRelayRxPackets("otbr_relay_rx_packets_total",
+                                         "Relay RX messages forwarded from joiner routers to commissioners.");
+static Metrics::Counter   sRelayRxBytes("otbr_relay_rx_bytes_total",
+                                       "Payload bytes of relay RX messages forwarded to commissioners.");
+static Metrics::Counter   sRelayTxPackets("otbr_relay_tx_packets_total",
+                                         "Relay TX messages forwarded from commissioners to joiner routers.");
+static Metrics::Counter   sRelayTxBytes("otbr_relay_tx_bytes_total",
+                                       "Payload bytes of relay TX messages forwarded to joiner routers.");
+static Metrics::Histogram sLeaderPetitionTime("otbr_leader_petition_rtt_seconds",
+                                              "Round-trip time of commissioner petitions to the leader.");
+static Metrics::Histogram sLeaderKeepAliveTime("otbr_leader_keep_alive_rtt_seconds",
+                                               "Round-trip time of commissioner keep-alives to the leader.");
+static Metrics::Counter   sMgmtGetCacheHits("otbr_mgmt_get_cache_hits_total",
+                                            "MGMT GET requests answered from the border agent cache.");
+static Metrics::Counter   sMgmtGetCacheMisses("otbr_mgmt_get_cache_misses_total",
+                                              "MGMT GET requests forwarded to the leader.");
+static Metrics::Gauge     sReadyAgents("otbr_border_agents_ready",
+                                       "Border agents accepting commissioners.");
+static Metrics::Histogram sStartupTime("otbr_border_agent_startup_seconds",
+                                       "Time from creating a border agent until it accepts commissioners.");
+
 const Coap::Resource BorderAgent::kCoapResources[] =
 {
     { OPENTHREAD_URI_RELAY_RX, BorderAgent::HandleRelayReceive },
@@ -93,7 +112,12 @@ const Coap::Resource BorderAgent::kCoapsResources[] =
 {
     { OPENTHREAD_URI_COMMISSIONER_PETITION, BorderAgent::ForwardCommissionerRequest },
     { OPENTHREAD_URI_COMMISSIONER_KEEP_ALIVE, BorderAgent::ForwardCommissionerRequest },
+    { OPENTHREAD_URI_COMMISSIONER_GET, BorderAgent::ForwardCommissionerRequest },
     { OPENTHREAD_URI_COMMISSIONER_SET, BorderAgent::ForwardCommissionerRequest },
+    { OPENTHREAD_URI_ACTIVE_GET, BorderAgent::ForwardCommissionerRequest },
+    { OPENTHREAD_URI_ACTIVE_SET, BorderAgent::ForwardCommissionerRequest },
+    { OPENTHREAD_URI_PENDING_GET, BorderAgent::ForwardCommissionerRequest },
+    { OPENTHREAD_URI_PENDING_SET, BorderAgent::ForwardCommissionerRequest },
     { OPENTHREAD_URI_RELAY_TX, BorderAgent::HandleRelayTransmit },
     {NULL, NULL},
 };
@@ -108,6 +132,9 @@ void BorderAgent::ForwardCommissionerResponse(const Coap::Message &aMessage)
 
     Coap::Message::Code code = aMessage.GetCode();
 
+    CompleteLeaderRequest(token, tokenLength);
+    CacheResponse(aMessage);
+
     Coap::Message *message = mCoaps->NewMessage(
         Coap::Message::kCoapTypeNonConfirmable, code,
         token, tokenLength);
@@ -120,42 +147,179 @@ void BorderAgent::ForwardCommissionerResponse(const Coap::Message &aMessage)
 }
 
 void BorderAgent::ForwardCommissionerRequest(const Coap::Resource &aResource, const Coap::Message &aMessage,
-                                             const uint8_t *aIp6, uint16_t aPort)
+                                             Coap::Message &aResponse, const uint8_t *aIp6, uint16_t aPort)
 {
     uint8_t        tokenLength = 0;
     const uint8_t *token = aMessage.GetToken(tokenLength);
+    const char    *path = aResource.mPath;
 
-    Coap::Message *message = mCoap->NewMessage(Coap::Message::kCoapTypeConfirmable, Coap::Message::kCoapRequestPost,
-                                               token, tokenLength);
-
-    const char *path = aResource.mPath;
+    VerifyOrExit(!AnswerFromCache(path, aMessage, aResponse));
 
     syslog(LOG_INFO, "forwarding request %s", path);
 
+    InvalidateCache(path);
+
     if (!strcmp(OPENTHREAD_URI_COMMISSIONER_PETITION, path))
     {
         path = OPENTHREAD_URI_LEADER_PETITION;
+        TrackLeaderRequest(sLeaderPetitionTime, token, tokenLength);
     }
     else if (!strcmp(OPENTHREAD_URI_COMMISSIONER_KEEP_ALIVE, path))
     {
         path = OPENTHREAD_URI_LEADER_KEEP_ALIVE;
+        TrackLeaderRequest(sLeaderKeepAliveTime, token, tokenLength);
     }
 
-    message->SetPath(path);
+    {
+        Coap::Message *message = mCoap->NewMessage(Coap::Message::kCoapTypeConfirmable,
+                                                   Coap::Message::kCoapRequestPost,
+                                                   token, tokenLength);
 
-    uint16_t       length = 0;
-    const uint8_t *payload = aMessage.GetPayload(length);
-    message->SetPayload(payload, length);
+        message->SetPath(path);
 
-    Ip6Address addr(kAloc16Leader);
+        uint16_t       length = 0;
+        const uint8_t *payload = aMessage.GetPayload(length);
+        message->SetPayload(payload, length);
 
-    mCoap->Send(*message, addr.m8, kCoapUdpPort, BorderAgent::ForwardCommissionerResponse);
-    mCoap->FreeMessage(message);
+        Ip6Address addr(kAloc16Leader);
+
+        mCoap->Send(*message, addr.m8, kCoapUdpPort, BorderAgent::ForwardCommissionerResponse);
+        mCoap->FreeMessage(message);
+    }
+
+exit:
 
     (void)aIp6;
     (void)aPort;
 }
 
+bool BorderAgent::AnswerFromCache(const char *aPath, const Coap::Message &aMessage, Coap::Message &aResponse)
+{
+    bool                          answered = false;
+    uint8_t                       tokenLength = 0;
+    const uint8_t                *token = aMessage.GetToken(tokenLength);
+    uint16_t                      length = 0;
+    const uint8_t                *payload = aMessage.GetPayload(length);
+    std::string                   key(aPath);
+    ResponseCache::const_iterator it;
+
+    // The pending dataset carries a delay timer counting down on the leader, so only the commissioner and the
+    // active datasets are cached.
+    VerifyOrExit(!strcmp(OPENTHREAD_URI_COMMISSIONER_GET, aPath) || !strcmp(OPENTHREAD_URI_ACTIVE_GET, aPath));
+
+    key.append(reinterpret_cast<const char *>(payload), length);
+    it = mResponseCache.find(key);
+
+    if (it == mResponseCache.end())
+    {
+        sMgmtGetCacheMisses.Increment();
+
+        if (mPendingGets.size() >= kMaxPendingGets)
+        {
+            // Responses never received leave their entries behind, start over rather than growing.
+            mPendingGets.clear();
+        }
+
+        mPendingGets[std::string(reinterpret_cast<const char *>(token), tokenLength)] = key;
+        ExitNow();
+    }
+
+    // Answered in the acknowledgment, the commissioner gets the response without waiting for the mesh.
+    aResponse.SetCode(Coap::Message::kCoapResponseChanged);
+    aResponse.SetPayload(reinterpret_cast<const uint8_t *>(it->second.mPayload.data()),
+                         static_cast<uint16_t>(it->second.mPayload.size()));
+    sMgmtGetCacheHits.Increment();
+    answered = true;
+
+exit:
+    return answered;
+}
+
+void BorderAgent::CacheResponse(const Coap::Message &aMessage)
+{
+    uint8_t                 tokenLength = 0;
+    const uint8_t          *token = aMessage.GetToken(tokenLength);
+    uint16_t                length = 0;
+    const uint8_t          *payload = aMessage.GetPayload(length);
+    PendingGetMap::iterator it = mPendingGets.find(std::string(reinterpret_cast<const char *>(token), tokenLength));
+
+    VerifyOrExit(it != mPendingGets.end());
+
+    if (aMessage.GetCode() == Coap::Message::kCoapResponseChanged)
+    {
+        // Every distinct set of TLVs is a key of its own, evict the oldest rather than growing until the network data
+        // changes.
+        if (mResponseCache.size() >= kMaxCachedGets && mResponseCache.find(it->second) == mResponseCache.end())
+        {
+            ResponseCache::iterator oldest = mResponseCache.begin();
+
+            for (ResponseCache::iterator entry = mResponseCache.begin(); entry != mResponseCache.end(); ++entry)
+            {
+                if (mResponseSequence - entry->second.mSequence > mResponseSequence - oldest->second.mSequence)
+                {
+                    oldest = entry;
+                }
+            }
+
+            mResponseCache.erase(oldest);
+        }
+
+        CachedResponse &response = mResponseCache[it->second];
+
+        response.mPayload.assign(reinterpret_cast<const char *>(payload), length);
+        response.mSequence = mResponseSequence++;
+    }
+
+    mPendingGets.erase(it);
+
+exit:
+    return;
+}
+
+void BorderAgent::InvalidateCache(const char *aPath)
+{
+    const char *getPath = NULL;
+
+    // Petitions and keep-alives change the commissioner session, SETs the datasets they target.
+    if (!strcmp(OPENTHREAD_URI_COMMISSIONER_SET, aPath) || !strcmp(OPENTHREAD_URI_COMMISSIONER_PETITION, aPath) ||
+        !strcmp(OPENTHREAD_URI_COMMISSIONER_KEEP_ALIVE, aPath))
+    {
+        getPath = OPENTHREAD_URI_COMMISSIONER_GET;
+    }
+    else if (!strcmp(OPENTHREAD_URI_ACTIVE_SET, aPath) || !strcmp(OPENTHREAD_URI_PENDING_SET, aPath))
+    {
+        getPath = OPENTHREAD_URI_ACTIVE_GET;
+    }
+
+    VerifyOrExit(getPath != NULL);
+
+    {
+        size_t                  pathLength = strlen(getPath);
+        ResponseCache::iterator it = mResponseCache.lower_bound(getPath);
+
+        while (it != mResponseCache.end() && !it->first.compare(0, pathLength, getPath))
+        {
+            mResponseCache.erase(it++);
+        }
+    }
+
+    // A GET still in flight may be answered with the data before this request.
+    for (PendingGetMap::iterator it = mPendingGets.begin(); it != mPendingGets.end();)
+    {
+        if (!it->second.compare(0, strlen(getPath), getPath))
+        {
+            mPendingGets.erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+exit:
+    return;
+}
+
 void BorderAgent::HandleRelayReceive(const Coap::Message &aMessage, const uint8_t *aIp6, uint16_t aPort)
 {
     uint8_t        tokenLength = 0;
@@ -169,6 +333,9 @@ void BorderAgent::HandleRelayReceive(const Coap::Message &aMessage, const uint8_
     const uint8_t *payload = aMessage.GetPayload(length);
     message->SetPayload(payload, length);
 
+    sRelayRxPackets.Increment();
+    sRelayRxBytes.Increment(length);
+
     mCoaps->Send(*message, NULL, 0, NULL);
     mCoaps->FreeMessage(message);
 
@@ -210,6 +377,9 @@ void BorderAgent::HandleRelayTransmit(const Coap::Message &aMessage, const uint8
         message->SetPayload(payload, length);
         mCoap->Send(*message, addr.m8, kCoapUdpPort, NULL);
         mCoap->FreeMessage(message);
+
+        sRelayTxPackets.Increment();
+        sRelayTxBytes.Increment(length);
     }
 
 exit:
@@ -220,49 +390,80 @@ exit:
     return;
 }
 
-BorderAgent::BorderAgent(const char *aInterfaceName) :
+BorderAgent::BorderAgent(const char *aInterfaceName, uint16_t aPort) :
     mNcpController(Ncp::Controller::Create(aInterfaceName, HandlePSKcChanged, FeedCoap, this)),
     mCoap(Coap::Agent::Create(SendCoap, kCoapResources, this)),
     mCoaps(Coap::Agent::Create(SendCoaps, kCoapsResources, this)),
-    mDtlsServer(Dtls::Server::Create(kBorderAgentUdpPort, HandleDtlsSessionState, this))
+    mDtlsServer(Dtls::Server::Create(aPort, HandleDtlsSessionState, this)),
+    mDtlsSession(NULL),
+    mResponseSequence(0),
+    mInterfaceName(aInterfaceName),
+    mState(kStateStarting),
+    mStartTime(GetMonotonicMicros())
 {
-    int error = 0;
-
-    error = mNcpController->BorderAgentProxyStart();
+    memset(mLeaderRequests, 0, sizeof(mLeaderRequests));
 
-    if (error)
-    {
-        syslog(LOG_ERR, "failed to enable border agent proxy");
-        throw std::runtime_error("Failed to start border agent proxy");
-    }
+    mNcpController->SetNetworkDataHandler(HandleNetworkDataChanged, this);
+    mNcpController->SetReadyHandler(HandleNcpReady, this);
 
-    const uint8_t *pskc = mNcpController->GetPSKc();
-    if (pskc == NULL)
+    // wpantund may not be up yet at boot, the controller keeps trying in the background and reports when it is done.
+    if (mNcpController->BorderAgentProxyStart())
     {
-        syslog(LOG_ERR, "failed to get PSKc");
-        throw std::runtime_error("Failed to get PSKc");
+        syslog(LOG_WARNING, "border agent proxy not started on %s yet", aInterfaceName);
     }
-    mDtlsServer->SetPSK(pskc, kSizePSKc);
 
-    const uint8_t *eui64 = mNcpController->GetEui64();
-    if (eui64 == NULL)
-    {
-        syslog(LOG_ERR, "failed to get Eui64");
-        throw std::runtime_error("Failed to get Eui64");
-    }
-    mDtlsServer->SetSeed(eui64, kSizeEui64);
+    syslog(LOG_INFO, "border agent on %s listening on port %u", aInterfaceName, aPort);
 }
 
 BorderAgent::~BorderAgent(void)
 {
+    if (mState == kStateReady)
+    {
+        sReadyAgents.Add(-1);
+    }
+
     Dtls::Server::Destroy(mDtlsServer);
     Coap::Agent::Destroy(mCoaps);
     Coap::Agent::Destroy(mCoap);
     Ncp::Controller::Destroy(mNcpController);
 }
 
+int BorderAgent::StartTrace(const char *aPath)
+{
+    int ret = 0;
+
+    SuccessOrExit(ret = mTraceWriter.Open(aPath));
+
+    // The PSKc retrieved on start lets a replay begin with the same credentials, otherwise it is recorded once the
+    // border agent is ready.
+    if (mNcpController->GetPSKc() != NULL)
+    {
+        mTraceWriter.WritePSKc(mNcpController->GetPSKc(), kSizePSKc);
+    }
+
+exit:
+    return ret;
+}
+
+bool BorderAgent::IsIdle(void) const
+{
+    return mDtlsServer->GetSessionCount() == 0;
+}
+
+void BorderAgent::HandOver(std::vector<uint8_t> &aState, std::vector<int> &aFds)
+{
+    mDtlsServer->HandOver(aState, aFds);
+}
+
+int BorderAgent::Resume(const std::vector<uint8_t> &aState, const std::vector<int> &aFds)
+{
+    return mDtlsServer->Resume(aState, aFds);
+}
+
 void BorderAgent::HandleDtlsSessionState(Dtls::Session &aSession, Dtls::Session::State aState)
 {
+    mTraceWriter.WriteDtlsState(static_cast<uint8_t>(aState));
+
     switch (aState)
     {
     case Dtls::Session::kStateReady:
@@ -311,6 +512,7 @@ void BorderAgent::FeedCoap(const uint8_t *aBuffer, uint16_t aLength, uint16_t aL
     BorderAgent *borderAgent = static_cast<BorderAgent *>(aContext);
     Ip6Address   addr(aLocator);
 
+    borderAgent->mTraceWriter.WriteProxyStream(aBuffer, aLength, aLocator, aPort);
     borderAgent->mCoap->Input(aBuffer, aLength, addr.m8, aPort);
 }
 
@@ -318,27 +520,113 @@ void BorderAgent::FeedCoaps(const uint8_t *aBuffer, uint16_t aLength, void *aCon
 {
     BorderAgent *borderAgent = static_cast<BorderAgent *>(aContext);
 
+    borderAgent->mTraceWriter.WriteDtlsPayload(aBuffer, aLength);
     borderAgent->mCoaps->Input(aBuffer, aLength, NULL, 0);
 }
 
 void BorderAgent::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd,
                               timeval &aTimeout)
 {
-    mNcpController->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd);
+    mNcpController->UpdateFdSet(aReadFdSet, aWriteFdSet, aErrorFdSet, aMaxFd, aTimeout);
     mDtlsServer->UpdateFdSet(aReadFdSet, aWriteFdSet, aMaxFd, aTimeout);
+    mCoap->UpdateTimeout(aTimeout);
+    mCoaps->UpdateTimeout(aTimeout);
 }
 
 void BorderAgent::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
 {
     mNcpController->Process(aReadFdSet, aWriteFdSet, aErrorFdSet);
     mDtlsServer->Process(aReadFdSet, aWriteFdSet);
+    mCoap->Process();
+    mCoaps->Process();
+}
+
+void BorderAgent::TrackLeaderRequest(Metrics::Histogram &aRoundTripTime, const uint8_t *aToken, uint8_t aTokenLength)
+{
+    LeaderRequest *request = &mLeaderRequests[0];
+
+    VerifyOrExit(aTokenLength <= kMaxTokenLength);
+
+    // Reuse a free entry, or the oldest one whose response is likely lost.
+    for (int i = 0; i < kMaxLeaderRequests; i++)
+    {
+        if (mLeaderRequests[i].mRoundTripTime == NULL)
+        {
+            request = &mLeaderRequests[i];
+            break;
+        }
+
+        if (mLeaderRequests[i].mSentTime < request->mSentTime)
+        {
+            request = &mLeaderRequests[i];
+        }
+    }
+
+    request->mRoundTripTime = &aRoundTripTime;
+    request->mSentTime = GetMonotonicMicros();
+    request->mTokenLength = aTokenLength;
+    memcpy(request->mToken, aToken, aTokenLength);
+
+exit:
+    return;
+}
+
+void BorderAgent::CompleteLeaderRequest(const uint8_t *aToken, uint8_t aTokenLength)
+{
+    for (int i = 0; i < kMaxLeaderRequests; i++)
+    {
+        LeaderRequest &request = mLeaderRequests[i];
+
+        if (request.mRoundTripTime != NULL && request.mTokenLength == aTokenLength &&
+            !memcmp(request.mToken, aToken, aTokenLength))
+        {
+            request.mRoundTripTime->Record(GetMonotonicMicros() - request.mSentTime);
+            request.mRoundTripTime = NULL;
+            break;
+        }
+    }
 }
 
 void BorderAgent::HandlePSKcChanged(const uint8_t *aPSKc, void *aContext)
 {
+    static_cast<BorderAgent *>(aContext)->mTraceWriter.WritePSKc(aPSKc, kSizePSKc);
     static_cast<BorderAgent *>(aContext)->mDtlsServer->SetPSK(aPSKc, kSizePSKc);
 }
 
+void BorderAgent::HandleNcpReady(void *aContext)
+{
+    static_cast<BorderAgent *>(aContext)->HandleNcpReady();
+}
+
+void BorderAgent::HandleNcpReady(void)
+{
+    // Called again with fresh credentials whenever wpantund restarts.
+    mTraceWriter.WritePSKc(mNcpController->GetPSKc(), kSizePSKc);
+    mDtlsServer->SetPSK(mNcpController->GetPSKc(), kSizePSKc);
+    mDtlsServer->SetSeed(mNcpController->GetEui64(), kSizeEui64);
+
+    VerifyOrExit(mState == kStateStarting);
+
+    mState = kStateReady;
+    mDtlsServer->Start();
+    sReadyAgents.Add(1);
+    sStartupTime.Record(GetMonotonicMicros() - mStartTime);
+
+    syslog(LOG_INFO, "border agent on %s ready", mInterfaceName.c_str());
+
+exit:
+    return;
+}
+
+void BorderAgent::HandleNetworkDataChanged(void *aContext)
+{
+    BorderAgent *borderAgent = static_cast<BorderAgent *>(aContext);
+
+    borderAgent->mTraceWriter.WriteNetworkData();
+    borderAgent->mResponseCache.clear();
+    borderAgent->mPendingGets.clear();
+}
+
 } // namespace BorderRouter
 
 } // namespace ot
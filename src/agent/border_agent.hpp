@@ -37,11 +37,17 @@
 #include <stdint.h>
 
 #include <boost/scoped_ptr.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
 #include <boost/shared_ptr.hpp>
 
 #include "coap.hpp"
 #include "dtls.hpp"
 #include "ncp.hpp"
+#include "trace.hpp"
+#include "common/metrics.hpp"
 
 namespace ot {
 
@@ -56,9 +62,21 @@ namespace BorderRouter {
  * @{
  */
 
+/**
+ * UDP ports
+ *
+ */
+enum
+{
+    kBorderAgentUdpPort = 49191, ///< Thread commissioning port of the first interface.
+};
+
 /**
  * This class implements Thread border agent functionality.
  *
+ * One process may host several border agents, one per Thread interface. They share the DBus connection and the
+ * random generator, and each listens for commissioners on its own DTLS port.
+ *
  */
 class BorderAgent
 {
@@ -66,9 +84,10 @@ public:
     /**
      * The constructor to initialize the Thread border agent.
      * @param[in]   aInterfaceName  interface name string.
+     * @param[in]   aPort           UDP port of the DTLS server for external commissioners.
      *
      */
-    BorderAgent(const char *aInterfaceName);
+    BorderAgent(const char *aInterfaceName, uint16_t aPort = kBorderAgentUdpPort);
 
     ~BorderAgent(void);
 
@@ -80,6 +99,55 @@ public:
      */
     void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet);
 
+    /**
+     * This method starts recording inbound events to a trace file.
+     *
+     * @param[in]   aPath   The path of the trace file.
+     *
+     * @returns 0 on success, otherwise failure.
+     *
+     */
+    int StartTrace(const char *aPath);
+
+    /**
+     * This method indicates whether the border agent accepts commissioners.
+     *
+     * The border agent starts without waiting for wpantund, and becomes ready once the border agent proxy is started
+     * and the PSKc and EUI64 are retrieved.
+     *
+     * @returns Whether the border agent is ready.
+     *
+     */
+    bool IsReady(void) const { return mState == kStateReady; }
+
+    /**
+     * This method indicates whether no commissioner is connected or connecting.
+     *
+     * @returns Whether the border agent is idle.
+     *
+     */
+    bool IsIdle(void) const;
+
+    /**
+     * This method hands the commissioner sessions over to another process.
+     *
+     * @param[out]  aState  The serialized state of the sessions.
+     * @param[out]  aFds    The sockets of the sessions, owned by the caller from now on.
+     *
+     */
+    void HandOver(std::vector<uint8_t> &aState, std::vector<int> &aFds);
+
+    /**
+     * This method resumes the commissioner sessions handed over by another process.
+     *
+     * @param[in]   aState  The serialized state of the sessions.
+     * @param[in]   aFds    The sockets of the sessions, owned by the border agent from now on.
+     *
+     * @returns 0 on success, otherwise failure.
+     *
+     */
+    int Resume(const std::vector<uint8_t> &aState, const std::vector<int> &aFds);
+
 private:
     static void FeedCoap(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort, void *aContext);
     static ssize_t SendCoap(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort,
@@ -120,12 +188,10 @@ private:
                                            Coap::Message &aResponse,
                                            const uint8_t *aIp6, uint16_t aPort, void *aContext)
     {
-        (void)aIp6;
-        (void)aResponse;
-        static_cast<BorderAgent *>(aContext)->ForwardCommissionerRequest(aResource, aMessage, aIp6, aPort);
+        static_cast<BorderAgent *>(aContext)->ForwardCommissionerRequest(aResource, aMessage, aResponse, aIp6, aPort);
     }
     void ForwardCommissionerRequest(const Coap::Resource &aResource, const Coap::Message &aMessage,
-                                    const uint8_t *aIp6, uint16_t aPort);
+                                    Coap::Message &aResponse, const uint8_t *aIp6, uint16_t aPort);
 
     static void ForwardCommissionerResponse(const Coap::Message &aMessage, void *aContext)
     {
@@ -134,6 +200,68 @@ private:
     void ForwardCommissionerResponse(const Coap::Message &aMessage);
 
     static void HandlePSKcChanged(const uint8_t *aPSKc, void *aContext);
+    static void HandleNcpReady(void *aContext);
+    void HandleNcpReady(void);
+    static void HandleNetworkDataChanged(void *aContext);
+
+    bool AnswerFromCache(const char *aPath, const Coap::Message &aMessage, Coap::Message &aResponse);
+    void CacheResponse(const Coap::Message &aMessage);
+    void InvalidateCache(const char *aPath);
+
+    void TrackLeaderRequest(Metrics::Histogram &aRoundTripTime, const uint8_t *aToken, uint8_t aTokenLength);
+    void CompleteLeaderRequest(const uint8_t *aToken, uint8_t aTokenLength);
+
+    enum
+    {
+        kMaxTokenLength    = 8, ///< Max length of CoAP token.
+        kMaxLeaderRequests = 4, ///< Max number of leader requests tracked for round-trip time.
+        kMaxPendingGets    = 8, ///< Max number of GET requests awaiting a response to cache.
+        kMaxCachedGets     = 8, ///< Max number of GET responses cached.
+    };
+
+    /**
+     * Startup states of the border agent.
+     *
+     */
+    enum State
+    {
+        kStateStarting, ///< Sockets are bound, waiting for the NCP to start the border agent proxy.
+        kStateReady,    ///< Commissioners are accepted.
+    };
+
+    /**
+     * This structure tracks a request forwarded to the leader for measuring its round-trip time.
+     *
+     */
+    struct LeaderRequest
+    {
+        Metrics::Histogram *mRoundTripTime;
+        uint64_t            mSentTime;
+        uint8_t             mToken[kMaxTokenLength];
+        uint8_t             mTokenLength;
+    };
+
+    /**
+     * This structure represents a response payload of the leader, and when it was cached.
+     *
+     */
+    struct CachedResponse
+    {
+        std::string mPayload;
+        uint32_t    mSequence;
+    };
+
+    /**
+     * This type maps a GET path followed by its request TLVs to the cached response of the leader.
+     *
+     */
+    typedef std::map<std::string, CachedResponse> ResponseCache;
+
+    /**
+     * This type maps the token of a GET forwarded to the leader to its cache key.
+     *
+     */
+    typedef std::map<std::string, std::string> PendingGetMap;
 
     /**
      * Border agent resources for Thread network.
@@ -152,6 +280,14 @@ private:
     Coap::Agent                *mCoaps;
     Dtls::Server               *mDtlsServer;
     Dtls::Session              *mDtlsSession;
+    LeaderRequest               mLeaderRequests[kMaxLeaderRequests];
+    TraceWriter                 mTraceWriter;
+    ResponseCache               mResponseCache;
+    uint32_t                    mResponseSequence;
+    PendingGetMap               mPendingGets;
+    std::string                 mInterfaceName;
+    State                       mState;
+    uint64_t                    mStartTime;
 };
 
 /**
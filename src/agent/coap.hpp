@@ -37,6 +37,8 @@
 #include <stdint.h>
 #include <unistd.h>
 
+#include <sys/time.h>
+
 namespace ot {
 
 namespace BorderRouter {
@@ -77,17 +79,19 @@ public:
      */
     typedef enum Code
     {
-        kCoapEmpty           = 0x00, ///< Empty message code
-        kCoapRequestGet      = 0x01, ///< Get
-        kCoapRequestPost     = 0x02, ///< Post
-        kCoapRequestPut      = 0x03, ///< Put
-        kCoapRequestDelete   = 0x04, ///< Delete
-        kCoapResponseCodeMin = 0x40, ///< 2.00
-        kCoapResponseCreated = 0x41, ///< Created
-        kCoapResponseDeleted = 0x42, ///< Deleted
-        kCoapResponseValid   = 0x43, ///< Valid
-        kCoapResponseChanged = 0x44, ///< Changed
-        kCoapResponseContent = 0x45, ///< Content
+        kCoapEmpty                    = 0x00, ///< Empty message code
+        kCoapRequestGet               = 0x01, ///< Get
+        kCoapRequestPost              = 0x02, ///< Post
+        kCoapRequestPut               = 0x03, ///< Put
+        kCoapRequestDelete            = 0x04, ///< Delete
+        kCoapResponseCodeMin          = 0x40, ///< 2.00
+        kCoapResponseCreated          = 0x41, ///< Created
+        kCoapResponseDeleted          = 0x42, ///< Deleted
+        kCoapResponseValid            = 0x43, ///< Valid
+        kCoapResponseChanged          = 0x44, ///< Changed
+        kCoapResponseContent          = 0x45, ///< Content
+        kCoapResponseNotFound         = 0x84, ///< Not Found
+        kCoapResponseMethodNotAllowed = 0x85, ///< Method Not Allowed
     } Code;
 
 public:
@@ -251,6 +255,22 @@ public:
      */
     virtual void Send(Message &aMessage, const uint8_t *aIp6, uint16_t aPort, ResponseHandler aHandler) = 0;
 
+    /**
+     * This method updates the timeout for mainloop.
+     * @p aTimeout should only be updated if a confirmable message is due to be retransmitted in less than its current
+     * value.
+     *
+     * @param[inout]    aTimeout    A reference to the timeout.
+     *
+     */
+    virtual void UpdateTimeout(timeval &aTimeout) = 0;
+
+    /**
+     * This method retransmits the confirmable messages which are not acknowledged in time.
+     *
+     */
+    virtual void Process(void) = 0;
+
     /**
      * This method creates a CoAP agent.
      *
@@ -0,0 +1,559 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for encoding and decoding CoAP messages in place.
+ */
+
+#ifndef COAP_CODEC_HPP_
+#define COAP_CODEC_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "coap.hpp"
+#include "common/code_utils.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+/**
+ * @addtogroup border-agent-coap
+ *
+ * @{
+ */
+
+/**
+ * This class implements a read-only view of a CoAP message in a caller buffer.
+ *
+ * Only the offsets of the options and the payload are kept, nothing is copied. The buffer must outlive the view.
+ *
+ */
+class MessageReader
+{
+public:
+    enum
+    {
+        kVersion        = 1,    ///< The CoAP version.
+        kHeaderSize     = 4,    ///< Number of bytes of the fixed header.
+        kMaxTokenLength = 8,    ///< Max length of a CoAP token.
+        kPayloadMarker  = 0xff, ///< The byte separating the options from the payload.
+        kOptionUriPath  = 11,   ///< The Uri-Path option number.
+    };
+
+    /**
+     * The constructor to initialize an empty view.
+     *
+     */
+    MessageReader(void) :
+        mBuffer(NULL),
+        mLength(0),
+        mOptionsEnd(0) {}
+
+    /**
+     * This method parses the CoAP message in @p aBuffer.
+     *
+     * @param[in]   aBuffer     A pointer to the message.
+     * @param[in]   aLength     Number of bytes of @p aBuffer.
+     *
+     * @retval  0   Successfully parsed the message.
+     * @retval  -1  The message is malformed.
+     *
+     */
+    int Parse(const uint8_t *aBuffer, uint16_t aLength) {
+        int            ret = -1;
+        const uint8_t *end = aBuffer + aLength;
+        const uint8_t *cursor = aBuffer + kHeaderSize;
+        uint16_t       delta = 0;
+        uint16_t       length = 0;
+
+        mBuffer = aBuffer;
+        mLength = aLength;
+        mOptionsEnd = 0;
+
+        VerifyOrExit(aLength >= kHeaderSize && (aBuffer[0] >> 6) == kVersion);
+        VerifyOrExit(GetTokenLength() <= kMaxTokenLength && GetTokenLength() <= aLength - kHeaderSize);
+
+        // An empty message is only the header.
+        VerifyOrExit(aBuffer[1] != Message::kCoapEmpty || aLength == kHeaderSize);
+
+        cursor += GetTokenLength();
+
+        while (cursor < end && *cursor != kPayloadMarker)
+        {
+            VerifyOrExit((cursor = ReadOption(cursor, end, delta, length)) != NULL);
+            VerifyOrExit(length <= end - cursor);
+            cursor += length;
+        }
+
+        // The payload marker is only present before a payload.
+        VerifyOrExit(cursor == end || cursor + 1 < end);
+
+        mOptionsEnd = static_cast<uint16_t>(cursor - aBuffer);
+        ret = 0;
+
+exit:
+        return ret;
+    }
+
+    /**
+     * This method returns the CoAP type of this message.
+     *
+     * @returns The CoAP type of the message.
+     *
+     */
+    Message::Type GetType(void) const { return static_cast<Message::Type>((mBuffer[0] >> 4) & 0x03); }
+
+    /**
+     * This method returns the CoAP code of this message.
+     *
+     * @returns The CoAP code of the message.
+     *
+     */
+    Message::Code GetCode(void) const { return static_cast<Message::Code>(mBuffer[1]); }
+
+    /**
+     * This method returns the CoAP message id of this message.
+     *
+     * @returns The CoAP message id of the message.
+     *
+     */
+    uint16_t GetMessageId(void) const { return static_cast<uint16_t>(mBuffer[2] << 8 | mBuffer[3]); }
+
+    /**
+     * This method returns the token of this message.
+     *
+     * @param[out]    aLength     Number of bytes of the token.
+     *
+     * @returns A pointer to the token.
+     *
+     */
+    const uint8_t *GetToken(uint8_t &aLength) const {
+        aLength = GetTokenLength();
+        return mBuffer + kHeaderSize;
+    }
+
+    /**
+     * This method returns the payload of this message.
+     *
+     * @param[out]  aLength     Number of bytes of the payload.
+     *
+     * @returns A pointer to the payload, or NULL if there is no payload.
+     *
+     */
+    const uint8_t *GetPayload(uint16_t &aLength) const {
+        const uint8_t *payload = NULL;
+
+        aLength = 0;
+        VerifyOrExit(mOptionsEnd < mLength);
+
+        payload = mBuffer + mOptionsEnd + 1;
+        aLength = static_cast<uint16_t>(mLength - mOptionsEnd - 1);
+
+exit:
+        return payload;
+    }
+
+    /**
+     * This method indicates whether the Uri-Path options of this message are @p aPath.
+     *
+     * @param[in]   aPath   A pointer to the null-terminated Uri Path, whose segments are separated by '/'.
+     *
+     * @returns Whether the message is for @p aPath.
+     *
+     */
+    bool IsPath(const char *aPath) const {
+        const uint8_t *cursor = mBuffer + kHeaderSize + GetTokenLength();
+        const uint8_t *end = mBuffer + mOptionsEnd;
+        uint32_t       number = 0;
+        uint16_t       delta = 0;
+        uint16_t       length = 0;
+        bool           matched = false;
+
+        if (*aPath == '/')
+        {
+            aPath++;
+        }
+
+        while (cursor < end)
+        {
+            cursor = ReadOption(cursor, end, delta, length);
+            number += delta;
+
+            if (number > kOptionUriPath)
+            {
+                break;
+            }
+
+            if (number == kOptionUriPath)
+            {
+                size_t segment = strcspn(aPath, "/");
+
+                VerifyOrExit(segment == length && !memcmp(aPath, cursor, length));
+                aPath += segment;
+                aPath += (*aPath == '/');
+            }
+
+            cursor += length;
+        }
+
+        matched = (*aPath == '\0');
+
+exit:
+        return matched;
+    }
+
+    /**
+     * This method returns the length of this message.
+     *
+     * @returns Number of bytes of the message.
+     *
+     */
+    uint16_t GetLength(void) const { return mLength; }
+
+    /**
+     * This method returns the buffer of this message.
+     *
+     * @returns A pointer to the message.
+     *
+     */
+    const uint8_t *GetBuffer(void) const { return mBuffer; }
+
+protected:
+    uint8_t GetTokenLength(void) const { return mBuffer[0] & 0x0f; }
+
+    /**
+     * This method reads the header of an option.
+     *
+     * @param[in]   aCursor     A pointer to the option.
+     * @param[in]   aEnd        A pointer to the end of the options.
+     * @param[out]  aDelta      The difference between the number of this option and the previous one.
+     * @param[out]  aLength     Number of bytes of the option value.
+     *
+     * @returns A pointer to the option value, or NULL if the header is malformed.
+     *
+     */
+    static const uint8_t *ReadOption(const uint8_t *aCursor, const uint8_t *aEnd, uint16_t &aDelta,
+                                     uint16_t &aLength) {
+        uint8_t first = *aCursor++;
+
+        aCursor = ReadOptionField(first >> 4, aCursor, aEnd, aDelta);
+        VerifyOrExit(aCursor != NULL);
+        aCursor = ReadOptionField(first & 0x0f, aCursor, aEnd, aLength);
+
+exit:
+        return aCursor;
+    }
+
+    enum
+    {
+        kOptionExtended8  = 13,  ///< The nibble value of a field extended by one byte.
+        kOptionExtended16 = 14,  ///< The nibble value of a field extended by two bytes.
+        kOptionReserved   = 15,  ///< The nibble value reserved for the payload marker.
+        kOptionOffset8    = 13,  ///< The value subtracted from a field extended by one byte.
+        kOptionOffset16   = 269, ///< The value subtracted from a field extended by two bytes.
+    };
+
+    const uint8_t *mBuffer;
+    uint16_t       mLength;
+    uint16_t       mOptionsEnd;
+
+private:
+    static const uint8_t *ReadOptionField(uint8_t aNibble, const uint8_t *aCursor, const uint8_t *aEnd,
+                                          uint16_t &aValue) {
+        switch (aNibble)
+        {
+        case kOptionExtended8:
+            VerifyOrExit(aCursor + 1 <= aEnd, aCursor = NULL);
+            aValue = static_cast<uint16_t>(kOptionOffset8 + aCursor[0]);
+            aCursor += 1;
+            break;
+
+        case kOptionExtended16:
+            VerifyOrExit(aCursor + 2 <= aEnd && (aCursor[0] << 8 | aCursor[1]) <= 0xffff - kOptionOffset16,
+                         aCursor = NULL);
+            aValue = static_cast<uint16_t>(kOptionOffset16 + (aCursor[0] << 8 | aCursor[1]));
+            aCursor += 2;
+            break;
+
+        case kOptionReserved:
+            aCursor = NULL;
+            break;
+
+        default:
+            aValue = aNibble;
+            break;
+        }
+
+exit:
+        return aCursor;
+    }
+};
+
+/**
+ * This class implements encoding a CoAP message in place into a caller buffer.
+ *
+ * Options are inserted in front of the payload, so the payload may be set before the Uri Path.
+ *
+ */
+class MessageWriter : public MessageReader
+{
+public:
+    /**
+     * The constructor to initialize a writer.
+     *
+     * @param[in]   aBuffer     A pointer to the buffer to encode into.
+     * @param[in]   aSize       Number of bytes of @p aBuffer.
+     *
+     */
+    MessageWriter(uint8_t *aBuffer, uint16_t aSize) :
+        mData(aBuffer),
+        mSize(aSize),
+        mLastOption(0),
+        mFailed(false) {
+        mBuffer = aBuffer;
+    }
+
+    /**
+     * This method starts a message without options or payload.
+     *
+     * @param[in]   aType           The CoAP type.
+     * @param[in]   aCode           The CoAP code.
+     * @param[in]   aMessageId      The CoAP message id.
+     * @param[in]   aToken          The CoAP token.
+     * @param[in]   aTokenLength    Number of bytes in @p aToken.
+     *
+     * @retval  0   Successfully started the message.
+     * @retval  -1  The token does not fit.
+     *
+     */
+    int Init(Message::Type aType, Message::Code aCode, uint16_t aMessageId, const uint8_t *aToken,
+             uint8_t aTokenLength) {
+        int ret = -1;
+
+        mFailed = false;
+        mLastOption = 0;
+        mLength = 0;
+        mOptionsEnd = 0;
+
+        VerifyOrExit(aTokenLength <= kMaxTokenLength && kHeaderSize + aTokenLength <= mSize, mFailed = true);
+
+        mData[0] = static_cast<uint8_t>(kVersion << 6 | aType << 4 | aTokenLength);
+        mData[1] = static_cast<uint8_t>(aCode);
+        mData[2] = static_cast<uint8_t>(aMessageId >> 8);
+        mData[3] = static_cast<uint8_t>(aMessageId & 0xff);
+        if (aTokenLength > 0)
+        {
+            memcpy(mData + kHeaderSize, aToken, aTokenLength);
+        }
+
+        mLength = mOptionsEnd = static_cast<uint16_t>(kHeaderSize + aTokenLength);
+        ret = 0;
+
+exit:
+        return ret;
+    }
+
+    /**
+     * This method sets the CoAP type of this message.
+     *
+     * @param[in]   aType   The CoAP type.
+     *
+     */
+    void SetType(Message::Type aType) { mData[0] = static_cast<uint8_t>((mData[0] & 0xcf) | aType << 4); }
+
+    /**
+     * This method sets the CoAP code of this message.
+     *
+     * @param[in]   aCode   The CoAP code.
+     *
+     */
+    void SetCode(Message::Code aCode) { mData[1] = static_cast<uint8_t>(aCode); }
+
+    /**
+     * This method sets the token of this message, moving the options and the payload after it.
+     *
+     * @param[in]   aToken      The CoAP token.
+     * @param[in]   aLength     Number of bytes in @p aToken.
+     *
+     * @retval  0   Successfully set the token.
+     * @retval  -1  The token does not fit.
+     *
+     */
+    int SetToken(const uint8_t *aToken, uint8_t aLength) {
+        int ret = -1;
+        int shift = aLength - GetTokenLength();
+
+        VerifyOrExit(aLength <= kMaxTokenLength && mLength + shift <= mSize, mFailed = true);
+
+        memmove(mData + kHeaderSize + aLength, mData + kHeaderSize + GetTokenLength(),
+                mLength - kHeaderSize - GetTokenLength());
+        memcpy(mData + kHeaderSize, aToken, aLength);
+        mData[0] = static_cast<uint8_t>((mData[0] & 0xf0) | aLength);
+        mLength = static_cast<uint16_t>(mLength + shift);
+        mOptionsEnd = static_cast<uint16_t>(mOptionsEnd + shift);
+        ret = 0;
+
+exit:
+        return ret;
+    }
+
+    /**
+     * This method appends the Uri-Path options of @p aPath.
+     *
+     * @param[in]   aPath   A pointer to the null-terminated Uri Path, whose segments are separated by '/'.
+     *
+     * @retval  0   Successfully appended the options.
+     * @retval  -1  The options do not fit.
+     *
+     */
+    int AppendPath(const char *aPath) {
+        int ret = 0;
+
+        if (*aPath == '/')
+        {
+            aPath++;
+        }
+
+        while (*aPath != '\0')
+        {
+            size_t segment = strcspn(aPath, "/");
+
+            SuccessOrExit(ret = AppendOption(kOptionUriPath, reinterpret_cast<const uint8_t *>(aPath), segment));
+            aPath += segment;
+            aPath += (*aPath == '/');
+        }
+
+exit:
+        return ret;
+    }
+
+    /**
+     * This method sets the payload of this message, replacing any previous one.
+     *
+     * @param[in]   aPayload    A pointer to the payload buffer.
+     * @param[in]   aLength     Number of bytes in @p aPayload.
+     *
+     * @retval  0   Successfully set the payload.
+     * @retval  -1  The payload does not fit.
+     *
+     */
+    int SetPayload(const uint8_t *aPayload, uint16_t aLength) {
+        int ret = -1;
+
+        mLength = mOptionsEnd;
+        VerifyOrExit(aLength > 0, ret = 0);
+        VerifyOrExit(mOptionsEnd + 1 + aLength <= mSize, mFailed = true);
+
+        mData[mOptionsEnd] = kPayloadMarker;
+        memcpy(mData + mOptionsEnd + 1, aPayload, aLength);
+        mLength = static_cast<uint16_t>(mOptionsEnd + 1 + aLength);
+        ret = 0;
+
+exit:
+        return ret;
+    }
+
+    /**
+     * This method indicates whether any change of this message failed since it was started.
+     *
+     * @returns Whether the message is incomplete.
+     *
+     */
+    bool HasFailed(void) const { return mFailed; }
+
+private:
+    int AppendOption(uint16_t aNumber, const uint8_t *aValue, size_t aLength) {
+        int      ret = -1;
+        uint8_t  header[5];
+        uint8_t *cursor = header + 1;
+        size_t   size;
+
+        VerifyOrExit(aNumber >= mLastOption && aLength <= 0xffff - kOptionOffset16, mFailed = true);
+
+        header[0] = static_cast<uint8_t>(WriteOptionField(aNumber - mLastOption, cursor) << 4);
+        header[0] |= WriteOptionField(static_cast<uint16_t>(aLength), cursor);
+        size = static_cast<size_t>(cursor - header) + aLength;
+
+        VerifyOrExit(mLength + size <= static_cast<size_t>(mSize), mFailed = true);
+
+        memmove(mData + mOptionsEnd + size, mData + mOptionsEnd, mLength - mOptionsEnd);
+        memcpy(mData + mOptionsEnd, header, static_cast<size_t>(cursor - header));
+        memcpy(mData + mOptionsEnd + (cursor - header), aValue, aLength);
+        mLength = static_cast<uint16_t>(mLength + size);
+        mOptionsEnd = static_cast<uint16_t>(mOptionsEnd + size);
+        mLastOption = aNumber;
+        ret = 0;
+
+exit:
+        return ret;
+    }
+
+    static uint8_t WriteOptionField(uint16_t aValue, uint8_t *&aCursor) {
+        uint8_t nibble;
+
+        if (aValue < kOptionOffset8)
+        {
+            nibble = static_cast<uint8_t>(aValue);
+        }
+        else if (aValue < kOptionOffset16)
+        {
+            nibble = kOptionExtended8;
+            *aCursor++ = static_cast<uint8_t>(aValue - kOptionOffset8);
+        }
+        else
+        {
+            nibble = kOptionExtended16;
+            *aCursor++ = static_cast<uint8_t>((aValue - kOptionOffset16) >> 8);
+            *aCursor++ = static_cast<uint8_t>((aValue - kOptionOffset16) & 0xff);
+        }
+
+        return nibble;
+    }
+
+    uint8_t *mData;
+    uint16_t mSize;
+    uint16_t mLastOption;
+    bool     mFailed;
+};
+
+/**
+ * @}
+ */
+
+} // namespace Coap
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif  // COAP_CODEC_HPP_
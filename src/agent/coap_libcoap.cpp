@@ -178,7 +178,7 @@ void AgentLibcoap::Send(Message &aMessage, const uint8_t *aIp6, uint16_t aPort,
         // we have to embed the handler to its payload.
         if (pdu->length + sizeof(&aHandler) < pdu->max_size)
         {
-            memcpy(pdu->data + pdu->length, &aHandler, sizeof(aHandler));
+            memcpy(reinterpret_cast<uint8_t *>(pdu->hdr) + pdu->length, &aHandler, sizeof(aHandler));
         }
         else
         {
@@ -196,6 +196,46 @@ void AgentLibcoap::Send(Message &aMessage, const uint8_t *aIp6, uint16_t aPort,
     }
 }
 
+void AgentLibcoap::UpdateTimeout(timeval &aTimeout)
+{
+    const coap_queue_t *next = coap_peek_next(&mCoap);
+    coap_tick_t         now;
+    coap_tick_t         remaining = 0;
+
+    VerifyOrExit(next != NULL);
+
+    // Times in the send queue are relative to its base time.
+    coap_ticks(&now);
+    if (mCoap.sendqueue_basetime + next->t > now)
+    {
+        remaining = mCoap.sendqueue_basetime + next->t - now;
+    }
+
+    if (static_cast<uint64_t>(remaining) * 1000000 / COAP_TICKS_PER_SECOND <
+        static_cast<uint64_t>(aTimeout.tv_sec) * 1000000 + static_cast<uint64_t>(aTimeout.tv_usec))
+    {
+        aTimeout.tv_sec = static_cast<time_t>(remaining / COAP_TICKS_PER_SECOND);
+        aTimeout.tv_usec = static_cast<suseconds_t>(remaining % COAP_TICKS_PER_SECOND * 1000000 /
+                                                    COAP_TICKS_PER_SECOND);
+    }
+
+exit:
+    return;
+}
+
+void AgentLibcoap::Process(void)
+{
+    coap_tick_t now;
+
+    coap_ticks(&now);
+
+    for (coap_queue_t *next = coap_peek_next(&mCoap); next != NULL && next->t <= now - mCoap.sendqueue_basetime;
+         next = coap_peek_next(&mCoap))
+    {
+        coap_retransmit(&mCoap, coap_pop_next(&mCoap));
+    }
+}
+
 void AgentLibcoap::HandleRequest(coap_context_t *aCoap,
                                  struct coap_resource_t *aResource,
                                  const coap_endpoint_t *aEndPoint,
@@ -228,6 +268,7 @@ void AgentLibcoap::Input(const void *aBuffer, uint16_t aLength, const uint8_t *a
     mPacket.interface = mCoap.endpoint;
     CoapAddressInit(mPacket.src, aIp6, aPort);
     memcpy(mPacket.payload, aBuffer, aLength);
+    SaveSeparateResponse(mPacket.payload, aLength);
     coap_handle_message(&mCoap, &mPacket);
 }
 
@@ -240,11 +281,19 @@ void AgentLibcoap::HandleResponse(coap_context_t *aCoap,
 {
     AgentLibcoap *agent = (AgentLibcoap *)CONTAINING_RECORD(aCoap, AgentLibcoap, mCoap);
 
-    VerifyOrExit(aSent != NULL, syslog(LOG_ERR, "request not found!"));
-
     {
-        ResponseHandler handler;
-        memcpy(&handler, aSent->data + aSent->length, sizeof(handler));
+        ResponseHandler handler = NULL;
+
+        if (aSent != NULL)
+        {
+            memcpy(&handler, reinterpret_cast<uint8_t *>(aSent->hdr) + aSent->length, sizeof(handler));
+        }
+        else
+        {
+            handler = agent->TakeSeparateResponse(*aReceived);
+        }
+
+        VerifyOrExit(handler != NULL, syslog(LOG_ERR, "request not found!"));
 
         MessageLibcoap message(aReceived);
         handler(message, agent->mContext);
@@ -259,11 +308,60 @@ exit:
     return;
 }
 
+void AgentLibcoap::SaveSeparateResponse(const uint8_t *aBuffer, uint16_t aLength)
+{
+    const coap_hdr_t *hdr = reinterpret_cast<const coap_hdr_t *>(aBuffer);
+
+    // libcoap forgets a request once its empty ACK arrives, so keep its handler for the separate response.
+    VerifyOrExit(aLength >= sizeof(coap_hdr_t) && hdr->type == COAP_MESSAGE_ACK && hdr->code == 0);
+
+    for (const coap_queue_t *node = mCoap.sendqueue; node != NULL; node = node->next)
+    {
+        const coap_pdu_t *pdu = node->pdu;
+
+        if (pdu->hdr->id == hdr->id && pdu->hdr->token_length <= kMaxTokenLength)
+        {
+            SeparateResponse &response = mSeparateResponses[mNextSeparateResponse];
+
+            mNextSeparateResponse = (mNextSeparateResponse + 1) % kMaxSeparateResponses;
+            memcpy(response.mToken, pdu->hdr->token, pdu->hdr->token_length);
+            response.mTokenLength = pdu->hdr->token_length;
+            memcpy(&response.mHandler, reinterpret_cast<uint8_t *>(pdu->hdr) + pdu->length, sizeof(response.mHandler));
+            break;
+        }
+    }
+
+exit:
+    return;
+}
+
+ResponseHandler AgentLibcoap::TakeSeparateResponse(const coap_pdu_t &aResponse)
+{
+    ResponseHandler handler = NULL;
+
+    for (int i = 0; i < kMaxSeparateResponses; i++)
+    {
+        SeparateResponse &response = mSeparateResponses[i];
+
+        if (response.mHandler != NULL && response.mTokenLength == aResponse.hdr->token_length &&
+            !memcmp(response.mToken, aResponse.hdr->token, response.mTokenLength))
+        {
+            handler = response.mHandler;
+            response.mHandler = NULL;
+            break;
+        }
+    }
+
+    return handler;
+}
+
 AgentLibcoap::AgentLibcoap(NetworkSender aNetworkSender, const Resource *aResources, void *aContext)
 {
     mContext = aContext;
     mResources = aResources;
     mNetworkSender = aNetworkSender;
+    mNextSeparateResponse = 0;
+    memset(mSeparateResponses, 0, sizeof(mSeparateResponses));
     coap_clock_init();
 
     time_t clock_offset = time(NULL);
@@ -302,16 +400,6 @@ ssize_t AgentLibcoap::NetworkSend(coap_context_t *aCoap,
                                  ntohs(aDestination->addr.sin6.sin6_port), agent->mContext);
 }
 
-Agent *Agent::Create(NetworkSender aNetworkSender, const Resource *aResources, void *aContext)
-{
-    return new AgentLibcoap(aNetworkSender, aResources, aContext);
-}
-
-void Agent::Destroy(Agent *aAgent)
-{
-    delete static_cast<AgentLibcoap *>(aAgent);
-}
-
 } // namespace Coap
 
 } // namespace BorderRouter
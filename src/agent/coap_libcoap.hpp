@@ -113,6 +113,8 @@ private:
 /**
  * This class implements CoAP agent based on libcoap.
  *
+ * The border agent uses AgentNative instead, this one is kept to compare with.
+ *
  */
 class AgentLibcoap : public Agent
 {
@@ -149,6 +151,20 @@ public:
      */
     void Send(Message &aMessage, const uint8_t *aIp6, uint16_t aPort, ResponseHandler aHandler);
 
+    /**
+     * This method updates the timeout for mainloop.
+     *
+     * @param[inout]    aTimeout    A reference to the timeout.
+     *
+     */
+    void UpdateTimeout(timeval &aTimeout);
+
+    /**
+     * This method retransmits the confirmable messages which are not acknowledged in time.
+     *
+     */
+    void Process(void);
+
     /**
      * This method creates a CoAP message with the given arguments.
      *
@@ -171,6 +187,25 @@ public:
     virtual void FreeMessage(Message *aMessage);
 
 private:
+    enum
+    {
+        kMaxSeparateResponses = 8, ///< Max number of requests acknowledged but not yet answered.
+        kMaxTokenLength       = 8, ///< Max length of a CoAP token.
+    };
+
+    /**
+     * This structure represents a request whose response comes separately from its empty ACK.
+     *
+     */
+    struct SeparateResponse
+    {
+        uint8_t         mToken[kMaxTokenLength];
+        uint8_t         mTokenLength;
+        ResponseHandler mHandler;
+    };
+
+    void SaveSeparateResponse(const uint8_t *aBuffer, uint16_t aLength);
+    ResponseHandler TakeSeparateResponse(const coap_pdu_t &aResponse);
 
     static void HandleRequest(coap_context_t *aCoap,
                               struct coap_resource_t *aResource,
@@ -197,6 +232,9 @@ private:
     void           *mContext;
     coap_context_t  mCoap;
     coap_packet_t   mPacket;
+
+    SeparateResponse mSeparateResponses[kMaxSeparateResponses];
+    uint8_t          mNextSeparateResponse;
 };
 
 /**
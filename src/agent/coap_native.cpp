@@ -0,0 +1,537 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements the native CoAP service.
+ */
+
+#include "coap_native.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+#include "common/code_utils.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+static Metrics::Gauge   sPendingRequests("otbr_coap_pending_requests",
+                                         "Confirmable CoAP requests waiting for a response.");
+static Metrics::Counter sRetransmissions("otbr_coap_retransmissions_total",
+                                         "Confirmable CoAP messages sent again for lack of an acknowledgment.");
+static Metrics::Counter sDuplicates("otbr_coap_duplicates_total",
+                                    "CoAP messages received again and answered with the reply already sent.");
+
+static uint64_t GetNowMillis(void)
+{
+    return GetMonotonicMicros() / 1000;
+}
+
+static uint16_t GetMessageId(const uint8_t *aBuffer)
+{
+    return static_cast<uint16_t>(aBuffer[2] << 8 | aBuffer[3]);
+}
+
+AgentNative::AgentNative(NetworkSender aNetworkSender, const Resource *aResources, void *aContext) :
+    mResources(aResources),
+    mNetworkSender(aNetworkSender),
+    mContext(aContext),
+    mNextMessageId(0),
+    mSeed(static_cast<unsigned int>(GetMonotonicMicros() ^ reinterpret_cast<uintptr_t>(this))),
+    mNextRecentMessage(0)
+{
+    // Start from a random message id, so that a restarted agent is not taken for a duplicate.
+    mNextMessageId = static_cast<uint16_t>(rand_r(&mSeed));
+
+    for (int i = 0; i < kMaxMessages; i++)
+    {
+        mMessagesUsed[i] = false;
+    }
+
+    for (int i = 0; i < kMaxPendingRequests; i++)
+    {
+        mPendingRequests[i].mLength = 0;
+    }
+
+    for (int i = 0; i < kMaxRecentMessages; i++)
+    {
+        mRecentMessages[i].mExpiry = 0;
+    }
+}
+
+AgentNative::~AgentNative(void)
+{
+    for (int i = 0; i < kMaxPendingRequests; i++)
+    {
+        if (mPendingRequests[i].mLength != 0)
+        {
+            FreePendingRequest(mPendingRequests[i]);
+        }
+    }
+}
+
+Message *AgentNative::NewMessage(Message::Type aType, Message::Code aCode, const uint8_t *aToken,
+                                 uint8_t aTokenLength)
+{
+    MessageNative *message = NULL;
+
+    for (int i = 0; i < kMaxMessages; i++)
+    {
+        if (!mMessagesUsed[i])
+        {
+            mMessagesUsed[i] = true;
+            message = &mMessages[i];
+            break;
+        }
+    }
+
+    // Messages are freed right after being sent, so only nested handlers may use up the buffers.
+    if (message == NULL)
+    {
+        message = new MessageNative();
+    }
+
+    message->GetWriter().Init(aType, aCode, mNextMessageId++, aToken, aTokenLength);
+
+    return message;
+}
+
+void AgentNative::FreeMessage(Message *aMessage)
+{
+    MessageNative *message = static_cast<MessageNative *>(aMessage);
+
+    if (message >= mMessages && message < mMessages + kMaxMessages)
+    {
+        mMessagesUsed[message - mMessages] = false;
+    }
+    else
+    {
+        delete message;
+    }
+}
+
+void AgentNative::Send(Message &aMessage, const uint8_t *aIp6, uint16_t aPort, ResponseHandler aHandler)
+{
+    const MessageWriter &message = static_cast<MessageNative &>(aMessage).GetWriter();
+    PendingRequest      *request;
+    Peer                 peer;
+
+    VerifyOrExit(!message.HasFailed(), syslog(LOG_ERR, "CoAP message larger than %u bytes", MessageNative::kMaxSize));
+
+    peer.Set(aIp6, aPort);
+
+    if (message.GetType() == Message::kCoapTypeConfirmable)
+    {
+        VerifyOrExit((request = NewPendingRequest()) != NULL,
+                     syslog(LOG_WARNING, "too many pending CoAP requests"));
+
+        memcpy(request->mBuffer, message.GetBuffer(), message.GetLength());
+        request->mLength = message.GetLength();
+        request->mPeer = peer;
+        request->mHandler = aHandler;
+
+        // The first timeout is random between ACK_TIMEOUT and ACK_TIMEOUT * ACK_RANDOM_FACTOR, which is 1.5.
+        request->mRetransmitTimeout = kAckTimeout + static_cast<uint32_t>(rand_r(&mSeed)) % (kAckTimeout / 2 + 1);
+        request->mTimeout = GetNowMillis() + request->mRetransmitTimeout;
+        request->mRetransmissions = 0;
+        request->mAcknowledged = false;
+    }
+
+    Transmit(message.GetBuffer(), message.GetLength(), peer);
+
+exit:
+    return;
+}
+
+void AgentNative::Input(const void *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort)
+{
+    const uint8_t *buffer = static_cast<const uint8_t *>(aBuffer);
+    MessageReader  message;
+    RecentMessage *recent;
+    Peer           peer;
+    uint64_t       now;
+
+    peer.Set(aIp6, aPort);
+
+    if (message.Parse(buffer, aLength))
+    {
+        // A malformed confirmable message is rejected, any other one is silently ignored.
+        if (aLength >= MessageReader::kHeaderSize && (buffer[0] >> 6) == MessageReader::kVersion &&
+            ((buffer[0] >> 4) & 0x03) == Message::kCoapTypeConfirmable)
+        {
+            ReplyEmpty(Message::kCoapTypeReset, GetMessageId(buffer), peer, NULL);
+        }
+
+        ExitNow(syslog(LOG_WARNING, "malformed CoAP message of %u bytes", aLength));
+    }
+
+    if (message.GetType() == Message::kCoapTypeAcknowledgment || message.GetType() == Message::kCoapTypeReset)
+    {
+        HandleAcknowledgment(message);
+        ExitNow();
+    }
+
+    now = GetNowMillis();
+
+    if ((recent = FindRecentMessage(message.GetMessageId(), peer, now)) != NULL)
+    {
+        sDuplicates.Increment();
+
+        if (recent->mReplyLength != 0)
+        {
+            Transmit(recent->mReply, recent->mReplyLength, peer);
+        }
+
+        ExitNow();
+    }
+
+    recent = &mRecentMessages[mNextRecentMessage];
+    mNextRecentMessage = (mNextRecentMessage + 1) % kMaxRecentMessages;
+    recent->mPeer = peer;
+    recent->mMessageId = message.GetMessageId();
+    recent->mExpiry = now + kExchangeLifetime;
+    recent->mReplyLength = 0;
+
+    if (message.GetCode() == Message::kCoapEmpty)
+    {
+        // An empty confirmable message is a ping.
+        if (message.GetType() == Message::kCoapTypeConfirmable)
+        {
+            ReplyEmpty(Message::kCoapTypeReset, message.GetMessageId(), peer, recent);
+        }
+    }
+    else if (message.GetCode() < Message::kCoapResponseCodeMin)
+    {
+        HandleRequest(message, *recent);
+    }
+    else
+    {
+        HandleResponse(message, *recent);
+    }
+
+exit:
+    return;
+}
+
+void AgentNative::HandleRequest(const MessageReader &aRequest, RecentMessage &aRecent)
+{
+    const Resource *resource = mResources;
+    bool            confirmable = (aRequest.GetType() == Message::kCoapTypeConfirmable);
+    MessageNative   request(aRequest);
+    MessageNative   response;
+    MessageWriter  &writer = response.GetWriter();
+    const uint8_t  *token;
+    uint8_t         tokenLength;
+
+    token = aRequest.GetToken(tokenLength);
+    writer.Init(confirmable ? Message::kCoapTypeAcknowledgment : Message::kCoapTypeNonConfirmable, Message::kCoapEmpty,
+                confirmable ? aRequest.GetMessageId() : mNextMessageId++, token, tokenLength);
+
+    while (resource != NULL && resource->mPath != NULL && !aRequest.IsPath(resource->mPath))
+    {
+        resource++;
+    }
+
+    if (resource == NULL || resource->mPath == NULL)
+    {
+        writer.SetCode(Message::kCoapResponseNotFound);
+    }
+    else if (aRequest.GetCode() != Message::kCoapRequestPost)
+    {
+        writer.SetCode(Message::kCoapResponseMethodNotAllowed);
+    }
+    else
+    {
+        resource->mHandler(*resource, request, response, aRecent.mPeer.mIp6.m8, aRecent.mPeer.mPort, mContext);
+    }
+
+    VerifyOrExit(!writer.HasFailed(), syslog(LOG_ERR, "CoAP response larger than %u bytes", MessageNative::kMaxSize));
+
+    if (writer.GetCode() != Message::kCoapEmpty)
+    {
+        Reply(writer, aRecent.mPeer, &aRecent);
+    }
+    else if (confirmable)
+    {
+        // The response will be sent separately.
+        ReplyEmpty(Message::kCoapTypeAcknowledgment, aRequest.GetMessageId(), aRecent.mPeer, &aRecent);
+    }
+
+exit:
+    return;
+}
+
+void AgentNative::HandleResponse(const MessageReader &aResponse, RecentMessage &aRecent)
+{
+    PendingRequest *request = NULL;
+    ResponseHandler handler = NULL;
+    const uint8_t  *token;
+    uint8_t         tokenLength;
+
+    token = aResponse.GetToken(tokenLength);
+
+    // Responses are matched by token only, as the leader answers requests to its anycast locator from its own.
+    for (int i = 0; i < kMaxPendingRequests; i++)
+    {
+        PendingRequest &pending = mPendingRequests[i];
+
+        if (pending.mLength != 0 && (pending.mBuffer[0] & 0x0f) == tokenLength &&
+            !memcmp(pending.mBuffer + MessageReader::kHeaderSize, token, tokenLength))
+        {
+            request = &pending;
+            break;
+        }
+    }
+
+    if (aResponse.GetType() == Message::kCoapTypeConfirmable)
+    {
+        ReplyEmpty(request != NULL ? Message::kCoapTypeAcknowledgment : Message::kCoapTypeReset,
+                   aResponse.GetMessageId(), aRecent.mPeer, &aRecent);
+    }
+
+    VerifyOrExit(request != NULL, syslog(LOG_ERR, "request not found!"));
+
+    handler = request->mHandler;
+    FreePendingRequest(*request);
+
+    if (handler != NULL)
+    {
+        MessageNative response(aResponse);
+
+        handler(response, mContext);
+    }
+
+exit:
+    return;
+}
+
+void AgentNative::HandleAcknowledgment(const MessageReader &aMessage)
+{
+    PendingRequest *request = NULL;
+    ResponseHandler handler = NULL;
+
+    for (int i = 0; i < kMaxPendingRequests; i++)
+    {
+        PendingRequest &pending = mPendingRequests[i];
+
+        if (pending.mLength != 0 && !pending.mAcknowledged && GetMessageId(pending.mBuffer) == aMessage.GetMessageId())
+        {
+            request = &pending;
+            break;
+        }
+    }
+
+    // Acknowledgments received again, or after giving up, are ignored.
+    VerifyOrExit(request != NULL);
+
+    if (aMessage.GetType() == Message::kCoapTypeReset)
+    {
+        syslog(LOG_WARNING, "CoAP request %u reset", aMessage.GetMessageId());
+        FreePendingRequest(*request);
+        ExitNow();
+    }
+
+    if (aMessage.GetCode() == Message::kCoapEmpty)
+    {
+        // The response will come separately, if anyone waits for it.
+        VerifyOrExit(request->mHandler != NULL, FreePendingRequest(*request));
+        request->mAcknowledged = true;
+        request->mTimeout = GetNowMillis() + kExchangeLifetime;
+        ExitNow();
+    }
+
+    handler = request->mHandler;
+    FreePendingRequest(*request);
+
+    if (handler != NULL)
+    {
+        MessageNative response(aMessage);
+
+        handler(response, mContext);
+    }
+
+exit:
+    return;
+}
+
+void AgentNative::UpdateTimeout(timeval &aTimeout)
+{
+    uint64_t now = GetNowMillis();
+    uint64_t timeout = static_cast<uint64_t>(aTimeout.tv_sec) * 1000 + static_cast<uint64_t>(aTimeout.tv_usec) / 1000;
+
+    for (int i = 0; i < kMaxPendingRequests; i++)
+    {
+        const PendingRequest &request = mPendingRequests[i];
+
+        if (request.mLength != 0 && request.mTimeout < now + timeout)
+        {
+            timeout = request.mTimeout > now ? request.mTimeout - now : 0;
+            aTimeout.tv_sec = static_cast<time_t>(timeout / 1000);
+            aTimeout.tv_usec = static_cast<suseconds_t>((timeout % 1000) * 1000);
+        }
+    }
+}
+
+void AgentNative::Process(void)
+{
+    uint64_t now = GetNowMillis();
+
+    for (int i = 0; i < kMaxPendingRequests; i++)
+    {
+        PendingRequest &request = mPendingRequests[i];
+
+        if (request.mLength == 0 || request.mTimeout > now)
+        {
+            continue;
+        }
+
+        if (request.mAcknowledged || request.mRetransmissions == kMaxRetransmit)
+        {
+            syslog(LOG_WARNING, "CoAP request %u timed out", GetMessageId(request.mBuffer));
+            FreePendingRequest(request);
+        }
+        else
+        {
+            request.mRetransmissions++;
+            request.mRetransmitTimeout *= 2;
+            request.mTimeout = now + request.mRetransmitTimeout;
+            sRetransmissions.Increment();
+            Transmit(request.mBuffer, request.mLength, request.mPeer);
+        }
+    }
+}
+
+void AgentNative::Reply(const MessageReader &aReply, const Peer &aPeer, RecentMessage *aRecent)
+{
+    // The reply is remembered to be repeated if the message it answers is received again.
+    if (aRecent != NULL)
+    {
+        memcpy(aRecent->mReply, aReply.GetBuffer(), aReply.GetLength());
+        aRecent->mReplyLength = aReply.GetLength();
+    }
+
+    Transmit(aReply.GetBuffer(), aReply.GetLength(), aPeer);
+}
+
+void AgentNative::ReplyEmpty(Message::Type aType, uint16_t aMessageId, const Peer &aPeer, RecentMessage *aRecent)
+{
+    uint8_t       buffer[MessageReader::kHeaderSize];
+    MessageWriter reply(buffer, sizeof(buffer));
+
+    reply.Init(aType, Message::kCoapEmpty, aMessageId, NULL, 0);
+    Reply(reply, aPeer, aRecent);
+}
+
+void AgentNative::Transmit(const uint8_t *aBuffer, uint16_t aLength, const Peer &aPeer)
+{
+    if (mNetworkSender(aBuffer, aLength, aPeer.mIp6.m8, aPeer.mPort, mContext) < 0)
+    {
+        syslog(LOG_WARNING, "failed to send CoAP message of %u bytes", aLength);
+    }
+}
+
+AgentNative::RecentMessage *AgentNative::FindRecentMessage(uint16_t aMessageId, const Peer &aPeer, uint64_t aNow)
+{
+    RecentMessage *recent = NULL;
+
+    for (int i = 0; i < kMaxRecentMessages; i++)
+    {
+        if (mRecentMessages[i].mExpiry > aNow && mRecentMessages[i].mMessageId == aMessageId &&
+            mRecentMessages[i].mPeer == aPeer)
+        {
+            recent = &mRecentMessages[i];
+            break;
+        }
+    }
+
+    return recent;
+}
+
+AgentNative::PendingRequest *AgentNative::NewPendingRequest(void)
+{
+    PendingRequest *request = NULL;
+
+    for (int i = 0; i < kMaxPendingRequests; i++)
+    {
+        PendingRequest &pending = mPendingRequests[i];
+
+        if (pending.mLength == 0)
+        {
+            request = &pending;
+            break;
+        }
+
+        // Otherwise the request waiting longest for its separate response is given up.
+        if (pending.mAcknowledged && (request == NULL || pending.mTimeout < request->mTimeout))
+        {
+            request = &pending;
+        }
+    }
+
+    VerifyOrExit(request != NULL);
+
+    if (request->mLength != 0)
+    {
+        syslog(LOG_WARNING, "CoAP request %u no longer waits for its response", GetMessageId(request->mBuffer));
+        FreePendingRequest(*request);
+    }
+
+    sPendingRequests.Add(1);
+
+exit:
+    return request;
+}
+
+void AgentNative::FreePendingRequest(PendingRequest &aRequest)
+{
+    aRequest.mLength = 0;
+    sPendingRequests.Add(-1);
+}
+
+Agent *Agent::Create(NetworkSender aNetworkSender, const Resource *aResources, void *aContext)
+{
+    return new AgentNative(aNetworkSender, aResources, aContext);
+}
+
+void Agent::Destroy(Agent *aAgent)
+{
+    delete static_cast<AgentNative *>(aAgent);
+}
+
+} // namespace Coap
+
+} // namespace BorderRouter
+
+} // namespace ot
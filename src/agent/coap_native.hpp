@@ -0,0 +1,295 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for the native CoAP service.
+ */
+
+#ifndef COAP_NATIVE_HPP_
+#define COAP_NATIVE_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "coap.hpp"
+#include "coap_codec.hpp"
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Coap {
+
+/**
+ * @addtogroup border-agent-coap
+ *
+ * @{
+ */
+
+/**
+ * This class implements CoAP message functionality over the in-place codec.
+ *
+ */
+class MessageNative : public Message
+{
+public:
+    enum
+    {
+        kMaxSize = 1280, ///< Max number of bytes of a message, the IPv6 minimum MTU.
+    };
+
+    /**
+     * The constructor to initialize an empty message in its own buffer.
+     *
+     */
+    MessageNative(void) :
+        mWriter(mBuffer, sizeof(mBuffer)),
+        mReader(&mWriter) {}
+
+    /**
+     * The constructor to wrap a received message, which must not be changed.
+     *
+     * @param[in]   aReader     A reference to the parsed message.
+     *
+     */
+    explicit MessageNative(const MessageReader &aReader) :
+        mWriter(mBuffer, sizeof(mBuffer)),
+        mReader(&aReader) {}
+
+    Code GetCode(void) const { return mReader->GetCode(); }
+    void SetCode(Code aCode) { mWriter.SetCode(aCode); }
+
+    Type GetType(void) const { return mReader->GetType(); }
+    void SetType(Type aType) { mWriter.SetType(aType); }
+
+    const uint8_t *GetToken(uint8_t &aLength) const { return mReader->GetToken(aLength); }
+    void SetToken(const uint8_t *aToken, uint8_t aLength) { mWriter.SetToken(aToken, aLength); }
+
+    void SetPath(const char *aPath) { mWriter.AppendPath(aPath); }
+
+    const uint8_t *GetPayload(uint16_t &aLength) const { return mReader->GetPayload(aLength); }
+
+    void SetPayload(const uint8_t *aPayload, uint16_t aLength) { mWriter.SetPayload(aPayload, aLength); }
+
+    /**
+     * This method returns the writer of this message.
+     *
+     * @returns A reference to the writer.
+     *
+     */
+    MessageWriter &GetWriter(void) { return mWriter; }
+
+private:
+    MessageNative(const MessageNative &);
+    MessageNative &operator=(const MessageNative &);
+
+    uint8_t              mBuffer[kMaxSize];
+    MessageWriter        mWriter;
+    const MessageReader *mReader;
+};
+
+/**
+ * This class implements a CoAP agent over the in-place codec.
+ *
+ * Received messages are parsed where they are, and messages are built in a few buffers owned by the agent, so no
+ * memory is allocated per message. Confirmable messages are retransmitted and received messages are deduplicated as
+ * RFC 7252 requires, with the exchanges in flight limited to fixed tables.
+ *
+ */
+class AgentNative : public Agent
+{
+public:
+    /**
+     * The constructor to initialize a CoAP agent.
+     *
+     * @param[in]   aNetworkSender      A pointer to the function that actually sends the data.
+     * @param[in]   aResources          A pointer to the Resource array. The last resource must be {0, 0}.
+     * @param[in]   aContext            A pointer to application-specific context.
+     *
+     */
+    AgentNative(NetworkSender aNetworkSender, const Resource *aResources, void *aContext);
+
+    ~AgentNative(void);
+
+    /**
+     * This method processes this CoAP message in @p aBuffer, which can be a request or response.
+     *
+     * @param[in]   aBuffer     A pointer to decrypted data.
+     * @param[in]   aLength     Number of bytes of @p aBuffer.
+     * @param[in]   aIp6        A pointer to the source Ipv6 address of this request.
+     * @param[in]   aPort       Source UDP port of this request.
+     *
+     */
+    void Input(const void *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort);
+
+    /**
+     * This method sends the CoAP message, which can be a request or response.
+     *
+     * @param[in]   aMessage    A reference to the message to send.
+     * @param[in]   aIp6        A pointer to the source Ipv6 address of this request.
+     * @param[in]   aPort       Source UDP port of this request.
+     * @param[in]   aHandler    A function poiner to be called when response is received if the message is a request.
+     *
+     */
+    void Send(Message &aMessage, const uint8_t *aIp6, uint16_t aPort, ResponseHandler aHandler);
+
+    /**
+     * This method creates a CoAP message with the given arguments.
+     *
+     * @param[in]   aType           The CoAP type.
+     * @param[in]   aCode           The CoAP code.
+     * @param[in]   aToken          The CoAP token.
+     * @param[in]   aTokenLength    Number of bytes in @p aToken.
+     *
+     * @returns The newly CoAP message.
+     *
+     */
+    Message *NewMessage(Message::Type aType, Message::Code aCode, const uint8_t *aToken, uint8_t aTokenLength);
+
+    /**
+     * This method frees a CoAP message.
+     *
+     * @param[in]   aMessage    A pointer to the message to free.
+     *
+     */
+    void FreeMessage(Message *aMessage);
+
+    /**
+     * This method updates the timeout for mainloop.
+     *
+     * @param[inout]    aTimeout    A reference to the timeout.
+     *
+     */
+    void UpdateTimeout(timeval &aTimeout);
+
+    /**
+     * This method retransmits the confirmable messages which are not acknowledged in time.
+     *
+     */
+    void Process(void);
+
+private:
+    enum
+    {
+        kMaxMessages        = 4,      ///< Max number of messages being built at once.
+        kMaxPendingRequests = 8,      ///< Max number of confirmable messages waiting for their response.
+        kMaxRecentMessages  = 8,      ///< Max number of received messages remembered for deduplication.
+        kAckTimeout         = 2000,   ///< ACK_TIMEOUT in milliseconds.
+        kMaxRetransmit      = 4,      ///< MAX_RETRANSMIT.
+        kExchangeLifetime   = 247000, ///< EXCHANGE_LIFETIME in milliseconds.
+    };
+
+    /**
+     * This structure represents the other end of an exchange.
+     *
+     */
+    struct Peer
+    {
+        void Set(const uint8_t *aIp6, uint16_t aPort) {
+            mIp6 = Ip6Address();
+            mPort = aPort;
+
+            if (aIp6 != NULL)
+            {
+                memcpy(mIp6.m8, aIp6, sizeof(mIp6.m8));
+            }
+        }
+
+        bool operator==(const Peer &aOther) const {
+            return mPort == aOther.mPort && mIp6.m64[0] == aOther.mIp6.m64[0] && mIp6.m64[1] == aOther.mIp6.m64[1];
+        }
+
+        Ip6Address mIp6;
+        uint16_t   mPort;
+    };
+
+    /**
+     * This structure represents a confirmable message sent and waiting for its acknowledgment or response.
+     *
+     */
+    struct PendingRequest
+    {
+        uint8_t         mBuffer[MessageNative::kMaxSize]; ///< The message to retransmit.
+        uint16_t        mLength;                          ///< Number of bytes of the message, 0 if unused.
+        Peer            mPeer;                            ///< The destination.
+        ResponseHandler mHandler;                         ///< The function to handle the response.
+        uint64_t        mTimeout;                         ///< When to retransmit, or to give up once acknowledged.
+        uint32_t        mRetransmitTimeout;               ///< Milliseconds before the next retransmission.
+        uint8_t         mRetransmissions;                 ///< Number of retransmissions so far.
+        bool            mAcknowledged;                    ///< Whether only the response is waited for.
+    };
+
+    /**
+     * This structure represents a message received, with the reply to repeat when it is received again.
+     *
+     */
+    struct RecentMessage
+    {
+        Peer     mPeer;                           ///< The source.
+        uint16_t mMessageId;                      ///< The CoAP message id.
+        uint64_t mExpiry;                         ///< When the message is forgotten, 0 if unused.
+        uint8_t  mReply[MessageNative::kMaxSize]; ///< The reply sent.
+        uint16_t mReplyLength;                    ///< Number of bytes of the reply, 0 if none.
+    };
+
+    void HandleRequest(const MessageReader &aRequest, RecentMessage &aRecent);
+    void HandleResponse(const MessageReader &aResponse, RecentMessage &aRecent);
+    void HandleAcknowledgment(const MessageReader &aMessage);
+    void Reply(const MessageReader &aReply, const Peer &aPeer, RecentMessage *aRecent);
+    void ReplyEmpty(Message::Type aType, uint16_t aMessageId, const Peer &aPeer, RecentMessage *aRecent);
+    void Transmit(const uint8_t *aBuffer, uint16_t aLength, const Peer &aPeer);
+    RecentMessage *FindRecentMessage(uint16_t aMessageId, const Peer &aPeer, uint64_t aNow);
+    PendingRequest *NewPendingRequest(void);
+    void FreePendingRequest(PendingRequest &aRequest);
+
+    const Resource *mResources;
+    NetworkSender   mNetworkSender;
+    void           *mContext;
+    uint16_t        mNextMessageId;
+    unsigned int    mSeed;
+
+    MessageNative  mMessages[kMaxMessages];
+    bool           mMessagesUsed[kMaxMessages];
+    PendingRequest mPendingRequests[kMaxPendingRequests];
+    RecentMessage  mRecentMessages[kMaxRecentMessages];
+    uint8_t        mNextRecentMessage;
+};
+
+/**
+ * @}
+ */
+
+} // namespace Coap
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif  // COAP_NATIVE_HPP_
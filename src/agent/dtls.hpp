@@ -34,6 +34,9 @@
 #ifndef DTLS_HPP_
 #define DTLS_HPP_
 
+#include <vector>
+
+#include <stdint.h>
 #include <sys/select.h>
 
 namespace ot {
@@ -109,6 +112,8 @@ public:
     /**
      * This method sends data through the session.
      *
+     * The data is encrypted right away, and the record is sent once the socket is writable.
+     *
      * @param[in]   aBuffer     A pointer to plain data.
      * @param[in]   aLength     Number of bytes of @p aBuffer.
      *
@@ -186,6 +191,22 @@ public:
      */
     virtual void SetSeed(const uint8_t *aSeed, uint16_t aLength) = 0;
 
+    /**
+     * This method starts accepting new sessions.
+     *
+     * The socket is bound on creation, but handshakes of new peers wait in it until the PSK and seed are set.
+     *
+     */
+    virtual void Start(void) = 0;
+
+    /**
+     * This method returns the number of sessions handshaking or established.
+     *
+     * @returns The number of active sessions.
+     *
+     */
+    virtual size_t GetSessionCount(void) const = 0;
+
     /**
      * This method updates the fd_set and timeout for mainloop.
      * @p aTimeout should only be updated if the DTLS service has pending process in less than its current value.
@@ -205,6 +226,31 @@ public:
      */
     virtual void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet) = 0;
 
+    /**
+     * This method hands the established sessions over to another process.
+     *
+     * The sessions are detached without notifying their peers, and can no longer be used by this server.
+     *
+     * @param[out]  aState  The serialized state of the sessions.
+     * @param[out]  aFds    The sockets of the sessions, owned by the caller from now on.
+     *
+     */
+    virtual void HandOver(std::vector<uint8_t> &aState, std::vector<int> &aFds) = 0;
+
+    /**
+     * This method resumes the sessions handed over by another process.
+     *
+     * The server takes the ownership of @p aFds, sockets of sessions failing to resume are closed and the other
+     * sessions are resumed.
+     *
+     * @param[in]   aState  The serialized state of the sessions.
+     * @param[in]   aFds    The sockets of the sessions.
+     *
+     * @returns 0 if every session is resumed, otherwise failure.
+     *
+     */
+    virtual int Resume(const std::vector<uint8_t> &aState, const std::vector<int> &aFds) = 0;
+
     virtual ~Server(void) {}
 };
 
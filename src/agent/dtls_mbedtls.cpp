@@ -34,10 +34,22 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <new>
 
+#include <errno.h>
 #include <syslog.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+extern "C" {
+#include <mbedtls/ssl_internal.h>
+}
 
 #include "common/code_utils.hpp"
+#include "common/metrics.hpp"
+#include "common/systemd.hpp"
 #include "common/time.hpp"
 
 namespace ot {
@@ -55,6 +67,68 @@ enum
     kLogLevelVerbose,     ///< 4 Verbose
 };
 
+static Metrics::Counter   sHandshakesStarted("otbr_dtls_handshakes_started_total",
+                                            "DTLS handshakes started by external commissioners.");
+static Metrics::Counter   sHandshakesSucceeded("otbr_dtls_handshakes_succeeded_total",
+                                              "DTLS handshakes completed successfully.");
+static Metrics::Counter   sHandshakesFailed("otbr_dtls_handshakes_failed_total",
+                                           "DTLS handshakes aborted with an error.");
+static Metrics::Histogram sHandshakeDuration("otbr_dtls_handshake_duration_seconds",
+                                             "Duration of successful DTLS handshakes.");
+static Metrics::Gauge     sActiveSessions("otbr_dtls_sessions_active",
+                                          "DTLS sessions ready for commissioning traffic.");
+static Metrics::Counter   sRecordsSent("otbr_dtls_records_sent_total",
+                                       "Encrypted DTLS records sent to commissioners.");
+static Metrics::Counter   sRecordsDropped("otbr_dtls_records_dropped_total",
+                                          "Encrypted DTLS records dropped because the write queue was full.");
+static Metrics::Counter   sWriteFlushes("otbr_dtls_write_flushes_total",
+                                        "Calls to sendmmsg flushing the DTLS write queues.");
+static Metrics::Counter   sSessionsRejected("otbr_dtls_sessions_rejected_total",
+                                            "DTLS sessions refused because the session pool or heap was full.");
+static Metrics::Gauge     sSessionHeapPeak("otbr_dtls_session_heap_peak_bytes",
+                                           "Most bytes of mbed TLS heap used by a single DTLS session.");
+static Metrics::Gauge     sWriteQueuePeak("otbr_dtls_write_queue_peak_bytes",
+                                          "Most bytes of encrypted records queued by a single DTLS session.");
+
+static void WriteBigEndian(uint8_t *aBuffer, uint64_t aValue, size_t aLength)
+{
+    while (aLength > 0)
+    {
+        aBuffer[--aLength] = static_cast<uint8_t>(aValue & 0xff);
+        aValue >>= 8;
+    }
+}
+
+static uint64_t ReadBigEndian(const uint8_t *aBuffer, size_t aLength)
+{
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < aLength; i++)
+    {
+        value = (value << 8) | aBuffer[i];
+    }
+
+    return value;
+}
+
+/**
+ * This function returns the address of a peer, which is the transport id of its session.
+ *
+ */
+static void GetPeerIp(const sockaddr_storage &aPeer, const uint8_t *&aIp, size_t &aIpLength)
+{
+    if (aPeer.ss_family == AF_INET6)
+    {
+        aIp = reinterpret_cast<const sockaddr_in6 *>(&aPeer)->sin6_addr.s6_addr;
+        aIpLength = sizeof(in6_addr);
+    }
+    else
+    {
+        aIp = reinterpret_cast<const uint8_t *>(&reinterpret_cast<const sockaddr_in *>(&aPeer)->sin_addr);
+        aIpLength = sizeof(in_addr);
+    }
+}
+
 static void MbedtlsDebug(void *ctx, int level,
                          const char *file, int line,
                          const char *str)
@@ -98,10 +172,81 @@ void Server::Destroy(Server *aServer)
     delete static_cast<MbedtlsServer *>(aServer);
 }
 
+#if defined(MBEDTLS_ECP_FIXED_POINT_SHARED)
+/**
+ * This function computes the multiples of the base point shared by all EC-JPAKE contexts.
+ *
+ * Done before any session exists, so no session is charged for them.
+ *
+ */
+static int PrecomputeBasePoint(void)
+{
+    int               ret;
+    mbedtls_ecp_group group;
+    mbedtls_ecp_point point;
+    mbedtls_mpi       one;
+
+    mbedtls_ecp_group_init(&group);
+    mbedtls_ecp_point_init(&point);
+    mbedtls_mpi_init(&one);
+
+    SuccessOrExit(ret = mbedtls_ecp_group_load(&group, MBEDTLS_ECP_DP_SECP256R1));
+    SuccessOrExit(ret = mbedtls_mpi_lset(&one, 1));
+    ret = mbedtls_ecp_mul(&group, &point, &one, &group.G, NULL, NULL);
+
+exit:
+    mbedtls_mpi_free(&one);
+    mbedtls_ecp_point_free(&point);
+    mbedtls_ecp_group_free(&group);
+
+    return ret;
+}
+#endif
+
+unsigned                 MbedtlsServer::sServerCount = 0;
+mbedtls_entropy_context  MbedtlsServer::sEntropy;
+mbedtls_ctr_drbg_context MbedtlsServer::sCtrDrbg;
+
+int MbedtlsServer::InitRandom(void)
+{
+    int ret = 0;
+
+    VerifyOrExit(sServerCount++ == 0);
+
+    mbedtls_entropy_init(&sEntropy);
+    mbedtls_ctr_drbg_init(&sCtrDrbg);
+
+    // Sessions are bounded from the first server on, before any of them allocates.
+    MbedtlsHeap::Install();
+
+    syslog(LOG_DEBUG, "Setting CTR_DRBG seed");
+    SuccessOrExit(ret = mbedtls_ctr_drbg_seed(&sCtrDrbg, mbedtls_entropy_func, &sEntropy, NULL, 0));
+
+#if defined(MBEDTLS_ECP_FIXED_POINT_SHARED)
+    SuccessOrExit(ret = PrecomputeBasePoint());
+#endif
+
+exit:
+    return ret;
+}
+
+void MbedtlsServer::FreeRandom(void)
+{
+    VerifyOrExit(--sServerCount == 0);
+
+    mbedtls_ctr_drbg_free(&sCtrDrbg);
+    mbedtls_entropy_free(&sEntropy);
+
+exit:
+    return;
+}
+
 MbedtlsServer::MbedtlsServer(uint16_t aPort, StateHandler aStateHandler, void *aContext) :
     mPort(aPort),
     mStateHandler(aStateHandler),
-    mContext(aContext)
+    mContext(aContext),
+    mPSKLength(0),
+    mStarted(false)
 {
     int              ret = 0;
     static const int ciphersuites[] =
@@ -115,14 +260,11 @@ MbedtlsServer::MbedtlsServer(uint16_t aPort, StateHandler aStateHandler, void *a
 #if defined(MBEDTLS_SSL_CACHE_C)
     mbedtls_ssl_cache_init(&mCache);
 #endif
-    mbedtls_entropy_init(&mEntropy);
-    mbedtls_ctr_drbg_init(&mCtrDrbg);
+    mbedtls_net_init(&mNet);
 
     mbedtls_debug_set_threshold(kLogLevelError);
 
-    syslog(LOG_DEBUG, "Setting CTR_DRBG seed");
-    SuccessOrExit(ret = mbedtls_ctr_drbg_seed(&mCtrDrbg, mbedtls_entropy_func, &mEntropy, mSeed,
-                                              mSeedLength));
+    SuccessOrExit(ret = InitRandom());
 
     syslog(LOG_DEBUG, "Configuring DTLS");
     SuccessOrExit(ret = mbedtls_ssl_config_defaults(&mConf,
@@ -130,7 +272,7 @@ MbedtlsServer::MbedtlsServer(uint16_t aPort, StateHandler aStateHandler, void *a
                                                     MBEDTLS_SSL_TRANSPORT_DATAGRAM,
                                                     MBEDTLS_SSL_PRESET_DEFAULT));
 
-    mbedtls_ssl_conf_rng(&mConf, mbedtls_ctr_drbg_random, &mCtrDrbg);
+    mbedtls_ssl_conf_rng(&mConf, mbedtls_ctr_drbg_random, &sCtrDrbg);
     mbedtls_ssl_conf_min_version(&mConf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
     mbedtls_ssl_conf_max_version(&mConf, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
     mbedtls_ssl_conf_dbg(&mConf, MbedtlsDebug, this);
@@ -142,16 +284,25 @@ MbedtlsServer::MbedtlsServer(uint16_t aPort, StateHandler aStateHandler, void *a
 #endif
 
     syslog(LOG_DEBUG, "Setting up cookie");
-    SuccessOrExit(ret = mbedtls_ssl_cookie_setup(&mCookie, mbedtls_ctr_drbg_random, &mCtrDrbg));
+    SuccessOrExit(ret = mbedtls_ssl_cookie_setup(&mCookie, mbedtls_ctr_drbg_random, &sCtrDrbg));
 
     mbedtls_ssl_conf_dtls_cookies(&mConf, mbedtls_ssl_cookie_write, mbedtls_ssl_cookie_check,
                                   &mCookie);
 
-    mbedtls_net_init(&mNet);
+    if ((mNet.fd = Systemd::TakeListenSocket(SOCK_DGRAM, mPort)) >= 0)
+    {
+        int reuse = 1;
 
-    syslog(LOG_DEBUG, "Binding to port %u", mPort);
+        syslog(LOG_INFO, "Using the socket passed for port %u", mPort);
+        // Sessions bind their own sockets to the same address.
+        VerifyOrExit(setsockopt(mNet.fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == 0,
+                     ret = MBEDTLS_ERR_NET_SOCKET_FAILED);
+    }
+    else
     {
         char port[6];
+
+        syslog(LOG_DEBUG, "Binding to port %u", mPort);
         sprintf(port, "%u", mPort);
         SuccessOrExit(ret = mbedtls_net_bind(&mNet, "0.0.0.0", port, MBEDTLS_NET_PROTO_UDP));
     }
@@ -160,12 +311,33 @@ exit:
     if (ret != 0)
     {
         syslog(LOG_ERR, "mbedtls error: %d", ret);
+        CloseListener();
+        mbedtls_ssl_config_free(&mConf);
+        mbedtls_ssl_cookie_free(&mCookie);
+#if defined(MBEDTLS_SSL_CACHE_C)
+        mbedtls_ssl_cache_free(&mCache);
+#endif
+        FreeRandom();
         throw std::runtime_error("Failed to create DTLS server");
     }
 }
 
 void MbedtlsSession::SetState(State aState)
 {
+    if (mState != kStateReady && aState == kStateReady)
+    {
+        sActiveSessions.Add(1);
+    }
+    else if (mState == kStateReady && aState != kStateReady)
+    {
+        sActiveSessions.Add(-1);
+    }
+
+    if (aState == kStateHandshaking)
+    {
+        mHandshakeStart = 0;
+    }
+
     mState = aState;
     mServer.HandleSessionState(*this, aState);
 }
@@ -176,45 +348,186 @@ void MbedtlsSession::SetDataHandler(DataHandler aDataHandler, void *aContext)
     mDataHandler = aDataHandler;
 }
 
-ssize_t MbedtlsSession::Write(const uint8_t *aBuffer, uint16_t aLength)
+SlabPool MbedtlsSession::sPool(sizeof(MbedtlsSession), kMaxSessions);
+
+void *MbedtlsSession::operator new(size_t aSize)
 {
-    int ret;
+    void *pointer = (aSize == sizeof(MbedtlsSession) ? sPool.Allocate() : NULL);
 
-    do
+    if (pointer == NULL)
     {
-        ret = mbedtls_ssl_write(&mSsl, aBuffer, aLength);
+        throw std::bad_alloc();
     }
-    while (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
 
-    if (ret < 0)
+    return pointer;
+}
+
+void MbedtlsSession::operator delete(void *aPointer)
+{
+    sPool.Free(aPointer);
+}
+
+ssize_t MbedtlsSession::Write(const uint8_t *aBuffer, uint16_t aLength)
+{
+    MbedtlsHeap::Scope scope(mHeapUsage);
+    int                ret = -1;
+
+    // A full queue drops the data like a congested link would, rather than stalling the agent.
+    VerifyOrExit(mWriteCount < kWriteQueueSize, DropRecord());
+
+    ret = mbedtls_ssl_write(&mSsl, aBuffer, aLength);
+
+    if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
     {
         SetState(kStateError);
     }
 
+exit:
     return ret;
 }
 
 void MbedtlsSession::Close(void)
 {
+    MbedtlsHeap::Scope scope(mHeapUsage);
+
     VerifyOrExit(mState != kStateError && mState != kStateEnd);
 
-    while (mbedtls_ssl_close_notify(&mSsl) == MBEDTLS_ERR_SSL_WANT_WRITE) ;
+    mbedtls_ssl_close_notify(&mSsl);
     SetState(kStateEnd);
 
 exit:
     return;
 }
 
+int MbedtlsSession::SendRecord(void *aContext, const unsigned char *aBuffer, size_t aLength)
+{
+    MbedtlsSession *session = static_cast<MbedtlsSession *>(aContext);
+
+    if (session->mWriteCount == kWriteQueueSize || aLength > kMaxPacketSize ||
+        session->mWriteQueue.size() + aLength > kWriteQueueMax)
+    {
+        session->DropRecord();
+    }
+    else
+    {
+        session->mWriteQueue.insert(session->mWriteQueue.end(), aBuffer, aBuffer + aLength);
+        session->mWriteLengths[session->mWriteCount++] = static_cast<uint16_t>(aLength);
+        session->mWriteQueuePeak = std::max(session->mWriteQueuePeak, session->mWriteQueue.size());
+    }
+
+    // Dropped records are reported as sent, DTLS copes with them as with any datagram lost on the way.
+    return static_cast<int>(aLength);
+}
+
+int MbedtlsSession::ReceiveRecord(void *aContext, unsigned char *aBuffer, size_t aLength)
+{
+    MbedtlsSession *session = static_cast<MbedtlsSession *>(aContext);
+    int             ret;
+
+    VerifyOrExit(!session->mPendingRecord.empty(), ret = mbedtls_net_recv(&session->mNet, aBuffer, aLength));
+
+    // Like a datagram, a record larger than the buffer is truncated.
+    aLength = std::min(aLength, session->mPendingRecord.size());
+    memcpy(aBuffer, &session->mPendingRecord[0], aLength);
+    session->mPendingRecord.clear();
+    ret = static_cast<int>(aLength);
+
+exit:
+    return ret;
+}
+
+void MbedtlsSession::DropRecord(void)
+{
+    mDroppedRecords++;
+    sRecordsDropped.Increment();
+    syslog(LOG_WARNING, "DTLS session[%d] write queue full, record dropped", mNet.fd);
+}
+
+void MbedtlsSession::Flush(void)
+{
+    struct mmsghdr messages[kWriteQueueSize];
+    struct iovec   iovecs[kWriteQueueSize];
+    size_t         offset = 0;
+    int            sent;
+
+    VerifyOrExit(mWriteCount > 0);
+
+    memset(messages, 0, sizeof(messages));
+
+    for (uint8_t i = 0; i < mWriteCount; i++)
+    {
+        iovecs[i].iov_base = &mWriteQueue[offset];
+        iovecs[i].iov_len = mWriteLengths[i];
+        offset += mWriteLengths[i];
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // The socket is connected to the commissioner, so one call sends the whole burst.
+    sent = sendmmsg(mNet.fd, messages, mWriteCount, 0);
+    sWriteFlushes.Increment();
+
+    if (sent < 0)
+    {
+        VerifyOrExit(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+        syslog(LOG_WARNING, "DTLS session[%d] failed to send: %s", mNet.fd, strerror(errno));
+
+        // Give up the record at the head rather than failing on it again and again.
+        sent = 1;
+    }
+    else
+    {
+        sRecordsSent.Increment(static_cast<uint64_t>(sent));
+    }
+
+    offset = 0;
+
+    for (int i = 0; i < sent; i++)
+    {
+        offset += mWriteLengths[i];
+    }
+
+    mWriteCount -= sent;
+    memmove(mWriteLengths, mWriteLengths + sent, mWriteCount * sizeof(mWriteLengths[0]));
+    mWriteQueue.erase(mWriteQueue.begin(), mWriteQueue.begin() + offset);
+
+    // Memory of a burst is given back once it is sent, an idle session keeps at most one packet.
+    if (mWriteCount == 0 && mWriteQueue.capacity() > kMaxPacketSize)
+    {
+        std::vector<uint8_t>().swap(mWriteQueue);
+    }
+
+exit:
+    return;
+}
+
 MbedtlsSession::~MbedtlsSession(void)
 {
     Close();
+
+    // Alerts are queued like any other record, send what the socket takes before closing it.
+    Flush();
     mbedtls_net_free(&mNet);
     mbedtls_ssl_free(&mSsl);
-    syslog(LOG_INFO, "DTLS session destroyed: %d", mState);
+
+    if (sSessionHeapPeak.Get() < static_cast<int64_t>(mHeapUsage.mPeak))
+    {
+        sSessionHeapPeak.Set(static_cast<int64_t>(mHeapUsage.mPeak));
+    }
+
+    if (sWriteQueuePeak.Get() < static_cast<int64_t>(mWriteQueuePeak))
+    {
+        sWriteQueuePeak.Set(static_cast<int64_t>(mWriteQueuePeak));
+    }
+
+    syslog(LOG_INFO, "DTLS session destroyed: %d, %lu records dropped, at most %zu bytes of heap, %zu of records",
+           mState, mDroppedRecords, mHeapUsage.mPeak, mWriteQueuePeak);
 }
 
 void MbedtlsSession::Process(void)
 {
+    MbedtlsHeap::Scope scope(mHeapUsage);
+
     mExpiration = GetNow() + kSessionTimeout;
 
     switch (mState)
@@ -296,13 +609,101 @@ int MbedtlsSession::ExportKeys(void *aContext, const unsigned char *aMasterSecre
     return 0;
 }
 
+void MbedtlsSession::Save(SessionSnapshot &aSnapshot) const
+{
+    uint64_t now = GetNow();
+
+    memset(&aSnapshot, 0, sizeof(aSnapshot));
+    WriteBigEndian(aSnapshot.mCiphersuite, static_cast<uint64_t>(mSsl.session->ciphersuite),
+                   sizeof(aSnapshot.mCiphersuite));
+    memcpy(aSnapshot.mMaster, mSsl.session->master, sizeof(aSnapshot.mMaster));
+    memcpy(aSnapshot.mRandBytes, mRandBytes, sizeof(aSnapshot.mRandBytes));
+    memcpy(aSnapshot.mOutCounter, mSsl.out_ctr, sizeof(aSnapshot.mOutCounter));
+    WriteBigEndian(aSnapshot.mInEpoch, mSsl.in_epoch, sizeof(aSnapshot.mInEpoch));
+#if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
+    WriteBigEndian(aSnapshot.mInWindowTop, mSsl.in_window_top, sizeof(aSnapshot.mInWindowTop));
+    WriteBigEndian(aSnapshot.mInWindow, mSsl.in_window, sizeof(aSnapshot.mInWindow));
+#endif
+    WriteBigEndian(aSnapshot.mTimeout, mExpiration > now ? mExpiration - now : 0, sizeof(aSnapshot.mTimeout));
+}
+
+int MbedtlsSession::Resume(const SessionSnapshot &aSnapshot)
+{
+    MbedtlsHeap::Scope               scope(mHeapUsage);
+    int                              ret = 0;
+    int                              id = static_cast<int>(ReadBigEndian(aSnapshot.mCiphersuite,
+                                                                         sizeof(aSnapshot.mCiphersuite)));
+    const mbedtls_ssl_ciphersuite_t *ciphersuite = mbedtls_ssl_ciphersuite_from_id(id);
+    mbedtls_ssl_transform           *transform = mSsl.transform_negotiate;
+
+    VerifyOrExit(ciphersuite != NULL && mSsl.handshake != NULL, ret = MBEDTLS_ERR_SSL_BAD_INPUT_DATA);
+
+    // mbedtls 2.4 cannot serialize a context, so the keys are derived again as for an abbreviated handshake
+    // resuming the session.
+    mSsl.major_ver = MBEDTLS_SSL_MAJOR_VERSION_3;
+    mSsl.minor_ver = MBEDTLS_SSL_MINOR_VERSION_3;
+    mSsl.handshake->resume = 1;
+    mSsl.session_negotiate->ciphersuite = id;
+    memcpy(mSsl.session_negotiate->master, aSnapshot.mMaster, sizeof(aSnapshot.mMaster));
+    memcpy(mSsl.handshake->randbytes, aSnapshot.mRandBytes, sizeof(aSnapshot.mRandBytes));
+    transform->ciphersuite_info = ciphersuite;
+    SuccessOrExit(ret = mbedtls_ssl_derive_keys(&mSsl));
+
+    // Switch both directions to the derived keys, as the ChangeCipherSpec messages of the handshake did.
+    mSsl.transform_in = transform;
+    mSsl.transform_out = transform;
+    mSsl.session_in = mSsl.session_negotiate;
+    mSsl.session_out = mSsl.session_negotiate;
+    mSsl.in_msg = mSsl.in_iv + transform->ivlen - transform->fixed_ivlen;
+    mSsl.out_msg = mSsl.out_iv + transform->ivlen - transform->fixed_ivlen;
+
+    memcpy(mSsl.out_ctr, aSnapshot.mOutCounter, sizeof(aSnapshot.mOutCounter));
+    mSsl.in_epoch = static_cast<uint16_t>(ReadBigEndian(aSnapshot.mInEpoch, sizeof(aSnapshot.mInEpoch)));
+#if defined(MBEDTLS_SSL_DTLS_ANTI_REPLAY)
+    mSsl.in_window_top = ReadBigEndian(aSnapshot.mInWindowTop, sizeof(aSnapshot.mInWindowTop));
+    mSsl.in_window = ReadBigEndian(aSnapshot.mInWindow, sizeof(aSnapshot.mInWindow));
+#endif
+
+    mSsl.state = MBEDTLS_SSL_HANDSHAKE_WRAPUP;
+    mbedtls_ssl_handshake_wrapup(&mSsl);
+
+    mExpiration = GetNow() + ReadBigEndian(aSnapshot.mTimeout, sizeof(aSnapshot.mTimeout));
+
+exit:
+    return ret;
+}
+
+int MbedtlsSession::Detach(void)
+{
+    int fd = mNet.fd;
+
+    // Records the socket does not take now are lost like any datagram, the peer retransmits what it misses.
+    Flush();
+    mWriteCount = 0;
+    std::vector<uint8_t>().swap(mWriteQueue);
+    SetState(kStateEnd);
+
+    // mbedtls_net_free() shuts the socket down, which would also cut it off in the new process.
+    mNet.fd = -1;
+
+    return fd;
+}
+
 MbedtlsSession::MbedtlsSession(MbedtlsServer &aServer, mbedtls_net_context &aNet, const uint8_t *aIp,
                                size_t aIpLength) :
     mNet(aNet),
-    mServer(aServer)
+    mServer(aServer),
+    mWriteCount(0),
+    mWriteQueuePeak(0),
+    mDroppedRecords(0),
+    mHeapUsage()
 {
     int ret = 0;
 
+    mHeapUsage.mLimit = kMaxHeapSize;
+
+    MbedtlsHeap::Scope scope(mHeapUsage);
+
     mbedtls_ssl_init(&mSsl);
     SuccessOrExit(ret = mbedtls_ssl_setup(&mSsl, &mServer.mConf));
 
@@ -312,14 +713,17 @@ MbedtlsSession::MbedtlsSession(MbedtlsServer &aServer, mbedtls_net_context &aNet
     SuccessOrExit(ret = mbedtls_ssl_set_hs_ecjpake_password(&mSsl, mServer.mPSK, mServer.mPSKLength));
     SuccessOrExit(ret = mbedtls_ssl_set_client_transport_id(&mSsl, aIp, aIpLength));
     SuccessOrExit(ret = mbedtls_net_set_nonblock(&mNet));
-    mbedtls_ssl_set_bio(&mSsl, &mNet, mbedtls_net_send, mbedtls_net_recv, NULL);
+    mbedtls_ssl_set_bio(&mSsl, this, SendRecord, ReceiveRecord, NULL);
 
     mState = kStateHandshaking;
+    mHandshakeStart = 0;
 
 exit:
     if (ret)
     {
         syslog(LOG_ERR, "Failed to create session: %d", ret);
+        // The destructor is not run, and the socket stays with the caller.
+        mbedtls_ssl_free(&mSsl);
         throw std::runtime_error("Failed to create session");
     }
 }
@@ -332,10 +736,37 @@ int MbedtlsSession::Handshake(void)
 
     syslog(LOG_INFO, "Performing DTLS handshake");
 
-    SuccessOrExit(ret = mbedtls_ssl_handshake(&mSsl));
+    {
+        uint64_t now = GetMonotonicMicros();
+
+        // Stepping through the handshake like mbedtls_ssl_handshake() does, to keep the random values before the
+        // key derivation wipes them. They let another process derive the same keys when the session is handed over.
+        do
+        {
+            if (mSsl.state == MBEDTLS_SSL_CLIENT_KEY_EXCHANGE)
+            {
+                memcpy(mRandBytes, mSsl.handshake->randbytes, sizeof(mRandBytes));
+            }
+
+            ret = mbedtls_ssl_handshake_step(&mSsl);
+        }
+        while (ret == 0 && mSsl.state != MBEDTLS_SSL_HANDSHAKE_OVER);
+
+        // A ClientHello without a valid cookie only triggers the cookie exchange, the real handshake comes with
+        // the next ClientHello.
+        if (mHandshakeStart == 0 && ret != MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED)
+        {
+            sHandshakesStarted.Increment();
+            mHandshakeStart = now;
+        }
+    }
+
+    SuccessOrExit(ret);
 
     syslog(LOG_INFO, "DTLS session ready");
 
+    sHandshakesSucceeded.Increment();
+    sHandshakeDuration.Record(GetMonotonicMicros() - mHandshakeStart);
     SetState(kStateReady);
 
 
@@ -354,6 +785,7 @@ exit:
             {
                 mbedtls_ssl_send_alert_message(&mSsl, MBEDTLS_SSL_ALERT_LEVEL_FATAL,
                                                MBEDTLS_SSL_ALERT_MSG_HANDSHAKE_FAILURE);
+                sHandshakesFailed.Increment();
             }
             mState = kStateError;
         }
@@ -387,6 +819,11 @@ void MbedtlsServer::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, int &aM
             syslog(LOG_INFO, "DTLS session[%d] alive", fd);
             FD_SET(fd, &aReadFdSet);
 
+            if (session->HasQueuedRecords())
+            {
+                FD_SET(fd, &aWriteFdSet);
+            }
+
             if (aMaxFd < fd)
             {
                 aMaxFd = fd;
@@ -406,17 +843,18 @@ void MbedtlsServer::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, int &aM
         }
     }
 
-    FD_SET(mNet.fd, &aReadFdSet);
-
-    if (aMaxFd < mNet.fd)
+    if (mStarted)
     {
-        aMaxFd = mNet.fd;
+        FD_SET(mNet.fd, &aReadFdSet);
+
+        if (aMaxFd < mNet.fd)
+        {
+            aMaxFd = mNet.fd;
+        }
     }
 
     aTimeout.tv_sec = timeout / 1000;
     aTimeout.tv_usec = (timeout % 1000) * 1000;
-
-    (void)aWriteFdSet;
 }
 
 void MbedtlsServer::HandleSessionState(Session &aSession, Session::State aState)
@@ -428,23 +866,72 @@ void MbedtlsServer::HandleSessionState(Session &aSession, Session::State aState)
     }
 }
 
+boost::shared_ptr<MbedtlsSession> MbedtlsServer::NewSession(mbedtls_net_context &aNet, const uint8_t *aIp,
+                                                            size_t aIpLength)
+{
+    boost::shared_ptr<MbedtlsSession> session;
+
+    // Setting up a session fails when its heap or the session pool runs out, which only costs this peer.
+    try
+    {
+        session.reset(new MbedtlsSession(*this, aNet, aIp, aIpLength));
+    }
+    catch (const std::exception &e)
+    {
+        sSessionsRejected.Increment();
+        syslog(LOG_WARNING, "DTLS session[%d] rejected: %s", aNet.fd, e.what());
+    }
+
+    return session;
+}
+
 void MbedtlsServer::ProcessServer(const fd_set &aReadFdSet, const fd_set &aWriteFdSet)
 {
     int                 ret = 0;
+    int                 reuse = 1;
+    uint8_t             record[MbedtlsSession::kMaxPacketSize];
+    ssize_t             length;
+    sockaddr_storage    local;
+    socklen_t           localLength = sizeof(local);
+    sockaddr_storage    peer;
+    socklen_t           peerLength = sizeof(peer);
+    const uint8_t      *addr;
     size_t              addrLength;
-    Ip6Address          addr;
     mbedtls_net_context net;
 
-
-    VerifyOrExit(FD_ISSET(mNet.fd, &aReadFdSet));
+    VerifyOrExit(mStarted && FD_ISSET(mNet.fd, &aReadFdSet));
 
     syslog(LOG_INFO, "Trying to accept connection");
     mbedtls_net_init(&net);
-    SuccessOrExit(ret = mbedtls_net_accept(&mNet, &net, addr.m8, sizeof(addr), &addrLength));
+
+    // Unlike mbedtls_net_accept(), the listening socket is never handed to the session, as it may be shared with the
+    // service manager. The first record is taken out of it and the session goes on with its own connected socket.
+    length = recvfrom(mNet.fd, record, sizeof(record), 0, reinterpret_cast<sockaddr *>(&peer), &peerLength);
+    VerifyOrExit(length >= 0, ret = MBEDTLS_ERR_NET_RECV_FAILED);
+
+    // The record is dropped like a lost datagram, the peer retries once sessions have ended.
+    VerifyOrExit(!MbedtlsSession::sPool.IsFull(), sSessionsRejected.Increment(),
+                 syslog(LOG_WARNING, "Too many DTLS sessions, ignoring new peer"));
+
+    VerifyOrExit(getsockname(mNet.fd, reinterpret_cast<sockaddr *>(&local), &localLength) == 0,
+                 ret = MBEDTLS_ERR_NET_ACCEPT_FAILED);
+    VerifyOrExit((net.fd = socket(local.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP)) >= 0,
+                 ret = MBEDTLS_ERR_NET_SOCKET_FAILED);
+    VerifyOrExit(setsockopt(net.fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == 0 &&
+                 bind(net.fd, reinterpret_cast<sockaddr *>(&local), localLength) == 0,
+                 ret = MBEDTLS_ERR_NET_BIND_FAILED);
+    VerifyOrExit(connect(net.fd, reinterpret_cast<sockaddr *>(&peer), peerLength) == 0,
+                 ret = MBEDTLS_ERR_NET_CONNECT_FAILED);
+
+    GetPeerIp(peer, addr, addrLength);
 
     // TODO Should check if this client has an existing session.
     {
-        boost::shared_ptr<MbedtlsSession> session(new MbedtlsSession(*this, net, addr.m8, addrLength));
+        boost::shared_ptr<MbedtlsSession> session = NewSession(net, addr, addrLength);
+
+        VerifyOrExit(session, ret = MBEDTLS_ERR_SSL_ALLOC_FAILED);
+        net.fd = -1;
+        session->mPendingRecord.assign(record, record + length);
         mSessions.push_back(session);
         mbedtls_ssl_conf_export_keys_cb(&mConf, MbedtlsSession::ExportKeys, session.get());
         session->Process();
@@ -454,6 +941,7 @@ exit:
     if (ret)
     {
         syslog(LOG_ERR, "Failed to initiate new session: -0x%x", -ret);
+        mbedtls_net_free(&net);
     }
 
     (void)aWriteFdSet;
@@ -473,36 +961,178 @@ void MbedtlsServer::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet)
             syslog(LOG_INFO, "DTLS session [%d] readable", fd);
             session->Process();
         }
+
+        if (FD_ISSET(fd, &aWriteFdSet))
+        {
+            session->Flush();
+        }
     }
 
     ProcessServer(aReadFdSet, aWriteFdSet);
 }
 
+void MbedtlsServer::HandOver(std::vector<uint8_t> &aState, std::vector<int> &aFds)
+{
+    aState.push_back(kSnapshotFormat);
+
+    for (SessionSet::iterator it = mSessions.begin(); it != mSessions.end(); ++it)
+    {
+        boost::shared_ptr<MbedtlsSession> session = *it;
+        SessionSnapshot                   snapshot;
+
+        // Handshakes in progress are not handed over, their peers retransmit to the new process and start over.
+        if (session->GetState() != Session::kStateReady)
+        {
+            continue;
+        }
+
+        session->Save(snapshot);
+        aState.insert(aState.end(), reinterpret_cast<const uint8_t *>(&snapshot),
+                      reinterpret_cast<const uint8_t *>(&snapshot) + sizeof(snapshot));
+        aFds.push_back(session->Detach());
+    }
+
+    syslog(LOG_INFO, "handing over %zu DTLS sessions", aFds.size());
+}
+
+int MbedtlsServer::Resume(const std::vector<uint8_t> &aState, const std::vector<int> &aFds)
+{
+    int    ret = 0;
+    size_t resumed = 0;
+
+    if (aState.empty() || aState[0] != kSnapshotFormat || aState.size() != 1 + aFds.size() * sizeof(SessionSnapshot))
+    {
+        syslog(LOG_ERR, "unsupported DTLS session state");
+
+        for (size_t i = 0; i < aFds.size(); i++)
+        {
+            close(aFds[i]);
+        }
+
+        ExitNow(ret = -1);
+    }
+
+    // A session failing to resume is skipped, it does not keep the following ones from resuming.
+    for (size_t i = 0; i < aFds.size(); i++)
+    {
+        SessionSnapshot     snapshot;
+        sockaddr_storage    peer;
+        socklen_t           peerLength = sizeof(peer);
+        const uint8_t      *addr = NULL;
+        size_t              addrLength = 0;
+        mbedtls_net_context net;
+        int                 error;
+
+        memcpy(&snapshot, &aState[1 + i * sizeof(snapshot)], sizeof(snapshot));
+        mbedtls_net_init(&net);
+        net.fd = aFds[i];
+
+        if (MbedtlsSession::sPool.IsFull())
+        {
+            sSessionsRejected.Increment();
+            syslog(LOG_ERR, "failed to resume DTLS session[%d]: too many sessions", net.fd);
+            close(net.fd);
+            ret = -1;
+            continue;
+        }
+
+        // The transport id is the peer address, as set when the session was accepted.
+        if (getpeername(net.fd, reinterpret_cast<sockaddr *>(&peer), &peerLength) != 0)
+        {
+            syslog(LOG_ERR, "failed to resume DTLS session[%d]: %s", net.fd, strerror(errno));
+            close(net.fd);
+            ret = -1;
+            continue;
+        }
+
+        GetPeerIp(peer, addr, addrLength);
+
+        {
+            boost::shared_ptr<MbedtlsSession> session = NewSession(net, addr, addrLength);
+
+            if (!session)
+            {
+                close(net.fd);
+                ret = -1;
+                continue;
+            }
+
+            mbedtls_ssl_conf_export_keys_cb(&mConf, MbedtlsSession::ExportKeys, session.get());
+
+            if ((error = session->Resume(snapshot)) != 0)
+            {
+                // The session closes its socket silently, the peer would not understand its alerts anyway.
+                syslog(LOG_ERR, "failed to resume DTLS session[%d]: %d", net.fd, error);
+                session->mState = Session::kStateError;
+                ret = -1;
+                continue;
+            }
+
+            mSessions.push_back(session);
+            session->SetState(Session::kStateReady);
+            resumed++;
+        }
+    }
+
+    syslog(LOG_INFO, "resumed %zu of %zu DTLS sessions", resumed, aFds.size());
+
+exit:
+    return ret;
+}
+
+size_t MbedtlsServer::GetSessionCount(void) const
+{
+    size_t count = 0;
+
+    for (SessionSet::const_iterator it = mSessions.begin(); it != mSessions.end(); ++it)
+    {
+        if ((*it)->GetState() == Session::kStateHandshaking || (*it)->GetState() == Session::kStateReady)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
 void MbedtlsServer::SetPSK(const uint8_t *aPSK, uint8_t aLength)
 {
     mPSKLength = aLength;
     memcpy(mPSK, aPSK, aLength);
 }
 
+void MbedtlsServer::CloseListener(void)
+{
+    // Unlike mbedtls_net_free(), the socket is not shut down, as the service manager may keep listening on it.
+    if (mNet.fd >= 0)
+    {
+        close(mNet.fd);
+        mNet.fd = -1;
+    }
+}
+
 MbedtlsServer::~MbedtlsServer(void)
 {
-    mbedtls_net_free(&mNet);
+    CloseListener();
     mbedtls_ssl_config_free(&mConf);
     mbedtls_ssl_cookie_free(&mCookie);
 #if defined(MBEDTLS_SSL_CACHE_C)
     mbedtls_ssl_cache_free(&mCache);
 #endif
-    mbedtls_ctr_drbg_free(&mCtrDrbg);
-    mbedtls_entropy_free(&mEntropy);
+    FreeRandom();
+}
+
+void MbedtlsServer::Start(void)
+{
+    mStarted = true;
 }
 
 void MbedtlsServer::SetSeed(const uint8_t *aSeed, uint16_t aLength)
 {
-    VerifyOrExit(aLength <= sizeof(mSeed),
-                 syslog(LOG_ERR, "Seed must be no more than %zu bytes", sizeof(mSeed)));
+    VerifyOrExit(aLength <= MBEDTLS_CTR_DRBG_MAX_SEED_INPUT,
+                 syslog(LOG_ERR, "Seed must be no more than %d bytes", MBEDTLS_CTR_DRBG_MAX_SEED_INPUT));
 
-    memcpy(mSeed, aSeed, aLength);
-    mSeedLength = aLength;
+    mbedtls_ctr_drbg_update(&sCtrDrbg, aSeed, aLength);
 
 exit:
     return;
@@ -76,6 +76,7 @@ extern "C" {
 
 #include "common/types.hpp"
 #include "dtls.hpp"
+#include "mbedtls_heap.hpp"
 
 namespace ot {
 
@@ -94,6 +95,24 @@ namespace Dtls {
 
 class MbedtlsServer;
 
+/**
+ * This structure represents the state of an established session handed over to another process.
+ *
+ * All fields are in network byte order so the layout does not depend on the build.
+ *
+ */
+struct SessionSnapshot
+{
+    uint8_t mCiphersuite[2];  ///< The negotiated ciphersuite.
+    uint8_t mMaster[48];      ///< The master secret.
+    uint8_t mRandBytes[64];   ///< The client and server random values.
+    uint8_t mOutCounter[8];   ///< The epoch and sequence number of the next outgoing record.
+    uint8_t mInEpoch[2];      ///< The epoch of incoming records.
+    uint8_t mInWindowTop[8];  ///< The last validated incoming sequence number.
+    uint8_t mInWindow[8];     ///< The bitmask for replay detection.
+    uint8_t mTimeout[4];      ///< Milliseconds until the session expires.
+};
+
 /**
  * This class implements the DTLS Session functionality based on mbedTLS.
  *
@@ -114,6 +133,20 @@ public:
 
     ~MbedtlsSession(void);
 
+    /**
+     * This method allocates a session from the pool shared by all DTLS servers.
+     *
+     * @throws std::bad_alloc if the pool is full.
+     *
+     */
+    static void *operator new(size_t aSize);
+
+    /**
+     * This method gives a session back to the pool.
+     *
+     */
+    static void operator delete(void *aPointer);
+
     ssize_t Write(const uint8_t *aBuffer, uint16_t aLength);
     void SetDataHandler(DataHandler aDataHandler, void *aContext);
 
@@ -160,16 +193,72 @@ public:
      */
     void Close(void);
 
+    /**
+     * This method indicates whether encrypted records are waiting for the socket to become writable.
+     *
+     * @returns Whether the write queue is not empty.
+     *
+     */
+    bool HasQueuedRecords(void) const { return mWriteCount > 0; }
+
+    /**
+     * This method sends as many queued records as the socket accepts without blocking.
+     *
+     */
+    void Flush(void);
+
+    /**
+     * This method returns the number of records dropped because the write queue was full.
+     *
+     * @returns Number of dropped records.
+     *
+     */
+    unsigned long GetDroppedRecords(void) const { return mDroppedRecords; }
+
+    /**
+     * This method saves the state of this established session.
+     *
+     * @param[out]  aSnapshot   A reference to the snapshot.
+     *
+     */
+    void Save(SessionSnapshot &aSnapshot) const;
+
+    /**
+     * This method resumes an established session from its snapshot, without any handshake with the peer.
+     *
+     * @param[in]   aSnapshot   A reference to the snapshot.
+     *
+     * @returns 0 on success, otherwise failure.
+     *
+     */
+    int Resume(const SessionSnapshot &aSnapshot);
+
+    /**
+     * This method detaches this session from its peer, which keeps the session alive with another process.
+     *
+     * @returns The socket of the session, owned by the caller from now on.
+     *
+     */
+    int Detach(void);
+
 private:
     enum
     {
         kMaxPacketSize  = 1500,  ///< Max size of DTLS UDP packet.
         kSessionTimeout = 60000, ///< Default DTLS session timeout in miniseconds.
         kKekSize        = 32,    ///< Size of KEK.
+        kWriteQueueSize = 32,    ///< Max number of encrypted records waiting to be sent.
+        kWriteQueueMax  = 8192,  ///< Max bytes of encrypted records waiting to be sent.
+        kRandBytesSize  = 64,    ///< Size of the client and server random values.
+        kMaxSessions    = 16,    ///< Max number of sessions of all DTLS servers.
+        kMaxHeapSize    = 20480, ///< Max bytes of mbedTLS heap used by a session, about 14 KiB are needed.
     };
 
     static int ExportKeys(void *aContext, const unsigned char *aMasterSecret, const unsigned char *aKeyBlock,
                           size_t aMacLength, size_t aKeyLength, size_t aIvLength);
+    static int SendRecord(void *aContext, const unsigned char *aBuffer, size_t aLength);
+    static int ReceiveRecord(void *aContext, unsigned char *aBuffer, size_t aLength);
+    void DropRecord(void);
     int Handshake(void);
     int Read(void);
     void SetState(State aState);
@@ -183,7 +272,20 @@ private:
     State                        mState;
     MbedtlsServer               &mServer;
     uint64_t                     mExpiration;
+    uint64_t                     mHandshakeStart;
     uint8_t                      mKek[kKekSize];
+    uint8_t                      mRandBytes[kRandBytesSize];
+
+    std::vector<uint8_t>         mWriteQueue;    ///< The records waiting to be sent, back to back.
+    uint16_t                     mWriteLengths[kWriteQueueSize];
+    uint8_t                      mWriteCount;
+    size_t                       mWriteQueuePeak;
+    unsigned long                mDroppedRecords;
+
+    std::vector<uint8_t>         mPendingRecord; ///< The first record, received on the listening socket.
+    HeapUsage                    mHeapUsage;
+
+    static SlabPool              sPool;
 };
 
 /**
@@ -220,7 +322,10 @@ public:
     void SetPSK(const uint8_t *aPSK, uint8_t aLength);
 
     /**
-     * This method updates the seed for random generator.
+     * This method mixes a seed into the random generator.
+     *
+     * The random generator is shared by all DTLS servers in the process, so each server adds its own seed on top of
+     * the entropy source instead of reseeding from scratch.
      *
      * @param[in]   aSeed   A pointer to the buffer of seed.
      * @param[in]   aLength The length of the seed.
@@ -228,33 +333,48 @@ public:
      */
     void SetSeed(const uint8_t *aSeed, uint16_t aLength);
 
+    void Start(void);
+
+    size_t GetSessionCount(void) const;
+
+    void HandOver(std::vector<uint8_t> &aState, std::vector<int> &aFds);
+
+    int Resume(const std::vector<uint8_t> &aState, const std::vector<int> &aFds);
+
 private:
     typedef std::vector< boost::shared_ptr<MbedtlsSession> > SessionSet;
     enum
     {
-        kMaxSizeOfPSK = 32, ///< Max size of PSK in bytes.
+        kMaxSizeOfPSK   = 32, ///< Max size of PSK in bytes.
+        kSnapshotFormat = 1,  ///< Version of the session snapshots handed over to another process.
     };
 
     void HandleSessionState(Session &aSession, Session::State aState);
+    boost::shared_ptr<MbedtlsSession> NewSession(mbedtls_net_context &aNet, const uint8_t *aIp, size_t aIpLength);
     void ProcessServer(const fd_set &aReadFdSet, const fd_set &aWriteFdSet);
+    void CloseListener(void);
+
+    static int InitRandom(void);
+    static void FreeRandom(void);
 
     SessionSet                mSessions;
     uint16_t                  mPort;
     StateHandler              mStateHandler;
     void                     *mContext;
-    uint8_t                   mSeed[MBEDTLS_CTR_DRBG_MAX_SEED_INPUT];
-    uint16_t                  mSeedLength;
     uint8_t                   mPSK[kMaxSizeOfPSK];
     uint8_t                   mPSKLength;
+    bool                      mStarted;
 
     mbedtls_net_context       mNet;
     mbedtls_ssl_cookie_ctx    mCookie;
-    mbedtls_entropy_context   mEntropy;
-    mbedtls_ctr_drbg_context  mCtrDrbg;
     mbedtls_ssl_config        mConf;
 #if defined(MBEDTLS_SSL_CACHE_C)
     mbedtls_ssl_cache_context mCache;
 #endif
+
+    static unsigned                 sServerCount;
+    static mbedtls_entropy_context  sEntropy;
+    static mbedtls_ctr_drbg_context sCtrDrbg;
 };
 
 /**
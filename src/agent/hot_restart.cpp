@@ -0,0 +1,349 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements handing the border agents over to a new process.
+ */
+
+#include "hot_restart.hpp"
+
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "common/code_utils.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+static int InitAddress(sockaddr_un &aAddress, const std::string &aPath)
+{
+    int ret = 0;
+
+    VerifyOrExit(aPath.size() < sizeof(aAddress.sun_path), ret = -1, errno = ENAMETOOLONG);
+
+    memset(&aAddress, 0, sizeof(aAddress));
+    aAddress.sun_family = AF_UNIX;
+    strcpy(aAddress.sun_path, aPath.c_str());
+
+exit:
+    return ret;
+}
+
+static bool IsSameUser(int aFd)
+{
+    ucred     cred;
+    socklen_t length = sizeof(cred);
+
+    return getsockopt(aFd, SOL_SOCKET, SO_PEERCRED, &cred, &length) == 0 && length == sizeof(cred) &&
+           cred.uid == geteuid();
+}
+
+HotRestart::HotRestart(const char *aPath) :
+    mPath(aPath),
+    mFd(-1),
+    mPeer(-1)
+{
+}
+
+HotRestart::~HotRestart(void)
+{
+    CloseStates();
+
+    if (mFd >= 0)
+    {
+        close(mFd);
+        unlink(mPath.c_str());
+    }
+
+    // Closing the connection last tells the new agent that this one is gone.
+    if (mPeer >= 0)
+    {
+        close(mPeer);
+    }
+}
+
+int HotRestart::TakeOver(void)
+{
+    int            ret = 0;
+    int            fd = -1;
+    sockaddr_un    addr;
+    struct timeval timeout = { kTakeOverTimeout, 0 };
+
+    SuccessOrExit(ret = InitAddress(addr, mPath));
+    VerifyOrExit((fd = socket(AF_UNIX, SOCK_SEQPACKET, 0)) >= 0, ret = -1);
+
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        // Nothing to take over, start from scratch.
+        VerifyOrExit(errno != ENOENT && errno != ECONNREFUSED, syslog(LOG_INFO, "no agent to take over"));
+        ExitNow(ret = -1);
+    }
+
+    // Anyone else listening there would feed this agent sockets and sessions of its choosing.
+    VerifyOrExit(IsSameUser(fd), ret = -1, errno = EPERM);
+    SuccessOrExit(ret = setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+
+    do
+    {
+        ret = Receive(fd);
+    }
+    while (ret > 0);
+
+    SuccessOrExit(ret);
+
+    syslog(LOG_INFO, "took over %zu interfaces", mStates.size());
+
+exit:
+    if (ret)
+    {
+        syslog(LOG_ERR, "failed to take over: %s", strerror(errno));
+
+        // Sessions of a partial handover are not resumed.
+        CloseStates();
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    return ret;
+}
+
+int HotRestart::Receive(int aFd)
+{
+    int             ret = 0;
+    uint8_t         buffer[kMaxMessageSize];
+    char            control[CMSG_SPACE(kMaxFds * sizeof(int))];
+    iovec           iov;
+    msghdr          msg;
+    ssize_t         length;
+    const uint8_t  *end;
+    const uint8_t  *name;
+    State          *state;
+
+    iov.iov_base = buffer;
+    iov.iov_len = sizeof(buffer);
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    do
+    {
+        length = recvmsg(aFd, &msg, MSG_CMSG_CLOEXEC);
+    }
+    while (length < 0 && errno == EINTR);
+
+    // The previous agent closes the connection once it has exited.
+    VerifyOrExit(length != 0);
+    VerifyOrExit(length > 0 && !(msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)), ret = -1);
+
+    name = buffer;
+    end = static_cast<const uint8_t *>(memchr(buffer, '\0', static_cast<size_t>(length)));
+    VerifyOrExit(end != NULL, ret = -1, errno = EBADMSG);
+
+    state = &mStates[reinterpret_cast<const char *>(name)];
+    state->mData.assign(end + 1, static_cast<const uint8_t *>(buffer + length));
+
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+            const int *fds = reinterpret_cast<const int *>(CMSG_DATA(cmsg));
+            size_t     count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+            state->mFds.insert(state->mFds.end(), fds, fds + count);
+        }
+    }
+
+    ret = 1;
+
+exit:
+    return ret;
+}
+
+bool HotRestart::TakeState(const char *aInterfaceName, std::vector<uint8_t> &aState, std::vector<int> &aFds)
+{
+    StateMap::iterator it = mStates.find(aInterfaceName);
+    bool               found = (it != mStates.end());
+
+    VerifyOrExit(found);
+
+    aState.swap(it->second.mData);
+    aFds.swap(it->second.mFds);
+    mStates.erase(it);
+
+exit:
+    return found;
+}
+
+void HotRestart::CloseStates(void)
+{
+    for (StateMap::iterator it = mStates.begin(); it != mStates.end(); ++it)
+    {
+        for (std::vector<int>::iterator fd = it->second.mFds.begin(); fd != it->second.mFds.end(); ++fd)
+        {
+            close(*fd);
+        }
+    }
+
+    mStates.clear();
+}
+
+int HotRestart::Listen(void)
+{
+    int         ret = 0;
+    sockaddr_un addr;
+
+    // Interfaces still in the map are no longer served by this agent.
+    CloseStates();
+
+    SuccessOrExit(ret = InitAddress(addr, mPath));
+    VerifyOrExit((mFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)) >= 0, ret = -1);
+    unlink(mPath.c_str());
+    SuccessOrExit(ret = bind(mFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)));
+    // The handover gives away the DTLS master secrets, only agents running as the same user may connect.
+    SuccessOrExit(ret = chmod(mPath.c_str(), S_IRUSR | S_IWUSR));
+    SuccessOrExit(ret = listen(mFd, 1));
+
+exit:
+    if (ret)
+    {
+        syslog(LOG_ERR, "failed to listen for hot restart on %s: %s", mPath.c_str(), strerror(errno));
+
+        if (mFd >= 0)
+        {
+            close(mFd);
+            mFd = -1;
+        }
+    }
+
+    return ret;
+}
+
+void HotRestart::UpdateFdSet(fd_set &aReadFdSet, int &aMaxFd)
+{
+    VerifyOrExit(mFd >= 0 && mPeer < 0);
+
+    FD_SET(mFd, &aReadFdSet);
+
+    if (aMaxFd < mFd)
+    {
+        aMaxFd = mFd;
+    }
+
+exit:
+    return;
+}
+
+bool HotRestart::Process(const fd_set &aReadFdSet)
+{
+    VerifyOrExit(mFd >= 0 && mPeer < 0 && FD_ISSET(mFd, &aReadFdSet));
+
+    mPeer = accept(mFd, NULL, NULL);
+    VerifyOrExit(mPeer >= 0, syslog(LOG_ERR, "failed to accept new agent: %s", strerror(errno)));
+
+    // The mode of the socket is only set after bind(), so the peer is checked as well.
+    if (!IsSameUser(mPeer))
+    {
+        syslog(LOG_WARNING, "refused to hand over to a process of another user");
+        close(mPeer);
+        ExitNow(mPeer = -1);
+    }
+
+    syslog(LOG_INFO, "handing over to a new agent");
+
+exit:
+    return mPeer >= 0;
+}
+
+int HotRestart::HandOver(const char *aInterfaceName, const std::vector<uint8_t> &aState,
+                         const std::vector<int> &aFds)
+{
+    int                  ret = 0;
+    std::vector<uint8_t> buffer(aInterfaceName, aInterfaceName + strlen(aInterfaceName) + 1);
+    char                 control[CMSG_SPACE(kMaxFds * sizeof(int))];
+    iovec                iov;
+    msghdr               msg;
+
+    VerifyOrExit(aFds.size() <= kMaxFds, ret = -1, errno = EMSGSIZE);
+
+    buffer.insert(buffer.end(), aState.begin(), aState.end());
+    VerifyOrExit(buffer.size() <= kMaxMessageSize, ret = -1, errno = EMSGSIZE);
+
+    iov.iov_base = &buffer[0];
+    iov.iov_len = buffer.size();
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (!aFds.empty())
+    {
+        cmsghdr *cmsg;
+
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(aFds.size() * sizeof(int));
+
+        cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(aFds.size() * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &aFds[0], aFds.size() * sizeof(int));
+    }
+
+    VerifyOrExit(sendmsg(mPeer, &msg, 0) == static_cast<ssize_t>(buffer.size()), ret = -1);
+
+exit:
+    if (ret)
+    {
+        syslog(LOG_ERR, "failed to hand %s over: %s", aInterfaceName, strerror(errno));
+    }
+
+    for (std::vector<int>::const_iterator fd = aFds.begin(); fd != aFds.end(); ++fd)
+    {
+        close(*fd);
+    }
+
+    return ret;
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for handing the border agents over to a new process.
+ */
+
+#ifndef HOT_RESTART_HPP_
+#define HOT_RESTART_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/select.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class hands the established commissioner sessions over from a running agent to its replacement.
+ *
+ * Both agents use the same Unix socket. The new agent connects to it and receives, for each interface, the
+ * serialized DTLS sessions together with their sockets. It waits for the old agent to exit before starting its own
+ * border agents, then listens on the socket for its own replacement.
+ *
+ */
+class HotRestart
+{
+public:
+    /**
+     * The constructor to initialize the hot restart.
+     *
+     * @param[in]   aPath   The path of the Unix socket.
+     *
+     */
+    HotRestart(const char *aPath);
+
+    ~HotRestart(void);
+
+    /**
+     * This method takes over from the agent listening on the socket, if any.
+     *
+     * It blocks until the previous agent has exited.
+     *
+     * @returns 0 on success or if no agent is running, otherwise failure, in which case the previous agent may still
+     *          be running and nothing is handed over.
+     *
+     */
+    int TakeOver(void);
+
+    /**
+     * This method takes the state handed over for an interface.
+     *
+     * The caller owns the sockets from now on.
+     *
+     * @param[in]   aInterfaceName  The name of the Thread interface.
+     * @param[out]  aState          The serialized DTLS sessions.
+     * @param[out]  aFds            The sockets of the DTLS sessions.
+     *
+     * @returns Whether any state was handed over for @p aInterfaceName.
+     *
+     */
+    bool TakeState(const char *aInterfaceName, std::vector<uint8_t> &aState, std::vector<int> &aFds);
+
+    /**
+     * This method starts listening for a replacement.
+     *
+     * Sockets of interfaces no longer served are closed.
+     *
+     * @returns 0 on success, otherwise failure.
+     *
+     */
+    int Listen(void);
+
+    /**
+     * This method updates the fd_set for the main loop.
+     *
+     * @param[inout]    aReadFdSet  A reference to fd_set for polling read.
+     * @param[inout]    aMaxFd      A reference to the current max fd in @p aReadFdSet.
+     *
+     */
+    void UpdateFdSet(fd_set &aReadFdSet, int &aMaxFd);
+
+    /**
+     * This method accepts a replacement. A process running as another user is refused.
+     *
+     * @param[in]   aReadFdSet  A reference to fd_set ready for reading.
+     *
+     * @returns Whether a new agent is taking over, in which case the state of every interface should be handed over
+     *          and this agent should exit.
+     *
+     */
+    bool Process(const fd_set &aReadFdSet);
+
+    /**
+     * This method sends the state of an interface to the new agent.
+     *
+     * The sockets are closed once sent, the new agent keeps its own copies.
+     *
+     * @param[in]   aInterfaceName  The name of the Thread interface.
+     * @param[in]   aState          The serialized DTLS sessions.
+     * @param[in]   aFds            The sockets of the DTLS sessions.
+     *
+     * @returns 0 on success, otherwise failure.
+     *
+     */
+    int HandOver(const char *aInterfaceName, const std::vector<uint8_t> &aState, const std::vector<int> &aFds);
+
+private:
+    enum
+    {
+        kMaxFds          = 32,   ///< Max number of sockets handed over per interface.
+        kMaxMessageSize  = 8192, ///< Max size of the state of an interface.
+        kTakeOverTimeout = 10,   ///< Seconds to wait for the previous agent.
+    };
+
+    /**
+     * This structure represents the state handed over for an interface.
+     *
+     */
+    struct State
+    {
+        std::vector<uint8_t> mData;
+        std::vector<int>     mFds;
+    };
+
+    typedef std::map<std::string, State> StateMap;
+
+    int Receive(int aFd);
+    void CloseStates(void);
+
+    std::string mPath;
+    int         mFd;
+    int         mPeer;
+    StateMap    mStates;
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif  // HOT_RESTART_HPP_
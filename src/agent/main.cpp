@@ -30,11 +30,20 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <syslog.h>
 #include <unistd.h>
 
+#include <string>
+#include <vector>
+
 #include "border_agent.hpp"
+#include "hot_restart.hpp"
+#include "metrics_exporter.hpp"
 #include "common/code_utils.hpp"
+#include "common/systemd.hpp"
+#include "common/time.hpp"
 
 static const char kSyslogIdent[] = "otbr-agent";
 static const char kDefaultInterfaceName[] = "wpan0";
@@ -42,11 +51,108 @@ static const char kDefaultInterfaceName[] = "wpan0";
 // Default poll timeout.
 static const struct timeval kPollTimeout = {10, 0};
 
-int Mainloop(const char *aInterfaceName)
+enum
+{
+    kMaxInterfaces = 8, ///< Max number of Thread interfaces served by one process.
+};
+
+/**
+ * This structure represents a Thread interface to serve and the DTLS port of its border agent.
+ *
+ */
+struct InterfaceConfig
+{
+    const char *mName;
+    uint16_t    mPort;
+};
+
+typedef std::vector<ot::BorderRouter::BorderAgent *> BorderAgentList;
+
+static bool IsReady(const BorderAgentList &aAgents)
 {
-    int rval = 0;
+    bool ready = true;
+
+    for (BorderAgentList::const_iterator it = aAgents.begin(); it != aAgents.end() && ready; ++it)
+    {
+        ready = (*it)->IsReady();
+    }
+
+    return ready;
+}
+
+static bool IsIdle(const BorderAgentList &aAgents)
+{
+    bool idle = true;
+
+    for (BorderAgentList::const_iterator it = aAgents.begin(); it != aAgents.end() && idle; ++it)
+    {
+        idle = (*it)->IsIdle();
+    }
+
+    return idle;
+}
+
+int Mainloop(const InterfaceConfig *aInterfaces, int aCount, const char *aMetricsEndpoint, const char *aTracePath,
+             const char *aHotRestartPath, unsigned aIdleTimeout)
+{
+    int                                rval = 0;
+    bool                               notifiedReady = false;
+    uint64_t                           lastActive = GetNow();
+    BorderAgentList                    agents;
+    ot::BorderRouter::MetricsExporter *exporter = NULL;
+    ot::BorderRouter::HotRestart      *hotRestart = NULL;
+
+    if (aHotRestartPath != NULL)
+    {
+        // The previous agent must be gone before the border agents of this one take the interfaces. After a partial
+        // handover it may still hold them, so give up and let the service manager start the agent again.
+        hotRestart = new ot::BorderRouter::HotRestart(aHotRestartPath);
+        VerifyOrExit(hotRestart->TakeOver() == 0, rval = -1);
+    }
+
+    if (aMetricsEndpoint != NULL)
+    {
+        exporter = new ot::BorderRouter::MetricsExporter(aMetricsEndpoint);
+    }
+
+    for (int i = 0; i < aCount; i++)
+    {
+        agents.push_back(new ot::BorderRouter::BorderAgent(aInterfaces[i].mName, aInterfaces[i].mPort));
+
+        if (aTracePath != NULL)
+        {
+            // Each interface records to its own trace so it can be replayed on its own.
+            std::string path(aTracePath);
+
+            if (aCount > 1)
+            {
+                path += ".";
+                path += aInterfaces[i].mName;
+            }
+
+            agents.back()->StartTrace(path.c_str());
+        }
 
-    ot::BorderRouter::BorderAgent br(aInterfaceName);
+        if (hotRestart != NULL)
+        {
+            std::vector<uint8_t> state;
+            std::vector<int>     fds;
+
+            if (hotRestart->TakeState(aInterfaces[i].mName, state, fds))
+            {
+                agents.back()->Resume(state, fds);
+            }
+        }
+    }
+
+    if (hotRestart != NULL)
+    {
+        hotRestart->Listen();
+    }
+
+    // The sockets are bound, so datagrams are queued from now on. wpantund may take a while or never come up, and the
+    // service manager would kill an agent still waiting for it, so that wait is only reported as status.
+    ot::Systemd::Notify("READY=1\nSTATUS=Waiting for wpantund");
 
     while (true)
     {
@@ -60,7 +166,34 @@ int Mainloop(const char *aInterfaceName)
         FD_ZERO(&writeFdSet);
         FD_ZERO(&errorFdSet);
 
-        br.UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+        for (BorderAgentList::iterator it = agents.begin(); it != agents.end(); ++it)
+        {
+            (*it)->UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+        }
+
+        if (exporter != NULL)
+        {
+            exporter->UpdateFdSet(readFdSet, writeFdSet, maxFd, timeout);
+        }
+
+        if (hotRestart != NULL)
+        {
+            hotRestart->UpdateFdSet(readFdSet, maxFd);
+        }
+
+        if (aIdleTimeout > 0)
+        {
+            uint64_t deadline = lastActive + aIdleTimeout * 1000ULL;
+            uint64_t now = GetNow();
+            uint64_t remaining = (deadline > now ? deadline - now : 0);
+
+            if (remaining < static_cast<uint64_t>(timeout.tv_sec) * 1000 + timeout.tv_usec / 1000)
+            {
+                timeout.tv_sec = static_cast<time_t>(remaining / 1000);
+                timeout.tv_usec = static_cast<suseconds_t>((remaining % 1000) * 1000);
+            }
+        }
+
         rval = select(maxFd + 1, &readFdSet, &writeFdSet, &errorFdSet, &timeout);
 
         if ((rval < 0) && (errno != EINTR))
@@ -70,9 +203,62 @@ int Mainloop(const char *aInterfaceName)
             break;
         }
 
-        br.Process(readFdSet, writeFdSet, errorFdSet);
+        for (BorderAgentList::iterator it = agents.begin(); it != agents.end(); ++it)
+        {
+            (*it)->Process(readFdSet, writeFdSet, errorFdSet);
+        }
+
+        if (exporter != NULL)
+        {
+            exporter->Process(readFdSet, writeFdSet);
+        }
+
+        if (hotRestart != NULL && hotRestart->Process(readFdSet))
+        {
+            for (int i = 0; i < aCount; i++)
+            {
+                std::vector<uint8_t> state;
+                std::vector<int>     fds;
+
+                agents[i]->HandOver(state, fds);
+                hotRestart->HandOver(aInterfaces[i].mName, state, fds);
+            }
+
+            rval = 0;
+            break;
+        }
+
+        if (!notifiedReady && IsReady(agents))
+        {
+            ot::Systemd::Notify("STATUS=Border agents ready");
+            notifiedReady = true;
+        }
+
+        if (!IsIdle(agents))
+        {
+            lastActive = GetNow();
+        }
+        else if (aIdleTimeout > 0 && GetNow() >= lastActive + aIdleTimeout * 1000ULL)
+        {
+            // Started again on demand when the service manager passes the listening sockets.
+            syslog(LOG_INFO, "no commissioner for %u seconds, exiting", aIdleTimeout);
+            ot::Systemd::Notify("STOPPING=1");
+            rval = 0;
+            break;
+        }
+    }
+
+exit:
+    delete exporter;
+
+    for (BorderAgentList::reverse_iterator it = agents.rbegin(); it != agents.rend(); ++it)
+    {
+        delete *it;
     }
 
+    // Destroyed last, the new agent waits for this to start its border agents.
+    delete hotRestart;
+
     return rval;
 }
 
@@ -81,18 +267,73 @@ void PrintVersion(void)
     printf("%s\n", PACKAGE_VERSION);
 }
 
+/**
+ * This function parses an interface argument of the form `name[:port]`.
+ *
+ * Without an explicit port, the n-th interface listens on the n-th port after the Thread commissioning port.
+ *
+ */
+int ParseInterface(char *aArgument, int aIndex, InterfaceConfig &aInterface)
+{
+    int            ret = 0;
+    char          *port = strchr(aArgument, ':');
+    unsigned long  value = ot::BorderRouter::kBorderAgentUdpPort + aIndex;
+
+    if (port != NULL)
+    {
+        char *end = NULL;
+
+        *port++ = '\0';
+        value = strtoul(port, &end, 0);
+        VerifyOrExit(*port != '\0' && *end == '\0' && value > 0 && value <= 0xffff, ret = -1);
+    }
+
+    VerifyOrExit(*aArgument != '\0', ret = -1);
+
+    aInterface.mName = aArgument;
+    aInterface.mPort = static_cast<uint16_t>(value);
+
+exit:
+    return ret;
+}
+
 int main(int argc, char *argv[])
 {
-    const char *interfaceName = NULL;
-    int         ret = 0;
-    int         opt;
+    InterfaceConfig interfaces[kMaxInterfaces];
+    int             interfaceCount = 0;
+    const char     *metricsEndpoint = NULL;
+    const char     *tracePath = NULL;
+    const char     *hotRestartPath = NULL;
+    unsigned        idleTimeout = 0;
+    int             ret = 0;
+    int             opt;
 
-    while ((opt = getopt(argc, argv, "vI:")) != -1)
+    while ((opt = getopt(argc, argv, "vH:i:I:m:T:")) != -1)
     {
         switch (opt)
         {
+        case 'H':
+            hotRestartPath = optarg;
+            break;
+
+        case 'i':
+            idleTimeout = static_cast<unsigned>(strtoul(optarg, NULL, 0));
+            break;
+
+        case 'm':
+            metricsEndpoint = optarg;
+            break;
+
+        case 'T':
+            tracePath = optarg;
+            break;
+
         case 'I':
-            interfaceName = optarg;
+            VerifyOrExit(interfaceCount < kMaxInterfaces,
+                         fprintf(stderr, "At most %d interfaces are supported\n", kMaxInterfaces), ret = -1);
+            VerifyOrExit(ParseInterface(optarg, interfaceCount, interfaces[interfaceCount]) == 0,
+                         fprintf(stderr, "Invalid interface %s\n", optarg), ret = -1);
+            interfaceCount++;
             break;
 
         case 'v':
@@ -101,22 +342,31 @@ int main(int argc, char *argv[])
             break;
 
         default:
-            fprintf(stderr, "Usage: %s [-I interfaceName] [-v]\n", argv[0]);
+            fprintf(stderr,
+                    "Usage: %s [-I interfaceName[:port]]... [-m metricsPort|metricsSocketPath] [-T tracePath] "
+                    "[-H hotRestartSocketPath] [-i idleTimeout] [-v]\n",
+                    argv[0]);
             ExitNow(ret = -1);
             break;
         }
     }
 
-    if (interfaceName == NULL)
+    if (interfaceCount == 0)
     {
-        interfaceName = kDefaultInterfaceName;
-        printf("Network interface not specified, using default %s\n", interfaceName);
+        interfaces[0].mName = kDefaultInterfaceName;
+        interfaces[0].mPort = ot::BorderRouter::kBorderAgentUdpPort;
+        interfaceCount = 1;
+        printf("Network interface not specified, using default %s\n", kDefaultInterfaceName);
     }
 
     openlog(kSyslogIdent, LOG_CONS | LOG_PID, LOG_USER);
-    syslog(LOG_INFO, "border router agent started on %s", interfaceName);
 
-    ret = Mainloop(interfaceName);
+    for (int i = 0; i < interfaceCount; i++)
+    {
+        syslog(LOG_INFO, "border router agent started on %s port %u", interfaces[i].mName, interfaces[i].mPort);
+    }
+
+    ret = Mainloop(interfaces, interfaceCount, metricsEndpoint, tracePath, hotRestartPath, idleTimeout);
 
     closelog();
 
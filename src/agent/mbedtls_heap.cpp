@@ -0,0 +1,265 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the bounded memory of the mbedTLS-based DTLS service.
+ */
+
+#include "mbedtls_heap.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+extern "C" {
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#include <mbedtls/platform.h>
+
+} // extern "C"
+
+#include "common/code_utils.hpp"
+#include "common/metrics.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Dtls {
+
+static Metrics::Gauge   sHeapBytes("otbr_dtls_heap_bytes",
+                                   "Bytes of the mbed TLS heap allocated.");
+static Metrics::Gauge   sHeapPeakBytes("otbr_dtls_heap_peak_bytes",
+                                       "Most bytes of the mbed TLS heap allocated at once.");
+static Metrics::Gauge   sHeapArenaBytes("otbr_dtls_heap_arena_bytes",
+                                        "Bytes of the mbed TLS arena carved into blocks.");
+static Metrics::Counter sHeapFailures("otbr_dtls_heap_failures_total",
+                                      "mbed TLS allocations refused by the bounded heap.");
+
+HeapUsage           *MbedtlsHeap::sOwner = NULL;
+HeapUsage            MbedtlsHeap::sUsage;
+MbedtlsHeap::Header *MbedtlsHeap::sFreeLists[kClassCount];
+size_t               MbedtlsHeap::sArenaUsed = 0;
+MbedtlsHeap::Header  MbedtlsHeap::sArena[kArenaSize / sizeof(Header)];
+
+MbedtlsHeap::Scope::Scope(HeapUsage &aUsage) :
+    mPrevious(sOwner)
+{
+    sOwner = &aUsage;
+}
+
+MbedtlsHeap::Scope::~Scope(void)
+{
+    sOwner = mPrevious;
+}
+
+void MbedtlsHeap::Install(void)
+{
+    mbedtls_platform_set_calloc_free(Calloc, Free);
+}
+
+void MbedtlsHeap::Charge(HeapUsage &aUsage, size_t aSize)
+{
+    aUsage.mCurrent += aSize;
+
+    if (aUsage.mPeak < aUsage.mCurrent)
+    {
+        aUsage.mPeak = aUsage.mCurrent;
+    }
+}
+
+void *MbedtlsHeap::Calloc(size_t aCount, size_t aSize)
+{
+    Header  *header = NULL;
+    size_t   size;
+    unsigned cls = 0;
+
+    // Like malloc(), an empty allocation gives NULL.
+    VerifyOrExit(aCount != 0 && aSize != 0);
+    VerifyOrExit(aSize <= (GetClassSize(kClassCount - 1) - sizeof(Header)) / aCount,
+                 syslog(LOG_WARNING, "mbed TLS allocation of %zu x %zu bytes too large", aCount, aSize));
+
+    size = aCount * aSize;
+
+    while (GetClassSize(cls) < size + sizeof(Header))
+    {
+        cls++;
+    }
+
+    VerifyOrExit(sOwner == NULL || sOwner->mLimit == 0 || sOwner->mCurrent + GetClassSize(cls) <= sOwner->mLimit,
+                 syslog(LOG_WARNING, "mbed TLS allocation of %zu bytes over the limit of %zu", size, sOwner->mLimit));
+
+    if (sFreeLists[cls] == NULL && sArenaUsed + GetClassSize(cls) <= sizeof(sArena))
+    {
+        header = sArena + sArenaUsed / sizeof(Header);
+        sArenaUsed += GetClassSize(cls);
+        sHeapArenaBytes.Set(static_cast<int64_t>(sArenaUsed));
+    }
+    else
+    {
+        // Once the arena is carved out, a larger free block serves the allocation.
+        while (cls < kClassCount && sFreeLists[cls] == NULL)
+        {
+            cls++;
+        }
+
+        VerifyOrExit(cls < kClassCount, syslog(LOG_WARNING, "mbed TLS heap exhausted by %zu bytes", size));
+
+        header = sFreeLists[cls];
+        sFreeLists[cls] = header->mNext;
+    }
+
+    header->mUsed.mOwner = sOwner;
+    header->mUsed.mClass = cls;
+
+    Charge(sUsage, GetClassSize(cls));
+
+    if (sOwner != NULL)
+    {
+        Charge(*sOwner, GetClassSize(cls));
+    }
+
+    sHeapBytes.Set(static_cast<int64_t>(sUsage.mCurrent));
+    sHeapPeakBytes.Set(static_cast<int64_t>(sUsage.mPeak));
+
+    // Blocks are reused, so unlike fresh pages they have to be cleared.
+    memset(header + 1, 0, size);
+
+exit:
+    if (header == NULL && aCount != 0 && aSize != 0)
+    {
+        sHeapFailures.Increment();
+    }
+
+    return header != NULL ? header + 1 : NULL;
+}
+
+void MbedtlsHeap::Free(void *aPointer)
+{
+    Header  *header = static_cast<Header *>(aPointer);
+    unsigned cls;
+
+    VerifyOrExit(aPointer != NULL);
+
+    // Memory allocated before the heap was installed came from the C library.
+    if (header <= sArena || header >= sArena + sizeof(sArena) / sizeof(sArena[0]))
+    {
+        free(aPointer);
+        ExitNow();
+    }
+
+    header--;
+
+    cls = header->mUsed.mClass;
+
+    sUsage.mCurrent -= GetClassSize(cls);
+
+    if (header->mUsed.mOwner != NULL)
+    {
+        header->mUsed.mOwner->mCurrent -= GetClassSize(cls);
+    }
+
+    sHeapBytes.Set(static_cast<int64_t>(sUsage.mCurrent));
+
+    header->mNext = sFreeLists[cls];
+    sFreeLists[cls] = header;
+
+exit:
+    return;
+}
+
+SlabPool::SlabPool(size_t aObjectSize, size_t aCapacity) :
+    mObjectSize((aObjectSize + kAlignment - 1) / kAlignment * kAlignment),
+    mCapacity(aCapacity),
+    mCount(0),
+    mAllocated(0),
+    mFree(NULL)
+{
+}
+
+void *SlabPool::Allocate(void)
+{
+    Object *object = NULL;
+
+    VerifyOrExit(!IsFull());
+
+    if (mFree == NULL)
+    {
+        size_t   count = mCapacity - mAllocated;
+        uint8_t *slab;
+
+        if (count > kSlabObjects)
+        {
+            count = kSlabObjects;
+        }
+
+        // Slabs live as long as the process, the objects in them are reused.
+        VerifyOrExit((slab = static_cast<uint8_t *>(malloc(count * mObjectSize))) != NULL);
+        mAllocated += count;
+
+        while (count > 0)
+        {
+            object = reinterpret_cast<Object *>(slab + --count * mObjectSize);
+            object->mNext = mFree;
+            mFree = object;
+        }
+    }
+
+    object = mFree;
+    mFree = object->mNext;
+    mCount++;
+
+exit:
+    return object;
+}
+
+void SlabPool::Free(void *aObject)
+{
+    Object *object = static_cast<Object *>(aObject);
+
+    VerifyOrExit(object != NULL);
+
+    object->mNext = mFree;
+    mFree = object;
+    mCount--;
+
+exit:
+    return;
+}
+
+} // namespace Dtls
+
+} // namespace BorderRouter
+
+} // namespace ot
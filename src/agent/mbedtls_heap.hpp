@@ -0,0 +1,219 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for the bounded memory of the mbedTLS-based DTLS service.
+ */
+
+#ifndef MBEDTLS_HEAP_HPP_
+#define MBEDTLS_HEAP_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Dtls {
+
+/**
+ * @addtogroup border-agent-dtls
+ *
+ * @{
+ */
+
+/**
+ * This structure accounts the heap memory used by one owner, typically a DTLS session.
+ *
+ */
+struct HeapUsage
+{
+    size_t mCurrent; ///< Bytes allocated now.
+    size_t mPeak;    ///< Most bytes allocated at once.
+    size_t mLimit;   ///< Most bytes allowed at once, 0 for no limit.
+};
+
+/**
+ * This class implements a bounded heap for mbedTLS over a fixed arena.
+ *
+ * Blocks are handed out in power-of-two size classes. Freed blocks are kept on a list per class and reused, so the
+ * arena is only carved until the working set of the busiest load has been reached, and nothing of it is ever given
+ * back to the system. Allocations are charged to the owner of the innermost Scope, which fail once it would exceed
+ * its limit.
+ *
+ * Like the rest of the agent, the heap must only be used from the main loop.
+ *
+ */
+class MbedtlsHeap
+{
+public:
+    /**
+     * This class charges the mbedTLS allocations made during its lifetime to an owner.
+     *
+     */
+    class Scope
+    {
+    public:
+        /**
+         * The constructor to enter a scope.
+         *
+         * @param[in]   aUsage  A reference to the usage of the owner.
+         *
+         */
+        explicit Scope(HeapUsage &aUsage);
+
+        ~Scope(void);
+
+    private:
+        HeapUsage *mPrevious;
+    };
+
+    /**
+     * This method makes mbedTLS allocate from this heap.
+     *
+     * Memory allocated by mbedTLS before is still freed by the C library.
+     *
+     */
+    static void Install(void);
+
+private:
+    enum
+    {
+        kArenaSize    = 512 * 1024, ///< Size of the arena in bytes.
+        kMinClassBits = 5,          ///< The smallest block is 32 bytes.
+        kClassCount   = 10,         ///< The largest block is 16 KiB.
+    };
+
+    /**
+     * This structure describes a block in use.
+     *
+     */
+    struct Block
+    {
+        HeapUsage *mOwner; ///< The owner charged for the block.
+        uint32_t   mClass; ///< The size class of the block.
+    };
+
+    /**
+     * This union precedes every block, and links the block in its free list once freed.
+     *
+     */
+    union Header
+    {
+        Block        mUsed;  ///< The block in use.
+        Header      *mNext;  ///< The next free block of the same class.
+        long double  mAlign; ///< Keeps the data aligned as malloc() does.
+    };
+
+    static void *Calloc(size_t aCount, size_t aSize);
+    static void Free(void *aPointer);
+    static size_t GetClassSize(unsigned aClass) { return static_cast<size_t>(1) << (kMinClassBits + aClass); }
+    static void Charge(HeapUsage &aUsage, size_t aSize);
+
+    static HeapUsage *sOwner;
+    static HeapUsage  sUsage;
+    static Header    *sFreeLists[kClassCount];
+    static size_t     sArenaUsed;
+    static Header     sArena[kArenaSize / sizeof(Header)];
+};
+
+/**
+ * This class implements a pool of equally sized objects, allocated a slab at a time.
+ *
+ * The pool never holds more than its capacity of objects, and keeps freed objects for reuse instead of giving them
+ * back to the system.
+ *
+ */
+class SlabPool
+{
+public:
+    /**
+     * The constructor to initialize an empty pool.
+     *
+     * @param[in]   aObjectSize     Size of the objects in bytes.
+     * @param[in]   aCapacity       Max number of objects allocated at once.
+     *
+     */
+    SlabPool(size_t aObjectSize, size_t aCapacity);
+
+    /**
+     * This method allocates an object.
+     *
+     * @returns A pointer to the object, or NULL if the pool is full.
+     *
+     */
+    void *Allocate(void);
+
+    /**
+     * This method gives an object back to the pool.
+     *
+     * @param[in]   aObject     A pointer to the object.
+     *
+     */
+    void Free(void *aObject);
+
+    /**
+     * This method indicates whether every object of the pool is allocated.
+     *
+     * @returns Whether the pool is full.
+     *
+     */
+    bool IsFull(void) const { return mCount == mCapacity; }
+
+private:
+    enum
+    {
+        kSlabObjects = 4, ///< Number of objects allocated together.
+        kAlignment   = 16, ///< Alignment of the objects, as malloc() gives.
+    };
+
+    struct Object
+    {
+        Object *mNext;
+    };
+
+    size_t  mObjectSize;
+    size_t  mCapacity;
+    size_t  mCount;
+    size_t  mAllocated;
+    Object *mFree;
+};
+
+/**
+ * @}
+ */
+
+} // namespace Dtls
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif  // MBEDTLS_HEAP_HPP_
@@ -0,0 +1,286 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the Prometheus exporter of border agent metrics.
+ */
+
+#include "metrics_exporter.hpp"
+
+#include <stdexcept>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "common/code_utils.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+MetricsExporter::MetricsExporter(const char *aEndpoint) :
+    mFd(-1)
+{
+    int ret = 0;
+
+    if (aEndpoint[0] == '/')
+    {
+        sockaddr_un addr;
+
+        VerifyOrExit(strlen(aEndpoint) < sizeof(addr.sun_path), ret = -1, errno = ENAMETOOLONG);
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, aEndpoint);
+
+        VerifyOrExit((mFd = socket(AF_UNIX, SOCK_STREAM, 0)) >= 0, ret = -1);
+        unlink(aEndpoint);
+        SuccessOrExit(ret = bind(mFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)));
+        mPath = aEndpoint;
+    }
+    else
+    {
+        sockaddr_in   addr;
+        int           one = 1;
+        unsigned long port = strtoul(aEndpoint, NULL, 0);
+
+        VerifyOrExit(port > 0 && port <= 0xffff, ret = -1, errno = EINVAL);
+
+        // Metrics are only for local collectors.
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        VerifyOrExit((mFd = socket(AF_INET, SOCK_STREAM, 0)) >= 0, ret = -1);
+        setsockopt(mFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        SuccessOrExit(ret = bind(mFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)));
+    }
+
+    SuccessOrExit(ret = fcntl(mFd, F_SETFL, O_NONBLOCK));
+    SuccessOrExit(ret = listen(mFd, kMaxClients));
+
+    syslog(LOG_INFO, "metrics exported on %s", aEndpoint);
+
+exit:
+    if (ret)
+    {
+        syslog(LOG_ERR, "failed to export metrics on %s: %s", aEndpoint, strerror(errno));
+
+        if (mFd >= 0)
+        {
+            close(mFd);
+        }
+
+        throw std::runtime_error("Failed to create metrics exporter");
+    }
+}
+
+MetricsExporter::~MetricsExporter(void)
+{
+    for (ClientList::iterator it = mClients.begin(); it != mClients.end(); ++it)
+    {
+        close(it->mFd);
+    }
+
+    close(mFd);
+
+    if (!mPath.empty())
+    {
+        unlink(mPath.c_str());
+    }
+}
+
+void MetricsExporter::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, int &aMaxFd, timeval &aTimeout)
+{
+    uint64_t now = GetNow();
+    uint64_t timeout = aTimeout.tv_sec * 1000 + aTimeout.tv_usec / 1000;
+
+    for (ClientList::iterator it = mClients.begin(); it != mClients.end();)
+    {
+        if (it->mExpiration <= now)
+        {
+            close(it->mFd);
+            it = mClients.erase(it);
+            continue;
+        }
+
+        if (it->mResponse.empty())
+        {
+            FD_SET(it->mFd, &aReadFdSet);
+        }
+        else
+        {
+            FD_SET(it->mFd, &aWriteFdSet);
+        }
+
+        if (aMaxFd < it->mFd)
+        {
+            aMaxFd = it->mFd;
+        }
+
+        if (it->mExpiration - now < timeout)
+        {
+            timeout = it->mExpiration - now;
+        }
+
+        ++it;
+    }
+
+    if (mClients.size() < kMaxClients)
+    {
+        FD_SET(mFd, &aReadFdSet);
+
+        if (aMaxFd < mFd)
+        {
+            aMaxFd = mFd;
+        }
+    }
+
+    aTimeout.tv_sec = timeout / 1000;
+    aTimeout.tv_usec = (timeout % 1000) * 1000;
+}
+
+void MetricsExporter::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet)
+{
+    for (ClientList::iterator it = mClients.begin(); it != mClients.end();)
+    {
+        bool done = false;
+
+        if (it->mResponse.empty())
+        {
+            done = FD_ISSET(it->mFd, &aReadFdSet) && !Receive(*it);
+        }
+        else
+        {
+            done = FD_ISSET(it->mFd, &aWriteFdSet) && !Send(*it);
+        }
+
+        if (done)
+        {
+            close(it->mFd);
+            it = mClients.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (FD_ISSET(mFd, &aReadFdSet))
+    {
+        Accept();
+    }
+}
+
+void MetricsExporter::Accept(void)
+{
+    Client client;
+
+    VerifyOrExit(mClients.size() < kMaxClients);
+    VerifyOrExit((client.mFd = accept(mFd, NULL, NULL)) >= 0);
+
+    if (fcntl(client.mFd, F_SETFL, O_NONBLOCK) != 0)
+    {
+        close(client.mFd);
+        ExitNow();
+    }
+
+    client.mExpiration = GetNow() + kClientTimeout;
+    client.mSent = 0;
+    mClients.push_back(client);
+
+exit:
+    return;
+}
+
+bool MetricsExporter::Receive(Client &aClient)
+{
+    bool    keep = true;
+    char    buffer[512];
+    ssize_t count = read(aClient.mFd, buffer, sizeof(buffer));
+
+    VerifyOrExit(count != 0, keep = false);
+    VerifyOrExit(count > 0, keep = (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+
+    aClient.mRequest.append(buffer, static_cast<size_t>(count));
+    VerifyOrExit(aClient.mRequest.size() <= kMaxRequestSize, keep = false);
+
+    // Any complete request header is answered with the metrics.
+    if (aClient.mRequest.find("\r\n\r\n") != std::string::npos || aClient.mRequest.find("\n\n") != std::string::npos)
+    {
+        std::string body;
+        char        header[160];
+
+        Metrics::Metric::FormatAll(body);
+        snprintf(header, sizeof(header),
+                 "HTTP/1.0 200 OK\r\n"
+                 "Content-Type: text/plain; version=0.0.4\r\n"
+                 "Content-Length: %zu\r\n"
+                 "Connection: close\r\n\r\n", body.size());
+
+        aClient.mResponse = header;
+        aClient.mResponse += body;
+        keep = Send(aClient);
+    }
+
+exit:
+    return keep;
+}
+
+bool MetricsExporter::Send(Client &aClient)
+{
+    bool    keep = true;
+    ssize_t count = send(aClient.mFd, aClient.mResponse.data() + aClient.mSent,
+                         aClient.mResponse.size() - aClient.mSent, MSG_NOSIGNAL);
+
+    VerifyOrExit(count >= 0, keep = (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+
+    aClient.mSent += static_cast<size_t>(count);
+    keep = (aClient.mSent < aClient.mResponse.size());
+
+exit:
+    return keep;
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definition for the Prometheus exporter of border agent metrics.
+ */
+
+#ifndef METRICS_EXPORTER_HPP_
+#define METRICS_EXPORTER_HPP_
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/select.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * This class serves all registered metrics in Prometheus text format.
+ *
+ * It answers every HTTP request with the metrics and closes the connection. It is polled by the main loop like the
+ * other border agent components, so scraping never races with the code updating the metrics.
+ *
+ */
+class MetricsExporter
+{
+public:
+    /**
+     * The constructor to initialize the exporter.
+     *
+     * @param[in]   aEndpoint   A TCP port on localhost, or the path of a Unix socket if it starts with '/'.
+     *
+     */
+    MetricsExporter(const char *aEndpoint);
+
+    ~MetricsExporter(void);
+
+    /**
+     * This method updates the fd_set and timeout for the main loop.
+     *
+     * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
+     * @param[inout]    aWriteFdSet     A reference to fd_set for polling write.
+     * @param[inout]    aMaxFd          A reference to the current max fd in @p aReadFdSet and @p aWriteFdSet.
+     * @param[inout]    aTimeout        A reference to the timeout.
+     *
+     */
+    void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, int &aMaxFd, timeval &aTimeout);
+
+    /**
+     * This method performs the exporter processing.
+     *
+     * @param[in]   aReadFdSet      A reference to fd_set ready for reading.
+     * @param[in]   aWriteFdSet     A reference to fd_set ready for writing.
+     *
+     */
+    void Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet);
+
+private:
+    enum
+    {
+        kMaxClients     = 4,    ///< Max number of concurrent scrapes.
+        kMaxRequestSize = 2048, ///< Max size of an HTTP request header.
+        kClientTimeout  = 5000, ///< Timeout of a scrape in milliseconds.
+    };
+
+    /**
+     * This structure represents a scrape in progress.
+     *
+     */
+    struct Client
+    {
+        int         mFd;
+        uint64_t    mExpiration;
+        std::string mRequest;
+        std::string mResponse;
+        size_t      mSent;
+    };
+
+    typedef std::vector<Client> ClientList;
+
+    void Accept(void);
+    bool Receive(Client &aClient);
+    bool Send(Client &aClient);
+
+    int         mFd;
+    std::string mPath;
+    ClientList  mClients;
+};
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif  // METRICS_EXPORTER_HPP_
@@ -77,9 +77,28 @@ public:
      */
     typedef void (*PSKcHandler)(const uint8_t *aPSKc, void *aContext);
 
+    /**
+     * This function pointer is called when the network data or the active dataset may have changed.
+     *
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    typedef void (*NetworkDataHandler)(void *aContext);
+
+    /**
+     * This function pointer is called when the border agent proxy is started and the PSKc and EUI64 are retrieved.
+     *
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    typedef void (*ReadyHandler)(void *aContext);
+
     /**
      * This method request the NCP to start the border agent proxy service.
      *
+     * It does not block. The NCP is looked up in the background and retried with backoff until it answers, then the
+     * ready handler is called.
+     *
      * @returns 0 on success, otherwise failure.
      *
      */
@@ -107,9 +126,11 @@ public:
      * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
      * @param[inout]    aWriteFdSet     A reference to fd_set for polling read.
      * @param[inout]    aMaxFd          A reference to the current max fd in @p aReadFdSet and @p aWriteFdSet.
+     * @param[inout]    aTimeout        A reference to the timeout, shortened to the next retry if any.
      *
      */
-    virtual void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd) = 0;
+    virtual void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd,
+                             timeval &aTimeout) = 0;
 
     /**
      * This method performs the DTLS processing.
@@ -122,7 +143,7 @@ public:
     /**
      * This method retrieves the current PSKc.
      *
-     * @returns The current PSKc.
+     * @returns The current PSKc, or NULL until the ready handler is called.
      *
      */
     virtual const uint8_t *GetPSKc(void) = 0;
@@ -130,11 +151,29 @@ public:
     /**
      * This method retrieves the Eui64.
      *
-     * @returns The hardware address.
+     * @returns The hardware address, or NULL until the ready handler is called.
      *
      */
     virtual const uint8_t *GetEui64(void) = 0;
 
+    /**
+     * This method sets the handler notified once the border agent proxy is started.
+     *
+     * @param[in]   aHandler    A pointer to the function that handles the readiness.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    virtual void SetReadyHandler(ReadyHandler aHandler, void *aContext) = 0;
+
+    /**
+     * This method sets the handler notified of network data changes.
+     *
+     * @param[in]   aHandler    A pointer to the function that handles the change.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    virtual void SetNetworkDataHandler(NetworkDataHandler aHandler, void *aContext) = 0;
+
     /**
      * This method creates a NCP Controller.
      *
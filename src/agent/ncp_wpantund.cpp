@@ -28,6 +28,7 @@
 
 #include "ncp_wpantund.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 
@@ -37,13 +38,15 @@
 #include <sys/time.h>
 
 extern "C" {
-#include "wpanctl-utils.h"
+#include "wpan-dbus-v0.h"
 #include "wpan-dbus-v1.h"
 }
 
 #include "spinel.h"
 
 #include "common/code_utils.hpp"
+#include "common/metrics.hpp"
+#include "common/time.hpp"
 
 namespace ot {
 
@@ -51,14 +54,15 @@ namespace BorderRouter {
 
 namespace Ncp {
 
-/**
- * This string is used to filter the property changed signal from wpantund.
- */
-const char *kDBusMatchPropChanged = "type='signal',interface='"WPANTUND_DBUS_APIv1_INTERFACE "',"
-                                    "member='"WPANTUND_IF_SIGNAL_PROP_CHANGED "'";
-
 #define BORDER_AGENT_DBUS_NAME      "otbr.agent"
 
+static Metrics::Histogram sDBusSendTime("otbr_dbus_send_duration_seconds",
+                                        "Time from sending a border agent proxy packet to wpantund until it replies.");
+
+DBusConnection                     *ControllerWpantund::sDBus = NULL;
+ControllerWpantund::WatchMap        ControllerWpantund::sWatches;
+ControllerWpantund::ControllerList  ControllerWpantund::sControllers;
+
 DBusHandlerResult ControllerWpantund::HandleProperyChangedSignal(DBusConnection *aConnection, DBusMessage *aMessage,
                                                                  void *aContext)
 {
@@ -68,89 +72,416 @@ DBusHandlerResult ControllerWpantund::HandleProperyChangedSignal(DBusConnection
 DBusHandlerResult ControllerWpantund::HandleProperyChangedSignal(DBusConnection &aConnection, DBusMessage &aMessage)
 {
     DBusMessageIter   iter;
-    DBusHandlerResult result = DBUS_HANDLER_RESULT_HANDLED;
+    DBusHandlerResult result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
     const char       *key = NULL;
-    const uint8_t    *pskc = NULL;
     const char       *sender = dbus_message_get_sender(&aMessage);
     const char       *path = dbus_message_get_path(&aMessage);
 
-    syslog(LOG_DEBUG, "dbus message received");
-    if (sender && path && strcmp(sender, mInterfaceDBusName) && strstr(path, mInterfaceName))
+    VerifyOrExit(dbus_message_is_signal(&aMessage, WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_SIGNAL_PROP_CHANGED));
+
+    // Every controller installs a filter on the shared connection, leave signals of other interfaces to them.
+    VerifyOrExit(path != NULL && !strcmp(path, mInterfaceDBusPath));
+
+    if (sender && strcmp(sender, mInterfaceDBusName) && (mState == kStateReady || mState == kStateWaiting))
     {
         // DBus name of the interface has changed, possibly caused by wpantund restarted,
-        // We have to restart the border agent proxy.
+        // We have to restart the border agent proxy. A start in progress already looks up the new name.
         syslog(LOG_DEBUG, "dbus name changed");
 
         BorderAgentProxyStart();
     }
 
-    VerifyOrExit(dbus_message_is_signal(&aMessage, WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_SIGNAL_PROP_CHANGED),
-                 result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
-
     VerifyOrExit(dbus_message_iter_init(&aMessage, &iter));
+    VerifyOrExit(dbus_message_iter_get_arg_type(&iter) == DBUS_TYPE_STRING);
     dbus_message_iter_get_basic(&iter, &key);
-    VerifyOrExit(key != NULL, result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
     dbus_message_iter_next(&iter);
-    syslog(LOG_INFO, "property %s changed", key);
+    syslog(LOG_DEBUG, "property %s changed on %s", key, mInterfaceName);
+
+    result = DBUS_HANDLER_RESULT_HANDLED;
 
-    if (!strcmp(key, kWPANTUNDProperty_NetworkPSKc))
     {
-        int             count = 0;
+        std::pair<SubscriptionMap::const_iterator, SubscriptionMap::const_iterator> range =
+            mSubscriptions.equal_range(key);
+
+        for (SubscriptionMap::const_iterator it = range.first; it != range.second; ++it)
+        {
+            Dispatch(it->second, key, iter);
+        }
+    }
+
+exit:
+
+    (void)aConnection;
+
+    return result;
+}
+
+void ControllerWpantund::Dispatch(const Subscription &aSubscription, const char *aKey, DBusMessageIter &aIter)
+{
+    int type = dbus_message_iter_get_arg_type(&aIter);
+
+    switch (aSubscription.mType)
+    {
+    case kPropertyTypeData:
+    {
         DBusMessageIter subIter;
+        const uint8_t  *data = NULL;
+        int             count = 0;
 
-        dbus_message_iter_recurse(&iter, &subIter);
-        dbus_message_iter_get_fixed_array(&subIter, &pskc, &count);
-        mPSKcHandler(pskc, mContext);
+        VerifyOrExit(type == DBUS_TYPE_ARRAY && dbus_message_iter_get_element_type(&aIter) == DBUS_TYPE_BYTE);
+        dbus_message_iter_recurse(&aIter, &subIter);
+        dbus_message_iter_get_fixed_array(&subIter, &data, &count);
+        aSubscription.mHandler.mData(data, static_cast<uint16_t>(count), aSubscription.mContext);
+        break;
     }
-    else if (!strcmp(key, kWPANTUNDProperty_BorderAgentProxyStream))
+
+    case kPropertyTypeString:
     {
-        const uint8_t *buf = NULL;
-        uint16_t       locator = 0;
-        uint16_t       port = 0;
-        uint16_t       len = 0;
+        const char *value = NULL;
+
+        VerifyOrExit(type == DBUS_TYPE_STRING);
+        dbus_message_iter_get_basic(&aIter, &value);
+        aSubscription.mHandler.mString(value, aSubscription.mContext);
+        break;
+    }
+
+    case kPropertyTypeBool:
+    {
+        dbus_bool_t value = FALSE;
+
+        VerifyOrExit(type == DBUS_TYPE_BOOLEAN);
+        dbus_message_iter_get_basic(&aIter, &value);
+        aSubscription.mHandler.mBool(value ? true : false, aSubscription.mContext);
+        break;
+    }
+
+    case kPropertyTypeUint:
+    {
+        DBusBasicValue value;
+        uint32_t       uintValue = 0;
+
+        VerifyOrExit(type == DBUS_TYPE_BYTE || type == DBUS_TYPE_UINT16 || type == DBUS_TYPE_INT16 ||
+                     type == DBUS_TYPE_UINT32 || type == DBUS_TYPE_INT32);
+
+        memset(&value, 0, sizeof(value));
+        dbus_message_iter_get_basic(&aIter, &value);
+
+        switch (type)
         {
-            DBusMessageIter sub_iter;
-            int             nelements = 0;
+        case DBUS_TYPE_BYTE:
+            uintValue = value.byt;
+            break;
+
+        case DBUS_TYPE_UINT16:
+            uintValue = value.u16;
+            break;
 
-            dbus_message_iter_recurse(&iter, &sub_iter);
-            dbus_message_iter_get_fixed_array(&sub_iter, &buf, &nelements);
-            len = (uint16_t)nelements;
+        case DBUS_TYPE_INT16:
+            uintValue = static_cast<uint32_t>(value.i16);
+            break;
+
+        case DBUS_TYPE_UINT32:
+            uintValue = value.u32;
+            break;
+
+        default:
+            uintValue = static_cast<uint32_t>(value.i32);
+            break;
         }
 
-        // both port and locator are encoded in network endian.
-        port = buf[--len];
-        port |= buf[--len] << 8;
-        locator = buf[--len];
-        locator |= buf[--len] << 8;
+        aSubscription.mHandler.mUint(uintValue, aSubscription.mContext);
+        break;
+    }
+    }
+
+    return;
+
+exit:
+    syslog(LOG_WARNING, "unexpected type '%c' of property %s", type, aKey);
+}
+
+int ControllerWpantund::UpdateMatchRule(const char *aKey, bool aAdd)
+{
+    int       ret = 0;
+    char      rule[DBUS_MAXIMUM_MATCH_RULE_LENGTH];
+    DBusError error;
 
-        mPacketHandler(buf, len, locator, port, mContext);
+    dbus_error_init(&error);
+
+    VerifyOrExit(snprintf(rule, sizeof(rule),
+                          "type='signal',interface='%s',member='%s',path='%s',arg0='%s'",
+                          WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_SIGNAL_PROP_CHANGED,
+                          mInterfaceDBusPath, aKey) < static_cast<int>(sizeof(rule)), ret = -1);
+
+    if (aAdd)
+    {
+        dbus_bus_add_match(mDBus, rule, &error);
     }
     else
     {
-        result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+        dbus_bus_remove_match(mDBus, rule, &error);
     }
 
+    VerifyOrExit(!dbus_error_is_set(&error), ret = -1,
+                 syslog(LOG_ERR, "DBus error: %s", error.message));
+
 exit:
+    dbus_error_free(&error);
+    return ret;
+}
 
-    (void)aConnection;
+int ControllerWpantund::Subscribe(const char *aKey, const Subscription &aSubscription)
+{
+    int ret = 0;
 
-    return result;
+    if (mSubscriptions.count(aKey) == 0)
+    {
+        SuccessOrExit(ret = UpdateMatchRule(aKey, true));
+    }
+
+    mSubscriptions.insert(SubscriptionMap::value_type(aKey, aSubscription));
+
+exit:
+    return ret;
+}
+
+int ControllerWpantund::Subscribe(const char *aKey, DataHandler aHandler, void *aContext)
+{
+    Subscription subscription;
+
+    subscription.mType = kPropertyTypeData;
+    subscription.mHandler.mData = aHandler;
+    subscription.mContext = aContext;
+
+    return Subscribe(aKey, subscription);
+}
+
+int ControllerWpantund::Subscribe(const char *aKey, StringHandler aHandler, void *aContext)
+{
+    Subscription subscription;
+
+    subscription.mType = kPropertyTypeString;
+    subscription.mHandler.mString = aHandler;
+    subscription.mContext = aContext;
+
+    return Subscribe(aKey, subscription);
+}
+
+int ControllerWpantund::Subscribe(const char *aKey, BoolHandler aHandler, void *aContext)
+{
+    Subscription subscription;
+
+    subscription.mType = kPropertyTypeBool;
+    subscription.mHandler.mBool = aHandler;
+    subscription.mContext = aContext;
+
+    return Subscribe(aKey, subscription);
+}
+
+int ControllerWpantund::Subscribe(const char *aKey, UintHandler aHandler, void *aContext)
+{
+    Subscription subscription;
+
+    subscription.mType = kPropertyTypeUint;
+    subscription.mHandler.mUint = aHandler;
+    subscription.mContext = aContext;
+
+    return Subscribe(aKey, subscription);
+}
+
+void ControllerWpantund::Unsubscribe(const char *aKey, void *aContext)
+{
+    std::pair<SubscriptionMap::iterator, SubscriptionMap::iterator> range = mSubscriptions.equal_range(aKey);
+
+    VerifyOrExit(range.first != range.second);
+
+    for (SubscriptionMap::iterator it = range.first; it != range.second;)
+    {
+        if (it->second.mContext == aContext)
+        {
+            it = mSubscriptions.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (mSubscriptions.count(aKey) == 0)
+    {
+        UpdateMatchRule(aKey, false);
+    }
+
+exit:
+    return;
+}
+
+void ControllerWpantund::RemoveSubscriptions(void)
+{
+    ControllerList::iterator controller = std::find(sControllers.begin(), sControllers.end(), this);
+
+    // Keys are adjacent in the multimap, remove the match rule of each key once.
+    for (SubscriptionMap::iterator it = mSubscriptions.begin(); it != mSubscriptions.end();
+         it = mSubscriptions.equal_range(it->first).second)
+    {
+        UpdateMatchRule(it->first.c_str(), false);
+    }
+
+    mSubscriptions.clear();
+
+    VerifyOrExit(controller != sControllers.end());
+    dbus_connection_remove_filter(mDBus, HandleProperyChangedSignal, this);
+    sControllers.erase(controller);
+
+exit:
+    return;
+}
+
+void ControllerWpantund::HandlePSKc(const uint8_t *aData, uint16_t aLength, void *aContext)
+{
+    ControllerWpantund *controller = static_cast<ControllerWpantund *>(aContext);
+
+    VerifyOrExit(aLength == kSizePSKc, syslog(LOG_ERR, "invalid PSKc length %u", aLength));
+    memcpy(controller->mPSKc, aData, kSizePSKc);
+    controller->mPSKcHandler(aData, controller->mContext);
+
+exit:
+    return;
+}
+
+void ControllerWpantund::HandleProxyStream(const uint8_t *aData, uint16_t aLength, void *aContext)
+{
+    ControllerWpantund *controller = static_cast<ControllerWpantund *>(aContext);
+    uint16_t            locator = 0;
+    uint16_t            port = 0;
+
+    VerifyOrExit(aLength >= sizeof(locator) + sizeof(port), syslog(LOG_ERR, "invalid proxy stream"));
+
+    // both port and locator are encoded in network endian.
+    port = aData[--aLength];
+    port |= aData[--aLength] << 8;
+    locator = aData[--aLength];
+    locator |= aData[--aLength] << 8;
+
+    controller->mPacketHandler(aData, aLength, locator, port, controller->mContext);
+
+exit:
+    return;
+}
+
+void ControllerWpantund::HandleNcpState(const char *aValue, void *aContext)
+{
+    // The state is also subscribed so that a restarted wpantund is noticed by its new DBus name.
+    syslog(LOG_INFO, "%s state changed to %s", static_cast<ControllerWpantund *>(aContext)->mInterfaceName, aValue);
+
+    // Leaving or rejoining a partition may come with another leader and other datasets.
+    static_cast<ControllerWpantund *>(aContext)->NotifyNetworkData();
+}
+
+void ControllerWpantund::HandleNetworkValue(uint32_t aValue, void *aContext)
+{
+    (void)aValue;
+    static_cast<ControllerWpantund *>(aContext)->NotifyNetworkData();
+}
+
+void ControllerWpantund::HandleNetworkName(const char *aValue, void *aContext)
+{
+    (void)aValue;
+    static_cast<ControllerWpantund *>(aContext)->NotifyNetworkData();
+}
+
+void ControllerWpantund::NotifyNetworkData(void)
+{
+    if (mNetworkDataHandler != NULL)
+    {
+        mNetworkDataHandler(mNetworkDataContext);
+    }
+}
+
+void ControllerWpantund::SetNetworkDataHandler(NetworkDataHandler aHandler, void *aContext)
+{
+    mNetworkDataHandler = aHandler;
+    mNetworkDataContext = aContext;
+}
+
+void ControllerWpantund::SetReadyHandler(ReadyHandler aHandler, void *aContext)
+{
+    mReadyHandler = aHandler;
+    mReadyContext = aContext;
 }
 
 dbus_bool_t ControllerWpantund::AddDBusWatch(struct DBusWatch *aWatch, void *aContext)
 {
-    static_cast<ControllerWpantund *>(aContext)->mWatches[aWatch] = true;
+    sWatches[aWatch] = true;
+    (void)aContext;
     return TRUE;
 }
 
 void ControllerWpantund::RemoveDBusWatch(struct DBusWatch *aWatch, void *aContext)
 {
-    static_cast<ControllerWpantund *>(aContext)->mWatches.erase(aWatch);
+    sWatches.erase(aWatch);
+    (void)aContext;
 }
 
 void ControllerWpantund::ToggleDBusWatch(struct DBusWatch *aWatch, void *aContext)
 {
-    static_cast<ControllerWpantund *>(aContext)->mWatches[aWatch] = (dbus_watch_get_enabled(aWatch) ? true : false);
+    sWatches[aWatch] = (dbus_watch_get_enabled(aWatch) ? true : false);
+    (void)aContext;
+}
+
+DBusConnection *ControllerWpantund::ConnectDBus(DBusError &aError)
+{
+    DBusConnection *dbus = NULL;
+
+    VerifyOrExit(sDBus == NULL, dbus = sDBus);
+
+    dbus = dbus_bus_get(DBUS_BUS_STARTER, &aError);
+    if (!dbus)
+    {
+        dbus_error_free(&aError);
+        dbus = dbus_bus_get(DBUS_BUS_SYSTEM, &aError);
+    }
+    VerifyOrExit(dbus != NULL);
+
+    VerifyOrExit(dbus_bus_register(dbus, &aError));
+
+    VerifyOrExit(dbus_bus_request_name(dbus,
+                                       BORDER_AGENT_DBUS_NAME,
+                                       DBUS_NAME_FLAG_DO_NOT_QUEUE,
+                                       &aError) == DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER);
+
+    VerifyOrExit(dbus_connection_set_watch_functions(
+                     dbus,
+                     AddDBusWatch,
+                     RemoveDBusWatch,
+                     ToggleDBusWatch,
+                     NULL, NULL));
+
+    sDBus = dbus;
+
+exit:
+    if (dbus != NULL && dbus != sDBus)
+    {
+        dbus_connection_unref(dbus);
+        dbus = NULL;
+    }
+
+    return dbus;
+}
+
+void ControllerWpantund::DisconnectDBus(void)
+{
+    VerifyOrExit(sDBus != NULL && sControllers.empty());
+
+    // Push out pending requests, e.g. disabling the border agent proxy, before letting go of the connection.
+    dbus_connection_flush(sDBus);
+    dbus_connection_set_watch_functions(sDBus, NULL, NULL, NULL, NULL, NULL);
+    dbus_connection_unref(sDBus);
+    sDBus = NULL;
+    sWatches.clear();
+
+exit:
+    return;
 }
 
 int ControllerWpantund::BorderAgentProxyEnable(dbus_bool_t aEnable)
@@ -159,6 +490,8 @@ int ControllerWpantund::BorderAgentProxyEnable(dbus_bool_t aEnable)
     DBusMessage *message = NULL;
     const char  *key = kWPANTUNDProperty_BorderAgentProxyEnabled;
 
+    VerifyOrExit(mInterfaceDBusName[0] != '\0', ret = -1);
+
     message = dbus_message_new_method_call(
         mInterfaceDBusName,
         mInterfaceDBusPath,
@@ -186,44 +519,52 @@ exit:
 
 ControllerWpantund::ControllerWpantund(const char *aInterfaceName, PSKcHandler aPSKcHandler,
                                        PacketHandler aPacketHandler, void *aContext) :
+    mDBus(NULL),
     mPacketHandler(aPacketHandler),
     mPSKcHandler(aPSKcHandler),
-    mContext(aContext)
+    mContext(aContext),
+    mNetworkDataHandler(NULL),
+    mNetworkDataContext(NULL),
+    mReadyHandler(NULL),
+    mReadyContext(NULL),
+    mPending(NULL)
 {
     int       ret = 0;
     DBusError error;
 
-    strncpy(mInterfaceName, aInterfaceName, sizeof(mInterfaceName));
+    mInterfaceDBusName[0] = '\0';
+    mState = kStateStopped;
+    mHasCredentials = false;
+    mRetryTime = 0;
+    mRetryDelay = kMinRetryDelay;
+    strncpy(mInterfaceName, aInterfaceName, sizeof(mInterfaceName) - 1);
+    mInterfaceName[sizeof(mInterfaceName) - 1] = '\0';
 
-    dbus_error_init(&error);
-    mDBus = dbus_bus_get(DBUS_BUS_STARTER, &error);
-    if (!mDBus)
-    {
-        dbus_error_free(&error);
-        mDBus = dbus_bus_get(DBUS_BUS_SYSTEM, &error);
-    }
-    VerifyOrExit(mDBus != NULL, ret = -1);
+    // according to source code of wpanctl, better to export a function.
+    snprintf(mInterfaceDBusPath,
+             sizeof(mInterfaceDBusPath),
+             "%s/%s",
+             WPANTUND_DBUS_PATH,
+             mInterfaceName);
 
-    VerifyOrExit(dbus_bus_register(mDBus, &error), ret = -1);
+    dbus_error_init(&error);
+    VerifyOrExit((mDBus = ConnectDBus(error)) != NULL, ret = -1);
 
-    VerifyOrExit(dbus_bus_request_name(mDBus,
-                                       BORDER_AGENT_DBUS_NAME,
-                                       DBUS_NAME_FLAG_DO_NOT_QUEUE,
-                                       &error) == DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER,
+    VerifyOrExit(dbus_connection_add_filter(mDBus, HandleProperyChangedSignal, this, NULL),
                  ret = -1);
 
-    VerifyOrExit(dbus_connection_set_watch_functions(
-                     mDBus,
-                     AddDBusWatch,
-                     RemoveDBusWatch,
-                     ToggleDBusWatch,
-                     this, NULL), ret = -1);
+    sControllers.push_back(this);
 
-    dbus_bus_add_match(mDBus, kDBusMatchPropChanged, &error);
-    VerifyOrExit(!dbus_error_is_set(&error), ret = -1);
+    SuccessOrExit(ret = Subscribe(kWPANTUNDProperty_NetworkPSKc, HandlePSKc, this));
+    SuccessOrExit(ret = Subscribe(kWPANTUNDProperty_BorderAgentProxyStream, HandleProxyStream, this));
+    SuccessOrExit(ret = Subscribe(kWPANTUNDProperty_NCPState, HandleNcpState, this));
 
-    VerifyOrExit(dbus_connection_add_filter(mDBus, HandleProperyChangedSignal, this, NULL),
-                 ret = -1);
+    // The commissioner dataset is part of the network data, the other properties belong to the active dataset.
+    SuccessOrExit(ret = Subscribe(kWPANTUNDProperty_ThreadNetworkDataVersion, HandleNetworkValue, this));
+    SuccessOrExit(ret = Subscribe(kWPANTUNDProperty_ThreadStableNetworkDataVersion, HandleNetworkValue, this));
+    SuccessOrExit(ret = Subscribe(kWPANTUNDProperty_NetworkPANID, HandleNetworkValue, this));
+    SuccessOrExit(ret = Subscribe(kWPANTUNDProperty_NCPChannel, HandleNetworkValue, this));
+    SuccessOrExit(ret = Subscribe(kWPANTUNDProperty_NetworkName, HandleNetworkName, this));
 
 exit:
     if (dbus_error_is_set(&error))
@@ -234,10 +575,12 @@ exit:
 
     if (ret)
     {
-        if (mDBus)
+        if (mDBus != NULL)
         {
-            dbus_connection_unref(mDBus);
+            RemoveSubscriptions();
         }
+
+        DisconnectDBus();
         syslog(LOG_ERR, "Failed to initialize ncp controller. error=%d", ret);
         throw std::runtime_error("Failed to create ncp controller");
     }
@@ -245,34 +588,259 @@ exit:
 
 ControllerWpantund::~ControllerWpantund(void)
 {
+    CancelRequest();
     BorderAgentProxyStop();
+    RemoveSubscriptions();
+    DisconnectDBus();
 }
 
 int ControllerWpantund::BorderAgentProxyStart(void)
 {
     int ret = 0;
 
-    SuccessOrExit(ret = lookup_dbus_name_from_interface(mInterfaceDBusName, mInterfaceName));
+    // A start in progress is abandoned, its replies would come from a wpantund that is gone.
+    CancelRequest();
+    mRetryDelay = kMinRetryDelay;
 
-    // according to source code of wpanctl, better to export a function.
-    snprintf(mInterfaceDBusPath,
-             sizeof(mInterfaceDBusPath),
-             "%s/%s",
-             WPANTUND_DBUS_PATH,
-             mInterfaceName);
+    SuccessOrExit(ret = RequestInterfaces());
+
+exit:
+    if (ret)
+    {
+        Retry();
+    }
+
+    return ret;
+}
+
+int ControllerWpantund::RequestInterfaces(void)
+{
+    mState = kStateLookingUp;
+
+    return SendRequest(dbus_message_new_method_call(WPAN_TUNNEL_DBUS_NAME,
+                                                    WPAN_TUNNEL_DBUS_PATH,
+                                                    WPAN_TUNNEL_DBUS_INTERFACE,
+                                                    WPAN_TUNNEL_CMD_GET_INTERFACES));
+}
+
+int ControllerWpantund::RequestProperty(const char *aKey)
+{
+    int          ret = 0;
+    DBusMessage *message = NULL;
+
+    VerifyOrExit((message = dbus_message_new_method_call(mInterfaceDBusName,
+                                                         mInterfaceDBusPath,
+                                                         WPANTUND_DBUS_APIv1_INTERFACE,
+                                                         WPANTUND_IF_CMD_PROP_GET)) != NULL, ret = -1);
+
+    VerifyOrExit(dbus_message_append_args(message, DBUS_TYPE_STRING, &aKey, DBUS_TYPE_INVALID), ret = -1);
+
+    SuccessOrExit(ret = SendRequest(message));
+    message = NULL;
+
+exit:
+    if (message != NULL)
+    {
+        dbus_message_unref(message);
+    }
+
+    return ret;
+}
+
+int ControllerWpantund::SendRequest(DBusMessage *aMessage)
+{
+    int ret = 0;
+
+    VerifyOrExit(aMessage != NULL, ret = -1);
+
+    // The timeout of the pending call is never fired without DBus timeout functions, so Process() enforces it.
+    VerifyOrExit(dbus_connection_send_with_reply(mDBus, aMessage, &mPending, kRequestTimeout) && mPending != NULL,
+                 ret = -1);
+    mRetryTime = GetNow() + kRequestTimeout;
+
+    if (!dbus_pending_call_set_notify(mPending, HandleReply, this, NULL))
+    {
+        CancelRequest();
+        ExitNow(ret = -1);
+    }
+
+exit:
+    if (aMessage != NULL)
+    {
+        dbus_message_unref(aMessage);
+    }
+
+    return ret;
+}
+
+void ControllerWpantund::HandleReply(DBusPendingCall *aPending, void *aContext)
+{
+    ControllerWpantund *controller = static_cast<ControllerWpantund *>(aContext);
+    DBusMessage        *reply = dbus_pending_call_steal_reply(aPending);
+
+    dbus_pending_call_unref(controller->mPending);
+    controller->mPending = NULL;
+
+    if (reply != NULL)
+    {
+        controller->HandleReply(*reply);
+        dbus_message_unref(reply);
+    }
+    else
+    {
+        controller->Retry();
+    }
+}
+
+void ControllerWpantund::HandleReply(DBusMessage &aReply)
+{
+    int ret = 0;
+
+    VerifyOrExit(dbus_message_get_type(&aReply) != DBUS_MESSAGE_TYPE_ERROR,
+                 syslog(LOG_INFO, "wpantund failed to answer on %s: %s", mInterfaceName,
+                        dbus_message_get_error_name(&aReply)),
+                 ret = -1);
+
+    switch (mState)
+    {
+    case kStateLookingUp:
+        SuccessOrExit(ret = HandleInterfaces(aReply));
+        SuccessOrExit(ret = BorderAgentProxyEnable(TRUE));
+        mState = kStateGettingPSKc;
+        SuccessOrExit(ret = RequestProperty(kWPANTUNDProperty_NetworkPSKc));
+        break;
+
+    case kStateGettingPSKc:
+        SuccessOrExit(ret = HandleProperty(aReply, mPSKc, sizeof(mPSKc)));
+        mState = kStateGettingEui64;
+        SuccessOrExit(ret = RequestProperty(kWPANTUNDProperty_NCPHardwareAddress));
+        break;
+
+    case kStateGettingEui64:
+        SuccessOrExit(ret = HandleProperty(aReply, mEui64, sizeof(mEui64)));
+        mState = kStateReady;
+        mHasCredentials = true;
+        mRetryDelay = kMinRetryDelay;
+        syslog(LOG_INFO, "border agent proxy started on %s", mInterfaceName);
+
+        if (mReadyHandler != NULL)
+        {
+            mReadyHandler(mReadyContext);
+        }
+
+        break;
+
+    default:
+        break;
+    }
+
+exit:
+    if (ret)
+    {
+        Retry();
+    }
+}
+
+int ControllerWpantund::HandleInterfaces(DBusMessage &aReply)
+{
+    int             ret = -1;
+    DBusMessageIter iter;
+    DBusMessageIter listIter;
+
+    VerifyOrExit(dbus_message_iter_init(&aReply, &iter) && dbus_message_iter_get_arg_type(&iter) == DBUS_TYPE_ARRAY);
+
+    // Every item is an array of the interface name followed by the DBus name serving it.
+    for (dbus_message_iter_recurse(&iter, &listIter);
+         dbus_message_iter_get_arg_type(&listIter) == DBUS_TYPE_ARRAY;
+         dbus_message_iter_next(&listIter))
+    {
+        DBusMessageIter itemIter;
+        const char     *interfaceName = NULL;
+        const char     *dbusName = NULL;
+
+        dbus_message_iter_recurse(&listIter, &itemIter);
+        VerifyOrExit(dbus_message_iter_get_arg_type(&itemIter) == DBUS_TYPE_STRING);
+        dbus_message_iter_get_basic(&itemIter, &interfaceName);
+        VerifyOrExit(dbus_message_iter_next(&itemIter) &&
+                     dbus_message_iter_get_arg_type(&itemIter) == DBUS_TYPE_STRING);
+        dbus_message_iter_get_basic(&itemIter, &dbusName);
+
+        if (!strcmp(interfaceName, mInterfaceName))
+        {
+            strncpy(mInterfaceDBusName, dbusName, sizeof(mInterfaceDBusName) - 1);
+            mInterfaceDBusName[sizeof(mInterfaceDBusName) - 1] = '\0';
+            ExitNow(ret = 0);
+        }
+    }
+
+exit:
+    if (ret)
+    {
+        syslog(LOG_INFO, "wpantund does not serve %s yet", mInterfaceName);
+    }
+
+    return ret;
+}
+
+int ControllerWpantund::HandleProperty(DBusMessage &aReply, uint8_t *aBuffer, size_t aSize)
+{
+    int       ret = 0;
+    uint8_t  *buffer = NULL;
+    int       count = 0;
+    DBusError error;
+
+    dbus_error_init(&error);
+    VerifyOrExit(dbus_message_get_args(&aReply, &error,
+                                       DBUS_TYPE_INT32, &ret,
+                                       DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &buffer, &count,
+                                       DBUS_TYPE_INVALID),
+                 ret = -1, syslog(LOG_ERR, "Failed to parse: %s", error.message));
+    VerifyOrExit(ret == 0, syslog(LOG_INFO, "wpantund failed to get property on %s: %d", mInterfaceName, ret));
+    VerifyOrExit(static_cast<size_t>(count) == aSize, ret = -1,
+                 syslog(LOG_ERR, "invalid property length %d on %s", count, mInterfaceName));
 
-    BorderAgentProxyEnable(TRUE);
+    memcpy(aBuffer, buffer, aSize);
 
 exit:
+    dbus_error_free(&error);
 
     return ret;
 }
 
+void ControllerWpantund::Retry(void)
+{
+    CancelRequest();
+
+    mState = kStateWaiting;
+    mRetryTime = GetNow() + mRetryDelay;
+    syslog(LOG_INFO, "retrying to start border agent proxy on %s in %u ms", mInterfaceName, mRetryDelay);
+
+    mRetryDelay *= 2;
+
+    if (mRetryDelay > kMaxRetryDelay)
+    {
+        mRetryDelay = kMaxRetryDelay;
+    }
+}
+
+void ControllerWpantund::CancelRequest(void)
+{
+    VerifyOrExit(mPending != NULL);
+
+    dbus_pending_call_cancel(mPending);
+    dbus_pending_call_unref(mPending);
+    mPending = NULL;
+
+exit:
+    return;
+}
+
 int ControllerWpantund::BorderAgentProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator,
                                              uint16_t aPort)
 {
-    int          ret = 0;
-    DBusMessage *message = NULL;
+    int              ret = 0;
+    DBusMessage     *message = NULL;
+    DBusPendingCall *pending = NULL;
 
     std::vector<uint8_t> data(aLength + sizeof(aLocator) + sizeof(aPort));
     const uint8_t       *value = data.data();
@@ -298,7 +866,20 @@ int ControllerWpantund::BorderAgentProxySend(const uint8_t *aBuffer, uint16_t aL
                      DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE,
                      &value, data.size(), DBUS_TYPE_INVALID), ret = -1);
 
-    VerifyOrExit(dbus_connection_send(mDBus, message, NULL), ret = -1);
+    // The reply is only awaited for measuring the latency, it never blocks the main loop.
+    VerifyOrExit(dbus_connection_send_with_reply(mDBus, message, &pending, DBUS_TIMEOUT_USE_DEFAULT), ret = -1);
+
+    if (pending != NULL)
+    {
+        uint64_t *sentTime = new uint64_t(GetMonotonicMicros());
+
+        if (!dbus_pending_call_set_notify(pending, HandleProxySendReply, sentTime, FreeSentTime))
+        {
+            delete sentTime;
+        }
+
+        dbus_pending_call_unref(pending);
+    }
 
 exit:
 
@@ -310,21 +891,51 @@ exit:
     return ret;
 }
 
-int ControllerWpantund::BorderAgentProxyStop(void)
+void ControllerWpantund::HandleProxySendReply(DBusPendingCall *aPending, void *aSentTime)
 {
-    BorderAgentProxyEnable(FALSE);
-    if (mDBus)
+    DBusMessage *reply = dbus_pending_call_steal_reply(aPending);
+
+    sDBusSendTime.Record(GetMonotonicMicros() - *static_cast<uint64_t *>(aSentTime));
+
+    if (reply != NULL)
     {
-        dbus_connection_unref(mDBus);
-        mDBus = NULL;
+        if (dbus_message_get_type(reply) == DBUS_MESSAGE_TYPE_ERROR)
+        {
+            syslog(LOG_WARNING, "border agent proxy send failed: %s", dbus_message_get_error_name(reply));
+        }
+
+        dbus_message_unref(reply);
     }
+}
 
-    return 0;
+void ControllerWpantund::FreeSentTime(void *aSentTime)
+{
+    delete static_cast<uint64_t *>(aSentTime);
+}
+
+int ControllerWpantund::BorderAgentProxyStop(void)
+{
+    return BorderAgentProxyEnable(FALSE);
 }
 
-void ControllerWpantund::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd)
+void ControllerWpantund::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd,
+                                     timeval &aTimeout)
 {
-    for (WatchMap::iterator it = mWatches.begin(); it != mWatches.end(); ++it)
+    if (mState != kStateStopped && mState != kStateReady)
+    {
+        uint64_t now = GetNow();
+        uint64_t delay = (mRetryTime > now ? mRetryTime - now : 0);
+
+        if (delay < static_cast<uint64_t>(aTimeout.tv_sec) * 1000 + static_cast<uint64_t>(aTimeout.tv_usec) / 1000)
+        {
+            aTimeout.tv_sec = static_cast<time_t>(delay / 1000);
+            aTimeout.tv_usec = static_cast<suseconds_t>((delay % 1000) * 1000);
+        }
+    }
+
+    VerifyOrExit(IsDBusOwner());
+
+    for (WatchMap::iterator it = sWatches.begin(); it != sWatches.end(); ++it)
     {
         if (!it->second)
         {
@@ -358,11 +969,25 @@ void ControllerWpantund::UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd
             aMaxFd = fd;
         }
     }
+
+exit:
+    return;
 }
 
 void ControllerWpantund::Process(const fd_set &aReadFdSet, const fd_set &aWriteFdSet, const fd_set &aErrorFdSet)
 {
-    for (WatchMap::iterator it = mWatches.begin(); it != mWatches.end(); ++it)
+    if (mState != kStateStopped && mState != kStateReady && GetNow() >= mRetryTime)
+    {
+        // Either the backoff is over, or wpantund did not answer in time.
+        if (mState != kStateWaiting || RequestInterfaces() != 0)
+        {
+            Retry();
+        }
+    }
+
+    VerifyOrExit(IsDBusOwner());
+
+    for (WatchMap::iterator it = sWatches.begin(); it != sWatches.end(); ++it)
     {
         if (!it->second)
         {
@@ -398,97 +1023,19 @@ void ControllerWpantund::Process(const fd_set &aReadFdSet, const fd_set &aWriteF
 
     while (DBUS_DISPATCH_DATA_REMAINS == dbus_connection_get_dispatch_status(mDBus) &&
            dbus_connection_read_write_dispatch(mDBus, 0)) ;
-}
-
-DBusMessage *ControllerWpantund::RequestProperty(const char *aKey)
-{
-    DBusMessage *message = NULL;
-    DBusMessage *reply = NULL;
-    int          timeout = DEFAULT_TIMEOUT_IN_SECONDS * 1000;
-    DBusError    error;
-
-    dbus_error_init(&error);
-    VerifyOrExit((message = dbus_message_new_method_call(mInterfaceDBusName,
-                                                         mInterfaceDBusPath,
-                                                         WPANTUND_DBUS_APIv1_INTERFACE,
-                                                         WPANTUND_IF_CMD_PROP_GET)) != NULL);
-
-    VerifyOrExit(dbus_message_append_args(message, DBUS_TYPE_STRING, &aKey, DBUS_TYPE_INVALID));
-
-    reply = dbus_connection_send_with_reply_and_block(mDBus, message, timeout, &error);
-
-exit:
-
-    if (dbus_error_is_set(&error))
-    {
-        syslog(LOG_ERR, "DBus error: %s", error.message);
-        dbus_error_free(&error);
-    }
-
-    if (message)
-    {
-        dbus_message_unref(message);
-    }
-
-    return reply;
-}
-
-int ControllerWpantund::GetProperty(const char *aKey, uint8_t *aBuffer, size_t &aSize)
-{
-    int          ret = 0;
-    DBusMessage *reply = NULL;
-    DBusError    error;
-
-    VerifyOrExit(reply = RequestProperty(aKey),
-                 ret = -1, syslog(LOG_ERR, "No reply"));
-
-    {
-        uint8_t *buffer = NULL;
-        int      count = 0;
-
-        dbus_error_init(&error);
-        VerifyOrExit(dbus_message_get_args(reply, &error,
-                                           DBUS_TYPE_INT32, &ret,
-                                           DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &buffer, &count,
-                                           DBUS_TYPE_INVALID),
-                     ret = -1, syslog(LOG_ERR, "Failed to parse"));
-        VerifyOrExit(ret == 0);
-
-        aSize = static_cast<size_t>(count);
-        memcpy(aBuffer, buffer, count);
-    }
 
 exit:
-
-    if (reply)
-    {
-        dbus_message_unref(reply);
-    }
-
-    return ret;
+    return;
 }
 
 const uint8_t *ControllerWpantund::GetPSKc(void)
 {
-    size_t size = 0;
-
-    VerifyOrExit(0 == GetProperty(kWPANTUNDProperty_NetworkPSKc, mPSKc, size),
-                 memset(mPSKc, 0, sizeof(mPSKc)));
-
-exit:
-    return mPSKc;
+    return mHasCredentials ? mPSKc : NULL;
 }
 
 const uint8_t *ControllerWpantund::GetEui64(void)
 {
-    size_t size = 0;
-
-    VerifyOrExit(0 == GetProperty(kWPANTUNDProperty_NCPHardwareAddress, mEui64, size),
-                 memset(mEui64, 0, sizeof(mEui64)));
-
-exit:
-
-    return mEui64;
+    return mHasCredentials ? mEui64 : NULL;
 }
 
 Controller *Controller::Create(const char *aInterfaceName, PSKcHandler aPSKcHandler, PacketHandler aPacketHandler,
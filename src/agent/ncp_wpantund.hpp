@@ -35,6 +35,10 @@
 #define NCP_WPANTUND_HPP_
 
 #include <map>
+#include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
 
 #include <arpa/inet.h>
 #include <dbus/dbus.h>
@@ -101,9 +105,11 @@ public:
      * @param[inout]    aReadFdSet      A reference to fd_set for polling read.
      * @param[inout]    aWriteFdSet     A reference to fd_set for polling read.
      * @param[inout]    aMaxFd          A reference to the current max fd in @p aReadFdSet and @p aWriteFdSet.
+     * @param[inout]    aTimeout        A reference to the timeout, shortened to the next retry if any.
      *
      */
-    virtual void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd);
+    virtual void UpdateFdSet(fd_set &aReadFdSet, fd_set &aWriteFdSet, fd_set &aErrorFdSet, int &aMaxFd,
+                             timeval &aTimeout);
 
     /**
      * This method performs the DTLS processing.
@@ -116,7 +122,7 @@ public:
     /**
      * This method retrieves the current PSKc.
      *
-     * @returns The current PSKc.
+     * @returns The current PSKc, or NULL until the ready handler is called.
      *
      */
     virtual const uint8_t *GetPSKc(void);
@@ -124,23 +130,182 @@ public:
     /**
      * This method retrieves the Eui64.
      *
-     * @returns The hardware address.
+     * @returns The hardware address, or NULL until the ready handler is called.
      *
      */
     virtual const uint8_t *GetEui64(void);
 
+    /**
+     * This method sets the handler notified once the border agent proxy is started.
+     *
+     * @param[in]   aHandler    A pointer to the function that handles the readiness.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    virtual void SetReadyHandler(ReadyHandler aHandler, void *aContext);
+
+    /**
+     * This method sets the handler notified of network data changes.
+     *
+     * @param[in]   aHandler    A pointer to the function that handles the change.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    virtual void SetNetworkDataHandler(NetworkDataHandler aHandler, void *aContext);
+
+    /**
+     * This function pointer is called when a property of byte array changed.
+     *
+     * @param[in]   aData       A pointer to the property value.
+     * @param[in]   aLength     Number of bytes of the property value.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    typedef void (*DataHandler)(const uint8_t *aData, uint16_t aLength, void *aContext);
+
+    /**
+     * This function pointer is called when a property of string changed.
+     *
+     * @param[in]   aValue      The property value.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    typedef void (*StringHandler)(const char *aValue, void *aContext);
+
+    /**
+     * This function pointer is called when a boolean property changed.
+     *
+     * @param[in]   aValue      The property value.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    typedef void (*BoolHandler)(bool aValue, void *aContext);
+
+    /**
+     * This function pointer is called when an unsigned integer property changed.
+     *
+     * @param[in]   aValue      The property value.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    typedef void (*UintHandler)(uint32_t aValue, void *aContext);
+
+    /**
+     * This method subscribes to changes of a property of this interface.
+     *
+     * The first subscription of a key installs a DBus match rule on the key, so wpantund signals of other
+     * properties are dropped by the bus daemon and never wake up the agent.
+     *
+     * @param[in]   aKey        The wpantund property key, it must outlive the subscription.
+     * @param[in]   aHandler    A pointer to the function called with the new value.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     * @returns 0 on success, otherwise failure.
+     *
+     */
+    int Subscribe(const char *aKey, DataHandler aHandler, void *aContext);
+    int Subscribe(const char *aKey, StringHandler aHandler, void *aContext);
+    int Subscribe(const char *aKey, BoolHandler aHandler, void *aContext);
+    int Subscribe(const char *aKey, UintHandler aHandler, void *aContext);
+
+    /**
+     * This method removes all subscriptions of a property made with the given context.
+     *
+     * @param[in]   aKey        The wpantund property key.
+     * @param[in]   aContext    A pointer to application-specific context.
+     *
+     */
+    void Unsubscribe(const char *aKey, void *aContext);
+
 private:
+    /**
+     * Steps of starting the border agent proxy, each one waits for a reply of wpantund.
+     *
+     */
+    enum State
+    {
+        kStateStopped,      ///< The border agent proxy is not started.
+        kStateLookingUp,    ///< Looking up the DBus name of the interface.
+        kStateGettingPSKc,  ///< The border agent proxy is enabled, retrieving the PSKc.
+        kStateGettingEui64, ///< Retrieving the EUI64.
+        kStateReady,        ///< The PSKc and EUI64 are retrieved.
+        kStateWaiting,      ///< Waiting to retry after wpantund failed to answer.
+    };
+
+    enum
+    {
+        kMinRetryDelay  = 100,   ///< Milliseconds before the first retry.
+        kMaxRetryDelay  = 10000, ///< Max milliseconds between retries.
+        kRequestTimeout = 5000,  ///< Milliseconds to wait for a reply of wpantund.
+    };
+
+    enum PropertyType
+    {
+        kPropertyTypeData,
+        kPropertyTypeString,
+        kPropertyTypeBool,
+        kPropertyTypeUint,
+    };
+
+    /**
+     * This structure represents a typed property subscription.
+     *
+     */
+    struct Subscription
+    {
+        PropertyType mType;
+        union
+        {
+            DataHandler   mData;
+            StringHandler mString;
+            BoolHandler   mBool;
+            UintHandler   mUint;
+        } mHandler;
+        void        *mContext;
+    };
+
+    /**
+     * This map dispatches property changes by hashing the property key.
+     *
+     */
+    typedef boost::unordered_multimap<std::string, Subscription> SubscriptionMap;
+
     /**
      * This map is used to track DBusWatch-es.
      *
      */
     typedef std::map<DBusWatch *, bool> WatchMap;
 
+    /**
+     * This vector tracks the controllers sharing the DBus connection.
+     *
+     */
+    typedef std::vector<ControllerWpantund *> ControllerList;
+
     static DBusHandlerResult HandleProperyChangedSignal(DBusConnection *aConnection, DBusMessage *aMessage,
                                                         void *aContext);
     DBusHandlerResult HandleProperyChangedSignal(DBusConnection &aConnection, DBusMessage &aMessage);
-    DBusMessage *RequestProperty(const char *aKey);
-    int      GetProperty(const char *aKey, uint8_t *aBuffer, size_t &aSize);
+    int Subscribe(const char *aKey, const Subscription &aSubscription);
+    int UpdateMatchRule(const char *aKey, bool aAdd);
+    void RemoveSubscriptions(void);
+    void Dispatch(const Subscription &aSubscription, const char *aKey, DBusMessageIter &aIter);
+
+    static void HandlePSKc(const uint8_t *aData, uint16_t aLength, void *aContext);
+    static void HandleProxyStream(const uint8_t *aData, uint16_t aLength, void *aContext);
+    static void HandleNcpState(const char *aValue, void *aContext);
+    static void HandleNetworkValue(uint32_t aValue, void *aContext);
+    static void HandleNetworkName(const char *aValue, void *aContext);
+    void NotifyNetworkData(void);
+
+    int RequestInterfaces(void);
+    int RequestProperty(const char *aKey);
+    int SendRequest(DBusMessage *aMessage);
+    static void HandleReply(DBusPendingCall *aPending, void *aContext);
+    void HandleReply(DBusMessage &aReply);
+    int HandleInterfaces(DBusMessage &aReply);
+    int HandleProperty(DBusMessage &aReply, uint8_t *aBuffer, size_t aSize);
+    void Retry(void);
+    void CancelRequest(void);
 
     static dbus_bool_t AddDBusWatch(struct DBusWatch *aWatch, void *aContext);
     static void RemoveDBusWatch(struct DBusWatch *aWatch, void *aContext);
@@ -148,16 +313,45 @@ private:
 
     int BorderAgentProxyEnable(dbus_bool_t aEnable);
 
+    static void HandleProxySendReply(DBusPendingCall *aPending, void *aSentTime);
+    static void FreeSentTime(void *aSentTime);
+
+    static DBusConnection *ConnectDBus(DBusError &aError);
+    static void DisconnectDBus(void);
+
+    /**
+     * This method indicates whether this controller polls the shared DBus connection.
+     *
+     * The first controller still alive polls and dispatches for all of them, so the connection is serviced once per
+     * loop however many interfaces are served.
+     *
+     */
+    bool IsDBusOwner(void) const { return !sControllers.empty() && sControllers.front() == this; }
+
+    static DBusConnection *sDBus;
+    static WatchMap        sWatches;
+    static ControllerList  sControllers;
+
     char            mInterfaceDBusName[DBUS_MAXIMUM_NAME_LENGTH + 1];
     char            mInterfaceDBusPath[DBUS_MAXIMUM_NAME_LENGTH + 1];
     uint8_t         mPSKc[kSizePSKc];
     uint8_t         mEui64[kSizeEui64];
+    State           mState;
+    bool            mHasCredentials;
+    uint64_t        mRetryTime;
+    uint32_t        mRetryDelay;
     char            mInterfaceName[IFNAMSIZ];
     DBusConnection *mDBus;
     PacketHandler   mPacketHandler;
     PSKcHandler     mPSKcHandler;
     void           *mContext;
-    WatchMap        mWatches;
+    SubscriptionMap mSubscriptions;
+
+    NetworkDataHandler mNetworkDataHandler;
+    void              *mNetworkDataContext;
+    ReadyHandler       mReadyHandler;
+    void              *mReadyContext;
+    DBusPendingCall   *mPending;
 };
 
 } // Ncp
@@ -0,0 +1,264 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements recording and replaying border agent traffic.
+ */
+
+#include "trace.hpp"
+
+#include <fcntl.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+
+#include "common/code_utils.hpp"
+#include "common/time.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+static const uint8_t kTraceMagic[] = { 'O', 'T', 'B', 'R', 'T', 'R', 'C', '1' };
+
+enum
+{
+    kRecordHeaderLength = 7, ///< Length, type and delay.
+    kMaxFieldsLength    = 4, ///< Locator and port of a proxy stream frame.
+};
+
+TraceWriter::TraceWriter(void) :
+    mFile(NULL),
+    mLastTime(0)
+{
+}
+
+TraceWriter::~TraceWriter(void)
+{
+    if (mFile != NULL)
+    {
+        fclose(mFile);
+    }
+}
+
+int TraceWriter::Open(const char *aPath)
+{
+    int ret = 0;
+    int fd;
+
+    // The trace holds the PSKc and the decrypted commissioner payloads, only the owner may read it, even if an older
+    // trace with a wider mode is overwritten.
+    VerifyOrExit((fd = open(aPath, O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, S_IRUSR | S_IWUSR)) >= 0, ret = -1);
+
+    if (fchmod(fd, S_IRUSR | S_IWUSR) != 0 || (mFile = fdopen(fd, "wb")) == NULL)
+    {
+        close(fd);
+        ExitNow(ret = -1);
+    }
+
+    VerifyOrExit(fwrite(kTraceMagic, sizeof(kTraceMagic), 1, mFile) == 1, ret = -1);
+    mLastTime = GetMonotonicMicros();
+
+exit:
+    if (ret)
+    {
+        syslog(LOG_ERR, "failed to create trace %s", aPath);
+
+        if (mFile != NULL)
+        {
+            fclose(mFile);
+            mFile = NULL;
+        }
+    }
+
+    return ret;
+}
+
+void TraceWriter::Write(TraceType aType, const uint8_t *aFields, uint16_t aFieldsLength, const uint8_t *aData,
+                        uint16_t aLength)
+{
+    uint8_t  header[kRecordHeaderLength + kMaxFieldsLength];
+    uint64_t now = GetMonotonicMicros();
+    uint64_t delay = now - mLastTime;
+    uint32_t length = kRecordHeaderLength - sizeof(uint16_t) + aFieldsLength + aLength;
+
+    VerifyOrExit(mFile != NULL);
+    VerifyOrExit(length <= 0xffff, syslog(LOG_WARNING, "trace record too long"));
+
+    if (delay > 0xffffffff)
+    {
+        delay = 0xffffffff;
+    }
+
+    header[0] = static_cast<uint8_t>(length >> 8);
+    header[1] = static_cast<uint8_t>(length & 0xff);
+    header[2] = static_cast<uint8_t>(aType);
+    header[3] = static_cast<uint8_t>(delay >> 24);
+    header[4] = static_cast<uint8_t>(delay >> 16);
+    header[5] = static_cast<uint8_t>(delay >> 8);
+    header[6] = static_cast<uint8_t>(delay & 0xff);
+    memcpy(header + kRecordHeaderLength, aFields, aFieldsLength);
+
+    mLastTime = now;
+
+    // Records are flushed one by one so a trace survives the agent being killed.
+    if (fwrite(header, kRecordHeaderLength + aFieldsLength, 1, mFile) != 1 ||
+        (aLength > 0 && fwrite(aData, aLength, 1, mFile) != 1) ||
+        fflush(mFile) != 0)
+    {
+        syslog(LOG_ERR, "failed to write trace, recording stopped");
+        fclose(mFile);
+        mFile = NULL;
+    }
+
+exit:
+    return;
+}
+
+void TraceWriter::WriteProxyStream(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort)
+{
+    uint8_t fields[kMaxFieldsLength];
+
+    fields[0] = static_cast<uint8_t>(aLocator >> 8);
+    fields[1] = static_cast<uint8_t>(aLocator & 0xff);
+    fields[2] = static_cast<uint8_t>(aPort >> 8);
+    fields[3] = static_cast<uint8_t>(aPort & 0xff);
+
+    Write(kTraceProxyStream, fields, sizeof(fields), aBuffer, aLength);
+}
+
+void TraceWriter::WriteDtlsPayload(const uint8_t *aBuffer, uint16_t aLength)
+{
+    Write(kTraceDtlsPayload, NULL, 0, aBuffer, aLength);
+}
+
+void TraceWriter::WriteDtlsState(uint8_t aState)
+{
+    Write(kTraceDtlsState, &aState, sizeof(aState), NULL, 0);
+}
+
+void TraceWriter::WritePSKc(const uint8_t *aPSKc, uint16_t aLength)
+{
+    Write(kTracePSKc, NULL, 0, aPSKc, aLength);
+}
+
+void TraceWriter::WriteNetworkData(void)
+{
+    Write(kTraceNetworkData, NULL, 0, NULL, 0);
+}
+
+TraceReader::TraceReader(void) :
+    mFile(NULL)
+{
+}
+
+TraceReader::~TraceReader(void)
+{
+    if (mFile != NULL)
+    {
+        fclose(mFile);
+    }
+}
+
+int TraceReader::Open(const char *aPath)
+{
+    int     ret = 0;
+    uint8_t magic[sizeof(kTraceMagic)];
+
+    VerifyOrExit((mFile = fopen(aPath, "rb")) != NULL, ret = -1);
+    VerifyOrExit(fread(magic, sizeof(magic), 1, mFile) == 1 && !memcmp(magic, kTraceMagic, sizeof(magic)),
+                 ret = -1);
+
+exit:
+    if (ret && mFile != NULL)
+    {
+        fclose(mFile);
+        mFile = NULL;
+    }
+
+    return ret;
+}
+
+int TraceReader::Read(TraceRecord &aRecord)
+{
+    int      ret = 1;
+    uint8_t  header[kRecordHeaderLength];
+    uint16_t length;
+    uint16_t fieldsLength = 0;
+
+    VerifyOrExit(mFile != NULL, ret = -1);
+    VerifyOrExit(fread(header, sizeof(header), 1, mFile) == 1, ret = (feof(mFile) ? 0 : -1));
+
+    length = static_cast<uint16_t>(header[0] << 8 | header[1]);
+    VerifyOrExit(length >= kRecordHeaderLength - sizeof(uint16_t), ret = -1);
+    length -= kRecordHeaderLength - sizeof(uint16_t);
+    VerifyOrExit(length == 0 || fread(mBuffer, length, 1, mFile) == 1, ret = -1);
+
+    memset(&aRecord, 0, sizeof(aRecord));
+    aRecord.mType = static_cast<TraceType>(header[2]);
+    aRecord.mDelay = static_cast<uint32_t>(header[3]) << 24 | static_cast<uint32_t>(header[4]) << 16 |
+                     static_cast<uint32_t>(header[5]) << 8 | header[6];
+
+    switch (aRecord.mType)
+    {
+    case kTraceProxyStream:
+        fieldsLength = 4;
+        VerifyOrExit(length >= fieldsLength, ret = -1);
+        aRecord.mLocator = static_cast<uint16_t>(mBuffer[0] << 8 | mBuffer[1]);
+        aRecord.mPort = static_cast<uint16_t>(mBuffer[2] << 8 | mBuffer[3]);
+        break;
+
+    case kTraceDtlsState:
+        fieldsLength = 1;
+        VerifyOrExit(length >= fieldsLength, ret = -1);
+        aRecord.mState = mBuffer[0];
+        break;
+
+    case kTraceDtlsPayload:
+    case kTracePSKc:
+    case kTraceNetworkData:
+        break;
+
+    default:
+        // Unknown records are passed on with their raw content.
+        break;
+    }
+
+    aRecord.mData = mBuffer + fieldsLength;
+    aRecord.mLength = length - fieldsLength;
+
+exit:
+    return ret;
+}
+
+} // namespace BorderRouter
+
+} // namespace ot
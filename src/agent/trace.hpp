@@ -0,0 +1,195 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for recording and replaying border agent traffic.
+ */
+
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace ot {
+
+namespace BorderRouter {
+
+/**
+ * @addtogroup border-agent-trace
+ *
+ * @brief
+ *   This module includes definitions for the binary trace of inbound border agent events.
+ *
+ *   A trace starts with an 8-byte magic followed by records. Every record is
+ *
+ *       | length (2) | type (1) | delay (4) | fields and data (length - 5) |
+ *
+ *   in network byte order, where delay is the number of microseconds since the previous record.
+ *
+ * @{
+ */
+
+/**
+ * Trace record types.
+ *
+ */
+enum TraceType
+{
+    kTraceProxyStream = 1, ///< A frame received from the border agent proxy, with locator and port.
+    kTraceDtlsPayload = 2, ///< A decrypted payload received on the DTLS session.
+    kTraceDtlsState   = 3, ///< The DTLS session state changed.
+    kTracePSKc        = 4, ///< The PSKc is retrieved or changed.
+    kTraceNetworkData = 5, ///< The network data or the active dataset changed.
+};
+
+/**
+ * This structure represents a trace record.
+ *
+ */
+struct TraceRecord
+{
+    TraceType      mType;    ///< The record type.
+    uint32_t       mDelay;   ///< Microseconds since the previous record.
+    uint16_t       mLocator; ///< Source locator of a proxy stream frame.
+    uint16_t       mPort;    ///< Source port of a proxy stream frame.
+    uint8_t        mState;   ///< The new DTLS session state.
+    const uint8_t *mData;    ///< The frame, payload or PSKc.
+    uint16_t       mLength;  ///< Number of bytes of @p mData.
+};
+
+/**
+ * This class writes inbound border agent events to a trace file.
+ *
+ */
+class TraceWriter
+{
+public:
+    TraceWriter(void);
+    ~TraceWriter(void);
+
+    /**
+     * This method creates the trace file.
+     *
+     * @param[in]   aPath   The path of the trace file.
+     *
+     * @returns 0 on success, otherwise failure.
+     *
+     */
+    int Open(const char *aPath);
+
+    /**
+     * This method writes a proxy stream frame.
+     *
+     */
+    void WriteProxyStream(const uint8_t *aBuffer, uint16_t aLength, uint16_t aLocator, uint16_t aPort);
+
+    /**
+     * This method writes a decrypted DTLS payload.
+     *
+     */
+    void WriteDtlsPayload(const uint8_t *aBuffer, uint16_t aLength);
+
+    /**
+     * This method writes a DTLS session state change.
+     *
+     */
+    void WriteDtlsState(uint8_t aState);
+
+    /**
+     * This method writes the PSKc.
+     *
+     */
+    void WritePSKc(const uint8_t *aPSKc, uint16_t aLength);
+
+    /**
+     * This method writes a network data change.
+     *
+     */
+    void WriteNetworkData(void);
+
+private:
+    void Write(TraceType aType, const uint8_t *aFields, uint16_t aFieldsLength, const uint8_t *aData,
+               uint16_t aLength);
+
+    FILE     *mFile;
+    uint64_t  mLastTime;
+};
+
+/**
+ * This class reads records from a trace file.
+ *
+ */
+class TraceReader
+{
+public:
+    TraceReader(void);
+    ~TraceReader(void);
+
+    /**
+     * This method opens a trace file.
+     *
+     * @param[in]   aPath   The path of the trace file.
+     *
+     * @returns 0 on success, otherwise failure.
+     *
+     */
+    int Open(const char *aPath);
+
+    /**
+     * This method reads the next record.
+     *
+     * The data of the record stays valid until the next call.
+     *
+     * @param[out]  aRecord     A reference to the record.
+     *
+     * @returns 1 if a record is read, 0 at the end of the trace, otherwise the trace is corrupted.
+     *
+     */
+    int Read(TraceRecord &aRecord);
+
+private:
+    enum
+    {
+        kMaxRecordLength = 0xffff, ///< Max length of a record.
+    };
+
+    FILE    *mFile;
+    uint8_t  mBuffer[kMaxRecordLength];
+};
+
+/**
+ * @}
+ */
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+#endif  // TRACE_HPP_
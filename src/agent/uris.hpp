@@ -109,6 +109,38 @@
  */
 #define OPENTHREAD_URI_COMMISSIONER_SET       "c/cs"
 
+/**
+ * @def OPENTHREAD_URI_ACTIVE_GET
+ *
+ * The URI Path for MGMT_ACTIVE_GET
+ *
+ */
+#define OPENTHREAD_URI_ACTIVE_GET             "c/ag"
+
+/**
+ * @def OPENTHREAD_URI_ACTIVE_SET
+ *
+ * The URI Path for MGMT_ACTIVE_SET
+ *
+ */
+#define OPENTHREAD_URI_ACTIVE_SET             "c/as"
+
+/**
+ * @def OPENTHREAD_URI_PENDING_GET
+ *
+ * The URI Path for MGMT_PENDING_GET
+ *
+ */
+#define OPENTHREAD_URI_PENDING_GET            "c/pg"
+
+/**
+ * @def OPENTHREAD_URI_PENDING_SET
+ *
+ * The URI Path for MGMT_PENDING_SET
+ *
+ */
+#define OPENTHREAD_URI_PENDING_SET            "c/ps"
+
 /**
  * @def OPENTHREAD_URI_COMMISSIONER_PET
  *
@@ -0,0 +1,193 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the metrics registry of the border router.
+ */
+
+#include "metrics.hpp"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace ot {
+
+namespace Metrics {
+
+Metric *Metric::sHead = NULL;
+
+Metric::Metric(const char *aName, const char *aHelp, const char *aType) :
+    mName(aName),
+    mHelp(aHelp),
+    mType(aType),
+    mNext(sHead)
+{
+    sHead = this;
+}
+
+Metric::~Metric(void)
+{
+    for (Metric **metric = &sHead; *metric != NULL; metric = &(*metric)->mNext)
+    {
+        if (*metric == this)
+        {
+            *metric = mNext;
+            break;
+        }
+    }
+}
+
+void Metric::Format(std::string &aOutput) const
+{
+    aOutput.append("# HELP ").append(mName).append(" ").append(mHelp).append("\n");
+    aOutput.append("# TYPE ").append(mName).append(" ").append(mType).append("\n");
+    FormatSamples(aOutput);
+}
+
+void Metric::FormatAll(std::string &aOutput)
+{
+    for (const Metric *metric = sHead; metric != NULL; metric = metric->mNext)
+    {
+        metric->Format(aOutput);
+    }
+}
+
+Counter::Counter(const char *aName, const char *aHelp) :
+    Metric(aName, aHelp, "counter"),
+    mValue(0)
+{
+}
+
+void Counter::FormatSamples(std::string &aOutput) const
+{
+    char line[128];
+
+    snprintf(line, sizeof(line), "%s %" PRIu64 "\n", GetName(), Get());
+    aOutput.append(line);
+}
+
+Gauge::Gauge(const char *aName, const char *aHelp) :
+    Metric(aName, aHelp, "gauge"),
+    mValue(0)
+{
+}
+
+void Gauge::FormatSamples(std::string &aOutput) const
+{
+    char line[128];
+
+    snprintf(line, sizeof(line), "%s %" PRId64 "\n", GetName(), Get());
+    aOutput.append(line);
+}
+
+Histogram::Histogram(const char *aName, const char *aHelp) :
+    Metric(aName, aHelp, "histogram"),
+    mCount(0),
+    mSum(0)
+{
+    memset(mBuckets, 0, sizeof(mBuckets));
+}
+
+int Histogram::GetBucketIndex(uint64_t aMicroseconds)
+{
+    int exponent;
+
+    if (aMicroseconds < kSubBucketCount)
+    {
+        return static_cast<int>(aMicroseconds);
+    }
+
+    if (aMicroseconds >= (1ULL << kMaxExponent))
+    {
+        return kBucketCount;
+    }
+
+    exponent = 63 - __builtin_clzll(aMicroseconds);
+
+    return (exponent - kSubBucketBits + 1) * kSubBucketCount +
+           static_cast<int>((aMicroseconds >> (exponent - kSubBucketBits)) & (kSubBucketCount - 1));
+}
+
+uint64_t Histogram::GetBucketUpperBound(int aIndex)
+{
+    int exponent;
+    int subBucket;
+
+    if (aIndex < kSubBucketCount)
+    {
+        return static_cast<uint64_t>(aIndex);
+    }
+
+    exponent = aIndex / kSubBucketCount + kSubBucketBits - 1;
+    subBucket = aIndex % kSubBucketCount;
+
+    return (static_cast<uint64_t>(kSubBucketCount + subBucket + 1) << (exponent - kSubBucketBits)) - 1;
+}
+
+void Histogram::Record(uint64_t aMicroseconds)
+{
+    int index = GetBucketIndex(aMicroseconds);
+
+    if (index < kBucketCount)
+    {
+        __atomic_fetch_add(&mBuckets[index], 1, __ATOMIC_RELAXED);
+    }
+
+    __atomic_fetch_add(&mSum, aMicroseconds, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&mCount, 1, __ATOMIC_RELAXED);
+}
+
+void Histogram::FormatSamples(std::string &aOutput) const
+{
+    char     line[160];
+    uint64_t cumulative = 0;
+    uint64_t sum = __atomic_load_n(&mSum, __ATOMIC_RELAXED);
+
+    for (int i = 0; i < kBucketCount; i++)
+    {
+        uint64_t bound = GetBucketUpperBound(i);
+
+        cumulative += GetBucket(i);
+        snprintf(line, sizeof(line), "%s_bucket{le=\"%" PRIu64 ".%06" PRIu64 "\"} %" PRIu64 "\n", GetName(),
+                 bound / 1000000, bound % 1000000, cumulative);
+        aOutput.append(line);
+    }
+
+    snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %" PRIu64 "\n", GetName(), GetCount());
+    aOutput.append(line);
+    snprintf(line, sizeof(line), "%s_sum %" PRIu64 ".%06" PRIu64 "\n", GetName(), sum / 1000000, sum % 1000000);
+    aOutput.append(line);
+    snprintf(line, sizeof(line), "%s_count %" PRIu64 "\n", GetName(), GetCount());
+    aOutput.append(line);
+}
+
+} // namespace Metrics
+
+} // namespace ot
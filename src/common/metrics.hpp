@@ -0,0 +1,267 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for the metrics registry of the border router.
+ */
+
+#ifndef METRICS_HPP_
+#define METRICS_HPP_
+
+#include <string>
+
+#include <stdint.h>
+
+namespace ot {
+
+namespace Metrics {
+
+/**
+ * This class is the base of all metrics.
+ *
+ * A metric registers itself on construction and is meant to have static storage duration. Registration is not
+ * thread-safe, updating a registered metric is lock-free.
+ *
+ */
+class Metric
+{
+public:
+    /**
+     * This method returns the name of this metric.
+     *
+     * @returns The metric name.
+     *
+     */
+    const char *GetName(void) const { return mName; }
+
+    /**
+     * This method appends this metric in Prometheus text format.
+     *
+     * @param[inout]    aOutput     A reference to the output string.
+     *
+     */
+    void Format(std::string &aOutput) const;
+
+    /**
+     * This function appends all registered metrics in Prometheus text format.
+     *
+     * @param[inout]    aOutput     A reference to the output string.
+     *
+     */
+    static void FormatAll(std::string &aOutput);
+
+protected:
+    Metric(const char *aName, const char *aHelp, const char *aType);
+    virtual ~Metric(void);
+
+    virtual void FormatSamples(std::string &aOutput) const = 0;
+
+private:
+    Metric(const Metric &);
+    Metric &operator=(const Metric &);
+
+    const char *mName;
+    const char *mHelp;
+    const char *mType;
+    Metric     *mNext;
+
+    static Metric *sHead;
+};
+
+/**
+ * This class implements a monotonically increasing counter.
+ *
+ */
+class Counter : public Metric
+{
+public:
+    /**
+     * The constructor to initialize a counter.
+     *
+     * @param[in]   aName   The metric name, it should end with `_total`.
+     * @param[in]   aHelp   The help text of this metric.
+     *
+     */
+    Counter(const char *aName, const char *aHelp);
+
+    /**
+     * This method increases the counter.
+     *
+     * @param[in]   aValue  The value to add.
+     *
+     */
+    void Increment(uint64_t aValue = 1) { __atomic_fetch_add(&mValue, aValue, __ATOMIC_RELAXED); }
+
+    /**
+     * This method returns the current value of the counter.
+     *
+     * @returns The counter value.
+     *
+     */
+    uint64_t Get(void) const { return __atomic_load_n(&mValue, __ATOMIC_RELAXED); }
+
+private:
+    void FormatSamples(std::string &aOutput) const;
+
+    uint64_t mValue;
+};
+
+/**
+ * This class implements a gauge which may go up and down.
+ *
+ */
+class Gauge : public Metric
+{
+public:
+    /**
+     * The constructor to initialize a gauge.
+     *
+     * @param[in]   aName   The metric name.
+     * @param[in]   aHelp   The help text of this metric.
+     *
+     */
+    Gauge(const char *aName, const char *aHelp);
+
+    /**
+     * This method adds a delta to the gauge.
+     *
+     * @param[in]   aDelta  The value to add, may be negative.
+     *
+     */
+    void Add(int64_t aDelta) { __atomic_fetch_add(&mValue, aDelta, __ATOMIC_RELAXED); }
+
+    /**
+     * This method sets the gauge.
+     *
+     * @param[in]   aValue  The new value.
+     *
+     */
+    void Set(int64_t aValue) { __atomic_store_n(&mValue, aValue, __ATOMIC_RELAXED); }
+
+    /**
+     * This method returns the current value of the gauge.
+     *
+     * @returns The gauge value.
+     *
+     */
+    int64_t Get(void) const { return __atomic_load_n(&mValue, __ATOMIC_RELAXED); }
+
+private:
+    void FormatSamples(std::string &aOutput) const;
+
+    int64_t mValue;
+};
+
+/**
+ * This class implements a log-linear latency histogram.
+ *
+ * Durations are recorded in microseconds. Every power of two is split into four linear buckets, which keeps the
+ * relative error under 25% from one microsecond up to about a minute. Longer durations only count in `+Inf`.
+ * Durations are exported in seconds.
+ *
+ */
+class Histogram : public Metric
+{
+public:
+    enum
+    {
+        kSubBucketBits  = 2,                                                      ///< Bits of linear sub-buckets.
+        kSubBucketCount = 1 << kSubBucketBits,                                    ///< Linear buckets per octave.
+        kMaxExponent    = 26,                                                     ///< Durations below 2^26 us.
+        kBucketCount    = (kMaxExponent - kSubBucketBits + 1) * kSubBucketCount, ///< Number of finite buckets.
+    };
+
+    /**
+     * The constructor to initialize a histogram.
+     *
+     * @param[in]   aName   The metric name, it should end with `_seconds`.
+     * @param[in]   aHelp   The help text of this metric.
+     *
+     */
+    Histogram(const char *aName, const char *aHelp);
+
+    /**
+     * This method records a duration.
+     *
+     * @param[in]   aMicroseconds   The duration in microseconds.
+     *
+     */
+    void Record(uint64_t aMicroseconds);
+
+    /**
+     * This method returns the number of recorded durations.
+     *
+     * @returns The number of durations.
+     *
+     */
+    uint64_t GetCount(void) const { return __atomic_load_n(&mCount, __ATOMIC_RELAXED); }
+
+    /**
+     * This method returns the number of durations in a bucket.
+     *
+     * @param[in]   aIndex  The index of the bucket.
+     *
+     * @returns The number of durations.
+     *
+     */
+    uint64_t GetBucket(int aIndex) const { return __atomic_load_n(&mBuckets[aIndex], __ATOMIC_RELAXED); }
+
+    /**
+     * This function returns the bucket index of a duration.
+     *
+     * @param[in]   aMicroseconds   The duration in microseconds.
+     *
+     * @returns The bucket index, or kBucketCount if the duration is out of range.
+     *
+     */
+    static int GetBucketIndex(uint64_t aMicroseconds);
+
+    /**
+     * This function returns the inclusive upper bound of a bucket.
+     *
+     * @param[in]   aIndex  The index of the bucket.
+     *
+     * @returns The upper bound in microseconds.
+     *
+     */
+    static uint64_t GetBucketUpperBound(int aIndex);
+
+private:
+    void FormatSamples(std::string &aOutput) const;
+
+    uint64_t mBuckets[kBucketCount];
+    uint64_t mCount;
+    uint64_t mSum;
+};
+
+} // namespace Metrics
+
+} // namespace ot
+
+#endif // METRICS_HPP_
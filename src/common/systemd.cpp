@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the socket activation and notification protocols of systemd.
+ */
+
+#include "systemd.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <vector>
+
+#include "common/code_utils.hpp"
+
+namespace ot {
+
+namespace Systemd {
+
+enum
+{
+    kListenFdsStart = 3,  ///< The first socket passed by the service manager.
+    kMaxListenFds   = 64, ///< Max number of passed sockets looked at.
+};
+
+static bool              sListenFdsParsed = false;
+static std::vector<bool> sListenFds; ///< Whether each passed socket is still available.
+
+static void ParseListenFds(void)
+{
+    const char *pid = getenv("LISTEN_PID");
+    const char *fds = getenv("LISTEN_FDS");
+
+    VerifyOrExit(!sListenFdsParsed);
+    sListenFdsParsed = true;
+
+    // The sockets are only meant for the process the service manager started, not for one it forked.
+    if (pid != NULL && fds != NULL && strtoul(pid, NULL, 10) == static_cast<unsigned long>(getpid()))
+    {
+        unsigned long count = strtoul(fds, NULL, 10);
+
+        if (count > kMaxListenFds)
+        {
+            count = kMaxListenFds;
+        }
+
+        sListenFds.assign(count, true);
+    }
+
+    unsetenv("LISTEN_PID");
+    unsetenv("LISTEN_FDS");
+    unsetenv("LISTEN_FDNAMES");
+
+exit:
+    return;
+}
+
+static int GetLocalPort(int aFd)
+{
+    int              port = -1;
+    sockaddr_storage addr;
+    socklen_t        length = sizeof(addr);
+
+    VerifyOrExit(getsockname(aFd, reinterpret_cast<sockaddr *>(&addr), &length) == 0);
+
+    if (addr.ss_family == AF_INET6)
+    {
+        port = ntohs(reinterpret_cast<const sockaddr_in6 *>(&addr)->sin6_port);
+    }
+    else if (addr.ss_family == AF_INET)
+    {
+        port = ntohs(reinterpret_cast<const sockaddr_in *>(&addr)->sin_port);
+    }
+
+exit:
+    return port;
+}
+
+int TakeListenSocket(int aType, uint16_t aPort)
+{
+    int fd = -1;
+
+    ParseListenFds();
+
+    for (size_t i = 0; i < sListenFds.size(); i++)
+    {
+        int       candidate = kListenFdsStart + static_cast<int>(i);
+        int       type;
+        socklen_t length = sizeof(type);
+
+        if (!sListenFds[i] ||
+            getsockopt(candidate, SOL_SOCKET, SO_TYPE, &type, &length) != 0 || type != aType ||
+            GetLocalPort(candidate) != aPort)
+        {
+            continue;
+        }
+
+        // Passed sockets are inherited without close-on-exec.
+        fcntl(candidate, F_SETFD, FD_CLOEXEC);
+        sListenFds[i] = false;
+        fd = candidate;
+        break;
+    }
+
+    return fd;
+}
+
+int Notify(const char *aState)
+{
+    int         ret = 0;
+    int         fd = -1;
+    const char *path = getenv("NOTIFY_SOCKET");
+    size_t      length;
+    sockaddr_un addr;
+
+    VerifyOrExit(path != NULL && (path[0] == '/' || path[0] == '@'));
+
+    length = strlen(path);
+    VerifyOrExit(length < sizeof(addr.sun_path), ret = -1, errno = ENAMETOOLONG);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, length);
+
+    // A leading '@' stands for a socket in the abstract namespace.
+    if (addr.sun_path[0] == '@')
+    {
+        addr.sun_path[0] = '\0';
+    }
+
+    VerifyOrExit((fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0)) >= 0, ret = -1);
+    VerifyOrExit(sendto(fd, aState, strlen(aState), MSG_NOSIGNAL, reinterpret_cast<sockaddr *>(&addr),
+                        static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + length)) >= 0, ret = -1);
+
+exit:
+    if (ret)
+    {
+        syslog(LOG_WARNING, "failed to notify the service manager: %s", strerror(errno));
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    return ret;
+}
+
+} // namespace Systemd
+
+} // namespace ot
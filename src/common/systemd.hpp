@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions for running under systemd without linking libsystemd.
+ */
+
+#ifndef SYSTEMD_HPP_
+#define SYSTEMD_HPP_
+
+#include <stdint.h>
+
+namespace ot {
+
+namespace Systemd {
+
+/**
+ * This function takes a listening socket passed by the service manager through the `LISTEN_FDS` protocol.
+ *
+ * Sockets are matched by type and local port, so the order of the listen directives in the socket unit does not
+ * matter. The environment describing the sockets is removed on first use so child processes do not inherit it.
+ *
+ * @param[in]   aType   The socket type, SOCK_DGRAM or SOCK_STREAM.
+ * @param[in]   aPort   The local port of the socket.
+ *
+ * @returns The socket, owned by the caller from now on, or -1 if no such socket was passed.
+ *
+ */
+int TakeListenSocket(int aType, uint16_t aPort);
+
+/**
+ * This function notifies the service manager of a state change, such as `READY=1` or `STOPPING=1`.
+ *
+ * @param[in]   aState  A pointer to the newline separated assignments to send.
+ *
+ * @returns 0 on success or if the process is not started by a service manager expecting notifications,
+ *          otherwise failure.
+ *
+ */
+int Notify(const char *aState);
+
+} // namespace Systemd
+
+} // namespace ot
+
+#endif // SYSTEMD_HPP_
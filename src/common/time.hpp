@@ -32,6 +32,7 @@
 #include <stdint.h>
 
 #include <sys/time.h>
+#include <time.h>
 
 /**
  * This method returns the current timestamp in miniseconds.
@@ -46,4 +47,17 @@ inline uint64_t GetNow(void) {
     return now.tv_sec * 1000 + now.tv_usec / 1000;
 }
 
+/**
+ * This method returns a monotonic timestamp in microseconds, for measuring durations.
+ *
+ * @returns Current monotonic timestamp in microseconds.
+ *
+ */
+inline uint64_t GetMonotonicMicros(void) {
+    timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec) / 1000;
+}
+
 #endif // TIME_HPP_
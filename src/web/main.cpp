@@ -30,14 +30,11 @@
  * @file
  *   This file is the entry of the program, it starts a Web service.
  */
-#ifndef OT_WEB_FILE_PATH
-#define OT_WEB_FILE_PATH "/usr/local/share/border-router/frontend"
-#endif
-
 #include "otbr-config.h"
 
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <syslog.h>
 #include <unistd.h>
 
@@ -55,26 +52,51 @@ void PrintVersion(void)
 int main(int argc, char **argv)
 {
     const char *interfaceName = NULL;
+    const char *webRoot = NULL;
     int         ret = 0;
     int         opt;
+    unsigned    scanInterval = OT_SCAN_DEFAULT_INTERVAL;
+    unsigned    threadCount = OT_WEB_DEFAULT_THREADS;
+    unsigned    workerCount = OT_WEB_DEFAULT_WORKERS;
+    unsigned    idleTimeout = 0;
 
     ot::Web::WebServer *server = NULL;
 
-    while ((opt = getopt(argc, argv, "vI:")) != -1)
+    while ((opt = getopt(argc, argv, "vd:i:I:s:t:w:")) != -1)
     {
         switch (opt)
         {
+        case 'd':
+            webRoot = optarg;
+            break;
+
+        case 'i':
+            idleTimeout = static_cast<unsigned>(strtoul(optarg, NULL, 0));
+            break;
+
         case 'I':
             interfaceName = optarg;
             break;
 
+        case 's':
+            scanInterval = static_cast<unsigned>(strtoul(optarg, NULL, 0));
+            break;
+
+        case 't':
+            threadCount = static_cast<unsigned>(strtoul(optarg, NULL, 0));
+            break;
+
+        case 'w':
+            workerCount = static_cast<unsigned>(strtoul(optarg, NULL, 0));
+            break;
+
         case 'v':
             PrintVersion();
             ExitNow();
             break;
 
         default:
-            fprintf(stderr, "Usage: %s [-I interfaceName] [-v]\n", argv[0]);
+            fprintf(stderr, "Usage: %s [-I interfaceName] [-s scanInterval] [-d webRoot] [-t threads] [-w workers] [-i idleTimeout] [-v]\n", argv[0]);
             ExitNow(ret = -1);
             break;
         }
@@ -89,6 +111,10 @@ int main(int argc, char **argv)
     openlog(kSyslogIdent, LOG_CONS | LOG_PID, LOG_USER);
     syslog(LOG_INFO, "border router web started on %s", interfaceName);
     server = new ot::Web::WebServer();
+    server->SetScanInterval(scanInterval);
+    server->SetWebRoot(webRoot);
+    server->SetThreadCount(threadCount, workerCount);
+    server->SetIdleTimeout(idleTimeout);
     server->StartWebServer(interfaceName);
 
     closelog();
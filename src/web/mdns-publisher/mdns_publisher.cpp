@@ -35,9 +35,6 @@
 
 #include "common/code_utils.hpp"
 
-#define OT_HOST_NAME "OPENTHREAD"
-#define OT_PERIODICAL_TIME 1000 * 7
-
 namespace ot {
 namespace Mdns {
 
@@ -53,13 +50,6 @@ enum
     kMdnsPublisher_FailedCreateClient,
 };
 
-void Publisher::HandleServicePublish(AVAHI_GCC_UNUSED AvahiTimeout *aTimeout, AVAHI_GCC_UNUSED void *aUserData)
-{
-    Publisher *publisher = static_cast<Publisher *>(aUserData);
-
-    publisher->HandleServicePublish(aTimeout);
-}
-
 void Publisher::HandleClientStart(AvahiClient *aClient, AvahiClientState aState,
                                   AVAHI_GCC_UNUSED void *aUserData)
 {
@@ -78,6 +68,12 @@ void Publisher::HandleEntryGroupStart(AvahiEntryGroup *aGroup, AvahiEntryGroupSt
 
 void Publisher::Free(void)
 {
+    if (mClientGroup != NULL)
+    {
+        avahi_entry_group_free(mClientGroup);
+        mClientGroup = NULL;
+    }
+
     if (mClient != NULL)
     {
         avahi_client_free(mClient);
@@ -90,35 +86,28 @@ void Publisher::Free(void)
         mSimplePoll = NULL;
     }
 
-    if (mServiceName != NULL)
-    {
-        avahi_free(mServiceName);
-        mServiceName = NULL;
-    }
-
-    if (mClientGroup != NULL)
-    {
-        avahi_entry_group_free(mClientGroup);
-        mClientGroup = NULL;
-    }
+    mIsPublished = false;
 }
 
 Publisher::Publisher(void) :
     mClientGroup(NULL),
     mSimplePoll(NULL),
     mClient(NULL),
-    mPort(0),
-    mServiceName(NULL),
-    mNetworkNameTxt(NULL),
-    mExtPanIdTxt(NULL),
-    mType(NULL)
+    mHasPendingService(false),
+    mIsStopping(false),
+    mHasService(false),
+    mIsPublished(false)
 {
 }
 
+Publisher::~Publisher(void)
+{
+    Stop();
+}
+
 int Publisher::CreateService(AvahiClient *aClient)
 {
-    char *serviceName;
-    int   ret = kMdnsPublisher_OK;
+    int ret = kMdnsPublisher_OK;
 
     assert(aClient);
 
@@ -128,71 +117,125 @@ int Publisher::CreateService(AvahiClient *aClient)
         VerifyOrExit(mClientGroup != NULL, ret = kMdnsPublisher_FailedCreateGoup);
     }
 
-    if (avahi_entry_group_is_empty(mClientGroup))
+    avahi_entry_group_reset(mClientGroup);
+    mIsPublished = false;
+
+    syslog(LOG_INFO, "Adding service '%s'", mServiceName.c_str());
+
+    ret = avahi_entry_group_add_service(mClientGroup, AVAHI_IF_UNSPEC,
+                                        AVAHI_PROTO_UNSPEC, static_cast<AvahiPublishFlags>(0),
+                                        mServiceName.c_str(), mService.mType.c_str(), NULL, NULL, mService.mPort,
+                                        mService.mNetworkNameTxt.c_str(), mService.mExtPanIdTxt.c_str(), NULL);
+    if (ret == AVAHI_ERR_COLLISION)
     {
-        syslog(LOG_ERR, "Adding service '%s'", mServiceName);
+        // Another host on the link already uses the name.
+        RenameService();
+        ExitNow(ret = CreateService(aClient));
+    }
+    VerifyOrExit(ret == 0, ret = kMdnsPublisher_FailedAddSevice);
 
-        VerifyOrExit(avahi_entry_group_add_service(mClientGroup, AVAHI_IF_UNSPEC,
-                                                   AVAHI_PROTO_UNSPEC, static_cast<AvahiPublishFlags>(0),
-                                                   mServiceName, mType, NULL, NULL, mPort,
-                                                   mNetworkNameTxt, mExtPanIdTxt, NULL) == 0,
-                     ret = kMdnsPublisher_FailedAddSevice);
+    syslog(LOG_INFO, " Service Name: %s \n Port: %d \n Network Name: %s \n Extended Pan ID: %s",
+           mServiceName.c_str(), mService.mPort, mService.mNetworkNameTxt.c_str(), mService.mExtPanIdTxt.c_str());
 
-        syslog(LOG_INFO, " Service Name: %s \n Port: %d \n Network Name: %s \n Extended Pan ID: %s",
-               mServiceName, mPort, mNetworkNameTxt, mExtPanIdTxt);
+    VerifyOrExit(avahi_entry_group_commit(mClientGroup) == 0,
+                 ret = kMdnsPublisher_FailedRegisterSevice);
 
-        VerifyOrExit(avahi_entry_group_commit(mClientGroup) == 0,
-                     ret = kMdnsPublisher_FailedRegisterSevice);
-    }
+    mPublished = mService;
+    mIsPublished = true;
 
 exit:
-
-    switch (ret)
+    if (ret != kMdnsPublisher_OK)
     {
-    case kMdnsPublisher_FailedAddSevice:
-        serviceName = avahi_alternative_service_name(mServiceName);
-        avahi_free(mServiceName);
-        mServiceName = serviceName;
-        syslog(LOG_INFO, "Service name collision, renaming service to '%s'", mServiceName);
-        avahi_entry_group_reset(mClientGroup);
-        ret = CreateService(aClient);
-        break;
+        syslog(LOG_ERR, "create service failure: %d", ret);
+    }
+    return ret;
+}
 
-    case kMdnsPublisher_FailedRegisterSevice:
-        avahi_simple_poll_quit(mSimplePoll);
-        break;
+void Publisher::RenameService(void)
+{
+    char *serviceName = avahi_alternative_service_name(mServiceName.c_str());
 
-    default:
-        break;
+    mServiceName = serviceName;
+    avahi_free(serviceName);
+    syslog(LOG_INFO, "Service name collision, renaming service to '%s'", mServiceName.c_str());
+}
+
+void Publisher::PublishService(void)
+{
+    int ret = kMdnsPublisher_OK;
+
+    // Applied once the client runs, HandleClientStart() calls back here.
+    VerifyOrExit(mHasService && mClient != NULL && avahi_client_get_state(mClient) == AVAHI_CLIENT_S_RUNNING);
+
+    if (!mIsPublished || mClientGroup == NULL || avahi_entry_group_is_empty(mClientGroup) ||
+        mService.mName != mPublished.mName || mService.mType != mPublished.mType ||
+        mService.mPort != mPublished.mPort)
+    {
+        if (mService.mName != mPublished.mName || !mIsPublished)
+        {
+            mServiceName = mService.mName;
+        }
+        ExitNow(ret = CreateService(mClient));
     }
 
-    return ret;
+    VerifyOrExit(mService.mNetworkNameTxt != mPublished.mNetworkNameTxt ||
+                 mService.mExtPanIdTxt != mPublished.mExtPanIdTxt);
+
+    // Only the TXT record changed, it is updated in place without withdrawing the service.
+    VerifyOrExit(avahi_entry_group_update_service_txt(mClientGroup, AVAHI_IF_UNSPEC,
+                                                      AVAHI_PROTO_UNSPEC, static_cast<AvahiPublishFlags>(0),
+                                                      mServiceName.c_str(), mService.mType.c_str(), NULL,
+                                                      mService.mNetworkNameTxt.c_str(),
+                                                      mService.mExtPanIdTxt.c_str(), NULL) == 0,
+                 ret = kMdnsPublisher_FailedUpdateSevice);
+    mPublished = mService;
+    syslog(LOG_INFO, "Updated TXT of service '%s': %s %s", mServiceName.c_str(),
+           mService.mNetworkNameTxt.c_str(), mService.mExtPanIdTxt.c_str());
+
+exit:
+    if (ret != kMdnsPublisher_OK)
+    {
+        syslog(LOG_ERR, "published service failure: %d", ret);
+    }
 }
 
 void Publisher::HandleClientStart(AvahiClient *aClient, AvahiClientState aState)
 {
-    int ret = kMdnsPublisher_OK;
-
     assert(aClient);
 
     switch (aState)
     {
     case AVAHI_CLIENT_S_RUNNING:
-        VerifyOrExit((ret = CreateService(aClient)) == kMdnsPublisher_OK);
+        // avahi_client_new() calls back before returning.
+        mClient = aClient;
+        PublishService();
         break;
 
     case AVAHI_CLIENT_FAILURE:
         syslog(LOG_ERR, "Client failure: %s", avahi_strerror(avahi_client_errno(aClient)));
-        avahi_simple_poll_quit(mSimplePoll);
+        if (avahi_client_errno(aClient) == AVAHI_ERR_DISCONNECTED)
+        {
+            // avahi-daemon restarted, a new client waits for it and publishes the service again.
+            avahi_client_free(aClient);
+            mClient = NULL;
+            mClientGroup = NULL;
+            mIsPublished = false;
+            CreateClient();
+        }
+        else
+        {
+            avahi_simple_poll_quit(mSimplePoll);
+        }
         break;
 
     case AVAHI_CLIENT_S_COLLISION:
     case AVAHI_CLIENT_S_REGISTERING:
+        // The host name changed, the service is registered again once the client runs.
         if (mClientGroup)
         {
             avahi_entry_group_reset(mClientGroup);
         }
-
+        mIsPublished = false;
         break;
 
     case AVAHI_CLIENT_CONNECTING:
@@ -201,73 +244,117 @@ void Publisher::HandleClientStart(AvahiClient *aClient, AvahiClientState aState)
     default:
         break;
     }
+}
 
-exit:
+int Publisher::CreateClient(void)
+{
+    int error;
+    int ret = kMdnsPublisher_OK;
 
+    // With AVAHI_CLIENT_NO_FAIL the client also waits for avahi-daemon to (re)appear.
+    mClient = avahi_client_new(avahi_simple_poll_get(mSimplePoll), AVAHI_CLIENT_NO_FAIL,
+                               HandleClientStart, this, &error);
+    VerifyOrExit(mClient != NULL, ret = kMdnsPublisher_FailedCreateClient);
+
+exit:
     if (ret != kMdnsPublisher_OK)
     {
-        syslog(LOG_ERR, "started client failure: %d", ret);
+        syslog(LOG_ERR, "create client failure: %s", avahi_strerror(error));
     }
+    return ret;
 }
 
-void Publisher::HandleServicePublish(AVAHI_GCC_UNUSED AvahiTimeout *aTimeout)
+void Publisher::Run(void)
 {
-    struct timeval tv;
-    int            ret = kMdnsPublisher_OK;
+    VerifyOrExit(CreateClient() == kMdnsPublisher_OK);
 
-    if ((mClient != NULL) && (avahi_client_get_state(mClient) == AVAHI_CLIENT_S_RUNNING))
+    while (true)
     {
-        if (mClientGroup != NULL)
+        bool hasUpdate = false;
+
         {
-            avahi_entry_group_reset(mClientGroup);
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            if (mIsStopping)
+            {
+                break;
+            }
+
+            if (mHasPendingService)
+            {
+                mService = mPendingService;
+                mHasService = true;
+                mHasPendingService = false;
+                hasUpdate = true;
+            }
         }
 
-        VerifyOrExit((ret = CreateService(mClient)) == kMdnsPublisher_OK);
+        if (hasUpdate)
+        {
+            PublishService();
+        }
 
-        avahi_simple_poll_get(mSimplePoll)->timeout_new(
-            avahi_simple_poll_get(mSimplePoll),
-            avahi_elapse_time(&tv, OT_PERIODICAL_TIME, 0),
-            HandleServicePublish,
-            this);
+        // Returns after an event or a wakeup from UpdateService() or Stop().
+        if (avahi_simple_poll_iterate(mSimplePoll, -1) != 0)
+        {
+            syslog(LOG_ERR, "mDNS publisher stopped");
+            break;
+        }
     }
 
 exit:
-
-    if (ret != kMdnsPublisher_OK)
-    {
-        syslog(LOG_ERR, "published service failure: %d", ret);
-    }
+    return;
 }
 
-int Publisher::StartClient(void)
+int Publisher::Start(void)
 {
-    int            error;
-    int            ret = kMdnsPublisher_OK;
-    struct timeval tv;
+    int                         ret = kMdnsPublisher_OK;
+    std::lock_guard<std::mutex> lock(mMutex);
 
+    VerifyOrExit(mSimplePoll == NULL);
     VerifyOrExit((mSimplePoll = avahi_simple_poll_new()) != NULL,
                  ret = kMdnsPublisher_FailedCreatePoll);
-    mClient = avahi_client_new(avahi_simple_poll_get(mSimplePoll), (AvahiClientFlags) 0,
-                               HandleClientStart, this, &error);
-    VerifyOrExit(mClient, ret = kMdnsPublisher_FailedCreateClient);
-
-    avahi_simple_poll_get(mSimplePoll)->timeout_new(
-        avahi_simple_poll_get(mSimplePoll),
-        avahi_elapse_time(&tv, OT_PERIODICAL_TIME, 0),
-        HandleServicePublish,
-        this);
-    avahi_simple_poll_loop(mSimplePoll);
+    mIsStopping = false;
+    mThread = std::thread(&Publisher::Run, this);
 
 exit:
-
-    Free();
     return ret;
 }
 
-void Publisher::SetServiceName(const char *aServiceName)
+void Publisher::Stop(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        VerifyOrExit(mSimplePoll != NULL);
+        mIsStopping = true;
+        avahi_simple_poll_wakeup(mSimplePoll);
+    }
+
+    mThread.join();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        // Freeing the client withdraws the service.
+        Free();
+        mHasService = false;
+    }
+
+exit:
+    return;
+}
+
+void Publisher::UpdateService(const ServiceInfo &aService)
 {
-    avahi_free(mServiceName);
-    mServiceName = avahi_strdup(aServiceName);
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mPendingService = aService;
+    mHasPendingService = true;
+    if (mSimplePoll != NULL)
+    {
+        avahi_simple_poll_wakeup(mSimplePoll);
+    }
 }
 
 void Publisher::HandleEntryGroupStart(AvahiEntryGroup *aGroup, AvahiEntryGroupState aState)
@@ -281,16 +368,11 @@ void Publisher::HandleEntryGroupStart(AvahiEntryGroup *aGroup, AvahiEntryGroupSt
     {
 
     case AVAHI_ENTRY_GROUP_ESTABLISHED:
-        syslog(LOG_INFO, "Service '%s' successfully established.", mServiceName);
+        syslog(LOG_INFO, "Service '%s' successfully established.", mServiceName.c_str());
         break;
 
     case AVAHI_ENTRY_GROUP_COLLISION:
-        char *serviceName;
-
-        serviceName = avahi_alternative_service_name(mServiceName);
-        avahi_free(mServiceName);
-        mServiceName = serviceName;
-        syslog(LOG_ERR, "Service name collision, renaming service to '%s'", mServiceName);
+        RenameService();
         VerifyOrExit((ret = CreateService(avahi_entry_group_get_client(aGroup))) == kMdnsPublisher_OK);
         break;
 
@@ -299,7 +381,8 @@ void Publisher::HandleEntryGroupStart(AvahiEntryGroup *aGroup, AvahiEntryGroupSt
         syslog(LOG_ERR, "Entry group failure: %s",
                avahi_strerror(avahi_client_errno(avahi_entry_group_get_client(aGroup))));
 
-        avahi_simple_poll_quit(mSimplePoll);
+        // Registered again on the next update.
+        mIsPublished = false;
         break;
 
     case AVAHI_ENTRY_GROUP_UNCOMMITED:
@@ -318,44 +401,5 @@ exit:
     }
 }
 
-void Publisher::SetNetworkNameTxt(const char *aNetworkNameTxt)
-{
-    avahi_free(mNetworkNameTxt);
-    mNetworkNameTxt = avahi_strdup(aNetworkNameTxt);
-}
-
-void Publisher::SetExtPanIdTxt(const char *aExtPanIdTxt)
-{
-    avahi_free(mExtPanIdTxt);
-    mExtPanIdTxt = avahi_strdup(aExtPanIdTxt);
-}
-
-void Publisher::SetType(const char *aType)
-{
-    avahi_free(mType);
-    mType = avahi_strdup(aType);
-}
-
-void Publisher::SetPort(uint16_t aPort)
-{
-    mPort = aPort;
-}
-
-int Publisher::UpdateService(void)
-{
-    int ret = kMdnsPublisher_OK;
-
-    if (mClientGroup != NULL)
-    {
-        ret = avahi_entry_group_update_service_txt(mClientGroup, AVAHI_IF_UNSPEC,
-                                                   AVAHI_PROTO_UNSPEC, static_cast<AvahiPublishFlags>(0),
-                                                   mServiceName, mType, NULL, NULL, mPort,
-                                                   mNetworkNameTxt, mExtPanIdTxt, NULL);
-    }
-    VerifyOrExit(ret == kMdnsPublisher_OK, ret = kMdnsPublisher_FailedUpdateSevice);
-exit:
-    return ret;
-}
-
 } //namespace Mdns
 } //namespace ot
@@ -34,6 +34,10 @@
 #ifndef MDNS_SERVER_HPP
 #define MDNS_SERVER_HPP
 
+#include <mutex>
+#include <string>
+#include <thread>
+
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -52,68 +56,53 @@
 namespace ot {
 namespace Mdns {
 
+/**
+ * This structure describes the service to publish.
+ *
+ */
+struct ServiceInfo
+{
+    std::string mName;           ///< The service instance name.
+    std::string mType;           ///< The service type, e.g. "_meshcop._udp".
+    uint16_t    mPort;           ///< The service port.
+    std::string mNetworkNameTxt; ///< The "nn=" TXT entry.
+    std::string mExtPanIdTxt;    ///< The "xp=" TXT entry.
+};
+
+/**
+ * This class publishes the border router service.
+ *
+ * The Avahi client and entry group are only touched by the publisher thread. Other threads queue
+ * the service they want published, and the thread announces it again only when it changed: a
+ * change of the TXT entries is an in-place TXT update, any other change re-registers the service.
+ *
+ */
 class Publisher
 {
 public:
 
     /**
-     * This method sets the service name.
-     *
-     * @param[in]  aServiceName  A pointer to the service name.
-     *
-     */
-    void SetServiceName(const char *aServiceName);
-
-    /**
-     * This method sets the network name in TxT record.
+     * This method starts the publisher thread, if not started yet.
      *
-     * @param[in]  aNetworkNameTxt  A pointer to the network name.
+     * @retval kMdnsPublisher_OK                Successfully started the publisher thread, or it was running.
+     * @retval kMdnsPublisher_FailedCreatePoll  Failed to create the simple poll.
      *
      */
-    void SetNetworkNameTxt(const char *aNetworkNameTxt);
+    int Start(void);
 
     /**
-     * This method sets the extended PAN ID in TxT record.
-     *
-     * @param[in]  aExtPanIdTxt  A pointer to the extended PAN ID.
-     *
-     */
-    void SetExtPanIdTxt(const char *aExtPanIdTxt);
-
-    /**
-     * This method sets the service type.
-     *
-     * @param[in]  aType  A pointer to the service type.
-     *
-     */
-    void SetType(const char *aType);
-
-    /**
-     * This method sets the service port.
-     *
-     * @param[in]  aPort  service port.
-     *
-     */
-    void SetPort(uint16_t aPort);
-
-    /**
-     * This method starts the mDNS client.
-     *
-     * @retval kMdnsPublisher_OK                  Successfully started the mDNS client.
-     * @retval kMdnsPublisher_FailedCreatePoll    Failed to created the simple poll.
-     * @retval kMdnsPublisher_FailedCreateServer  Failed to created the mDNS client.
+     * This method withdraws the service and stops the publisher thread.
      *
      */
-    int StartClient(void);
+    void Stop(void);
 
     /**
-     * This method updates the publishing service.
+     * This method queues the service to publish, replacing any update not applied yet.
      *
-     * @retval kMdnsPublisher_OK                  Successfully updated the publishing service.
-     * @retval kMdnsPublisher_FailedUpdateSevice  Failed to updated the publishing service.
+     * @param[in]  aService  A reference to the service.
      *
      */
-    int UpdateService(void);
+    void UpdateService(const ServiceInfo &aService);
 
     /**
      * This method returns the reference to the mDNS publisher instance.
@@ -130,6 +119,7 @@ public:
 
 private:
     Publisher(void);
+    ~Publisher(void);
 
     static void HandleEntryGroupStart(AvahiEntryGroup *aGroup, AvahiEntryGroupState aState,
                                       AVAHI_GCC_UNUSED void *aUserData);
@@ -137,19 +127,26 @@ private:
     static void HandleClientStart(AvahiClient *aClient, AvahiClientState aState,
                                   AVAHI_GCC_UNUSED void *aUserData);
     void HandleClientStart(AvahiClient *aClient, AvahiClientState aState);
-    static void HandleServicePublish(AVAHI_GCC_UNUSED AvahiTimeout *aTimeout, AVAHI_GCC_UNUSED void *aUserData);
-    void HandleServicePublish(AVAHI_GCC_UNUSED AvahiTimeout *aTimeout);
+    void Run(void);
+    int CreateClient(void);
     int CreateService(AvahiClient *aClient);
+    void PublishService(void);
+    void RenameService(void);
     void Free(void);
 
     AvahiEntryGroup *mClientGroup;
     AvahiSimplePoll *mSimplePoll;
     AvahiClient     *mClient;
-    uint16_t         mPort;
-    char            *mServiceName;
-    char            *mNetworkNameTxt;
-    char            *mExtPanIdTxt;
-    char            *mType;
+    std::thread      mThread;
+    std::mutex       mMutex;          // Guards mPendingService, mHasPendingService and mIsStopping.
+    ServiceInfo      mPendingService;
+    bool             mHasPendingService;
+    bool             mIsStopping;
+    ServiceInfo      mService;        // The service requested, owned by the publisher thread.
+    bool             mHasService;
+    ServiceInfo      mPublished;      // The service as last registered with avahi-daemon.
+    bool             mIsPublished;
+    std::string      mServiceName;    // The name registered, differs from mService.mName after a collision.
 };
 
 } //namespace Mdns
@@ -0,0 +1,869 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the streaming JSON writer and reader.
+ */
+
+#include "json.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/code_utils.hpp"
+
+namespace ot {
+namespace Utils {
+
+JsonWriter::JsonWriter(std::string &aBuffer) :
+    mBuffer(aBuffer),
+    mHasValue(0),
+    mDepth(0),
+    mIsAfterKey(false)
+{
+}
+
+void JsonWriter::BeginValue(void)
+{
+    if (mIsAfterKey)
+    {
+        mIsAfterKey = false;
+    }
+    else if (mDepth > 0)
+    {
+        uint32_t bit = 1U << (mDepth - 1);
+
+        if (mHasValue & bit)
+        {
+            mBuffer += ',';
+        }
+        mHasValue |= bit;
+    }
+}
+
+JsonWriter &JsonWriter::BeginObject(void)
+{
+    BeginValue();
+    mBuffer += '{';
+    if (mDepth < kMaxDepth)
+    {
+        mDepth++;
+        mHasValue &= ~(1U << (mDepth - 1));
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::EndObject(void)
+{
+    mBuffer += '}';
+    if (mDepth > 0)
+    {
+        mDepth--;
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::BeginArray(void)
+{
+    BeginValue();
+    mBuffer += '[';
+    if (mDepth < kMaxDepth)
+    {
+        mDepth++;
+        mHasValue &= ~(1U << (mDepth - 1));
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::EndArray(void)
+{
+    mBuffer += ']';
+    if (mDepth > 0)
+    {
+        mDepth--;
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::Key(const char *aKey)
+{
+    BeginValue();
+    Escape(aKey, strlen(aKey));
+    mBuffer += ':';
+    mIsAfterKey = true;
+    return *this;
+}
+
+void JsonWriter::Escape(const char *aValue, size_t aLength)
+{
+    static const char kHex[] = "0123456789abcdef";
+    const char       *start = aValue;
+    const char       *end = aValue + aLength;
+
+    mBuffer += '"';
+
+    // Copy runs of plain characters at once, only escapes are written one by one.
+    for (const char *cur = aValue; cur < end; cur++)
+    {
+        unsigned char c = static_cast<unsigned char>(*cur);
+        char          escaped[7] = "\\u00";
+
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+
+        mBuffer.append(start, cur);
+        start = cur + 1;
+
+        switch (c)
+        {
+        case '"':
+            mBuffer.append("\\\"", 2);
+            break;
+
+        case '\\':
+            mBuffer.append("\\\\", 2);
+            break;
+
+        case '\n':
+            mBuffer.append("\\n", 2);
+            break;
+
+        case '\r':
+            mBuffer.append("\\r", 2);
+            break;
+
+        case '\t':
+            mBuffer.append("\\t", 2);
+            break;
+
+        default:
+            escaped[4] = kHex[c >> 4];
+            escaped[5] = kHex[c & 0xf];
+            mBuffer.append(escaped, 6);
+            break;
+        }
+    }
+
+    mBuffer.append(start, end);
+    mBuffer += '"';
+}
+
+JsonWriter &JsonWriter::String(const char *aValue)
+{
+    return String(aValue, strlen(aValue));
+}
+
+JsonWriter &JsonWriter::String(const char *aValue, size_t aLength)
+{
+    BeginValue();
+    Escape(aValue, aLength);
+    return *this;
+}
+
+JsonWriter &JsonWriter::String(const std::string &aValue)
+{
+    return String(aValue.data(), aValue.size());
+}
+
+JsonWriter &JsonWriter::Int(int64_t aValue)
+{
+    char number[24];
+    int  length = snprintf(number, sizeof(number), "%lld", static_cast<long long>(aValue));
+
+    BeginValue();
+    mBuffer.append(number, static_cast<size_t>(length));
+    return *this;
+}
+
+JsonWriter &JsonWriter::Uint(uint64_t aValue)
+{
+    char number[24];
+    int  length = snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(aValue));
+
+    BeginValue();
+    mBuffer.append(number, static_cast<size_t>(length));
+    return *this;
+}
+
+JsonWriter &JsonWriter::Bool(bool aValue)
+{
+    BeginValue();
+    if (aValue)
+    {
+        mBuffer.append("true", 4);
+    }
+    else
+    {
+        mBuffer.append("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::Null(void)
+{
+    BeginValue();
+    mBuffer.append("null", 4);
+    return *this;
+}
+
+JsonWriter &JsonWriter::Raw(const char *aJson, size_t aLength)
+{
+    BeginValue();
+    mBuffer.append(aJson, aLength);
+    return *this;
+}
+
+JsonField JsonField::String(const char *aName, std::string &aValue, bool aIsRequired)
+{
+    JsonField field = { aName, kTypeString, &aValue, aIsRequired };
+
+    return field;
+}
+
+JsonField JsonField::Bool(const char *aName, bool &aValue, bool aIsRequired)
+{
+    JsonField field = { aName, kTypeBool, &aValue, aIsRequired };
+
+    return field;
+}
+
+JsonField JsonField::Int(const char *aName, int64_t &aValue, bool aIsRequired)
+{
+    JsonField field = { aName, kTypeInt, &aValue, aIsRequired };
+
+    return field;
+}
+
+JsonField JsonField::Uint(const char *aName, uint64_t &aValue, bool aIsRequired)
+{
+    JsonField field = { aName, kTypeUint, &aValue, aIsRequired };
+
+    return field;
+}
+
+JsonReader::JsonReader(const char *aData, size_t aLength) :
+    mCursor(aData),
+    mEnd(aData + aLength),
+    mNumber(NULL),
+    mNumberLength(0),
+    mToken(kTokenError),
+    mState(kStateValue),
+    mObjectBits(0),
+    mDepth(0),
+    mError(NULL)
+{
+}
+
+JsonReader::Token JsonReader::SetError(const char *aError)
+{
+    if (mError == NULL)
+    {
+        mError = aError;
+    }
+    mState = kStateDone;
+    mCursor = mEnd;
+    return mToken = kTokenError;
+}
+
+void JsonReader::SkipSpaces(void)
+{
+    while (mCursor < mEnd && (*mCursor == ' ' || *mCursor == '\t' || *mCursor == '\n' || *mCursor == '\r'))
+    {
+        mCursor++;
+    }
+}
+
+void JsonReader::AfterValue(void)
+{
+    mState = mDepth > 0 ? kStateCommaOrEnd : kStateDone;
+}
+
+JsonReader::Token JsonReader::Next(void)
+{
+    VerifyOrExit(mError == NULL, mToken = kTokenError);
+
+    SkipSpaces();
+
+    if (mCursor == mEnd)
+    {
+        VerifyOrExit(mState == kStateDone, SetError("unexpected end of input"));
+        ExitNow(mToken = kTokenEnd);
+    }
+
+    switch (mState)
+    {
+    case kStateDone:
+        SetError("unexpected data after the value");
+        break;
+
+    case kStateCommaOrEnd:
+        if (*mCursor == ',')
+        {
+            mCursor++;
+            mState = IsInObject() ? kStateKey : kStateValue;
+            Next();
+        }
+        else if (*mCursor == (IsInObject() ? '}' : ']'))
+        {
+            EndContainer();
+        }
+        else
+        {
+            SetError("expected ',' or the end of the container");
+        }
+        break;
+
+    case kStateFirstKey:
+        if (*mCursor == '}')
+        {
+            EndContainer();
+        }
+        else
+        {
+            ReadKey();
+        }
+        break;
+
+    case kStateKey:
+        ReadKey();
+        break;
+
+    case kStateFirstValue:
+        if (*mCursor == ']')
+        {
+            EndContainer();
+        }
+        else
+        {
+            ReadValue();
+        }
+        break;
+
+    case kStateValue:
+        ReadValue();
+        break;
+    }
+
+exit:
+    return mToken;
+}
+
+JsonReader::Token JsonReader::BeginContainer(bool aIsObject)
+{
+    VerifyOrExit(mDepth < kMaxDepth, SetError("nested too deeply"));
+
+    mCursor++;
+    mDepth++;
+    if (aIsObject)
+    {
+        mObjectBits |= 1U << (mDepth - 1);
+        mState = kStateFirstKey;
+        mToken = kTokenBeginObject;
+    }
+    else
+    {
+        mObjectBits &= ~(1U << (mDepth - 1));
+        mState = kStateFirstValue;
+        mToken = kTokenBeginArray;
+    }
+
+exit:
+    return mToken;
+}
+
+JsonReader::Token JsonReader::EndContainer(void)
+{
+    mToken = IsInObject() ? kTokenEndObject : kTokenEndArray;
+    mCursor++;
+    mDepth--;
+    AfterValue();
+    return mToken;
+}
+
+JsonReader::Token JsonReader::ReadKey(void)
+{
+    VerifyOrExit(*mCursor == '"', SetError("expected a key"));
+    VerifyOrExit(ReadString());
+    SkipSpaces();
+    VerifyOrExit(mCursor < mEnd && *mCursor == ':', SetError("expected ':'"));
+    mCursor++;
+    mState = kStateValue;
+    mToken = kTokenKey;
+
+exit:
+    return mToken;
+}
+
+JsonReader::Token JsonReader::ReadValue(void)
+{
+    switch (*mCursor)
+    {
+    case '{':
+        BeginContainer(true);
+        break;
+
+    case '[':
+        BeginContainer(false);
+        break;
+
+    case '"':
+        if (ReadString())
+        {
+            mToken = kTokenString;
+            AfterValue();
+        }
+        break;
+
+    case 't':
+        ReadLiteral("true", kTokenTrue);
+        break;
+
+    case 'f':
+        ReadLiteral("false", kTokenFalse);
+        break;
+
+    case 'n':
+        ReadLiteral("null", kTokenNull);
+        break;
+
+    default:
+        ReadNumber();
+        break;
+    }
+
+    return mToken;
+}
+
+JsonReader::Token JsonReader::ReadLiteral(const char *aLiteral, Token aToken)
+{
+    size_t length = strlen(aLiteral);
+
+    VerifyOrExit(static_cast<size_t>(mEnd - mCursor) >= length && memcmp(mCursor, aLiteral, length) == 0,
+                 SetError("invalid literal"));
+    mCursor += length;
+    mToken = aToken;
+    AfterValue();
+
+exit:
+    return mToken;
+}
+
+static bool IsDigit(char aChar)
+{
+    return aChar >= '0' && aChar <= '9';
+}
+
+JsonReader::Token JsonReader::ReadNumber(void)
+{
+    const char *start = mCursor;
+
+    if (mCursor < mEnd && *mCursor == '-')
+    {
+        mCursor++;
+    }
+    VerifyOrExit(mCursor < mEnd && IsDigit(*mCursor), SetError("invalid value"));
+    if (*mCursor == '0')
+    {
+        mCursor++;
+    }
+    else
+    {
+        while (mCursor < mEnd && IsDigit(*mCursor))
+        {
+            mCursor++;
+        }
+    }
+
+    if (mCursor < mEnd && *mCursor == '.')
+    {
+        mCursor++;
+        VerifyOrExit(mCursor < mEnd && IsDigit(*mCursor), SetError("invalid number"));
+        while (mCursor < mEnd && IsDigit(*mCursor))
+        {
+            mCursor++;
+        }
+    }
+
+    if (mCursor < mEnd && (*mCursor == 'e' || *mCursor == 'E'))
+    {
+        mCursor++;
+        if (mCursor < mEnd && (*mCursor == '+' || *mCursor == '-'))
+        {
+            mCursor++;
+        }
+        VerifyOrExit(mCursor < mEnd && IsDigit(*mCursor), SetError("invalid number"));
+        while (mCursor < mEnd && IsDigit(*mCursor))
+        {
+            mCursor++;
+        }
+    }
+
+    mNumber = start;
+    mNumberLength = static_cast<size_t>(mCursor - start);
+    mToken = kTokenNumber;
+    AfterValue();
+
+exit:
+    return mToken;
+}
+
+static int HexValue(char aChar)
+{
+    int value = -1;
+
+    if (aChar >= '0' && aChar <= '9')
+    {
+        value = aChar - '0';
+    }
+    else if (aChar >= 'a' && aChar <= 'f')
+    {
+        value = aChar - 'a' + 10;
+    }
+    else if (aChar >= 'A' && aChar <= 'F')
+    {
+        value = aChar - 'A' + 10;
+    }
+
+    return value;
+}
+
+static bool ReadHex4(const char *&aCursor, const char *aEnd, uint32_t &aValue)
+{
+    bool ret = false;
+
+    VerifyOrExit(aEnd - aCursor >= 4);
+    aValue = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int digit = HexValue(*aCursor++);
+
+        VerifyOrExit(digit >= 0);
+        aValue = (aValue << 4) | static_cast<uint32_t>(digit);
+    }
+    ret = true;
+
+exit:
+    return ret;
+}
+
+static void AppendUtf8(std::string &aString, uint32_t aCodePoint)
+{
+    if (aCodePoint < 0x80)
+    {
+        aString += static_cast<char>(aCodePoint);
+    }
+    else if (aCodePoint < 0x800)
+    {
+        aString += static_cast<char>(0xc0 | (aCodePoint >> 6));
+        aString += static_cast<char>(0x80 | (aCodePoint & 0x3f));
+    }
+    else if (aCodePoint < 0x10000)
+    {
+        aString += static_cast<char>(0xe0 | (aCodePoint >> 12));
+        aString += static_cast<char>(0x80 | ((aCodePoint >> 6) & 0x3f));
+        aString += static_cast<char>(0x80 | (aCodePoint & 0x3f));
+    }
+    else
+    {
+        aString += static_cast<char>(0xf0 | (aCodePoint >> 18));
+        aString += static_cast<char>(0x80 | ((aCodePoint >> 12) & 0x3f));
+        aString += static_cast<char>(0x80 | ((aCodePoint >> 6) & 0x3f));
+        aString += static_cast<char>(0x80 | (aCodePoint & 0x3f));
+    }
+}
+
+bool JsonReader::ReadString(void)
+{
+    bool        ret = false;
+    const char *start = ++mCursor;
+
+    mString.clear();
+
+    while (mCursor < mEnd && *mCursor != '"')
+    {
+        uint32_t codePoint;
+
+        if (static_cast<unsigned char>(*mCursor) < 0x20)
+        {
+            ExitNow(SetError("control character in string"));
+        }
+        else if (*mCursor != '\\')
+        {
+            mCursor++;
+            continue;
+        }
+
+        mString.append(start, mCursor);
+        mCursor++;
+        VerifyOrExit(mCursor < mEnd, SetError("unexpected end of input"));
+
+        switch (*mCursor++)
+        {
+        case '"':
+            mString += '"';
+            break;
+
+        case '\\':
+            mString += '\\';
+            break;
+
+        case '/':
+            mString += '/';
+            break;
+
+        case 'b':
+            mString += '\b';
+            break;
+
+        case 'f':
+            mString += '\f';
+            break;
+
+        case 'n':
+            mString += '\n';
+            break;
+
+        case 'r':
+            mString += '\r';
+            break;
+
+        case 't':
+            mString += '\t';
+            break;
+
+        case 'u':
+            VerifyOrExit(ReadHex4(mCursor, mEnd, codePoint), SetError("invalid unicode escape"));
+            if (codePoint >= 0xd800 && codePoint < 0xdc00)
+            {
+                uint32_t low;
+
+                // A character outside the basic plane is escaped as a surrogate pair.
+                VerifyOrExit(mEnd - mCursor >= 2 && mCursor[0] == '\\' && mCursor[1] == 'u',
+                             SetError("invalid surrogate pair"));
+                mCursor += 2;
+                VerifyOrExit(ReadHex4(mCursor, mEnd, low) && low >= 0xdc00 && low < 0xe000,
+                             SetError("invalid surrogate pair"));
+                codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+            }
+            AppendUtf8(mString, codePoint);
+            break;
+
+        default:
+            ExitNow(SetError("invalid escape"));
+        }
+
+        start = mCursor;
+    }
+
+    VerifyOrExit(mCursor < mEnd, SetError("unterminated string"));
+    mString.append(start, mCursor);
+    mCursor++;
+    ret = true;
+
+exit:
+    return ret;
+}
+
+bool JsonReader::Skip(void)
+{
+    uint8_t depth = mDepth;
+
+    if (mToken == kTokenKey)
+    {
+        Next();
+    }
+
+    if (mToken == kTokenBeginObject || mToken == kTokenBeginArray)
+    {
+        // Read until the container the value started is closed again.
+        depth = mDepth - 1;
+        while (mDepth > depth && Next() != kTokenError)
+        {
+        }
+    }
+
+    return mToken != kTokenError;
+}
+
+static bool ParseUint(const char *aText, size_t aLength, uint64_t &aValue)
+{
+    bool     ret = false;
+    uint64_t value = 0;
+
+    VerifyOrExit(aLength > 0 && aLength <= 20);
+    for (size_t i = 0; i < aLength; i++)
+    {
+        uint64_t next;
+
+        VerifyOrExit(IsDigit(aText[i]));
+        next = value * 10 + static_cast<uint64_t>(aText[i] - '0');
+        VerifyOrExit(next / 10 == value);
+        value = next;
+    }
+    aValue = value;
+    ret = true;
+
+exit:
+    return ret;
+}
+
+bool JsonReader::GetUint(uint64_t &aValue) const
+{
+    bool ret = false;
+
+    if (mToken == kTokenNumber)
+    {
+        ret = ParseUint(mNumber, mNumberLength, aValue);
+    }
+    else if (mToken == kTokenString)
+    {
+        ret = ParseUint(mString.data(), mString.size(), aValue);
+    }
+
+    return ret;
+}
+
+bool JsonReader::GetInt(int64_t &aValue) const
+{
+    bool        ret = false;
+    const char *text = mToken == kTokenNumber ? mNumber : mString.data();
+    size_t      length = mToken == kTokenNumber ? mNumberLength : mString.size();
+    bool        isNegative;
+    uint64_t    magnitude;
+
+    VerifyOrExit(mToken == kTokenNumber || mToken == kTokenString);
+    isNegative = length > 0 && text[0] == '-';
+    VerifyOrExit(ParseUint(text + isNegative, length - isNegative, magnitude));
+    VerifyOrExit(magnitude <= static_cast<uint64_t>(INT64_MAX) + isNegative);
+    aValue = isNegative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    ret = true;
+
+exit:
+    return ret;
+}
+
+bool JsonReader::ReadField(const JsonField &aField)
+{
+    bool ret = false;
+
+    switch (aField.mType)
+    {
+    case JsonField::kTypeString:
+        VerifyOrExit(mToken == kTokenString);
+        static_cast<std::string *>(aField.mValue)->assign(mString);
+        break;
+
+    case JsonField::kTypeBool:
+        if (mToken == kTokenTrue || mToken == kTokenFalse)
+        {
+            *static_cast<bool *>(aField.mValue) = (mToken == kTokenTrue);
+        }
+        else
+        {
+            VerifyOrExit(mToken == kTokenString && (mString == "true" || mString == "false"));
+            *static_cast<bool *>(aField.mValue) = (mString == "true");
+        }
+        break;
+
+    case JsonField::kTypeInt:
+        VerifyOrExit(GetInt(*static_cast<int64_t *>(aField.mValue)));
+        break;
+
+    case JsonField::kTypeUint:
+        VerifyOrExit(GetUint(*static_cast<uint64_t *>(aField.mValue)));
+        break;
+    }
+
+    ret = true;
+
+exit:
+    return ret;
+}
+
+bool JsonReader::ReadObject(const JsonField *aFields, size_t aCount)
+{
+    bool ret = false;
+
+    VerifyOrExit(Next() == kTokenBeginObject, SetError("expected an object"));
+    ret = ReadMembers(aFields, aCount);
+
+exit:
+    return ret;
+}
+
+bool JsonReader::ReadMembers(const JsonField *aFields, size_t aCount)
+{
+    bool     ret = false;
+    uint64_t found = 0;
+
+    VerifyOrExit(aCount <= 64, SetError("too many fields"));
+    VerifyOrExit(mToken == kTokenBeginObject, SetError("expected an object"));
+
+    while (Next() == kTokenKey)
+    {
+        size_t i;
+
+        for (i = 0; i < aCount; i++)
+        {
+            if (mString == aFields[i].mName)
+            {
+                break;
+            }
+        }
+
+        if (i == aCount)
+        {
+            VerifyOrExit(Skip());
+            continue;
+        }
+
+        // Next() replaces the key in mString, so the field is looked up before reading the value.
+        Next();
+        VerifyOrExit(ReadField(aFields[i]), SetError("invalid value type"));
+        found |= static_cast<uint64_t>(1) << i;
+    }
+
+    VerifyOrExit(mToken == kTokenEndObject);
+
+    for (size_t i = 0; i < aCount; i++)
+    {
+        VerifyOrExit(!aFields[i].mIsRequired || (found & (static_cast<uint64_t>(1) << i)),
+                     SetError("missing required field"));
+    }
+
+    ret = true;
+
+exit:
+    return ret;
+}
+
+} //namespace Utils
+} //namespace ot
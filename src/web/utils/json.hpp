@@ -0,0 +1,290 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of the streaming JSON writer and reader.
+ */
+
+#ifndef JSON_HPP_
+#define JSON_HPP_
+
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ot {
+namespace Utils {
+
+/**
+ * This class writes JSON straight into a string buffer, without building a tree.
+ *
+ * The caller is responsible for a well formed sequence of calls, e.g. a key before every
+ * value in an object. Strings are expected to be UTF-8.
+ *
+ */
+class JsonWriter
+{
+public:
+    /**
+     * The constructor appends to an existing buffer.
+     *
+     * @param[inout]  aBuffer  A reference to the buffer to append to.
+     *
+     */
+    explicit JsonWriter(std::string &aBuffer);
+
+    JsonWriter &BeginObject(void);
+    JsonWriter &EndObject(void);
+    JsonWriter &BeginArray(void);
+    JsonWriter &EndArray(void);
+
+    /**
+     * This method writes the key of the next member of the current object.
+     *
+     * @param[in]  aKey  A pointer to the null-terminated key.
+     *
+     */
+    JsonWriter &Key(const char *aKey);
+
+    JsonWriter &String(const char *aValue);
+    JsonWriter &String(const char *aValue, size_t aLength);
+    JsonWriter &String(const std::string &aValue);
+    JsonWriter &Int(int64_t aValue);
+    JsonWriter &Uint(uint64_t aValue);
+    JsonWriter &Bool(bool aValue);
+    JsonWriter &Null(void);
+
+    /**
+     * This method writes a value which is already serialized as JSON.
+     *
+     * @param[in]  aJson    A pointer to the JSON value.
+     * @param[in]  aLength  The length of the JSON value.
+     *
+     */
+    JsonWriter &Raw(const char *aJson, size_t aLength);
+
+private:
+    enum
+    {
+        kMaxDepth = 32,
+    };
+
+    void BeginValue(void);
+    void Escape(const char *aValue, size_t aLength);
+
+    std::string &mBuffer;
+    uint32_t     mHasValue;   ///< One bit per level, set once the level has an element.
+    uint8_t      mDepth;
+    bool         mIsAfterKey;
+};
+
+/**
+ * This structure binds a member of a JSON object to a variable, see JsonReader::ReadObject().
+ *
+ */
+struct JsonField
+{
+    enum Type
+    {
+        kTypeString, ///< mValue points to a std::string.
+        kTypeBool,   ///< mValue points to a bool, "true" and "false" strings are accepted too.
+        kTypeInt,    ///< mValue points to an int64_t, numeric strings are accepted too.
+        kTypeUint,   ///< mValue points to an uint64_t, numeric strings are accepted too.
+    };
+
+    static JsonField String(const char *aName, std::string &aValue, bool aIsRequired = true);
+    static JsonField Bool(const char *aName, bool &aValue, bool aIsRequired = true);
+    static JsonField Int(const char *aName, int64_t &aValue, bool aIsRequired = true);
+    static JsonField Uint(const char *aName, uint64_t &aValue, bool aIsRequired = true);
+
+    const char *mName;
+    Type        mType;
+    void       *mValue;
+    bool        mIsRequired;
+};
+
+/**
+ * This class reads JSON one token at a time, without building a tree.
+ *
+ * Strings and keys are decoded into a buffer reused for every token, numbers are read in
+ * place, so reading allocates nothing once the buffer has grown to the longest string.
+ *
+ */
+class JsonReader
+{
+public:
+    enum Token
+    {
+        kTokenError,       ///< The input is not valid JSON, see GetError().
+        kTokenEnd,         ///< The whole input has been read.
+        kTokenBeginObject,
+        kTokenEndObject,
+        kTokenBeginArray,
+        kTokenEndArray,
+        kTokenKey,         ///< A member key, see GetString().
+        kTokenString,      ///< A string value, see GetString().
+        kTokenNumber,      ///< A number value, see GetInt() and GetUint().
+        kTokenTrue,
+        kTokenFalse,
+        kTokenNull,
+    };
+
+    /**
+     * The constructor reads from a buffer, which must outlive the reader.
+     *
+     * @param[in]  aData    A pointer to the JSON text.
+     * @param[in]  aLength  The length of the JSON text.
+     *
+     */
+    JsonReader(const char *aData, size_t aLength);
+
+    /**
+     * This method reads the next token.
+     *
+     * @returns The token read.
+     *
+     */
+    Token Next(void);
+
+    /**
+     * This method skips the value starting at the last token, including all nested values.
+     *
+     * After a key, the value of the member is skipped.
+     *
+     * @retval TRUE   Successfully skipped the value.
+     * @retval FALSE  The input is not valid JSON.
+     *
+     */
+    bool Skip(void);
+
+    /**
+     * This method returns the decoded key or string of the last token.
+     *
+     */
+    const std::string &GetString(void) const { return mString; }
+
+    /**
+     * This method converts the last token to a signed integer.
+     *
+     * @param[out]  aValue  The value.
+     *
+     * @retval TRUE   The token is an integer, or a string of one, in range.
+     * @retval FALSE  The token is not an integer or is out of range.
+     *
+     */
+    bool GetInt(int64_t &aValue) const;
+
+    /**
+     * This method converts the last token to an unsigned integer.
+     *
+     * @param[out]  aValue  The value.
+     *
+     * @retval TRUE   The token is an unsigned integer, or a string of one, in range.
+     * @retval FALSE  The token is not an unsigned integer or is out of range.
+     *
+     */
+    bool GetUint(uint64_t &aValue) const;
+
+    /**
+     * This method reads an object, storing the members listed and skipping the others.
+     *
+     * @param[in]  aFields  A pointer to the members to read.
+     * @param[in]  aCount   The number of members in aFields.
+     *
+     * @retval TRUE   Successfully read the object with all the required members.
+     * @retval FALSE  The input is not such an object, see GetError().
+     *
+     */
+    bool ReadObject(const JsonField *aFields, size_t aCount);
+
+    /**
+     * This method reads the members of an object whose kTokenBeginObject was just returned by Next(),
+     * e.g. when reading the objects of an array.
+     *
+     * @param[in]  aFields  A pointer to the members to read.
+     * @param[in]  aCount   The number of members in aFields.
+     *
+     * @retval TRUE   Successfully read the object with all the required members.
+     * @retval FALSE  The input is not such an object, see GetError().
+     *
+     */
+    bool ReadMembers(const JsonField *aFields, size_t aCount);
+
+    /**
+     * This method returns a description of the first error.
+     *
+     */
+    const char *GetError(void) const { return mError; }
+
+private:
+    enum
+    {
+        kMaxDepth = 32,
+    };
+
+    enum State
+    {
+        kStateValue,
+        kStateFirstValue,  ///< A value or the end of an array.
+        kStateKey,
+        kStateFirstKey,    ///< A key or the end of an object.
+        kStateCommaOrEnd,
+        kStateDone,
+    };
+
+    Token SetError(const char *aError);
+    Token BeginContainer(bool aIsObject);
+    Token EndContainer(void);
+    Token ReadValue(void);
+    Token ReadKey(void);
+    Token ReadNumber(void);
+    Token ReadLiteral(const char *aLiteral, Token aToken);
+    bool ReadString(void);
+    bool ReadField(const JsonField &aField);
+    void SkipSpaces(void);
+    void AfterValue(void);
+    bool IsInObject(void) const { return (mObjectBits >> (mDepth - 1)) & 1; }
+
+    const char *mCursor;
+    const char *mEnd;
+    const char *mNumber;
+    size_t      mNumberLength;
+    std::string mString;
+    Token       mToken;
+    State       mState;
+    uint32_t    mObjectBits;  ///< One bit per level, set for objects and cleared for arrays.
+    uint8_t     mDepth;
+    const char *mError;
+};
+
+} //namespace Utils
+} //namespace ot
+
+#endif  // JSON_HPP_
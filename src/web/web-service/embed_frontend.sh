@@ -0,0 +1,150 @@
+#!/bin/sh
+#
+#  Copyright (c) 2017, The OpenThread Authors.
+#  All rights reserved.
+#
+#  Redistribution and use in source and binary forms, with or without
+#  modification, are permitted provided that the following conditions are met:
+#  1. Redistributions of source code must retain the above copyright
+#     notice, this list of conditions and the following disclaimer.
+#  2. Redistributions in binary form must reproduce the above copyright
+#     notice, this list of conditions and the following disclaimer in the
+#     documentation and/or other materials provided with the distribution.
+#  3. Neither the name of the copyright holder nor the
+#     names of its contributors may be used to endorse or promote products
+#     derived from this software without specific prior written permission.
+#
+#  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+#  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+#  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+#  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+#  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+#  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+#  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+#  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+#  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+#  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+#  POSSIBILITY OF SUCH DAMAGE.
+#
+#   Description:
+#       This script generates a C++ source embedding the frontend files, each
+#       with a gzip variant and an entity tag, so otbr-web serves them without
+#       reading the disk.
+#
+#   Usage:
+#       embed_frontend.sh OUTPUT ROOT FILE...
+#
+#       Each FILE is a path relative to ROOT, or PATH=SOURCE to serve the
+#       content of SOURCE at PATH.
+#
+
+set -e
+
+OUTPUT="$1"
+ROOT="$2"
+shift 2
+
+TMP_GZIP="$OUTPUT.gz.tmp"
+
+# Prints the content of a file as a C array initializer.
+dump_array()
+{
+    od -An -v -tx1 "$1" | sed -e 's/  */ /g' -e 's/^ //' -e '/^$/d' -e 's/\([0-9a-f][0-9a-f]\)/0x\1,/g' -e 's/^/    /'
+}
+
+# Prints the entity tag of a file, the same as StaticFileCache computes.
+etag()
+{
+    sha256sum "$1" | cut -c1-32 | tr a-f A-F
+}
+
+is_compressible()
+{
+    case "$1" in
+    *.html | *.js | *.css | *.json | *.svg | *.map | *.txt | *.ico | *.ttf)
+        return 0
+        ;;
+    esac
+    return 1
+}
+
+# Prints the request path of a FILE argument.
+file_path()
+{
+    echo "${1%%=*}"
+}
+
+# Prints the file holding the content of a FILE argument.
+file_source()
+{
+    case "$1" in
+    *=*)
+        echo "${1#*=}"
+        ;;
+    *)
+        echo "$ROOT/$1"
+        ;;
+    esac
+}
+
+{
+    echo "/* Generated by embed_frontend.sh, do not edit. */"
+    echo
+    echo "#include \"web-service/frontend_files.hpp\""
+    echo
+    echo "namespace ot {"
+    echo "namespace Web {"
+    echo
+
+    index=0
+    for file in "$@"; do
+        source=$(file_source "$file")
+        echo "static constexpr unsigned char kContent$index[] = {"
+        dump_array "$source"
+        echo "};"
+        echo
+
+        gzip_size=0
+        if is_compressible "$(file_path "$file")"; then
+            # -n keeps the name and time stamp out so the output is reproducible.
+            gzip -9 -n -c "$source" > "$TMP_GZIP"
+            gzip_size=$(wc -c < "$TMP_GZIP")
+            if [ "$gzip_size" -lt "$(wc -c < "$source")" ]; then
+                echo "static constexpr unsigned char kGzipContent$index[] = {"
+                dump_array "$TMP_GZIP"
+                echo "};"
+                echo
+            else
+                gzip_size=0
+            fi
+        fi
+        eval "gzip_size_$index=$gzip_size"
+        index=$((index + 1))
+    done
+
+    echo "const EmbeddedFile kFrontendFiles[] ="
+    echo "{"
+
+    index=0
+    for file in "$@"; do
+        tag=$(etag "$(file_source "$file")")
+        eval "gzip_size=\$gzip_size_$index"
+        if [ "$gzip_size" -ne 0 ]; then
+            gzip_content="kGzipContent$index, sizeof(kGzipContent$index), \"\\\"$tag-gz\\\"\""
+        else
+            gzip_content="NULL, 0, NULL"
+        fi
+        echo "    { \"/$(file_path "$file")\", kContent$index, sizeof(kContent$index), $gzip_content, \"\\\"$tag\\\"\" },"
+        index=$((index + 1))
+    done
+
+    echo "};"
+    echo
+    echo "const size_t kFrontendFilesCount = sizeof(kFrontendFiles) / sizeof(kFrontendFiles[0]);"
+    echo
+    echo "} //namespace Web"
+    echo "} //namespace ot"
+} > "$OUTPUT.tmp"
+
+rm -f "$TMP_GZIP"
+mv "$OUTPUT.tmp" "$OUTPUT"
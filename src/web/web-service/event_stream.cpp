@@ -0,0 +1,217 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the Server-Sent Events stream of the web service
+ */
+
+#include "event_stream.hpp"
+
+#include <algorithm>
+
+#include <syslog.h>
+
+#define OT_EVENT_STREAM_HEADER "HTTP/1.1 200 OK\r\n" \
+    "Content-Type: text/event-stream\r\n"            \
+    "Cache-Control: no-cache\r\n"                    \
+    "\r\n"
+#define OT_EVENT_STREAM_RETRY "retry: 3000\n\n"
+#define OT_EVENT_STREAM_HEARTBEAT ":\n"
+
+namespace ot {
+namespace Web {
+
+EventStream::EventStream(HttpServer &aServer) :
+    mServer(aServer),
+    mStrand(*aServer.io_service),
+    mHeartbeatTimer(*aServer.io_service),
+    mSubscriberCount(0)
+{
+}
+
+std::string EventStream::Format(const char *aEvent, const std::string &aData)
+{
+    std::string event = "event: ";
+    size_t      start = 0;
+
+    event += aEvent;
+    event += "\n";
+
+    // Every line of the data needs its own field, and a trailing newline is dropped.
+    while (start < aData.size())
+    {
+        size_t end = aData.find('\n', start);
+
+        if (end == std::string::npos)
+        {
+            end = aData.size();
+        }
+        event += "data: ";
+        event.append(aData, start, end - start);
+        event += "\n";
+        start = end + 1;
+    }
+
+    event += "\n";
+    return event;
+}
+
+void EventStream::Subscribe(const std::shared_ptr<HttpServer::Response> &aResponse, const std::string &aInitialEvent)
+{
+    std::shared_ptr<Subscriber> subscriber = std::make_shared<Subscriber>();
+
+    subscriber->mResponse = aResponse;
+    subscriber->mPending = OT_EVENT_STREAM_HEADER OT_EVENT_STREAM_RETRY + aInitialEvent;
+    subscriber->mIsSending = false;
+
+    // The stream ends only when the connection does, however long it stays idle.
+    aResponse->close_connection_after_response = true;
+    aResponse->cancel_timeout();
+
+    mStrand.dispatch([this, subscriber]() {
+                mSubscribers.push_back(subscriber);
+                mSubscriberCount = mSubscribers.size();
+                if (mSubscribers.size() == 1)
+                {
+                    StartHeartbeat();
+                }
+                Send(subscriber);
+                WaitForClose(subscriber);
+            });
+}
+
+void EventStream::Publish(const char *aEvent, const std::string &aData)
+{
+    std::string event = Format(aEvent, aData);
+
+    mStrand.post([this, event]() {
+                Deliver(event);
+            });
+}
+
+void EventStream::Deliver(const std::string &aEvent)
+{
+    std::list<std::shared_ptr<Subscriber> > subscribers(mSubscribers);
+
+    for (std::list<std::shared_ptr<Subscriber> >::iterator it = subscribers.begin(); it != subscribers.end(); ++it)
+    {
+        std::shared_ptr<Subscriber> &subscriber = *it;
+
+        if (subscriber->mPending.size() + aEvent.size() > kMaxPendingSize)
+        {
+            syslog(LOG_WARNING, "event stream client is too slow, dropped");
+            Remove(subscriber);
+            continue;
+        }
+
+        subscriber->mPending += aEvent;
+        Send(subscriber);
+    }
+}
+
+void EventStream::Send(const std::shared_ptr<Subscriber> &aSubscriber)
+{
+    if (aSubscriber->mIsSending || aSubscriber->mPending.empty())
+    {
+        return;
+    }
+
+    *aSubscriber->mResponse << aSubscriber->mPending;
+    aSubscriber->mPending.clear();
+    aSubscriber->mIsSending = true;
+
+    mServer.send(aSubscriber->mResponse, mStrand.wrap([this, aSubscriber](const boost::system::error_code &aError) {
+                aSubscriber->mIsSending = false;
+                if (aError)
+                {
+                    Remove(aSubscriber);
+                }
+                else
+                {
+                    Send(aSubscriber);
+                }
+            }));
+}
+
+void EventStream::WaitForClose(const std::shared_ptr<Subscriber> &aSubscriber)
+{
+    // Clients send nothing after the request, so a read only ends when the connection does.
+    aSubscriber->mResponse->get_socket()->async_read_some(
+        boost::asio::buffer(aSubscriber->mReadBuffer),
+        mStrand.wrap([this, aSubscriber](const boost::system::error_code &aError, size_t) {
+                if (aError)
+                {
+                    Remove(aSubscriber);
+                }
+                else
+                {
+                    WaitForClose(aSubscriber);
+                }
+            }));
+}
+
+void EventStream::Remove(const std::shared_ptr<Subscriber> &aSubscriber)
+{
+    std::list<std::shared_ptr<Subscriber> >::iterator it =
+        std::find(mSubscribers.begin(), mSubscribers.end(), aSubscriber);
+    boost::system::error_code error;
+
+    if (it == mSubscribers.end())
+    {
+        return;
+    }
+
+    mSubscribers.erase(it);
+    mSubscriberCount = mSubscribers.size();
+
+    // Closing the socket also ends the pending read, which holds the subscriber.
+    aSubscriber->mResponse->get_socket()->shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
+    aSubscriber->mResponse->get_socket()->close(error);
+}
+
+void EventStream::StartHeartbeat(void)
+{
+    mHeartbeatTimer.expires_from_now(boost::posix_time::seconds(static_cast<long>(kHeartbeatInterval)));
+    mHeartbeatTimer.async_wait(mStrand.wrap([this](const boost::system::error_code &aError) {
+                if (aError)
+                {
+                    return;
+                }
+
+                // A write to a client that is gone fails, which removes it.
+                Deliver(OT_EVENT_STREAM_HEARTBEAT);
+                if (!mSubscribers.empty())
+                {
+                    StartHeartbeat();
+                }
+            }));
+}
+
+} //namespace Web
+} //namespace ot
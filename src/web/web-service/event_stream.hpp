@@ -0,0 +1,142 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the Server-Sent Events stream of the web service
+ */
+
+#ifndef EVENT_STREAM_HPP
+#define EVENT_STREAM_HPP
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
+#include <server_http.hpp>
+
+namespace ot {
+namespace Web {
+
+typedef SimpleWeb::Server<SimpleWeb::HTTP> HttpServer;
+
+/**
+ * This class fans out events to every connected EventSource client.
+ *
+ * Subscribers are only touched on a strand of the server io_service, so events can be
+ * published from any thread. A client that falls too far behind is dropped, and will
+ * reconnect by itself. A comment is sent periodically so idle streams are kept open
+ * through proxies and dead clients are found.
+ *
+ */
+class EventStream
+{
+public:
+    /**
+     * The constructor of the event stream.
+     *
+     * @param[in]  aServer  A reference to the HTTP server, whose io_service must already be set.
+     *
+     */
+    explicit EventStream(HttpServer &aServer);
+
+    /**
+     * This method turns a response into an event stream and keeps it open.
+     *
+     * @param[in]  aResponse      A reference to the response of the /events request.
+     * @param[in]  aInitialEvent  An event already formatted by Format() sent only to this client.
+     *
+     */
+    void Subscribe(const std::shared_ptr<HttpServer::Response> &aResponse, const std::string &aInitialEvent);
+
+    /**
+     * This method sends an event to every subscriber.
+     *
+     * @param[in]  aEvent  A pointer to the event name.
+     * @param[in]  aData   The event data, usually a JSON document.
+     *
+     */
+    void Publish(const char *aEvent, const std::string &aData);
+
+    /**
+     * This method formats an event in the text/event-stream format.
+     *
+     * @param[in]  aEvent  A pointer to the event name.
+     * @param[in]  aData   The event data, which may span several lines.
+     *
+     * @returns The formatted event.
+     *
+     */
+    static std::string Format(const char *aEvent, const std::string &aData);
+
+    /**
+     * This method returns the number of connected clients, from any thread.
+     *
+     * A client is known to be gone once it closes the connection or sending to it fails.
+     *
+     * @returns The number of subscribers.
+     *
+     */
+    size_t GetSubscriberCount(void) const { return mSubscriberCount; }
+
+private:
+    enum
+    {
+        kMaxPendingSize    = 64 * 1024, ///< Bytes queued for one client before it is dropped.
+        kHeartbeatInterval = 15,        ///< Seconds between two comments sent to every client.
+    };
+
+    struct Subscriber
+    {
+        std::shared_ptr<HttpServer::Response> mResponse;
+        std::string                           mPending;
+        bool                                  mIsSending;
+        char                                  mReadBuffer[64];
+    };
+
+    void Deliver(const std::string &aEvent);
+    void Send(const std::shared_ptr<Subscriber> &aSubscriber);
+    void WaitForClose(const std::shared_ptr<Subscriber> &aSubscriber);
+    void Remove(const std::shared_ptr<Subscriber> &aSubscriber);
+    void StartHeartbeat(void);
+
+    HttpServer                             &mServer;
+    boost::asio::io_service::strand         mStrand;
+    boost::asio::deadline_timer             mHeartbeatTimer;
+    std::list<std::shared_ptr<Subscriber> > mSubscribers;
+    std::atomic<size_t>                     mSubscriberCount;
+};
+
+} //namespace Web
+} //namespace ot
+
+#endif  //EVENT_STREAM_HPP
@@ -31,19 +31,19 @@
         .module('StarterApp', ['ngMaterial'])
         .controller('AppCtrl', AppCtrl)
         .service('sharedProperties', function() {
-            var index = 0;
+            var network = null;
 
             return {
-                getIndex: function() {
-                    return index;
+                getNetwork: function() {
+                    return network;
                 },
-                setIndex: function(value) {
-                    index = value;
+                setNetwork: function(value) {
+                    network = value;
                 },
             };
         });
 
-    function AppCtrl($scope, $http, $mdDialog, $interval, sharedProperties) {
+    function AppCtrl($scope, $rootScope, $http, $mdDialog, $interval, sharedProperties) {
         $scope.menu = [{
                 title: 'Home',
                 icon: 'home',
@@ -89,8 +89,87 @@
 
         $scope.headerTitle = 'Home';
         $scope.status = [];
+        $scope.networksInfo = [];
 
         $scope.isLoading = false;
+        $rootScope.progress = '';
+
+        $scope.setStatus = function(name, value) {
+            for (var i = 0; i < $scope.status.length; i++) {
+                if ($scope.status[i].name == name) {
+                    $scope.status[i].value = value;
+                    return;
+                }
+            }
+            $scope.status.push({
+                name: name,
+                value: value,
+                icon: 'res/img/icon-info.png',
+            });
+        };
+
+        // Live state is pushed by the server, so nothing here polls.
+        var events = new EventSource('/events');
+
+        events.addEventListener('properties', function(event) {
+            var data = JSON.parse(event.data);
+            if (data.error == 0) {
+                $scope.$apply(function() {
+                    $scope.status = [];
+                    for (var name in data.result) {
+                        $scope.setStatus(name, data.result[name]);
+                    }
+                });
+            }
+        });
+
+        events.addEventListener('property', function(event) {
+            var data = JSON.parse(event.data);
+            $scope.$apply(function() {
+                $scope.setStatus(data.name, data.value);
+            });
+        });
+
+        events.addEventListener('beacon', function(event) {
+            var data = JSON.parse(event.data);
+            if (!$scope.isLoading) {
+                return;
+            }
+            $scope.$apply(function() {
+                for (var i = 0; i < $scope.networksInfo.length; i++) {
+                    if ($scope.networksInfo[i].xp == data.xp && $scope.networksInfo[i].ha == data.ha) {
+                        return;
+                    }
+                }
+                $scope.networksInfo.push(data);
+            });
+        });
+
+        events.addEventListener('progress', function(event) {
+            var data = JSON.parse(event.data);
+            $scope.$apply(function() {
+                $rootScope.progress = data.step == 'done' ? '' : data.action + ': ' + data.step;
+            });
+        });
+
+        // Cached results come back at once, a fresh scan is announced by a 'scan' event.
+        $scope.loadNetworks = function(refresh) {
+            $http.get('/available_network' + (refresh ? '?refresh=1' : '')).then(function(response) {
+                if (response.data.error == 0) {
+                    $scope.networksInfo = response.data.result;
+                    $scope.isLoading = response.data.scanning;
+                } else {
+                    $scope.isLoading = false;
+                    $scope.showScanAlert(event);
+                }
+            });
+        };
+
+        events.addEventListener('scan', function(event) {
+            if ($scope.menu[1].show) {
+                $scope.loadNetworks(false);
+            }
+        });
 
         $scope.showScanAlert = function(ev) {
             $mdDialog.show(
@@ -112,28 +191,14 @@
             }
             $scope.menu[index].show = true;
             if (index == 1) {
-                $scope.isLoading = true;
-                $http.get('/available_network').then(function(response) {
-                    $scope.isLoading = false;
-                    if (response.data.error == 0) {
-                        $scope.networksInfo = response.data.result;
-                    } else {
-                        $scope.showScanAlert(event);
-                    }
-                });
+                $scope.loadNetworks(true);
             }
-            if (index == 3) {
+            if (index == 3 && $scope.status.length == 0) {
+                // Only needed until the event stream delivers the first snapshot.
                 $http.get('/get_properties').then(function(response) {
-                    console.log(response);
                     if (response.data.error == 0) {
-                        var statusJson = response.data.result;
-                        $scope.status = [];
-                        for (var i = 0; i < Object.keys(statusJson).length; i++) {
-                            $scope.status.push({
-                                name: Object.keys(statusJson)[i],
-                                value: statusJson[Object.keys(statusJson)[i]],
-                                icon: 'res/img/icon-info.png',
-                            });
+                        for (var name in response.data.result) {
+                            $scope.setStatus(name, response.data.result[name]);
                         }
                     }
                 });
@@ -141,7 +206,7 @@
         };
 
         $scope.showJoinDialog = function(ev, index) {
-            sharedProperties.setIndex(index);
+            sharedProperties.setNetwork($scope.networksInfo[index]);
             $scope.index = index;
             $mdDialog.show({
                 controller: DialogController,
@@ -154,7 +219,7 @@
         };
 
         function DialogController($scope, $mdDialog, $http, $interval, sharedProperties) {
-            var index = sharedProperties.getIndex();
+            var network = sharedProperties.getNetwork();
             $scope.isDisplay = false;
             $scope.thread = {
                 networkKey: '00112233445566778899aabbccddeeff',
@@ -184,7 +249,8 @@
                     networkKey: $scope.thread.networkKey,
                     prefix: $scope.thread.prefix,
                     defaultRoute: $scope.thread.defaultRoute,
-                    index: index,
+                    xp: network.xp,
+                    ha: network.ha,
                 };
                 var httpRequest = $http({
                     method: 'POST',
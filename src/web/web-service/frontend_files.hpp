@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file includes definitions of the frontend files compiled into otbr-web.
+ */
+
+#ifndef FRONTEND_FILES_HPP
+#define FRONTEND_FILES_HPP
+
+#include <stddef.h>
+
+namespace ot {
+namespace Web {
+
+/**
+ * This structure represents a frontend file compiled into the binary.
+ *
+ */
+struct EmbeddedFile
+{
+    const char          *mPath;        ///< The request path, starting with '/'.
+    const unsigned char *mContent;     ///< The raw content.
+    size_t               mLength;      ///< The length of the raw content.
+    const unsigned char *mGzipContent; ///< The gzip encoded content, NULL if compression does not pay off.
+    size_t               mGzipLength;  ///< The length of the gzip encoded content.
+    const char          *mGzipETag;    ///< The quoted entity tag of the gzip encoded content.
+    const char          *mETag;        ///< The quoted entity tag of the raw content.
+};
+
+/**
+ * The frontend files, generated by embed_frontend.sh at build time.
+ *
+ */
+extern const EmbeddedFile kFrontendFiles[];
+
+/**
+ * The number of entries in kFrontendFiles.
+ *
+ */
+extern const size_t kFrontendFilesCount;
+
+} //namespace Web
+} //namespace ot
+
+#endif  //FRONTEND_FILES_HPP
@@ -0,0 +1,215 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the in-memory snapshot of Thread Network properties
+ */
+
+#include "property_snapshot.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+#include "../utils/json.hpp"
+
+namespace ot {
+namespace Web {
+
+const char *const PropertySnapshot::sProperties[kPropertiesCount] =
+{
+    kWPANTUNDProperty_NCPState,
+    kWPANTUNDProperty_DaemonEnabled,
+    kWPANTUNDProperty_NCPVersion,
+    kWPANTUNDProperty_DaemonVersion,
+    kWPANTUNDProperty_ConfigNCPDriverName,
+    kWPANTUNDProperty_NCPHardwareAddress,
+    kWPANTUNDProperty_NCPChannel,
+    kWPANTUNDProperty_NetworkNodeType,
+    kWPANTUNDProperty_NetworkName,
+    kWPANTUNDProperty_NetworkXPANID,
+    kWPANTUNDProperty_NetworkPANID,
+    kWPANTUNDProperty_IPv6LinkLocalAddress,
+    kWPANTUNDProperty_IPv6MeshLocalAddress,
+    kWPANTUNDProperty_IPv6MeshLocalPrefix,
+};
+
+PropertySnapshot::PropertySnapshot(void) :
+    mError(ot::Dbus::kWpantundStatus_Ok),
+    mIsValid(false),
+    mIsDirty(true),
+    mEpoch(static_cast<uint32_t>(time(NULL))),
+    mVersion(0)
+{
+    memset(mValues, 0, sizeof(mValues));
+    memset(mIfName, 0, sizeof(mIfName));
+    for (int i = 0; i < kPropertiesCount; i++)
+    {
+        mValues[i].mName = sProperties[i];
+    }
+}
+
+void PropertySnapshot::SetInterfaceName(const char *aIfName)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    strncpy(mIfName, aIfName, sizeof(mIfName) - 1);
+    mIsValid = false;
+}
+
+void PropertySnapshot::Invalidate(void)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mIsValid = false;
+}
+
+bool PropertySnapshot::IsValid(void)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mIsValid;
+}
+
+void PropertySnapshot::Update(const char *aName, const char *aValue)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mIsValid)
+    {
+        return;
+    }
+
+    for (int i = 0; i < kPropertiesCount; i++)
+    {
+        if (strcmp(mValues[i].mName, aName) != 0)
+        {
+            continue;
+        }
+
+        if (mValues[i].mStatus != ot::Dbus::kWpantundStatus_Ok ||
+            strncmp(mValues[i].mValue, aValue, sizeof(mValues[i].mValue)) != 0)
+        {
+            mValues[i].mStatus = ot::Dbus::kWpantundStatus_Ok;
+            strncpy(mValues[i].mValue, aValue, sizeof(mValues[i].mValue) - 1);
+            mVersion++;
+            mIsDirty = true;
+        }
+        break;
+    }
+}
+
+void PropertySnapshot::Get(std::string &aJson, std::string &aETag)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (!mIsValid)
+    {
+        Refresh();
+    }
+
+    if (mIsDirty)
+    {
+        Serialize();
+    }
+
+    aJson = mJson;
+    aETag = mETag;
+}
+
+void PropertySnapshot::Refresh(void)
+{
+    ot::Dbus::WPANController wpanController;
+    int                      failedCount = 0;
+
+    wpanController.SetInterfaceName(mIfName);
+    mError = wpanController.GetProperties(mValues, kPropertiesCount);
+
+    for (int i = 0; i < kPropertiesCount; i++)
+    {
+        if (mValues[i].mStatus != ot::Dbus::kWpantundStatus_Ok)
+        {
+            failedCount++;
+        }
+    }
+
+    // A partial snapshot is still useful, so only report an error when nothing could be fetched.
+    if (mError == ot::Dbus::kWpantundStatus_GetFailed && failedCount < kPropertiesCount)
+    {
+        mError = ot::Dbus::kWpantundStatus_Ok;
+    }
+
+    // Keep retrying on every read until wpantund answers.
+    mIsValid = (mError == ot::Dbus::kWpantundStatus_Ok);
+    mVersion++;
+    mIsDirty = true;
+
+    if (!mIsValid)
+    {
+        syslog(LOG_WARNING, "failed to load properties: %d", mError);
+    }
+}
+
+void PropertySnapshot::Serialize(void)
+{
+    ot::Utils::JsonWriter writer(mJson);
+    char                  etag[32];
+    bool                  hasFailed = false;
+
+    mJson.clear();
+    writer.BeginObject().Key("result").BeginObject();
+    for (int i = 0; i < kPropertiesCount; i++)
+    {
+        writer.Key(mValues[i].mName).String(mValues[i].mValue);
+        hasFailed = hasFailed || mValues[i].mStatus != ot::Dbus::kWpantundStatus_Ok;
+    }
+    writer.EndObject();
+
+    if (hasFailed)
+    {
+        writer.Key("failed").BeginObject();
+        for (int i = 0; i < kPropertiesCount; i++)
+        {
+            if (mValues[i].mStatus != ot::Dbus::kWpantundStatus_Ok)
+            {
+                writer.Key(mValues[i].mName).Int(mValues[i].mStatus);
+            }
+        }
+        writer.EndObject();
+    }
+    writer.Key("error").Int(mError).EndObject();
+
+    snprintf(etag, sizeof(etag), "\"%x-%x\"", mEpoch, mVersion);
+    mETag = etag;
+    mIsDirty = false;
+}
+
+} //namespace Web
+} //namespace ot
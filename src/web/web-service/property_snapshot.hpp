@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the in-memory snapshot of Thread Network properties
+ */
+
+#ifndef PROPERTY_SNAPSHOT_HPP
+#define PROPERTY_SNAPSHOT_HPP
+
+#include <mutex>
+#include <string>
+
+#include <net/if.h>
+#include <stdint.h>
+
+#include "../wpan-controller/wpan_controller.hpp"
+
+namespace ot {
+namespace Web {
+
+/**
+ * This class keeps the latest values of the properties shown on the status panel.
+ *
+ * The snapshot is loaded from wpantund once and then kept current by property changed
+ * signals, so reading it costs no DBus traffic. Every change bumps the version, which
+ * is exposed as a strong ETag.
+ *
+ */
+class PropertySnapshot
+{
+public:
+    PropertySnapshot(void);
+
+    /**
+     * This method sets the interface name of the wpantund.
+     *
+     * @param[in]  aIfName  A pointer to the interface name of the wpantund.
+     *
+     */
+    void SetInterfaceName(const char *aIfName);
+
+    /**
+     * This method drops the snapshot so the next read loads it from wpantund again.
+     *
+     */
+    void Invalidate(void);
+
+    /**
+     * This method indicates whether the snapshot can be read without DBus calls.
+     *
+     * @retval TRUE   The snapshot is loaded.
+     * @retval FALSE  The next read loads the snapshot from wpantund.
+     *
+     */
+    bool IsValid(void);
+
+    /**
+     * This method updates one property. Properties not in the snapshot are ignored.
+     *
+     * @param[in]  aName   A pointer to the property name.
+     * @param[in]  aValue  A pointer to the property value.
+     *
+     */
+    void Update(const char *aName, const char *aValue);
+
+    /**
+     * This method gets the snapshot as JSON, loading it from wpantund if needed.
+     *
+     * @param[out]  aJson  The JSON body of the snapshot.
+     * @param[out]  aETag  The strong entity tag of the snapshot, quoted.
+     *
+     */
+    void Get(std::string &aJson, std::string &aETag);
+
+    /**
+     * This method returns the names of the properties in the snapshot.
+     *
+     * @returns A pointer to the kPropertiesCount names.
+     *
+     */
+    static const char *const *GetPropertyNames(void) { return sProperties; }
+
+    enum
+    {
+        kPropertiesCount = 14, ///< The number of properties in the snapshot.
+    };
+
+private:
+
+    void Refresh(void);
+    void Serialize(void);
+
+    static const char *const sProperties[kPropertiesCount];
+
+    std::mutex                  mMutex;
+    ot::Dbus::WpanPropertyValue mValues[kPropertiesCount];
+    int                         mError;
+    bool                        mIsValid;
+    bool                        mIsDirty;
+    uint32_t                    mEpoch;
+    uint32_t                    mVersion;
+    std::string                 mJson;
+    std::string                 mETag;
+    char                        mIfName[IFNAMSIZ];
+};
+
+} //namespace Web
+} //namespace ot
+
+#endif  //PROPERTY_SNAPSHOT_HPP
@@ -0,0 +1,290 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the builder of HTTP responses of the web service
+ */
+
+#include "response_builder.hpp"
+
+#include <sstream>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <boost/algorithm/string.hpp>
+#include <zlib.h>
+
+#include "common/code_utils.hpp"
+
+#define OT_HTTP_COMPRESS_THRESHOLD 1024 // Bodies smaller than this fit a few packets, compressing saves little.
+#define OT_HTTP_DEFAULT_STATUS "200 OK"
+
+namespace ot {
+namespace Web {
+
+/**
+ * This class keeps a deflate stream per thread, so its state is only allocated once.
+ *
+ */
+class Deflater
+{
+public:
+    explicit Deflater(int aWindowBits) :
+        mWindowBits(aWindowBits),
+        mIsInitialized(false)
+    {
+        memset(&mStream, 0, sizeof(mStream));
+    }
+
+    ~Deflater(void)
+    {
+        if (mIsInitialized)
+        {
+            deflateEnd(&mStream);
+        }
+    }
+
+    bool Compress(const std::string &aInput, std::string &aOutput)
+    {
+        bool ret = false;
+
+        if (mIsInitialized)
+        {
+            VerifyOrExit(deflateReset(&mStream) == Z_OK);
+        }
+        else
+        {
+            VerifyOrExit(deflateInit2(&mStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, mWindowBits, 8,
+                                      Z_DEFAULT_STRATEGY) == Z_OK);
+            mIsInitialized = true;
+        }
+
+        aOutput.resize(deflateBound(&mStream, aInput.size()));
+        mStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(aInput.data()));
+        mStream.avail_in = static_cast<uInt>(aInput.size());
+        mStream.next_out = reinterpret_cast<Bytef *>(&aOutput[0]);
+        mStream.avail_out = static_cast<uInt>(aOutput.size());
+
+        ret = (deflate(&mStream, Z_FINISH) == Z_STREAM_END);
+        aOutput.resize(mStream.total_out);
+
+exit:
+        return ret;
+    }
+
+private:
+    z_stream mStream;
+    int      mWindowBits;
+    bool     mIsInitialized;
+};
+
+ResponseBuilder::ResponseBuilder(HttpServer::Response &aResponse, const HttpServer::Request &aRequest) :
+    mResponse(aResponse),
+    mRequest(aRequest),
+    mStatus(OT_HTTP_DEFAULT_STATUS),
+    mIsKeepAlive(aRequest.http_version >= "1.1"),
+    mIsHttp11(aRequest.http_version >= "1.1")
+{
+    auto range = aRequest.header.equal_range("Connection");
+
+    // The same rules the server applies when deciding to read the next request.
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (boost::algorithm::iequals(it->second, "close"))
+        {
+            mIsKeepAlive = false;
+            break;
+        }
+        else if (boost::algorithm::iequals(it->second, "keep-alive"))
+        {
+            mIsKeepAlive = true;
+            break;
+        }
+    }
+}
+
+ResponseBuilder &ResponseBuilder::SetStatus(const char *aStatus)
+{
+    mStatus = aStatus;
+    return *this;
+}
+
+ResponseBuilder &ResponseBuilder::AddHeader(const char *aName, const std::string &aValue)
+{
+    mHeaders.append(aName).append(": ").append(aValue).append("\r\n");
+    return *this;
+}
+
+ResponseBuilder &ResponseBuilder::SetETag(const std::string &aETag)
+{
+    mETag = aETag;
+    return *this;
+}
+
+void ResponseBuilder::Send(const char *aContentType, const std::string &aBody)
+{
+    static thread_local Deflater sGzip(15 + 16);
+    static thread_local Deflater sDeflate(15);
+
+    std::string compressed;
+    const char *coding = NULL;
+
+    if (aBody.size() >= OT_HTTP_COMPRESS_THRESHOLD)
+    {
+        double gzip = GetCodingQuality(mRequest, "gzip");
+        double deflate = GetCodingQuality(mRequest, "deflate");
+
+        // The response depends on Accept-Encoding whether it ends up compressed or not.
+        AddHeader("Vary", "Accept-Encoding");
+
+        if (gzip > 0 && gzip >= deflate && sGzip.Compress(aBody, compressed))
+        {
+            coding = "gzip";
+        }
+        else if (deflate > 0 && sDeflate.Compress(aBody, compressed))
+        {
+            coding = "deflate";
+        }
+
+        if (coding != NULL && compressed.size() >= aBody.size())
+        {
+            coding = NULL;
+        }
+    }
+
+    if (coding != NULL)
+    {
+        if (!mETag.empty() && !boost::algorithm::starts_with(mETag, "W/"))
+        {
+            mETag.insert(0, "W/");
+        }
+        WriteHeaders(aContentType, compressed.size(), coding);
+        mResponse.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+    }
+    else
+    {
+        WriteHeaders(aContentType, aBody.size(), NULL);
+        mResponse.write(aBody.data(), static_cast<std::streamsize>(aBody.size()));
+    }
+}
+
+void ResponseBuilder::Send(void)
+{
+    WriteHeaders(NULL, 0, NULL);
+}
+
+void ResponseBuilder::SendHeaders(const char *aContentType, size_t aLength)
+{
+    WriteHeaders(aContentType, aLength, NULL);
+}
+
+void ResponseBuilder::WriteHeaders(const char *aContentType, size_t aLength, const char *aCoding)
+{
+    mResponse << "HTTP/1.1 " << mStatus << "\r\n" << mHeaders;
+
+    if (!mETag.empty())
+    {
+        mResponse << "ETag: " << mETag << "\r\n";
+    }
+
+    if (aCoding != NULL)
+    {
+        mResponse << "Content-Encoding: " << aCoding << "\r\n";
+    }
+
+    if (aContentType != NULL)
+    {
+        mResponse << "Content-Type: " << aContentType << "\r\n";
+    }
+
+    // 304 has the headers of the full response but no body, every other status needs the length to reuse the connection.
+    if (strncmp(mStatus, "304", 3) != 0)
+    {
+        mResponse << "Content-Length: " << aLength << "\r\n";
+    }
+
+    if (!mIsKeepAlive)
+    {
+        mResponse << "Connection: close\r\n";
+        mResponse.close_connection_after_response = true;
+    }
+    else if (!mIsHttp11)
+    {
+        mResponse << "Connection: keep-alive\r\n";
+    }
+
+    mResponse << "\r\n";
+}
+
+double ResponseBuilder::GetCodingQuality(const HttpServer::Request &aRequest, const char *aCoding)
+{
+    double quality = 0;
+    double wildcard = 0;
+    bool   isFound = false;
+    auto   range = aRequest.header.equal_range("Accept-Encoding");
+
+    for (auto it = range.first; it != range.second && !isFound; ++it)
+    {
+        std::istringstream codings(it->second);
+        std::string        coding;
+
+        while (std::getline(codings, coding, ',') && !isFound)
+        {
+            size_t      semicolon = coding.find(';');
+            std::string name = boost::algorithm::trim_copy(coding.substr(0, semicolon));
+            double      value = 1;
+
+            if (semicolon != std::string::npos)
+            {
+                std::string params = boost::algorithm::erase_all_copy(coding.substr(semicolon + 1), " ");
+
+                if (boost::algorithm::starts_with(params, "q="))
+                {
+                    value = strtod(params.c_str() + 2, NULL);
+                }
+            }
+
+            if (boost::algorithm::iequals(name, aCoding))
+            {
+                quality = value;
+                isFound = true;
+            }
+            else if (name == "*")
+            {
+                wildcard = value;
+            }
+        }
+    }
+
+    return isFound ? quality : wildcard;
+}
+
+} //namespace Web
+} //namespace ot
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the builder of HTTP responses of the web service
+ */
+
+#ifndef RESPONSE_BUILDER_HPP
+#define RESPONSE_BUILDER_HPP
+
+#include <string>
+
+#include <stddef.h>
+
+#include <server_http.hpp>
+
+namespace ot {
+namespace Web {
+
+typedef SimpleWeb::Server<SimpleWeb::HTTP> HttpServer;
+
+/**
+ * This class writes the status line, headers and body of a response.
+ *
+ * It keeps the connection open unless the client asked otherwise, so following and pipelined
+ * requests reuse it, and it compresses bodies larger than a threshold when the client accepts
+ * gzip or deflate.
+ *
+ */
+class ResponseBuilder
+{
+public:
+    /**
+     * The constructor of the response builder.
+     *
+     * @param[in]  aResponse  A reference to the response to write.
+     * @param[in]  aRequest   A reference to the request being answered, which must outlive the builder.
+     *
+     */
+    ResponseBuilder(HttpServer::Response &aResponse, const HttpServer::Request &aRequest);
+
+    /**
+     * This method sets the status, "200 OK" by default.
+     *
+     * @param[in]  aStatus  The status code followed by the reason phrase.
+     *
+     */
+    ResponseBuilder &SetStatus(const char *aStatus);
+
+    /**
+     * This method adds a header.
+     *
+     * Content-Type, Content-Length, Content-Encoding and Connection are written by the builder.
+     *
+     * @param[in]  aName   The name of the header.
+     * @param[in]  aValue  The value of the header.
+     *
+     */
+    ResponseBuilder &AddHeader(const char *aName, const std::string &aValue);
+
+    /**
+     * This method sets the entity tag.
+     *
+     * The tag is made weak when the body gets compressed, as the representation sent differs.
+     *
+     * @param[in]  aETag  The quoted entity tag.
+     *
+     */
+    ResponseBuilder &SetETag(const std::string &aETag);
+
+    /**
+     * This method writes a response with a body, compressing it if worthwhile.
+     *
+     * @param[in]  aContentType  The content type of the body.
+     * @param[in]  aBody         The body.
+     *
+     */
+    void Send(const char *aContentType, const std::string &aBody);
+
+    /**
+     * This method writes a response without a body, e.g. 304 Not Modified.
+     *
+     */
+    void Send(void);
+
+    /**
+     * This method writes the headers of a response whose body is written by the caller as is.
+     *
+     * @param[in]  aContentType  The content type of the body.
+     * @param[in]  aLength       The length of the body.
+     *
+     */
+    void SendHeaders(const char *aContentType, size_t aLength);
+
+    /**
+     * This method returns whether the client accepts a content coding.
+     *
+     * @param[in]  aRequest  A reference to the request.
+     * @param[in]  aCoding   The content coding, e.g. "gzip".
+     *
+     * @returns The quality value of the coding, 0 if it is not accepted.
+     *
+     */
+    static double GetCodingQuality(const HttpServer::Request &aRequest, const char *aCoding);
+
+private:
+    void WriteHeaders(const char *aContentType, size_t aLength, const char *aCoding);
+
+    HttpServer::Response      &mResponse;
+    const HttpServer::Request &mRequest;
+    const char                *mStatus;
+    std::string                mHeaders;
+    std::string                mETag;
+    bool                       mIsKeepAlive;
+    bool                       mIsHttp11;
+};
+
+} //namespace Web
+} //namespace ot
+
+#endif  //RESPONSE_BUILDER_HPP
@@ -0,0 +1,275 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the background scan service of the web service
+ */
+
+#include "scan_service.hpp"
+
+#include <chrono>
+
+#include <string.h>
+#include <syslog.h>
+
+#include "common/time.hpp"
+
+namespace ot {
+namespace Web {
+
+ScanService::ScanService(void) :
+    mIsRunning(false),
+    mIsRequested(false),
+    mIsScanning(false),
+    mLastScan(0),
+    mInterval(0),
+    mScanDoneHandler(NULL),
+    mScanDoneContext(NULL)
+{
+    memset(mIfName, 0, sizeof(mIfName));
+}
+
+ScanService::~ScanService(void)
+{
+    Stop();
+}
+
+void ScanService::SetScanDoneHandler(ScanDoneHandler aHandler, void *aContext)
+{
+    mScanDoneHandler = aHandler;
+    mScanDoneContext = aContext;
+}
+
+void ScanService::Start(const char *aIfName, unsigned aInterval)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mIsRunning)
+    {
+        return;
+    }
+
+    strncpy(mIfName, aIfName, sizeof(mIfName) - 1);
+    mInterval = aInterval;
+    mIsRunning = true;
+    mIsRequested = (aInterval != 0);
+    mThread = std::thread(&ScanService::Run, this);
+}
+
+void ScanService::Stop(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mIsRunning = false;
+        mCondition.notify_all();
+    }
+
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+void ScanService::Request(void)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mIsRequested = true;
+    mCondition.notify_all();
+}
+
+bool ScanService::IsScanning(void)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mIsRequested || mIsScanning;
+}
+
+uint64_t ScanService::GetAge(void)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mLastScan ? GetNow() - mLastScan : 0;
+}
+
+int ScanService::GetNetworks(size_t aOffset, size_t aLimit, std::vector<ot::Dbus::WpanNetworkInfo> &aNetworks)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t                      index = 0;
+
+    Expire(GetNow());
+    aNetworks.clear();
+
+    for (std::map<Key, Entry>::const_iterator it = mEntries.begin();
+         it != mEntries.end() && aNetworks.size() < aLimit; ++it, ++index)
+    {
+        if (index >= aOffset)
+        {
+            aNetworks.push_back(it->second.mNetwork);
+        }
+    }
+
+    return static_cast<int>(mEntries.size());
+}
+
+bool ScanService::Find(uint64_t aExtPanId, const uint8_t *aHardwareAddress, ot::Dbus::WpanNetworkInfo &aNetwork)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    bool                        found = false;
+
+    std::map<Key, Entry>::const_iterator it = mEntries.find(GetKey(aExtPanId, aHardwareAddress));
+
+    if (it != mEntries.end())
+    {
+        aNetwork = it->second.mNetwork;
+        found = true;
+    }
+
+    return found;
+}
+
+ScanService::Key ScanService::GetKey(uint64_t aExtPanId, const uint8_t *aHardwareAddress)
+{
+    uint64_t hardwareAddress = 0;
+
+    for (int i = 0; i < OT_HARDWARE_ADDRESS_SIZE; i++)
+    {
+        hardwareAddress = (hardwareAddress << 8) | aHardwareAddress[i];
+    }
+
+    return Key(aExtPanId, hardwareAddress);
+}
+
+void ScanService::Merge(const ot::Dbus::WpanNetworkInfo *aNetworks, int aCount, uint64_t aNow)
+{
+    for (int i = 0; i < aCount; i++)
+    {
+        const ot::Dbus::WpanNetworkInfo &network = aNetworks[i];
+        Key                              key = GetKey(network.mExtPanId, network.mHardwareAddress);
+        std::map<Key, Entry>::iterator   it = mEntries.find(key);
+
+        if (it == mEntries.end())
+        {
+            Entry entry;
+
+            entry.mNetwork = network;
+            entry.mLastSeen = aNow;
+            mEntries.insert(std::make_pair(key, entry));
+        }
+        else
+        {
+            // Keep the best RSSI heard, but let everything else follow the latest beacon.
+            int8_t rssi = it->second.mNetwork.mRssi;
+
+            it->second.mNetwork = network;
+            if (it->second.mLastSeen == aNow && rssi > network.mRssi)
+            {
+                it->second.mNetwork.mRssi = rssi;
+            }
+            it->second.mLastSeen = aNow;
+        }
+    }
+}
+
+void ScanService::Expire(uint64_t aNow)
+{
+    for (std::map<Key, Entry>::iterator it = mEntries.begin(); it != mEntries.end();)
+    {
+        if (aNow - it->second.mLastSeen > kEntryTimeout)
+        {
+            mEntries.erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void ScanService::Run(void)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    while (mIsRunning)
+    {
+        ot::Dbus::WPANController wpanController;
+        int                      ret;
+        int                      count;
+        uint64_t                 now;
+
+        if (!mIsRequested)
+        {
+            if (mInterval == 0)
+            {
+                mCondition.wait(lock);
+            }
+            else if (!mCondition.wait_for(lock, std::chrono::seconds(mInterval),
+                                          [this]() { return mIsRequested || !mIsRunning; }))
+            {
+                mIsRequested = true;
+            }
+            continue;
+        }
+
+        mIsRequested = false;
+        mIsScanning = true;
+        lock.unlock();
+
+        // Scanning does not require leaving the current network.
+        wpanController.SetInterfaceName(mIfName);
+        ret = wpanController.Scan();
+        now = GetNow();
+
+        lock.lock();
+        mIsScanning = false;
+        if (ret == ot::Dbus::kWpantundStatus_Ok || ret == ot::Dbus::kWpantundStatus_NetworkNotFound)
+        {
+            Merge(wpanController.GetScanNetworksInfo(), wpanController.GetScanNetworksInfoCount(), now);
+            mLastScan = now;
+            ret = ot::Dbus::kWpantundStatus_Ok;
+        }
+        else
+        {
+            syslog(LOG_WARNING, "scan failed: %d", ret);
+        }
+        Expire(now);
+        count = static_cast<int>(mEntries.size());
+
+        if (mScanDoneHandler != NULL)
+        {
+            lock.unlock();
+            mScanDoneHandler(mScanDoneContext, ret, count);
+            lock.lock();
+        }
+    }
+}
+
+} //namespace Web
+} //namespace ot
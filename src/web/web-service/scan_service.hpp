@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the background scan service of the web service
+ */
+
+#ifndef SCAN_SERVICE_HPP
+#define SCAN_SERVICE_HPP
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <net/if.h>
+#include <stdint.h>
+
+#include "../wpan-controller/wpan_controller.hpp"
+
+namespace ot {
+namespace Web {
+
+/**
+ * This function pointer is called on the scan thread after every scan.
+ *
+ * @param[in]  aContext  A pointer to application-specific context.
+ * @param[in]  aError    The result of the scan.
+ * @param[in]  aCount    The number of networks in the cache after the scan.
+ *
+ */
+typedef void (*ScanDoneHandler)(void *aContext, int aError, int aCount);
+
+/**
+ * This class scans for Thread Networks in the background and caches the results.
+ *
+ * Beacons are deduplicated by Extended PAN ID and hardware address, keeping the best RSSI,
+ * and a network is forgotten once it has not been heard for kEntryTimeout.
+ *
+ */
+class ScanService
+{
+public:
+    ScanService(void);
+    ~ScanService(void);
+
+    /**
+     * This method starts the scan thread.
+     *
+     * @param[in]  aIfName    A pointer to the interface name of the wpantund.
+     * @param[in]  aInterval  The interval of periodic scans in seconds, 0 to only scan on demand.
+     *
+     */
+    void Start(const char *aIfName, unsigned aInterval);
+
+    /**
+     * This method stops the scan thread, waiting for an ongoing scan to finish.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This method requests a scan as soon as possible without waiting for it.
+     *
+     */
+    void Request(void);
+
+    /**
+     * This method sets the handler called after every scan. It must be called before Start().
+     *
+     * @param[in]  aHandler  The handler to be called.
+     * @param[in]  aContext  A pointer to application-specific context.
+     *
+     */
+    void SetScanDoneHandler(ScanDoneHandler aHandler, void *aContext);
+
+    /**
+     * This method gets a page of the cached networks, ordered by Extended PAN ID and hardware address.
+     *
+     * @param[in]   aOffset    The index of the first network to return.
+     * @param[in]   aLimit     The maximum number of networks to return.
+     * @param[out]  aNetworks  The networks of the page.
+     *
+     * @returns The total number of cached networks.
+     *
+     */
+    int GetNetworks(size_t aOffset, size_t aLimit, std::vector<ot::Dbus::WpanNetworkInfo> &aNetworks);
+
+    /**
+     * This method finds a cached network.
+     *
+     * @param[in]   aExtPanId         The Extended PAN ID of the network.
+     * @param[in]   aHardwareAddress  A pointer to the hardware address of the network.
+     * @param[out]  aNetwork          The network found.
+     *
+     * @retval true   The network is found.
+     * @retval false  The network is not in the cache.
+     *
+     */
+    bool Find(uint64_t aExtPanId, const uint8_t *aHardwareAddress, ot::Dbus::WpanNetworkInfo &aNetwork);
+
+    /**
+     * This method indicates whether a scan is requested or ongoing.
+     *
+     * @returns Whether a scan is pending.
+     *
+     */
+    bool IsScanning(void);
+
+    /**
+     * This method returns the age of the cached results.
+     *
+     * @returns The milliseconds since the last successful scan, or 0 if there was none.
+     *
+     */
+    uint64_t GetAge(void);
+
+private:
+    enum
+    {
+        kEntryTimeout = 10 * 60 * 1000, ///< Milliseconds a network is kept after it was last heard.
+    };
+
+    struct Entry
+    {
+        ot::Dbus::WpanNetworkInfo mNetwork;
+        uint64_t                  mLastSeen;
+    };
+
+    typedef std::pair<uint64_t, uint64_t> Key;
+
+    static Key GetKey(uint64_t aExtPanId, const uint8_t *aHardwareAddress);
+    void Run(void);
+    void Merge(const ot::Dbus::WpanNetworkInfo *aNetworks, int aCount, uint64_t aNow);
+    void Expire(uint64_t aNow);
+
+    std::mutex              mMutex;
+    std::condition_variable mCondition;
+    std::thread             mThread;
+    std::map<Key, Entry>    mEntries;
+    bool                    mIsRunning;
+    bool                    mIsRequested;
+    bool                    mIsScanning;
+    uint64_t                mLastScan;
+    unsigned                mInterval;
+    char                    mIfName[IFNAMSIZ];
+    ScanDoneHandler         mScanDoneHandler;
+    void                   *mScanDoneContext;
+};
+
+} //namespace Web
+} //namespace ot
+
+#endif  //SCAN_SERVICE_HPP
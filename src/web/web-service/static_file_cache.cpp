@@ -0,0 +1,391 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the in-memory cache of the frontend files
+ */
+
+#include "static_file_cache.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define BOOST_NO_CXX11_SCOPED_ENUMS
+#include <boost/filesystem.hpp>
+#undef BOOST_NO_CXX11_SCOPED_ENUMS
+#include <mbedtls/sha256.h>
+#include <zlib.h>
+
+#include "common/code_utils.hpp"
+#include "utils/hex.hpp"
+
+#include "frontend_files.hpp"
+
+#define OT_STATIC_FILE_WATCH_EVENTS (IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+#define OT_STATIC_FILE_SETTLE_TIME 200 // Milliseconds without changes before reloading.
+#define OT_STATIC_FILE_ETAG_LENGTH 16  // Bytes of the SHA-256 hash used in ETags.
+
+namespace ot {
+namespace Web {
+
+struct ContentType
+{
+    const char *mExtension;
+    const char *mType;
+    bool        mIsCompressible;
+};
+
+static const ContentType sContentTypes[] =
+{
+    { ".html", "text/html; charset=utf-8",               true  },
+    { ".js",   "application/javascript; charset=utf-8", true  },
+    { ".css",  "text/css; charset=utf-8",                true  },
+    { ".json", "application/json",                       true  },
+    { ".svg",  "image/svg+xml",                          true  },
+    { ".map",  "application/json",                       true  },
+    { ".txt",  "text/plain; charset=utf-8",              true  },
+    { ".ico",  "image/x-icon",                           true  },
+    { ".png",  "image/png",                              false },
+    { ".jpg",  "image/jpeg",                             false },
+    { ".gif",  "image/gif",                              false },
+    { ".woff", "font/woff",                              false },
+    { ".woff2", "font/woff2",                            false },
+    { ".ttf",  "font/ttf",                               true  },
+};
+
+static const ContentType *FindContentType(const std::string &aPath)
+{
+    const ContentType *type = NULL;
+    size_t             dot = aPath.rfind('.');
+
+    VerifyOrExit(dot != std::string::npos);
+
+    for (size_t i = 0; i < sizeof(sContentTypes) / sizeof(sContentTypes[0]); i++)
+    {
+        if (aPath.compare(dot, std::string::npos, sContentTypes[i].mExtension) == 0)
+        {
+            type = &sContentTypes[i];
+            break;
+        }
+    }
+
+exit:
+    return type;
+}
+
+StaticFileCache::StaticFileCache(void) :
+    mFiles(std::make_shared<FileMap>()),
+    mInotifyFd(-1)
+{
+    mStopFd[0] = -1;
+    mStopFd[1] = -1;
+}
+
+StaticFileCache::~StaticFileCache(void)
+{
+    Stop();
+}
+
+const char *StaticFileCache::GetContentType(const std::string &aPath)
+{
+    const ContentType *type = FindContentType(aPath);
+
+    return type ? type->mType : "application/octet-stream";
+}
+
+int StaticFileCache::Start(const char *aRoot)
+{
+    int                       ret = -1;
+    boost::system::error_code error;
+
+    if (aRoot == NULL)
+    {
+        LoadEmbedded();
+        ExitNow(ret = 0);
+    }
+
+    mRoot = boost::filesystem::canonical(aRoot, error).string();
+    VerifyOrExit(!error, syslog(LOG_ERR, "invalid web root %s: %s", aRoot, error.message().c_str()));
+
+    Load();
+
+    VerifyOrExit((mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) >= 0,
+                 syslog(LOG_WARNING, "inotify_init1() failed: %s", strerror(errno)));
+    VerifyOrExit(pipe2(mStopFd, O_NONBLOCK | O_CLOEXEC) == 0);
+    AddWatches();
+    mThread = std::thread(&StaticFileCache::Watch, this);
+    ret = 0;
+
+exit:
+    return ret;
+}
+
+void StaticFileCache::Stop(void)
+{
+    if (mThread.joinable())
+    {
+        // Any byte on the pipe wakes the watch thread up to exit.
+        (void)write(mStopFd[1], "", 1);
+        mThread.join();
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (mStopFd[i] >= 0)
+        {
+            close(mStopFd[i]);
+            mStopFd[i] = -1;
+        }
+    }
+
+    if (mInotifyFd >= 0)
+    {
+        close(mInotifyFd);
+        mInotifyFd = -1;
+    }
+}
+
+std::shared_ptr<const StaticFile> StaticFileCache::Find(const std::string &aPath)
+{
+    std::shared_ptr<FileMap> files;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        files = mFiles;
+    }
+
+    FileMap::const_iterator it = files->find(aPath);
+
+    return it == files->end() ? std::shared_ptr<const StaticFile>() : it->second;
+}
+
+bool StaticFileCache::Compress(const std::string &aInput, std::string &aOutput)
+{
+    bool     ret = false;
+    z_stream stream;
+
+    memset(&stream, 0, sizeof(stream));
+    // 16 added to the window bits selects the gzip wrapper.
+    VerifyOrExit(deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) == Z_OK);
+
+    aOutput.resize(deflateBound(&stream, aInput.size()));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(aInput.data()));
+    stream.avail_in = static_cast<uInt>(aInput.size());
+    stream.next_out = reinterpret_cast<Bytef *>(&aOutput[0]);
+    stream.avail_out = static_cast<uInt>(aOutput.size());
+
+    ret = (deflate(&stream, Z_FINISH) == Z_STREAM_END);
+    aOutput.resize(stream.total_out);
+    deflateEnd(&stream);
+
+exit:
+    return ret;
+}
+
+std::string StaticFileCache::ComputeETag(const std::string &aContent, const char *aSuffix)
+{
+    unsigned char hash[32];
+    char          hex[OT_STATIC_FILE_ETAG_LENGTH * 2 + 1];
+
+    mbedtls_sha256(reinterpret_cast<const unsigned char *>(aContent.data()), aContent.size(), hash, 0);
+    ot::Utils::Bytes2Hex(hash, OT_STATIC_FILE_ETAG_LENGTH, hex);
+
+    return std::string("\"") + hex + aSuffix + "\"";
+}
+
+static const char *GetCacheControl(const std::string &aPath)
+{
+    const ContentType *type = FindContentType(aPath);
+
+    // Pages must be revalidated to pick up new assets, the assets themselves rarely change.
+    return (type && strcmp(type->mExtension, ".html") == 0) ? "no-cache" : "public, max-age=86400";
+}
+
+void StaticFileCache::LoadEmbedded(void)
+{
+    std::shared_ptr<FileMap> files = std::make_shared<FileMap>();
+
+    for (size_t i = 0; i < kFrontendFilesCount; i++)
+    {
+        const EmbeddedFile         &embedded = kFrontendFiles[i];
+        std::shared_ptr<StaticFile> file = std::make_shared<StaticFile>();
+
+        file->mContent = reinterpret_cast<const char *>(embedded.mContent);
+        file->mLength = embedded.mLength;
+        file->mGzipContent = reinterpret_cast<const char *>(embedded.mGzipContent);
+        file->mGzipLength = embedded.mGzipLength;
+        file->mETag = embedded.mETag;
+        file->mGzipETag = embedded.mGzipETag ? embedded.mGzipETag : "";
+        file->mContentType = GetContentType(embedded.mPath);
+        file->mCacheControl = GetCacheControl(embedded.mPath);
+        (*files)[embedded.mPath] = file;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mFiles = files;
+    }
+}
+
+void StaticFileCache::Load(void)
+{
+    std::shared_ptr<FileMap>                       files = std::make_shared<FileMap>();
+    boost::system::error_code                      error;
+    boost::filesystem::recursive_directory_iterator it(mRoot, error), end;
+
+    for (; !error && it != end; it.increment(error))
+    {
+        const boost::filesystem::path &path = it->path();
+        std::string                    name = path.string().substr(mRoot.size());
+        const ContentType             *type = FindContentType(name);
+
+        if (!boost::filesystem::is_regular_file(path, error) ||
+            boost::filesystem::file_size(path, error) > kMaxFileSize)
+        {
+            continue;
+        }
+
+        std::ifstream               stream(path.string().c_str(), std::ios::in | std::ios::binary);
+        std::shared_ptr<StaticFile> file = std::make_shared<StaticFile>();
+
+        if (!stream)
+        {
+            continue;
+        }
+
+        file->mBuffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        file->mContent = file->mBuffer.data();
+        file->mLength = file->mBuffer.size();
+        file->mETag = ComputeETag(file->mBuffer, "");
+        file->mContentType = GetContentType(name);
+        file->mCacheControl = GetCacheControl(name);
+        file->mGzipContent = NULL;
+        file->mGzipLength = 0;
+
+        if (type && type->mIsCompressible && Compress(file->mBuffer, file->mGzipBuffer) &&
+            file->mGzipBuffer.size() < file->mBuffer.size())
+        {
+            file->mGzipContent = file->mGzipBuffer.data();
+            file->mGzipLength = file->mGzipBuffer.size();
+            file->mGzipETag = ComputeETag(file->mBuffer, "-gz");
+        }
+        else
+        {
+            file->mGzipBuffer.clear();
+        }
+
+        (*files)[name] = file;
+    }
+
+    if (error)
+    {
+        syslog(LOG_WARNING, "failed to load %s: %s", mRoot.c_str(), error.message().c_str());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mFiles = files;
+    }
+
+    syslog(LOG_INFO, "cached %zu files from %s", files->size(), mRoot.c_str());
+}
+
+void StaticFileCache::AddWatches(void)
+{
+    boost::system::error_code                      error;
+    boost::filesystem::recursive_directory_iterator it(mRoot, error), end;
+
+    inotify_add_watch(mInotifyFd, mRoot.c_str(), OT_STATIC_FILE_WATCH_EVENTS);
+
+    // Watching an already watched directory again is harmless.
+    for (; !error && it != end; it.increment(error))
+    {
+        if (boost::filesystem::is_directory(it->path(), error))
+        {
+            inotify_add_watch(mInotifyFd, it->path().string().c_str(), OT_STATIC_FILE_WATCH_EVENTS);
+        }
+    }
+}
+
+void StaticFileCache::Watch(void)
+{
+    struct pollfd fds[2];
+    char          buffer[4096];
+    bool          isChanged = false;
+
+    fds[0].fd = mInotifyFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = mStopFd[0];
+    fds[1].events = POLLIN;
+
+    while (true)
+    {
+        // Wait for the changes to settle, an update usually touches several files.
+        int rval = poll(fds, 2, isChanged ? OT_STATIC_FILE_SETTLE_TIME : -1);
+
+        if (rval < 0 && errno != EINTR)
+        {
+            syslog(LOG_ERR, "poll() failed: %s", strerror(errno));
+            break;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            break;
+        }
+
+        if (rval > 0 && (fds[0].revents & POLLIN))
+        {
+            while (read(mInotifyFd, buffer, sizeof(buffer)) > 0)
+            {
+            }
+            isChanged = true;
+        }
+        else if (rval == 0 && isChanged)
+        {
+            isChanged = false;
+            AddWatches();
+            Load();
+        }
+    }
+}
+
+} //namespace Web
+} //namespace ot
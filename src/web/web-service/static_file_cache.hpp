@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the in-memory cache of the frontend files
+ */
+
+#ifndef STATIC_FILE_CACHE_HPP
+#define STATIC_FILE_CACHE_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <stddef.h>
+#include <thread>
+
+namespace ot {
+namespace Web {
+
+/**
+ * This structure represents one cached file.
+ *
+ */
+struct StaticFile
+{
+    const char *mContent;      ///< The raw content.
+    size_t      mLength;       ///< The length of the raw content.
+    const char *mGzipContent;  ///< The gzip encoded content, NULL if compression does not pay off.
+    size_t      mGzipLength;   ///< The length of the gzip encoded content.
+    std::string mETag;         ///< The quoted strong entity tag of the raw content.
+    std::string mGzipETag;     ///< The quoted strong entity tag of the gzip encoded content.
+    const char *mContentType;  ///< The media type.
+    const char *mCacheControl; ///< The Cache-Control directives.
+    std::string mBuffer;       ///< The raw content of a file loaded from disk.
+    std::string mGzipBuffer;   ///< The gzip encoded content of a file loaded from disk.
+};
+
+/**
+ * This class keeps the frontend files in memory, precompressed and hashed.
+ *
+ * By default the files compiled into the binary are served. For development a directory
+ * can override them, its tree is loaded once and reloaded whenever inotify reports a
+ * change below the root, so a file is never read from disk on the request path. Files
+ * larger than kMaxFileSize are left on disk.
+ *
+ */
+class StaticFileCache
+{
+public:
+    StaticFileCache(void);
+    ~StaticFileCache(void);
+
+    /**
+     * This method loads the files and starts watching the override directory.
+     *
+     * @param[in]  aRoot  A pointer to the directory overriding the compiled in files, NULL to
+     *                    serve the compiled in files.
+     *
+     * @retval 0   Successfully loaded the files.
+     * @retval -1  Failed to load the files from aRoot.
+     *
+     */
+    int Start(const char *aRoot);
+
+    /**
+     * This method stops watching the root directory.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This method finds a cached file.
+     *
+     * @param[in]  aPath  The request path, relative to the root and starting with '/'.
+     *
+     * @returns The cached file, or NULL if the file is not cached.
+     *
+     */
+    std::shared_ptr<const StaticFile> Find(const std::string &aPath);
+
+    /**
+     * This method returns the media type of a file.
+     *
+     * @param[in]  aPath  The path of the file.
+     *
+     * @returns The media type guessed from the file extension.
+     *
+     */
+    static const char *GetContentType(const std::string &aPath);
+
+private:
+    enum
+    {
+        kMaxFileSize = 1024 * 1024, ///< Files larger than this are served from disk.
+    };
+
+    typedef std::map<std::string, std::shared_ptr<const StaticFile> > FileMap;
+
+    void LoadEmbedded(void);
+    void Load(void);
+    void Watch(void);
+    void AddWatches(void);
+    static bool Compress(const std::string &aInput, std::string &aOutput);
+    static std::string ComputeETag(const std::string &aContent, const char *aSuffix);
+
+    std::string              mRoot;
+    std::mutex               mMutex;
+    std::shared_ptr<FileMap> mFiles;
+    std::thread              mThread;
+    int                      mInotifyFd;
+    int                      mStopFd[2];
+};
+
+} //namespace Web
+} //namespace ot
+
+#endif  //STATIC_FILE_CACHE_HPP
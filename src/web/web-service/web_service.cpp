@@ -33,35 +33,54 @@
 
 #include "web_service.hpp"
 
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+
+#include <boost/algorithm/string.hpp>
 #define BOOST_NO_CXX11_SCOPED_ENUMS
 #include <boost/filesystem.hpp>
 #undef BOOST_NO_CXX11_SCOPED_ENUMS
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
 #include <server_http.hpp>
 
 #include "common/code_utils.hpp"
+#include "common/systemd.hpp"
+#include "common/time.hpp"
 #include "utils/hex.hpp"
 
+#include "event_stream.hpp"
+#include "response_builder.hpp"
+#include "scan_service.hpp"
+#include "worker_pool.hpp"
 #include "../mdns-publisher/mdns_publisher.hpp"
 #include "../pskc-generator/pskc.hpp"
 #include "../utils/encoding.hpp"
+#include "../utils/json.hpp"
 
 #define OT_ADD_PREFIX_PATH "^/add_prefix"
-#define OT_AVAILABLE_NETWORK_PATH "^/available_network$"
+#define OT_AVAILABLE_NETWORK_PATH "^/available_network(\\?.*)?$"
 #define OT_BOOT_MDNS_PATH "^/boot_mdns$"
 #define OT_DELETE_PREFIX_PATH "^/delete_prefix"
 #define OT_FORM_NETWORK_PATH "^/form_network$"
+#define OT_GATEWAYS_PATH "^/gateways$"
+#define OT_EVENTS_PATH "^/events$"
 #define OT_GET_NETWORK_PATH "^/get_properties$"
 #define OT_JOIN_NETWORK_PATH "^/join_network$"
 #define OT_SET_NETWORK_PATH "^/settings$"
 #define OT_REQUEST_METHOD_GET "GET"
 #define OT_REQUEST_METHOD_POST "POST"
-#define OT_RESPONSE_SUCCESS_STATUS "HTTP/1.1 200 OK\r\n"
-#define OT_RESPONSE_HEADER_LENGTH "Content-Length: "
-#define OT_RESPONSE_HEADER_TYPE "Content-Type: application/json\r\n charset=utf-8"
-#define OT_RESPONSE_PLACEHOLD "\r\n\r\n"
-#define OT_RESPONSE_FAILURE_STATUS "HTTP/1.1 400 Bad Request\r\n"
+#define OT_RESPONSE_FAILURE_STATUS "400 Bad Request"
+#define OT_RESPONSE_NOT_MODIFIED_STATUS "304 Not Modified"
+#define OT_RESPONSE_NOT_FOUND_STATUS "404 Not Found"
+#define OT_RESPONSE_TYPE_JSON "application/json; charset=utf-8"
+#define OT_RESPONSE_TYPE_TEXT "text/plain; charset=utf-8"
+#define OT_RESPONSE_HEADER_CACHE_CONTROL "Cache-Control"
+#define OT_RESPONSE_HEADER_VARY "Vary"
+#define OT_REQUEST_HEADER_IF_NONE_MATCH "If-None-Match"
+#define OT_REQUEST_HEADER_ACCEPT_ENCODING "Accept-Encoding"
 
 #define OT_BORDER_ROUTER_PORT 49191
 #define OT_EXTENDED_PANID_LENGTH 8
@@ -70,100 +89,239 @@
 #define OT_PANID_LENGTH 4
 #define OT_PSKC_MAX_LENGTH 16
 #define OT_PUBLISH_SERVICE_INTERVAL 20
+#define OT_SCAN_PAGE_DEFAULT_LIMIT 50
+#define OT_GATEWAY_OPERATIONS_MAX 64
+#define OT_NETWORK_INFO_JSON_SIZE 128 // Typical size of one network in JSON, to size the buffer up front.
 
 namespace ot {
 namespace Web {
 
-ot::Dbus::WpanNetworkInfo sNetworks[DBUS_MAXIMUM_NAME_LENGTH];
-int                       sNetworksCount = 0;
 std::string               sNetworkName = "";
 std::string               sExtPanId = "";
-bool                      sIsStarted = false;
+bool                      sIsMdnsEnabled = false;
+EventStream              *sEventStream = NULL;
+ScanService              *sScanService = NULL;
+std::mutex                sNetworkInfoMutex; // Guards sNetworkName, sExtPanId and sIsMdnsEnabled.
+std::mutex                sOperationMutex;   // Serializes operations changing the Thread Network.
 
-void DefaultResourceSend(const HttpServer &aServer, const std::shared_ptr<HttpServer::Response> &aResponse,
-                         const std::shared_ptr<std::ifstream> &aIfStream);
+static void SendResponse(const std::shared_ptr<HttpServer::Response> &aResponse)
+{
+    // The response is sent once its last reference is dropped.
+    (void)aResponse;
+}
 
-static std::string HttpReponse(uint8_t error)
+/**
+ * This function runs a task on a worker thread and sends the response it writes from an I/O thread.
+ *
+ * @param[in]  aPool      The worker pool to run the task on.
+ * @param[in]  aServer    The server the response belongs to.
+ * @param[in]  aResponse  The response, the task must not keep other references to it.
+ * @param[in]  aTask      The task writing the response.
+ *
+ */
+static void RunInWorker(WorkerPool &aPool, HttpServer &aServer, const std::shared_ptr<HttpServer::Response> &aResponse,
+                        const std::function<void(HttpServer::Response &)> &aTask)
 {
-    boost::property_tree::ptree root;
-    std::stringstream           ss;
+    std::shared_ptr<boost::asio::io_service> ioService = aServer.io_service;
 
-    root.put("error", error);
-    if (error == 0)
-    {
-        root.put("result", "successful");
-    }
-    else
-    {
-        root.put("result", "failed");
-    }
-    write_json(ss, root, false);
-    return ss.str();
+    aPool.Post([ioService, aResponse, aTask]() mutable {
+                aTask(*aResponse);
+                ioService->post(std::bind(SendResponse, std::move(aResponse)));
+            });
+}
+
+static void SubscribeEvents(PropertySnapshot &aSnapshot, EventStream &aEventStream,
+                            const std::shared_ptr<HttpServer::Response> &aResponse)
+{
+    std::string json, etag;
+
+    // Start every client from the current snapshot, changes follow as events.
+    aSnapshot.Get(json, etag);
+    aEventStream.Subscribe(aResponse, EventStream::Format("properties", json));
+}
+
+static void SendCachedFile(const std::shared_ptr<HttpServer::Response> &aResponse, const HttpServer::Request &aRequest,
+                           const StaticFile &aFile);
+static void SendFileFromDisk(HttpServer &aServer, const std::shared_ptr<HttpServer::Response> &aResponse,
+                             const HttpServer::Request &aRequest, const char *aRoot, const std::string &aPath);
+
+static void HttpReponse(ot::Utils::JsonWriter &aWriter, int error)
+{
+    aWriter.BeginObject()
+    .Key("error").Int(error)
+    .Key("result").String(error == 0 ? "successful" : "failed")
+    .EndObject();
+}
+
+/**
+ * This function queues the service describing the current network to the mDNS publisher.
+ *
+ * It must be called with sNetworkInfoMutex held.
+ *
+ */
+static void UpdateMdnsService(void)
+{
+    ot::Mdns::ServiceInfo service;
+
+    service.mName = sNetworkName;
+    service.mType = "_meshcop._udp";
+    service.mPort = OT_BORDER_ROUTER_PORT;
+    service.mNetworkNameTxt = "nn=" + sNetworkName;
+    service.mExtPanIdTxt = "xp=" + sExtPanId;
+    ot::Mdns::Publisher::GetInstance().UpdateService(service);
 }
 
 static void SetNetworkInfo(const char *networkName, const char *extPanId)
 {
+    std::lock_guard<std::mutex> lock(sNetworkInfoMutex);
+
     sNetworkName = networkName;
     sExtPanId = extPanId;
+
+    // The publisher only announces again what actually changed.
+    if (sIsMdnsEnabled)
+    {
+        UpdateMdnsService();
+    }
 }
 
-static std::string OnJoinNetworkRequest(boost::property_tree::ptree &aJoinRequest, const char *aIfName)
+static void PublishProgress(const char *aAction, const char *aStep, int aError)
 {
-    char extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1];
-    int  ret = ot::Dbus::kWpantundStatus_Ok;
-    int  index = aJoinRequest.get<int>("index");
+    std::string           progress;
+    ot::Utils::JsonWriter writer(progress);
+
+    VerifyOrExit(sEventStream != NULL);
+    writer.BeginObject()
+    .Key("action").String(aAction)
+    .Key("step").String(aStep)
+    .Key("error").Int(aError)
+    .EndObject();
+    sEventStream->Publish("progress", progress);
 
-    std::string              networkKey = aJoinRequest.get<std::string>("networkKey");
-    std::string              prefix = aJoinRequest.get<std::string>("prefix");
-    bool                     defaultRoute = aJoinRequest.get<bool>("defaultRoute");
-    ot::Dbus::WPANController wpanController;
+exit:
+    return;
+}
+
+static void WriteNetworkInfo(ot::Utils::JsonWriter &aWriter, const ot::Dbus::WpanNetworkInfo &aNetwork)
+{
+    char extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1], panId[OT_PANID_LENGTH + 3],
+         hardwareAddress[OT_HARDWARE_ADDRESS_LENGTH * 2 + 1];
+
+    ot::Utils::Long2Hex(Thread::Encoding::BigEndian::HostSwap64(aNetwork.mExtPanId), extPanId);
+    ot::Utils::Bytes2Hex(aNetwork.mHardwareAddress, OT_HARDWARE_ADDRESS_LENGTH, hardwareAddress);
+    sprintf(panId, "0x%X", aNetwork.mPanId);
+    aWriter.BeginObject()
+    .Key("nn").String(aNetwork.mNetworkName)
+    .Key("xp").String(extPanId)
+    .Key("pi").String(panId)
+    .Key("ch").Uint(aNetwork.mChannel)
+    .Key("ha").String(hardwareAddress)
+    .Key("rssi").Int(aNetwork.mRssi)
+    .EndObject();
+}
+
+static bool OnJoinNetworkRequest(ot::Utils::JsonReader &aJoinRequest, ot::Utils::JsonWriter &aResponse,
+                                 const char *aIfName)
+{
+    char                      extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1];
+    uint8_t                   hardwareAddress[OT_HARDWARE_ADDRESS_LENGTH];
+    int                       ret = ot::Dbus::kWpantundStatus_Ok;
+    ot::Dbus::WpanNetworkInfo network;
+
+    std::string                networkKey, prefix, xp, ha;
+    bool                       defaultRoute;
+    ot::Dbus::WPANController   wpanController;
+    const ot::Utils::JsonField fields[] =
+    {
+        ot::Utils::JsonField::String("networkKey", networkKey),
+        ot::Utils::JsonField::String("prefix", prefix),
+        ot::Utils::JsonField::Bool("defaultRoute", defaultRoute),
+        ot::Utils::JsonField::String("xp", xp),
+        ot::Utils::JsonField::String("ha", ha),
+    };
+
+    if (!aJoinRequest.ReadObject(fields, sizeof(fields) / sizeof(fields[0])))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sOperationMutex);
+
+    // Networks are identified the same way the scan results are keyed.
+    VerifyOrExit(ot::Utils::Hex2Bytes(ha.c_str(), hardwareAddress, sizeof(hardwareAddress)) ==
+                 OT_HARDWARE_ADDRESS_LENGTH, ret = ot::Dbus::kWpantundStatus_InvalidArgument);
+    VerifyOrExit(sScanService != NULL &&
+                 sScanService->Find(strtoull(xp.c_str(), NULL, 16), hardwareAddress, network),
+                 ret = ot::Dbus::kWpantundStatus_NetworkNotFound);
 
     wpanController.SetInterfaceName(aIfName);
+    PublishProgress("join", "leave", ret);
     VerifyOrExit(wpanController.Leave() == ot::Dbus::kWpantundStatus_Ok,
                  ret = ot::Dbus::kWpantundStatus_LeaveFailed);
+    PublishProgress("join", "credentials", ret);
     VerifyOrExit(wpanController.Set(WebServer::kPropertyType_Data,
                                     "NetworkKey",
                                     networkKey.c_str()) == ot::Dbus::kWpantundStatus_Ok,
                  ret = ot::Dbus::kWpantundStatus_SetFailed);
-    VerifyOrExit(wpanController.Join(sNetworks[index].mNetworkName,
-                                     sNetworks[index].mChannel,
-                                     sNetworks[index].mExtPanId,
-                                     sNetworks[index].mPanId) == ot::Dbus::kWpantundStatus_Ok,
+    PublishProgress("join", "join", ret);
+    VerifyOrExit(wpanController.Join(network.mNetworkName,
+                                     network.mChannel,
+                                     network.mExtPanId,
+                                     network.mPanId) == ot::Dbus::kWpantundStatus_Ok,
                  ret = ot::Dbus::kWpantundStatus_JoinFailed);
+    PublishProgress("join", "prefix", ret);
     VerifyOrExit(wpanController.AddGateway(prefix.c_str(), defaultRoute) == ot::Dbus::kWpantundStatus_Ok,
                  ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
 
-    ot::Utils::Long2Hex(sNetworks[index].mExtPanId, extPanId);
-    SetNetworkInfo(sNetworks[index].mNetworkName, extPanId);
+    ot::Utils::Long2Hex(network.mExtPanId, extPanId);
+    SetNetworkInfo(network.mNetworkName, extPanId);
 exit:
+    PublishProgress("join", "done", ret);
     if (ret != ot::Dbus::kWpantundStatus_Ok)
     {
         syslog(LOG_ERR, "Error is %d", ret);
     }
-    return HttpReponse(ret);
+    HttpReponse(aResponse, ret);
+    return true;
 }
 
-static std::string OnFormNetworkRequest(boost::property_tree::ptree &aFormRequest, const char *aIfName)
+static bool OnFormNetworkRequest(ot::Utils::JsonReader &aFormRequest, ot::Utils::JsonWriter &aResponse,
+                                 const char *aIfName)
 {
     int ret = ot::Dbus::kWpantundStatus_Ok;
 
-    std::string              networkKey = aFormRequest.get<std::string>("networkKey");
-    std::string              prefix = aFormRequest.get<std::string>("prefix");
-    uint16_t                 channel = aFormRequest.get<uint16_t>("channel");
-    std::string              networkName = aFormRequest.get<std::string>("networkName");
-    std::string              passphrase = aFormRequest.get<std::string>("passphrase");
-    std::string              panId = aFormRequest.get<std::string>("panId");
-    std::string              extPanId = aFormRequest.get<std::string>("extPanId");
-    bool                     defaultRoute = aFormRequest.get<bool>("defaultRoute");
-    ot::Psk::Pskc            psk;
-    char                     pskcStr[OT_PSKC_MAX_LENGTH * 2];
-    uint8_t                  extPanIdBytes[OT_EXTENDED_PANID_LENGTH];
-    ot::Dbus::WPANController wpanController;
+    std::string                networkKey, prefix, networkName, passphrase, panId, extPanId;
+    uint64_t                   channel;
+    bool                       defaultRoute;
+    ot::Psk::Pskc              psk;
+    char                       pskcStr[OT_PSKC_MAX_LENGTH * 2 + 1];
+    uint8_t                    extPanIdBytes[OT_EXTENDED_PANID_LENGTH];
+    ot::Dbus::WPANController   wpanController;
+    const ot::Utils::JsonField fields[] =
+    {
+        ot::Utils::JsonField::String("networkKey", networkKey),
+        ot::Utils::JsonField::String("prefix", prefix),
+        ot::Utils::JsonField::Uint("channel", channel),
+        ot::Utils::JsonField::String("networkName", networkName),
+        ot::Utils::JsonField::String("passphrase", passphrase),
+        ot::Utils::JsonField::String("panId", panId),
+        ot::Utils::JsonField::String("extPanId", extPanId),
+        ot::Utils::JsonField::Bool("defaultRoute", defaultRoute),
+    };
+
+    if (!aFormRequest.ReadObject(fields, sizeof(fields) / sizeof(fields[0])) || channel > UINT16_MAX)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sOperationMutex);
 
     wpanController.SetInterfaceName(aIfName);
+    PublishProgress("form", "leave", ret);
     VerifyOrExit(wpanController.Leave() == ot::Dbus::kWpantundStatus_Ok,
                  ret = ot::Dbus::kWpantundStatus_LeaveFailed);
 
+    PublishProgress("form", "credentials", ret);
     VerifyOrExit(wpanController.Set(WebServer::kPropertyType_Data,
                                     kWPANTUNDProperty_NetworkKey,
                                     networkKey.c_str()) == ot::Dbus::kWpantundStatus_Ok,
@@ -185,27 +343,45 @@ static std::string OnFormNetworkRequest(boost::property_tree::ptree &aFormReques
                                     pskcStr) == ot::Dbus::kWpantundStatus_Ok,
                  ret = ot::Dbus::kWpantundStatus_SetFailed);
 
-    VerifyOrExit(wpanController.Form(networkName.c_str(), channel) == ot::Dbus::kWpantundStatus_Ok,
+    PublishProgress("form", "form", ret);
+    VerifyOrExit(wpanController.Form(networkName.c_str(), static_cast<uint16_t>(channel)) ==
+                 ot::Dbus::kWpantundStatus_Ok,
                  ret = ot::Dbus::kWpantundStatus_FormFailed);
 
+    PublishProgress("form", "prefix", ret);
     VerifyOrExit(wpanController.AddGateway(prefix.c_str(), defaultRoute) == ot::Dbus::kWpantundStatus_Ok,
                  ret = ot::Dbus::kWpantundStatus_SetGatewayFailed);
     SetNetworkInfo(networkName.c_str(), extPanId.c_str());
 exit:
+    PublishProgress("form", "done", ret);
     if (ret != ot::Dbus::kWpantundStatus_Ok)
     {
         syslog(LOG_ERR, "Error is %d", ret);
     }
-    return HttpReponse(ret);
+    HttpReponse(aResponse, ret);
+    return true;
 }
 
-static std::string OnAddPrefixRequest(boost::property_tree::ptree &aAddPrefixRequest, const char *aIfName)
+static bool OnAddPrefixRequest(ot::Utils::JsonReader &aAddPrefixRequest, ot::Utils::JsonWriter &aResponse,
+                               const char *aIfName)
 {
     int ret = ot::Dbus::kWpantundStatus_Ok;
 
-    std::string              prefix = aAddPrefixRequest.get<std::string>("prefix");
-    bool                     defaultRoute = aAddPrefixRequest.get<bool>("defaultRoute");
-    ot::Dbus::WPANController wpanController;
+    std::string                prefix;
+    bool                       defaultRoute;
+    ot::Dbus::WPANController   wpanController;
+    const ot::Utils::JsonField fields[] =
+    {
+        ot::Utils::JsonField::String("prefix", prefix),
+        ot::Utils::JsonField::Bool("defaultRoute", defaultRoute),
+    };
+
+    if (!aAddPrefixRequest.ReadObject(fields, sizeof(fields) / sizeof(fields[0])))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sOperationMutex);
 
     wpanController.SetInterfaceName(aIfName);
     VerifyOrExit(wpanController.AddGateway(prefix.c_str(), defaultRoute) == ot::Dbus::kWpantundStatus_Ok,
@@ -215,16 +391,29 @@ exit:
     {
         syslog(LOG_ERR, "Error is %d", ret);
     }
-    return HttpReponse(ret);
+    HttpReponse(aResponse, ret);
+    return true;
 
 }
 
-static std::string OnDeletePrefixRequest(boost::property_tree::ptree &aDeleteRequest, const char *aIfName)
+static bool OnDeletePrefixRequest(ot::Utils::JsonReader &aDeleteRequest, ot::Utils::JsonWriter &aResponse,
+                                  const char *aIfName)
 {
     int ret = ot::Dbus::kWpantundStatus_Ok;
 
-    std::string              prefix = aDeleteRequest.get<std::string>("prefix");
-    ot::Dbus::WPANController wpanController;
+    std::string                prefix;
+    ot::Dbus::WPANController   wpanController;
+    const ot::Utils::JsonField fields[] =
+    {
+        ot::Utils::JsonField::String("prefix", prefix),
+    };
+
+    if (!aDeleteRequest.ReadObject(fields, sizeof(fields) / sizeof(fields[0])))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sOperationMutex);
 
     wpanController.SetInterfaceName(aIfName);
     VerifyOrExit(wpanController.RemoveGateway(prefix.c_str()) == ot::Dbus::kWpantundStatus_Ok,
@@ -234,142 +423,394 @@ exit:
     {
         syslog(LOG_ERR, "Error is %d", ret);
     }
-    return HttpReponse(ret);
+    HttpReponse(aResponse, ret);
+    return true;
 }
 
-static std::string OnGetNetworkRequest(boost::property_tree::ptree &aGetNetworkRequest, const char *aIfName)
+/**
+ * This function reads and checks one operation of a /gateways request.
+ *
+ * @param[in]   aReader     A reference to the reader, just past the beginning of the operation.
+ * @param[out]  aOperation  A reference to the operation read.
+ *
+ * @returns NULL if the operation is valid, otherwise a description of the problem.
+ *
+ */
+static const char *ReadGatewayOperation(ot::Utils::JsonReader &aReader, ot::Dbus::WpanGatewayOperation &aOperation)
 {
-    boost::property_tree::ptree root, networkInfo;
-    int                         ret = ot::Dbus::kWpantundStatus_Ok;
-    ot::Dbus::WPANController    wpanController;
+    const char                *error = NULL;
+    std::string                op, type = "prefix", prefix, preference = "medium";
+    bool                       defaultRoute = false;
+    size_t                     slash;
+    unsigned long              length = 64;
+    const ot::Utils::JsonField fields[] =
+    {
+        ot::Utils::JsonField::String("op", op),
+        ot::Utils::JsonField::String("type", type, false),
+        ot::Utils::JsonField::String("prefix", prefix),
+        ot::Utils::JsonField::Bool("defaultRoute", defaultRoute, false),
+        ot::Utils::JsonField::String("preference", preference, false),
+    };
+
+    memset(&aOperation, 0, sizeof(aOperation));
+    VerifyOrExit(aReader.ReadMembers(fields, sizeof(fields) / sizeof(fields[0])), error = aReader.GetError());
+    VerifyOrExit(op == "add" || op == "delete", error = "op must be add or delete");
+    VerifyOrExit(type == "prefix" || type == "route", error = "type must be prefix or route");
+
+    slash = prefix.find('/');
+    if (slash != std::string::npos)
+    {
+        char *end = NULL;
 
-    wpanController.SetInterfaceName(aIfName);
-    networkInfo.put(kWPANTUNDProperty_NCPState, wpanController.Get(kWPANTUNDProperty_NCPState));
-    networkInfo.put(kWPANTUNDProperty_DaemonEnabled, wpanController.Get(kWPANTUNDProperty_DaemonEnabled));
-    networkInfo.put(kWPANTUNDProperty_NCPVersion, wpanController.Get(kWPANTUNDProperty_NCPVersion));
-    networkInfo.put(kWPANTUNDProperty_DaemonVersion, wpanController.Get(kWPANTUNDProperty_DaemonVersion));
-    networkInfo.put(kWPANTUNDProperty_ConfigNCPDriverName, wpanController.Get(kWPANTUNDProperty_ConfigNCPDriverName));
-    networkInfo.put(kWPANTUNDProperty_NCPHardwareAddress, wpanController.Get(kWPANTUNDProperty_NCPHardwareAddress));
-    networkInfo.put(kWPANTUNDProperty_NCPChannel, wpanController.Get(kWPANTUNDProperty_NCPChannel));
-    networkInfo.put(kWPANTUNDProperty_NetworkNodeType, wpanController.Get(kWPANTUNDProperty_NetworkNodeType));
-    networkInfo.put(kWPANTUNDProperty_NetworkName, wpanController.Get(kWPANTUNDProperty_NetworkName));
-    networkInfo.put(kWPANTUNDProperty_NetworkXPANID, wpanController.Get(kWPANTUNDProperty_NetworkXPANID));
-    networkInfo.put(kWPANTUNDProperty_NetworkPANID, wpanController.Get(kWPANTUNDProperty_NetworkPANID));
-    networkInfo.put(kWPANTUNDProperty_IPv6LinkLocalAddress, wpanController.Get(kWPANTUNDProperty_IPv6LinkLocalAddress));
-    networkInfo.put(kWPANTUNDProperty_IPv6MeshLocalAddress, wpanController.Get(kWPANTUNDProperty_IPv6MeshLocalAddress));
-    networkInfo.put(kWPANTUNDProperty_IPv6MeshLocalPrefix, wpanController.Get(kWPANTUNDProperty_IPv6MeshLocalPrefix));
-    root.add_child("result", networkInfo);
-    root.put("error", ret);
-    std::stringstream ss;
-    write_json(ss, root, false);
+        VerifyOrExit(isdigit(static_cast<unsigned char>(prefix[slash + 1])), error = "invalid prefix length");
+        length = strtoul(prefix.c_str() + slash + 1, &end, 10);
+        VerifyOrExit(*end == '\0' && length <= 128, error = "invalid prefix length");
+    }
+    VerifyOrExit(inet_pton(AF_INET6, prefix.substr(0, slash).c_str(), aOperation.mPrefix) == 1,
+                 error = "invalid prefix");
+    for (unsigned long bit = length; bit < 128; bit++)
+    {
+        VerifyOrExit((aOperation.mPrefix[bit / 8] & (0x80 >> (bit % 8))) == 0, error = "prefix has bits set past its length");
+    }
+    aOperation.mPrefixLength = static_cast<uint8_t>(length);
 
-    (void)aIfName;
-    (void)aGetNetworkRequest;
+    if (type == "prefix")
+    {
+        // ConfigGateway always configures a /64, for SLAAC.
+        VerifyOrExit(length == 64, error = "on-mesh prefixes must be /64");
+        aOperation.mType = op == "add" ? ot::Dbus::kGatewayOperation_AddPrefix :
+                           ot::Dbus::kGatewayOperation_RemovePrefix;
+        aOperation.mIsDefaultRoute = defaultRoute;
+    }
+    else
+    {
+        VerifyOrExit(preference == "low" || preference == "medium" || preference == "high",
+                     error = "preference must be low, medium or high");
+        aOperation.mType = op == "add" ? ot::Dbus::kGatewayOperation_AddRoute :
+                           ot::Dbus::kGatewayOperation_RemoveRoute;
+        aOperation.mPreference = preference == "low" ? -1 : preference == "high" ? 1 : 0;
+    }
 
-    return ss.str();
+exit:
+    return error;
 }
 
-static std::string OnGetAvailableNetworkResponse(boost::property_tree::ptree &aGetAvailableNetworkRequest,
-                                                 const char *aIfName)
+static bool IsSameGateway(const ot::Dbus::WpanGatewayOperation &aFirst, const ot::Dbus::WpanGatewayOperation &aSecond)
 {
-    boost::property_tree::ptree root, networks, networkInfo;
-    int                         ret = ot::Dbus::kWpantundStatus_Ok;
-    ot::Dbus::WPANController    wpanController;
+    bool isFirstRoute = aFirst.mType == ot::Dbus::kGatewayOperation_AddRoute ||
+                        aFirst.mType == ot::Dbus::kGatewayOperation_RemoveRoute;
+    bool isSecondRoute = aSecond.mType == ot::Dbus::kGatewayOperation_AddRoute ||
+                         aSecond.mType == ot::Dbus::kGatewayOperation_RemoveRoute;
+
+    return isFirstRoute == isSecondRoute && aFirst.mPrefixLength == aSecond.mPrefixLength &&
+           memcmp(aFirst.mPrefix, aSecond.mPrefix, sizeof(aFirst.mPrefix)) == 0;
+}
+
+static void WriteGatewayOperation(ot::Utils::JsonWriter &aWriter, const ot::Dbus::WpanGatewayOperation &aOperation)
+{
+    static const char *const kOps[] = { "add", "delete", "add", "delete" };
+    static const char *const kTypes[] = { "prefix", "prefix", "route", "route" };
+    char                     prefix[INET6_ADDRSTRLEN + 4];
+    size_t                   length;
+
+    inet_ntop(AF_INET6, aOperation.mPrefix, prefix, INET6_ADDRSTRLEN);
+    length = strlen(prefix);
+    snprintf(prefix + length, sizeof(prefix) - length, "/%u", aOperation.mPrefixLength);
+
+    aWriter.BeginObject()
+    .Key("op").String(kOps[aOperation.mType])
+    .Key("type").String(kTypes[aOperation.mType])
+    .Key("prefix").String(prefix)
+    .Key("error").Int(aOperation.mStatus)
+    .EndObject();
+}
+
+/**
+ * This function handles a /gateways request, which adds and removes several on-mesh prefixes and
+ * external routes at once:
+ *
+ *     {"operations": [{"op": "add", "type": "prefix", "prefix": "fd11:22::/64", "defaultRoute": true},
+ *                     {"op": "delete", "type": "route", "prefix": "fd00:7d03::/48"}]}
+ *
+ * Every operation is checked before any is applied, so a bad request changes nothing.
+ *
+ */
+static bool OnGatewaysRequest(ot::Utils::JsonReader &aRequest, ot::Utils::JsonWriter &aResponse,
+                              const char *aIfName)
+{
+    int                                         ret = ot::Dbus::kWpantundStatus_Ok;
+    const char                                 *error = NULL;
+    int                                         index = -1;
+    ot::Utils::JsonReader::Token                token;
+    std::vector<ot::Dbus::WpanGatewayOperation> operations;
+    ot::Dbus::WPANController                    wpanController;
+
+    VerifyOrExit(aRequest.Next() == ot::Utils::JsonReader::kTokenBeginObject, error = "expected an object");
+    while ((token = aRequest.Next()) == ot::Utils::JsonReader::kTokenKey)
+    {
+        if (aRequest.GetString() != "operations")
+        {
+            VerifyOrExit(aRequest.Skip(), error = aRequest.GetError());
+            continue;
+        }
+
+        VerifyOrExit(aRequest.Next() == ot::Utils::JsonReader::kTokenBeginArray,
+                     error = "operations must be an array");
+        while ((token = aRequest.Next()) == ot::Utils::JsonReader::kTokenBeginObject)
+        {
+            ot::Dbus::WpanGatewayOperation operation;
+
+            index = static_cast<int>(operations.size());
+            VerifyOrExit(operations.size() < OT_GATEWAY_OPERATIONS_MAX, error = "too many operations");
+            SuccessOrExit(error = ReadGatewayOperation(aRequest, operation));
+            for (size_t i = 0; i < operations.size(); i++)
+            {
+                VerifyOrExit(!IsSameGateway(operations[i], operation), error = "duplicate prefix");
+            }
+            operations.push_back(operation);
+        }
+        index = -1;
+        VerifyOrExit(token == ot::Utils::JsonReader::kTokenEndArray,
+                     error = aRequest.GetError() ? aRequest.GetError() : "operations must be objects");
+    }
+    VerifyOrExit(token == ot::Utils::JsonReader::kTokenEndObject, error = aRequest.GetError());
+    VerifyOrExit(!operations.empty(), error = "no operations");
+
+    {
+        std::lock_guard<std::mutex> lock(sOperationMutex);
+
+        wpanController.SetInterfaceName(aIfName);
+        ret = wpanController.ConfigureGateways(&operations[0], static_cast<int>(operations.size()));
+    }
+
+    aResponse.BeginObject().Key("result").BeginArray();
+    for (size_t i = 0; i < operations.size(); i++)
+    {
+        WriteGatewayOperation(aResponse, operations[i]);
+    }
+    aResponse.EndArray().Key("error").Int(ret).EndObject();
 
-    wpanController.SetInterfaceName(aIfName);
-    VerifyOrExit(wpanController.Leave() == ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_LeaveFailed);
-    VerifyOrExit(wpanController.Scan() == ot::Dbus::kWpantundStatus_Ok,
-                 ret = ot::Dbus::kWpantundStatus_ScanFailed);
-    sNetworksCount = wpanController.GetScanNetworksInfoCount();
-    VerifyOrExit(sNetworksCount > 0, ret = ot::Dbus::kWpantundStatus_NetworkNotFound);
-    memcpy(sNetworks, wpanController.GetScanNetworksInfo(),
-           sNetworksCount * sizeof(ot::Dbus::WpanNetworkInfo));
-
-    for (int i = 0; i < sNetworksCount; i++)
-    {
-        char extPanId[OT_EXTENDED_PANID_LENGTH * 2 + 1], panId[OT_PANID_LENGTH + 3],
-             hardwareAddress[OT_HARDWARE_ADDRESS_LENGTH * 2 + 1];
-        ot::Utils::Long2Hex(Thread::Encoding::BigEndian::HostSwap64(sNetworks[i].mExtPanId), extPanId);
-        ot::Utils::Bytes2Hex(sNetworks[i].mHardwareAddress, OT_HARDWARE_ADDRESS_LENGTH, hardwareAddress);
-        sprintf(panId, "0x%X", sNetworks[i].mPanId);
-        networkInfo.put("nn", sNetworks[i].mNetworkName);
-        networkInfo.put("xp", extPanId);
-        networkInfo.put("pi", panId);
-        networkInfo.put("ch", sNetworks[i].mChannel);
-        networkInfo.put("ha", hardwareAddress);
-        networks.push_back(std::make_pair("", networkInfo));
-    }
-    root.add_child("result", networks);
 exit:
-    if (ret != ot::Dbus::kWpantundStatus_Ok)
+    if (error != NULL)
     {
-        root.put("result", "failed");
-        syslog(LOG_ERR, "Error is %d", ret);
+        aResponse.BeginObject().Key("error").Int(ot::Dbus::kWpantundStatus_InvalidArgument);
+        if (index >= 0)
+        {
+            aResponse.Key("index").Int(index);
+        }
+        aResponse.Key("message").String(error).EndObject();
     }
-    root.put("error", ret);
-    std::stringstream ss;
-    write_json(ss, root, false);
+    return error == NULL;
+}
+
+static size_t GetQueryParameter(const std::string &aPath, const char *aName, size_t aDefault)
+{
+    size_t      value = aDefault;
+    std::string key = std::string(aName) + "=";
+    size_t      start = aPath.find('?');
 
-    (void)aGetAvailableNetworkRequest;
+    while (start != std::string::npos)
+    {
+        start++;
+        if (aPath.compare(start, key.size(), key) == 0)
+        {
+            value = strtoul(aPath.c_str() + start + key.size(), NULL, 10);
+            break;
+        }
+        start = aPath.find('&', start);
+    }
 
-    return ss.str();
+    return value;
 }
 
-static std::string OnBootMdnsRequest(boost::property_tree::ptree &aBootMdnsRequest, const char *aIfName)
+static bool OnBootMdnsRequest(ot::Utils::JsonReader &aBootMdnsRequest, ot::Utils::JsonWriter &aResponse,
+                              const char *aIfName)
 {
-    std::thread mdnsPublisherThread([]() {
-                ot::Mdns::Publisher::GetInstance().SetServiceName(sNetworkName.c_str());
-                ot::Mdns::Publisher::GetInstance().SetType("_meshcop._udp");
-                ot::Mdns::Publisher::GetInstance().SetPort(OT_BORDER_ROUTER_PORT);
-                sNetworkName = "nn=" + sNetworkName;
-                sExtPanId = "xp=" + sExtPanId;
-                ot::Mdns::Publisher::GetInstance().SetNetworkNameTxt(sNetworkName.c_str());
-                ot::Mdns::Publisher::GetInstance().SetExtPanIdTxt(sExtPanId.c_str());
-                if (sIsStarted)
-                {
-                    ot::Mdns::Publisher::GetInstance().UpdateService();
-                }
-                else
-                {
-                    sIsStarted = true;
-                    ot::Mdns::Publisher::GetInstance().StartClient();
-                }
-            });
+    {
+        std::lock_guard<std::mutex> lock(sNetworkInfoMutex);
 
-    mdnsPublisherThread.detach();
+        sIsMdnsEnabled = true;
+        ot::Mdns::Publisher::GetInstance().Start();
+        UpdateMdnsService();
+    }
 
     (void)aBootMdnsRequest;
     (void)aIfName;
 
-    return HttpReponse(ot::Dbus::kWpantundStatus_Ok);
+    HttpReponse(aResponse, ot::Dbus::kWpantundStatus_Ok);
+    return true;
 }
 
-WebServer::WebServer(void) : mServer(new HttpServer()) {}
+WebServer::WebServer(void) :
+    mServer(new HttpServer()),
+    mEventStream(NULL),
+    mScanInterval(OT_SCAN_DEFAULT_INTERVAL),
+    mWebRoot(NULL),
+    mThreadCount(OT_WEB_DEFAULT_THREADS),
+    mWorkerCount(OT_WEB_DEFAULT_WORKERS),
+    mIdleTimeout(0),
+    mLastRequestTime(0),
+    mIdleTimer(NULL)
+{
+    // The event stream runs on the server io_service, so create it up front.
+    mServer->io_service = std::make_shared<boost::asio::io_service>();
+    mEventStream = new EventStream(*mServer);
+}
 
 WebServer::~WebServer(void)
 {
-    delete &mServer;
+    mWorkerPool.Stop();
+    ot::Mdns::Publisher::GetInstance().Stop();
+    mStaticFileCache.Stop();
+    mScanService.Stop();
+    mMonitor.Stop();
+    sScanService = NULL;
+    sEventStream = NULL;
+    delete mIdleTimer;
+    delete mEventStream;
+    delete mServer;
+}
+
+void WebServer::SetScanInterval(unsigned aInterval)
+{
+    mScanInterval = aInterval;
+}
+
+void WebServer::SetWebRoot(const char *aWebRoot)
+{
+    mWebRoot = aWebRoot;
+}
+
+void WebServer::SetThreadCount(unsigned aThreadCount, unsigned aWorkerCount)
+{
+    mThreadCount = aThreadCount > 0 ? aThreadCount : 1;
+    mWorkerCount = aWorkerCount > 0 ? aWorkerCount : 1;
+}
+
+void WebServer::SetIdleTimeout(unsigned aIdleTimeout)
+{
+    mIdleTimeout = aIdleTimeout;
 }
 
 void WebServer::StartWebServer(const char *aIfName)
 {
+    // Requests, the scan service and the monitor all use DBus from their own threads.
+    dbus_threads_init_default();
     mServer->config.port = 80;
+    if ((mServer->config.native_handle = ot::Systemd::TakeListenSocket(SOCK_STREAM, mServer->config.port)) >= 0)
+    {
+        syslog(LOG_INFO, "using the socket passed for port %u", mServer->config.port);
+    }
+    mServer->config.thread_pool_size = mThreadCount;
+    mWorkerPool.Start(mWorkerCount);
     strncpy(mIfName, aIfName, sizeof(mIfName));
+    mPropertySnapshot.SetInterfaceName(mIfName);
+    sEventStream = mEventStream;
+    mMonitor.SetPropertyChangedHandler(HandlePropertyChanged, this, PropertySnapshot::GetPropertyNames(),
+                                       PropertySnapshot::kPropertiesCount);
+    mMonitor.SetScanBeaconHandler(HandleScanBeacon, this);
+    sScanService = &mScanService;
+    mScanService.SetScanDoneHandler(HandleScanDone, this);
+    mScanService.Start(mIfName, mScanInterval);
+    if (mStaticFileCache.Start(mWebRoot) != 0)
+    {
+        syslog(LOG_WARNING, "frontend files in %s are not watched, changes require a restart", mWebRoot);
+    }
+    if (mMonitor.Start(mIfName) != ot::Dbus::kWpantundStatus_Ok)
+    {
+        syslog(LOG_WARNING, "property changes are not monitored, properties are loaded on every request");
+    }
     JoinNetworkResponse();
     FormNetworkResponse();
     AddOnMeshPrefix();
     DeleteOnMeshPrefix();
+    ConfigureGateways();
     GetNetworkResponse();
+    EventsResponse();
     AvailableNetworkResponse();
     DefaultHttpResponse();
     BootMdnsPublisher();
+    TrackRequests();
+    // Posted handlers only run once the server is listening.
+    mServer->io_service->post([]() {
+                ot::Systemd::Notify("READY=1");
+            });
+    if (mIdleTimeout > 0)
+    {
+        mIdleTimer = new boost::asio::deadline_timer(*mServer->io_service);
+        mLastRequestTime = GetMonotonicMicros();
+        StartIdleTimer(mIdleTimeout);
+    }
     std::thread ServerThread([this]() {
                 mServer->start();
             });
     ServerThread.join();
 }
 
+typedef std::function<void(std::shared_ptr<HttpServer::Response>, std::shared_ptr<HttpServer::Request>)> HttpHandler;
+
+void WebServer::TrackRequests(void)
+{
+    auto track = [this](HttpHandler &aHandler) {
+        HttpHandler handler = aHandler;
+
+        aHandler = [this, handler](std::shared_ptr<HttpServer::Response> aResponse,
+                                   std::shared_ptr<HttpServer::Request> aRequest) {
+            mLastRequestTime = GetMonotonicMicros();
+            handler(aResponse, aRequest);
+        };
+    };
+
+    for (auto &path : mServer->resource)
+    {
+        for (auto &method : path.second)
+        {
+            track(method.second);
+        }
+    }
+
+    for (auto &method : mServer->default_resource)
+    {
+        track(method.second);
+    }
+}
+
+void WebServer::StartIdleTimer(unsigned aSeconds)
+{
+    mIdleTimer->expires_from_now(boost::posix_time::seconds(aSeconds));
+    mIdleTimer->async_wait([this](const boost::system::error_code &aError) {
+                if (!aError)
+                {
+                    HandleIdleTimer();
+                }
+            });
+}
+
+void WebServer::HandleIdleTimer(void)
+{
+    uint64_t idle = (GetMonotonicMicros() - mLastRequestTime) / 1000000;
+    bool     isPublishing;
+
+    {
+        std::lock_guard<std::mutex> lock(sNetworkInfoMutex);
+
+        isPublishing = sIsMdnsEnabled;
+    }
+
+    // The border router stays advertised only as long as this process runs.
+    if (idle >= mIdleTimeout && mEventStream->GetSubscriberCount() == 0 && !isPublishing)
+    {
+        // Started again on demand when the service manager passes the listening socket.
+        syslog(LOG_INFO, "no request for %u seconds, exiting", mIdleTimeout);
+        ot::Systemd::Notify("STOPPING=1");
+        mServer->stop();
+    }
+    else
+    {
+        StartIdleTimer(idle < mIdleTimeout ? mIdleTimeout - static_cast<unsigned>(idle) : mIdleTimeout);
+    }
+}
+
 void WebServer::JoinNetworkResponse(void)
 {
     HandleHttpRequest(OT_JOIN_NETWORK_PATH, OT_REQUEST_METHOD_POST, OnJoinNetworkRequest, mIfName);
@@ -390,150 +831,456 @@ void WebServer::DeleteOnMeshPrefix(void)
     HandleHttpRequest(OT_DELETE_PREFIX_PATH, OT_REQUEST_METHOD_POST, OnDeletePrefixRequest, mIfName);
 }
 
+void WebServer::ConfigureGateways(void)
+{
+    HandleHttpRequest(OT_GATEWAYS_PATH, OT_REQUEST_METHOD_POST, OnGatewaysRequest, mIfName);
+}
+
 void WebServer::GetNetworkResponse(void)
 {
-    HandleHttpRequest(OT_GET_NETWORK_PATH, OT_REQUEST_METHOD_GET, OnGetNetworkRequest, mIfName);
+    mServer->resource[OT_GET_NETWORK_PATH][OT_REQUEST_METHOD_GET] =
+        [this](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
+        {
+            auto send = [this, request](HttpServer::Response &aResponse)
+            {
+                std::string     json, etag;
+                auto            ifNoneMatch = request->header.find(OT_REQUEST_HEADER_IF_NONE_MATCH);
+                ResponseBuilder builder(aResponse, *request);
+
+                mPropertySnapshot.Get(json, etag);
+                builder.SetETag(etag).AddHeader(OT_RESPONSE_HEADER_CACHE_CONTROL, "no-cache");
+
+                // A compressed response carries the weak form of the tag, which contains the strong one.
+                if (ifNoneMatch != request->header.end() &&
+                    (ifNoneMatch->second == "*" || ifNoneMatch->second.find(etag) != std::string::npos))
+                {
+                    builder.SetStatus(OT_RESPONSE_NOT_MODIFIED_STATUS).Send();
+                }
+                else
+                {
+                    builder.Send(OT_RESPONSE_TYPE_JSON, json);
+                }
+            };
+
+            if (!mMonitor.IsRunning())
+            {
+                mPropertySnapshot.Invalidate();
+            }
+
+            // Loading the snapshot takes DBus calls, which are left to the workers.
+            if (mPropertySnapshot.IsValid())
+            {
+                send(*response);
+            }
+            else
+            {
+                RunInWorker(mWorkerPool, *mServer, response, send);
+            }
+        };
 }
 
-void WebServer::AvailableNetworkResponse(void)
+void WebServer::HandlePropertyChanged(void *aContext, const char *aName, const char *aValue)
 {
-    HandleHttpRequest(OT_AVAILABLE_NETWORK_PATH, OT_REQUEST_METHOD_GET, OnGetAvailableNetworkResponse, mIfName);
+    static_cast<WebServer *>(aContext)->HandlePropertyChanged(aName, aValue);
 }
 
-void WebServer::BootMdnsPublisher(void)
+void WebServer::HandlePropertyChanged(const char *aName, const char *aValue)
 {
-    HandleHttpRequest(OT_BOOT_MDNS_PATH, OT_REQUEST_METHOD_GET, OnBootMdnsRequest, mIfName);
+    std::string           property;
+    ot::Utils::JsonWriter writer(property);
+
+    mPropertySnapshot.Update(aName, aValue);
+
+    writer.BeginObject()
+    .Key("name").String(aName)
+    .Key("value").String(aValue)
+    .EndObject();
+    mEventStream->Publish("property", property);
 }
 
-void WebServer::HandleHttpRequest(const char *aUrl, const char *aMethod, HttpRequestCallback aCallback,
-                                  const char *aIfName)
+void WebServer::HandleScanBeacon(void *aContext, const ot::Dbus::WpanNetworkInfo &aNetwork)
 {
-    mServer->resource[aUrl][aMethod] =
-        [aCallback, aIfName](std::shared_ptr<HttpServer::Response> response,
-                             std::shared_ptr<HttpServer::Request> request)
+    static_cast<WebServer *>(aContext)->HandleScanBeacon(aNetwork);
+}
+
+void WebServer::HandleScanBeacon(const ot::Dbus::WpanNetworkInfo &aNetwork)
+{
+    std::string           networkInfo;
+    ot::Utils::JsonWriter writer(networkInfo);
+
+    WriteNetworkInfo(writer, aNetwork);
+    mEventStream->Publish("beacon", networkInfo);
+}
+
+void WebServer::EventsResponse(void)
+{
+    mServer->resource[OT_EVENTS_PATH][OT_REQUEST_METHOD_GET] =
+        [this](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
         {
-            try
+            if (!mMonitor.IsRunning())
             {
-                boost::property_tree::ptree pt;
-                std::string                 httpResponse;
-                if (aCallback != NULL)
-                {
-                    if (request->content.size() > 0)
-                    {
-                        read_json(request->content, pt);
-                    }
-                    httpResponse = aCallback(pt, aIfName);
-                }
+                mPropertySnapshot.Invalidate();
+            }
 
-                *response << OT_RESPONSE_SUCCESS_STATUS
-                          << OT_RESPONSE_HEADER_LENGTH
-                          << httpResponse.length()
-                          << OT_RESPONSE_PLACEHOLD
-                          << httpResponse;
+            if (mPropertySnapshot.IsValid())
+            {
+                SubscribeEvents(mPropertySnapshot, *mEventStream, response);
             }
-            catch (std::exception & e)
+            else
             {
+                std::shared_ptr<boost::asio::io_service> ioService = mServer->io_service;
 
-                *response << OT_RESPONSE_FAILURE_STATUS
-                          << OT_RESPONSE_HEADER_LENGTH
-                          << strlen(e.what())
-                          << OT_RESPONSE_PLACEHOLD
-                          << e.what();
+                // The subscription keeps the response, so it is made on an I/O thread.
+                mWorkerPool.Post([this, ioService, response]() mutable {
+                            std::string json, etag;
+
+                            mPropertySnapshot.Get(json, etag);
+                            ioService->post(std::bind(SubscribeEvents, std::ref(mPropertySnapshot),
+                                                      std::ref(*mEventStream), std::move(response)));
+                        });
             }
+
+            (void)request;
         };
 }
 
-void WebServer::DefaultHttpResponse(void)
+void WebServer::AvailableNetworkResponse(void)
 {
-    mServer->default_resource[OT_REQUEST_METHOD_GET] =
+    mServer->resource[OT_AVAILABLE_NETWORK_PATH][OT_REQUEST_METHOD_GET] =
         [this](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
         {
-            try
+            std::vector<ot::Dbus::WpanNetworkInfo> page;
+            std::string                            body;
+            ot::Utils::JsonWriter                  writer(body);
+            size_t                                 offset = GetQueryParameter(request->path, "offset", 0);
+            size_t                                 limit = GetQueryParameter(request->path, "limit",
+                                                                             OT_SCAN_PAGE_DEFAULT_LIMIT);
+            int                                    total;
+
+            // Answer from the cache right away, a requested scan reports back through /events.
+            if (GetQueryParameter(request->path, "refresh", 0) != 0)
             {
-                auto webRootPath =
-                    boost::filesystem::canonical(WEB_FILE_PATH);
-                auto path = boost::filesystem::canonical(
-                    webRootPath / request->path);
-                //Check if path is within webRootPath
-                if (std::distance(webRootPath.begin(),
-                                  webRootPath.end()) > std::distance(path.begin(), path.end()) ||
-                    !std::equal(webRootPath.begin(), webRootPath.end(),
-                                path.begin()))
-                {
-                    throw std::invalid_argument("path must be within root path");
-                }
-                if (boost::filesystem::is_directory(path))
-                {
-                    path /= "index.html";
-                }
-                if (!(boost::filesystem::exists(path) &&
-                      boost::filesystem::is_regular_file(path)))
-                {
-                    throw std::invalid_argument("file does not exist");
-                }
+                mScanService.Request();
+            }
 
-                std::string cacheControl, etag;
+            total = mScanService.GetNetworks(offset, limit, page);
+            body.reserve(page.size() * OT_NETWORK_INFO_JSON_SIZE);
+            writer.BeginObject().Key("result").BeginArray();
+            for (size_t i = 0; i < page.size(); i++)
+            {
+                WriteNetworkInfo(writer, page[i]);
+            }
+            writer.EndArray()
+            .Key("total").Int(total)
+            .Key("offset").Uint(offset)
+            .Key("limit").Uint(limit)
+            .Key("age").Uint(mScanService.GetAge() / 1000)
+            .Key("scanning").Bool(mScanService.IsScanning())
+            .Key("error").Int(ot::Dbus::kWpantundStatus_Ok)
+            .EndObject();
+
+            ResponseBuilder(*response, *request).Send(OT_RESPONSE_TYPE_JSON, body);
+        };
+}
 
-                auto ifs = std::make_shared<std::ifstream>();
-                ifs->open(
-                    path.string(), std::ifstream::in | std::ios::binary | std::ios::ate);
+void WebServer::HandleScanDone(void *aContext, int aError, int aCount)
+{
+    static_cast<WebServer *>(aContext)->HandleScanDone(aError, aCount);
+}
 
-                if (*ifs)
-                {
-                    auto length = ifs->tellg();
-                    ifs->seekg(0, std::ios::beg);
+void WebServer::HandleScanDone(int aError, int aCount)
+{
+    std::string           scan;
+    ot::Utils::JsonWriter writer(scan);
+
+    writer.BeginObject()
+    .Key("error").Int(aError)
+    .Key("total").Int(aCount)
+    .EndObject();
+    mEventStream->Publish("scan", scan);
+}
+
+void WebServer::BootMdnsPublisher(void)
+{
+    HandleHttpRequest(OT_BOOT_MDNS_PATH, OT_REQUEST_METHOD_GET, OnBootMdnsRequest, mIfName);
+}
 
-                    *response << OT_RESPONSE_SUCCESS_STATUS
-                              << cacheControl << etag
-                              << OT_RESPONSE_HEADER_LENGTH
-                              << length
-                              << OT_RESPONSE_PLACEHOLD;
+void WebServer::HandleHttpRequest(const char *aUrl, const char *aMethod, HttpRequestCallback aCallback,
+                                  const char *aIfName)
+{
+    mServer->resource[aUrl][aMethod] =
+        [this, aCallback, aIfName](std::shared_ptr<HttpServer::Response> response,
+                                   std::shared_ptr<HttpServer::Request> request)
+        {
+            RunInWorker(mWorkerPool, *mServer, response, [aCallback, aIfName, request](HttpServer::Response &aResponse)
+                    {
+                        // Read the body in place, the content is one contiguous buffer.
+                        boost::asio::streambuf &content = *static_cast<boost::asio::streambuf *>(request->content.rdbuf());
+                        ot::Utils::JsonReader   reader(boost::asio::buffer_cast<const char *>(content.data()),
+                                                       content.size());
+                        std::string             httpResponse;
+                        ot::Utils::JsonWriter   writer(httpResponse);
+                        ResponseBuilder         builder(aResponse, *request);
+
+                        if (aCallback(reader, writer, aIfName))
+                        {
+                            builder.Send(OT_RESPONSE_TYPE_JSON, httpResponse);
+                        }
+                        else if (!httpResponse.empty())
+                        {
+                            builder.SetStatus(OT_RESPONSE_FAILURE_STATUS).Send(OT_RESPONSE_TYPE_JSON, httpResponse);
+                        }
+                        else
+                        {
+                            const char *error = reader.GetError() ? reader.GetError() : "invalid value";
 
-                    DefaultResourceSend(*mServer, response, ifs);
-                }
-                else
-                {
-                    throw std::invalid_argument("could not read file");
-                }
+                            builder.SetStatus(OT_RESPONSE_FAILURE_STATUS).Send(OT_RESPONSE_TYPE_TEXT, error);
+                        }
+                    });
+        };
+}
+
+void WebServer::DefaultHttpResponse(void)
+{
+    mServer->default_resource[OT_REQUEST_METHOD_GET] =
+        [this](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
+        {
+            std::string                       path = request->path.substr(0, request->path.find('?'));
+            std::shared_ptr<const StaticFile> file;
+
+            if (path.empty() || path[path.size() - 1] == '/')
+            {
+                path += "index.html";
+            }
 
+            if ((file = mStaticFileCache.Find(path)))
+            {
+                SendCachedFile(response, *request, *file);
             }
-            catch (const std::exception &e)
+            else
             {
-                std::string content = "Could not open path " + request->path + ": " +
-                                      e.what();
-                *response << OT_RESPONSE_FAILURE_STATUS
-                          << OT_RESPONSE_HEADER_LENGTH
-                          << content.length()
-                          << OT_RESPONSE_PLACEHOLD
-                          << content;
+                SendFileFromDisk(*mServer, response, *request, mWebRoot, path);
             }
         };
 }
 
-void DefaultResourceSend(const HttpServer &aServer, const std::shared_ptr<HttpServer::Response> &aResponse,
-                         const std::shared_ptr<std::ifstream> &aIfStream)
+static bool IsETagMatched(const HttpServer::Request &aRequest, const std::string &aETag)
+{
+    bool ret = false;
+    auto range = aRequest.header.equal_range(OT_REQUEST_HEADER_IF_NONE_MATCH);
+
+    for (auto it = range.first; it != range.second && !ret; ++it)
+    {
+        std::istringstream tags(it->second);
+        std::string        tag;
+
+        while (std::getline(tags, tag, ',') && !ret)
+        {
+            boost::algorithm::trim(tag);
+            // If-None-Match uses the weak comparison.
+            if (boost::algorithm::starts_with(tag, "W/"))
+            {
+                tag.erase(0, 2);
+            }
+            ret = (tag == "*" || tag == aETag || "W/" + tag == aETag);
+        }
+    }
+
+    return ret;
+}
+
+static void SendCachedFile(const std::shared_ptr<HttpServer::Response> &aResponse, const HttpServer::Request &aRequest,
+                           const StaticFile &aFile)
+{
+    bool               isGzip = aFile.mGzipContent != NULL &&
+                                ResponseBuilder::GetCodingQuality(aRequest, "gzip") > 0;
+    const std::string &etag = isGzip ? aFile.mGzipETag : aFile.mETag;
+    const char        *content = isGzip ? aFile.mGzipContent : aFile.mContent;
+    size_t             length = isGzip ? aFile.mGzipLength : aFile.mLength;
+    ResponseBuilder    builder(*aResponse, aRequest);
+
+    builder.SetETag(etag).AddHeader(OT_RESPONSE_HEADER_CACHE_CONTROL, aFile.mCacheControl);
+
+    if (aFile.mGzipContent != NULL)
+    {
+        builder.AddHeader(OT_RESPONSE_HEADER_VARY, "Accept-Encoding");
+    }
+
+    if (IsETagMatched(aRequest, etag))
+    {
+        builder.SetStatus(OT_RESPONSE_NOT_MODIFIED_STATUS).Send();
+        ExitNow();
+    }
+
+    if (isGzip)
+    {
+        builder.AddHeader("Content-Encoding", "gzip");
+    }
+
+    // The files are stored compressed already, the content is written as is.
+    builder.SendHeaders(aFile.mContentType, length);
+    aResponse->write(content, static_cast<std::streamsize>(length));
+
+exit:
+    return;
+}
+
+/**
+ * This structure tracks a file being sent with sendfile().
+ *
+ */
+struct FileTransfer
+{
+    FileTransfer(int aFd, off_t aSize) :
+        mFd(aFd),
+        mOffset(0),
+        mRemaining(aSize)
+    {
+    }
+    ~FileTransfer(void)
+    {
+        close(mFd);
+    }
+
+    int   mFd;
+    off_t mOffset;
+    off_t mRemaining;
+};
+
+static void SendFileContent(const std::shared_ptr<HttpServer::Response> &aResponse,
+                            const std::shared_ptr<FileTransfer> &aTransfer)
 {
-    static std::vector<char> buffer(131072); // Safe when server is running on one thread
+    const std::shared_ptr<SimpleWeb::HTTP> &socket = aResponse->get_socket();
+    boost::system::error_code               error;
 
-    std::streamsize readLength;
+    socket->native_non_blocking(true, error);
+    VerifyOrExit(!error);
 
-    if ((readLength = aIfStream->read(&buffer[0], buffer.size()).gcount()) > 0)
+    while (aTransfer->mRemaining > 0)
     {
-        aResponse->write(&buffer[0], readLength);
-        if (readLength == static_cast<std::streamsize>(buffer.size()))
+        ssize_t rval = sendfile(socket->native_handle(), aTransfer->mFd, &aTransfer->mOffset,
+                                static_cast<size_t>(aTransfer->mRemaining));
+
+        if (rval > 0)
+        {
+            aTransfer->mRemaining -= rval;
+        }
+        else if (rval < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
         {
-            aServer.send(aResponse, [&aServer, aResponse, aIfStream](const boost::system::error_code &ec)
+            // The response keeps the connection until the socket becomes writable again.
+            socket->async_write_some(boost::asio::null_buffers(),
+                                     [aResponse, aTransfer](const boost::system::error_code &aError, size_t)
                     {
-                        if (!ec)
+                        if (!aError)
                         {
-                            DefaultResourceSend(aServer, aResponse, aIfStream);
+                            SendFileContent(aResponse, aTransfer);
                         }
                         else
                         {
-                            std::cerr << "Connection interrupted" << std::endl;
+                            aResponse->close_connection_after_response = true;
                         }
                     });
+            ExitNow();
+        }
+        else
+        {
+            // The file was truncated or the peer is gone, the length sent can no longer be honored.
+            syslog(LOG_WARNING, "sendfile() failed: %s", rval < 0 ? strerror(errno) : "unexpected end of file");
+            ExitNow(error = boost::system::errc::make_error_code(boost::system::errc::io_error));
+        }
+    }
+
+exit:
+    if (error)
+    {
+        aResponse->close_connection_after_response = true;
+    }
+}
+
+static void SendFileFromDisk(HttpServer &aServer, const std::shared_ptr<HttpServer::Response> &aResponse,
+                             const HttpServer::Request &aRequest, const char *aRoot, const std::string &aPath)
+{
+    try
+    {
+        // Only the override directory is served from disk, the compiled in files are all cached.
+        if (aRoot == NULL)
+        {
+            throw std::invalid_argument("file does not exist");
+        }
+
+        auto webRootPath =
+            boost::filesystem::canonical(aRoot);
+        auto path = boost::filesystem::canonical(
+            webRootPath / aPath);
+        //Check if path is within webRootPath
+        if (std::distance(webRootPath.begin(),
+                          webRootPath.end()) > std::distance(path.begin(), path.end()) ||
+            !std::equal(webRootPath.begin(), webRootPath.end(),
+                        path.begin()))
+        {
+            throw std::invalid_argument("path must be within root path");
+        }
+        if (boost::filesystem::is_directory(path))
+        {
+            path /= "index.html";
+        }
+        if (!(boost::filesystem::exists(path) &&
+              boost::filesystem::is_regular_file(path)))
+        {
+            throw std::invalid_argument("file does not exist");
         }
+
+        int         fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        char        etag[64];
+
+        if (fd < 0)
+        {
+            throw std::invalid_argument("could not read file");
+        }
+
+        auto transfer = std::make_shared<FileTransfer>(fd, 0);
+
+        if (fstat(fd, &st) != 0)
+        {
+            throw std::invalid_argument("could not read file");
+        }
+
+        transfer->mRemaining = st.st_size;
+        snprintf(etag, sizeof(etag), "W/\"%lx-%lx\"", static_cast<unsigned long>(st.st_mtime),
+                 static_cast<unsigned long>(st.st_size));
+
+        ResponseBuilder builder(*aResponse, aRequest);
+
+        builder.SetETag(etag);
+
+        if (IsETagMatched(aRequest, etag))
+        {
+            builder.SetStatus(OT_RESPONSE_NOT_MODIFIED_STATUS).Send();
+            return;
+        }
+
+        builder.SendHeaders(StaticFileCache::GetContentType(path.string()), static_cast<size_t>(st.st_size));
+
+        // Send the headers before handing the socket to sendfile().
+        aServer.send(aResponse, [aResponse, transfer](const boost::system::error_code &ec)
+                {
+                    if (!ec)
+                    {
+                        SendFileContent(aResponse, transfer);
+                    }
+                    else
+                    {
+                        aResponse->close_connection_after_response = true;
+                    }
+                });
+    }
+    catch (const std::exception &e)
+    {
+        std::string content = "Could not open path " + aPath + ": " +
+                              e.what();
+        ResponseBuilder(*aResponse, aRequest).SetStatus(OT_RESPONSE_NOT_FOUND_STATUS)
+        .Send(OT_RESPONSE_TYPE_TEXT, content);
     }
 }
 
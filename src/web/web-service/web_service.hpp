@@ -35,6 +35,7 @@
 #define WEB_SERVICE
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -43,21 +44,37 @@
 #include <net/if.h>
 #include <syslog.h>
 
-#include <boost/property_tree/ptree_fwd.hpp>
+#include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include "property_snapshot.hpp"
+#include "scan_service.hpp"
+#include "static_file_cache.hpp"
+#include "worker_pool.hpp"
+#include "../wpan-controller/dbus_monitor.hpp"
 #include "../wpan-controller/wpan_controller.hpp"
 
+#define OT_SCAN_DEFAULT_INTERVAL 300
+#define OT_WEB_DEFAULT_THREADS 2
+#define OT_WEB_DEFAULT_WORKERS 2
+
 namespace SimpleWeb {
 template<class T> class Server;
 typedef boost::asio::ip::tcp::socket HTTP;
 }
 
 namespace ot {
+namespace Utils {
+class JsonReader;
+class JsonWriter;
+}
+
 namespace Web {
 
 typedef SimpleWeb::Server<SimpleWeb::HTTP> HttpServer;
 
+class EventStream;
+
 class WebServer
 {
 public:
@@ -65,6 +82,41 @@ public:
     ~WebServer(void);
     void StartWebServer(const char *aIfName);
 
+    /**
+     * This method sets the interval of background scans. It must be called before StartWebServer().
+     *
+     * @param[in]  aInterval  The interval in seconds, 0 to only scan on demand.
+     *
+     */
+    void SetScanInterval(unsigned aInterval);
+
+    /**
+     * This method sets a directory to serve the frontend files from instead of the compiled in
+     * ones, which is useful when developing the frontend. It must be called before StartWebServer().
+     *
+     * @param[in]  aWebRoot  A pointer to the directory, NULL to serve the compiled in files.
+     *
+     */
+    void SetWebRoot(const char *aWebRoot);
+
+    /**
+     * This method sets the number of threads. It must be called before StartWebServer().
+     *
+     * @param[in]  aThreadCount  The number of threads serving HTTP.
+     * @param[in]  aWorkerCount  The number of threads running DBus operations of requests.
+     *
+     */
+    void SetThreadCount(unsigned aThreadCount, unsigned aWorkerCount);
+
+    /**
+     * This method makes StartWebServer() return once no request has been received for a while and no client
+     * is subscribed to events. It must be called before StartWebServer().
+     *
+     * @param[in]  aIdleTimeout  The idle period in seconds, 0 to serve forever.
+     *
+     */
+    void SetIdleTimeout(unsigned aIdleTimeout);
+
     enum
     {
         kPropertyType_String = 0,
@@ -72,21 +124,52 @@ public:
     };
 
 private:
-    typedef std::string (*HttpRequestCallback)(boost::property_tree::ptree &aPtreeObject, const char *aIfName);
+    /**
+     * This function pointer handles the JSON body of a request.
+     *
+     * On success the response is sent with 200. On failure it is sent with 400, and is either what
+     * the callback wrote or the error of the reader.
+     *
+     */
+    typedef bool (*HttpRequestCallback)(ot::Utils::JsonReader &aRequest, ot::Utils::JsonWriter &aResponse,
+                                        const char *aIfName);
 
     void HandleHttpRequest(const char *aUrl, const char *aMethod, HttpRequestCallback aCallback, const char *aIfName);
     void JoinNetworkResponse(void);
     void FormNetworkResponse(void);
     void AddOnMeshPrefix(void);
     void DeleteOnMeshPrefix(void);
+    void ConfigureGateways(void);
     void GetNetworkResponse(void);
+    void EventsResponse(void);
     void AvailableNetworkResponse(void);
     void BootMdnsPublisher(void);
     void DefaultHttpResponse(void);
+    void TrackRequests(void);
+    void StartIdleTimer(unsigned aSeconds);
+    void HandleIdleTimer(void);
+
+    static void HandlePropertyChanged(void *aContext, const char *aName, const char *aValue);
+    void HandlePropertyChanged(const char *aName, const char *aValue);
+    static void HandleScanBeacon(void *aContext, const ot::Dbus::WpanNetworkInfo &aNetwork);
+    void HandleScanBeacon(const ot::Dbus::WpanNetworkInfo &aNetwork);
+    static void HandleScanDone(void *aContext, int aError, int aCount);
+    void HandleScanDone(int aError, int aCount);
 
     HttpServer                      *mServer;
-    static ot::Dbus::WpanNetworkInfo sNetworks[DBUS_MAXIMUM_NAME_LENGTH];
-    static int                       sNetworksCount;
+    EventStream                     *mEventStream;
+    ot::Dbus::DBusMonitor            mMonitor;
+    PropertySnapshot                 mPropertySnapshot;
+    ScanService                      mScanService;
+    StaticFileCache                  mStaticFileCache;
+    unsigned                         mScanInterval;
+    const char                      *mWebRoot;
+    unsigned                         mThreadCount;
+    unsigned                         mWorkerCount;
+    WorkerPool                       mWorkerPool;
+    unsigned                         mIdleTimeout;
+    std::atomic<uint64_t>            mLastRequestTime;
+    boost::asio::deadline_timer     *mIdleTimer;
     static std::string               sNetowrkName, sExtPanId;
     static bool                      sIsStarted;
     char                             mIfName[IFNAMSIZ];
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the worker pool running blocking operations of the web service
+ */
+
+#include "worker_pool.hpp"
+
+#include <syslog.h>
+
+namespace ot {
+namespace Web {
+
+WorkerPool::WorkerPool(void)
+{
+}
+
+WorkerPool::~WorkerPool(void)
+{
+    Stop();
+}
+
+void WorkerPool::Start(size_t aCount)
+{
+    mWork.reset(new boost::asio::io_service::work(mIoService));
+
+    for (size_t i = 0; i < aCount; i++)
+    {
+        mThreads.push_back(std::thread([this]() {
+                    mIoService.run();
+                }));
+    }
+
+    syslog(LOG_INFO, "started %zu workers", aCount);
+}
+
+void WorkerPool::Stop(void)
+{
+    mWork.reset();
+
+    for (size_t i = 0; i < mThreads.size(); i++)
+    {
+        mThreads[i].join();
+    }
+
+    mThreads.clear();
+}
+
+void WorkerPool::Post(const std::function<void(void)> &aTask)
+{
+    mIoService.post(aTask);
+}
+
+} //namespace Web
+} //namespace ot
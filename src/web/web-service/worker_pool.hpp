@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the worker pool running blocking operations of the web service
+ */
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+
+#include <boost/asio/io_service.hpp>
+
+namespace ot {
+namespace Web {
+
+/**
+ * This class runs tasks on a fixed set of threads.
+ *
+ * DBus calls to wpantund may block for up to a minute, running them here keeps the threads
+ * serving HTTP free for static files and cached data.
+ *
+ */
+class WorkerPool
+{
+public:
+    WorkerPool(void);
+    ~WorkerPool(void);
+
+    /**
+     * This method starts the worker threads.
+     *
+     * @param[in]  aCount  The number of worker threads.
+     *
+     */
+    void Start(size_t aCount);
+
+    /**
+     * This method stops the worker threads after the tasks already queued are done.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This method queues a task to run on one of the worker threads.
+     *
+     * @param[in]  aTask  The task to run.
+     *
+     */
+    void Post(const std::function<void(void)> &aTask);
+
+private:
+    boost::asio::io_service                        mIoService;
+    std::unique_ptr<boost::asio::io_service::work> mWork;
+    std::vector<std::thread>                       mThreads;
+};
+
+} //namespace Web
+} //namespace ot
+
+#endif  //WORKER_POOL_HPP
@@ -37,9 +37,6 @@
 #include "dbus_base.hpp"
 #include "wpan_controller.hpp"
 
-
-#define OT_DEFAULT_TIMEOUT_IN_MILLISECONDS 60 * 1000
-
 namespace ot {
 namespace Dbus {
 
@@ -38,6 +38,8 @@
 
 #include <dbus/dbus.h>
 
+#define OT_DEFAULT_TIMEOUT_IN_MILLISECONDS 60 * 1000
+
 namespace ot {
 namespace Dbus {
 
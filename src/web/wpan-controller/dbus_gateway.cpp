@@ -32,6 +32,8 @@
  */
 
 
+#include <vector>
+
 #include "common/code_utils.hpp"
 #include "utils/hex.hpp"
 
@@ -102,5 +104,124 @@ exit:
     return ret;
 }
 
+static bool AppendOperation(DBusMessage *aMessage, const WpanGatewayOperation &aOperation)
+{
+    const uint8_t *prefix = aOperation.mPrefix;
+    dbus_uint16_t  domainId = 0;
+    dbus_bool_t    ret = FALSE;
+
+    switch (aOperation.mType)
+    {
+    case kGatewayOperation_AddPrefix:
+    case kGatewayOperation_RemovePrefix:
+    {
+        dbus_bool_t   defaultRoute = aOperation.mIsDefaultRoute;
+        dbus_uint32_t lifetime = aOperation.mType == kGatewayOperation_AddPrefix ? 0xFFFFFFFF : 0;
+
+        ret = dbus_message_append_args(aMessage, DBUS_TYPE_BOOLEAN, &defaultRoute,
+                                       DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &prefix, sizeof(aOperation.mPrefix),
+                                       DBUS_TYPE_UINT32, &lifetime, DBUS_TYPE_UINT32, &lifetime,
+                                       DBUS_TYPE_INVALID);
+        break;
+    }
+
+    case kGatewayOperation_AddRoute:
+    {
+        dbus_int16_t preference = aOperation.mPreference;
+
+        ret = dbus_message_append_args(aMessage, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &prefix, sizeof(aOperation.mPrefix),
+                                       DBUS_TYPE_UINT16, &domainId, DBUS_TYPE_INT16, &preference,
+                                       DBUS_TYPE_BYTE, &aOperation.mPrefixLength, DBUS_TYPE_INVALID);
+        break;
+    }
+
+    case kGatewayOperation_RemoveRoute:
+        ret = dbus_message_append_args(aMessage, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE, &prefix, sizeof(aOperation.mPrefix),
+                                       DBUS_TYPE_UINT16, &domainId,
+                                       DBUS_TYPE_BYTE, &aOperation.mPrefixLength, DBUS_TYPE_INVALID);
+        break;
+
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+int DBusGateway::ProcessOperations(WpanGatewayOperation *aOperations, int aCount)
+{
+    int                            ret = kWpantundStatus_Ok;
+    DBusConnection                *connection = NULL;
+    std::vector<DBusPendingCall *> pendings(aCount, static_cast<DBusPendingCall *>(NULL));
+
+    VerifyOrExit((connection = GetConnection()) != NULL, ret = kWpantundStatus_InvalidConnection);
+
+    // Issue every call before waiting on any reply, wpantund handles them in the order sent.
+    for (int i = 0; i < aCount; i++)
+    {
+        bool         isRoute = aOperations[i].mType == kGatewayOperation_AddRoute ||
+                               aOperations[i].mType == kGatewayOperation_RemoveRoute;
+        DBusMessage *message = NULL;
+
+        SetMethod(!isRoute ? WPANTUND_IF_CMD_CONFIG_GATEWAY :
+                  aOperations[i].mType == kGatewayOperation_AddRoute ? WPANTUND_IF_CMD_ROUTE_ADD :
+                  WPANTUND_IF_CMD_ROUTE_REMOVE);
+        aOperations[i].mStatus = kWpantundStatus_InvalidMessage;
+        if ((message = GetMessage()) == NULL)
+        {
+            continue;
+        }
+
+        if (!AppendOperation(message, aOperations[i]))
+        {
+            aOperations[i].mStatus = kWpantundStatus_InvalidArgument;
+        }
+        else if (!dbus_connection_send_with_reply(connection, message, &pendings[i],
+                                                  OT_DEFAULT_TIMEOUT_IN_MILLISECONDS) || pendings[i] == NULL)
+        {
+            aOperations[i].mStatus = kWpantundStatus_InvalidPending;
+        }
+        dbus_message_unref(message);
+    }
+
+    dbus_connection_flush(connection);
+
+    for (int i = 0; i < aCount; i++)
+    {
+        DBusMessage *reply = NULL;
+
+        if (pendings[i] != NULL)
+        {
+            dbus_pending_call_block(pendings[i]);
+            reply = dbus_pending_call_steal_reply(pendings[i]);
+            dbus_pending_call_unref(pendings[i]);
+
+            if (reply == NULL || dbus_message_get_type(reply) != DBUS_MESSAGE_TYPE_METHOD_RETURN ||
+                !dbus_message_get_args(reply, NULL, DBUS_TYPE_INT32, &aOperations[i].mStatus, DBUS_TYPE_INVALID))
+            {
+                aOperations[i].mStatus = kWpantundStatus_InvalidReply;
+            }
+        }
+
+        if (aOperations[i].mStatus != kWpantundStatus_Ok)
+        {
+            syslog(LOG_WARNING, "gateway operation %d failed: %d", i, aOperations[i].mStatus);
+            ret = kWpantundStatus_SetGatewayFailed;
+        }
+
+        if (reply != NULL)
+        {
+            dbus_message_unref(reply);
+        }
+    }
+
+exit:
+    if (connection != NULL)
+    {
+        dbus_connection_unref(connection);
+    }
+    return ret;
+}
+
 } //namespace Dbus
 } //namespace ot
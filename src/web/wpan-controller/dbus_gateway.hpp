@@ -54,6 +54,22 @@ public:
     DBusGateway(void);
 
     int ProcessReply(void);
+
+    /**
+     * This method applies several on-mesh prefix and external route changes.
+     *
+     * All the calls are sent before any reply is waited for, so the total latency is roughly
+     * that of wpantund applying them rather than one round trip each.
+     *
+     * @param[inout]  aOperations  A pointer to the operations. On return mStatus of each is filled.
+     * @param[in]     aCount       The number of operations.
+     *
+     * @retval kWpantundStatus_Ok                 Successfully applied all the operations.
+     * @retval kWpantundStatus_SetGatewayFailed   At least one operation failed, see mStatus of each.
+     * @retval kWpantundStatus_InvalidConnection  The DBus connection is invalid.
+     *
+     */
+    int ProcessOperations(WpanGatewayOperation *aOperations, int aCount);
     void SetDefaultRoute(dbus_bool_t aDefaultRoute)
     {
         mDefaultRoute = aDefaultRoute;
@@ -31,6 +31,8 @@
  *   This file implements the function of "get property"
  */
 
+#include <vector>
+
 #include "common/code_utils.hpp"
 
 #include "dbus_get.hpp"
@@ -38,8 +40,8 @@
 namespace ot {
 namespace Dbus {
 
-static void DumpInfoFromIter(char *aOutput, DBusMessageIter *aIter, int aIndent,
-                             bool aBare)
+void DumpInfoFromIter(char *aOutput, DBusMessageIter *aIter, int aIndent,
+                      bool aBare)
 {
     DBusMessageIter subIter;
 
@@ -260,5 +262,89 @@ PropertyNameValue *DBusGet::GetPropertyList(void)
 
 }
 
+int DBusGet::GetPropertyValues(WpanPropertyValue *aProperties, int aCount)
+{
+    int                            ret = kWpantundStatus_Ok;
+    const char                    *method = "PropGet";
+    DBusConnection                *connection = NULL;
+    std::vector<DBusPendingCall *> pendings(aCount, static_cast<DBusPendingCall *>(NULL));
+
+    VerifyOrExit((connection = GetConnection()) != NULL, ret = kWpantundStatus_InvalidConnection);
+    SetMethod(method);
+
+    // Issue every request before waiting on any reply.
+    for (int i = 0; i < aCount; i++)
+    {
+        DBusMessage *message = GetMessage();
+
+        aProperties[i].mStatus = kWpantundStatus_InvalidMessage;
+        memset(aProperties[i].mValue, 0, sizeof(aProperties[i].mValue));
+        if (message == NULL)
+        {
+            continue;
+        }
+
+        dbus_message_append_args(message, DBUS_TYPE_STRING, &aProperties[i].mName,
+                                 DBUS_TYPE_INVALID);
+        if (!dbus_connection_send_with_reply(connection, message, &pendings[i],
+                                             OT_DEFAULT_TIMEOUT_IN_MILLISECONDS) || pendings[i] == NULL)
+        {
+            aProperties[i].mStatus = kWpantundStatus_InvalidPending;
+        }
+        dbus_message_unref(message);
+    }
+
+    dbus_connection_flush(connection);
+
+    for (int i = 0; i < aCount; i++)
+    {
+        DBusMessage    *reply = NULL;
+        DBusMessageIter iter;
+
+        if (pendings[i] == NULL)
+        {
+            ret = kWpantundStatus_GetFailed;
+            continue;
+        }
+
+        dbus_pending_call_block(pendings[i]);
+        reply = dbus_pending_call_steal_reply(pendings[i]);
+        dbus_pending_call_unref(pendings[i]);
+
+        if (reply == NULL || dbus_message_get_type(reply) != DBUS_MESSAGE_TYPE_METHOD_RETURN)
+        {
+            aProperties[i].mStatus = kWpantundStatus_InvalidReply;
+        }
+        else
+        {
+            dbus_message_iter_init(reply, &iter);
+            dbus_message_iter_get_basic(&iter, &aProperties[i].mStatus);
+            if (aProperties[i].mStatus == kWpantundStatus_Ok)
+            {
+                dbus_message_iter_next(&iter);
+                DumpInfoFromIter(aProperties[i].mValue, &iter, 0, false);
+            }
+        }
+
+        if (aProperties[i].mStatus != kWpantundStatus_Ok)
+        {
+            syslog(LOG_WARNING, "get property %s failed: %d", aProperties[i].mName, aProperties[i].mStatus);
+            ret = kWpantundStatus_GetFailed;
+        }
+
+        if (reply != NULL)
+        {
+            dbus_message_unref(reply);
+        }
+    }
+
+exit:
+    if (connection != NULL)
+    {
+        dbus_connection_unref(connection);
+    }
+    return ret;
+}
+
 } //namespace Dbus
 } //namespace ot
@@ -36,7 +36,6 @@
 
 #define OT_LIST_MAX_LENGTH 100
 #define OT_PROPERTY_NAME_SIZE 512
-#define OT_PROPERTY_VALUE_SIZE 512
 
 #include <math.h>
 #include <stdio.h>
@@ -56,6 +55,17 @@ struct PropertyNameValue
     char value[OT_PROPERTY_VALUE_SIZE];
 };
 
+/**
+ * This function appends the textual form of the value at @p aIter to @p aOutput.
+ *
+ * @param[inout]  aOutput  A pointer to the output buffer, at least OT_PROPERTY_VALUE_SIZE bytes.
+ * @param[in]     aIter    A pointer to the iterator of the value.
+ * @param[in]     aIndent  The indent level of nested arrays.
+ * @param[in]     aBare    Whether the value is printed without decoration.
+ *
+ */
+void DumpInfoFromIter(char *aOutput, DBusMessageIter *aIter, int aIndent, bool aBare);
+
 class DBusGet : public DBusBase
 {
 public:
@@ -65,6 +75,22 @@ public:
     const char *GetPropertyValue(const char *aPropertyName);
     PropertyNameValue *GetPropertyList(void);
 
+    /**
+     * This method gets several properties with one round trip.
+     *
+     * All PropGet calls are sent before any reply is waited for, so the total latency is
+     * roughly that of the slowest property rather than the sum of all of them.
+     *
+     * @param[inout]  aProperties  A pointer to the properties, each with mName set.
+     * @param[in]     aCount       The number of properties.
+     *
+     * @retval kWpantundStatus_Ok                 Successfully got all the properties.
+     * @retval kWpantundStatus_GetFailed          At least one property failed, see mStatus of each.
+     * @retval kWpantundStatus_InvalidConnection  The DBus connection is invalid.
+     *
+     */
+    int GetPropertyValues(WpanPropertyValue *aProperties, int aCount);
+
 private:
     int GetAllPropertyNames(void);
     void GetAllPropertyValues(int aPropCnt);
@@ -0,0 +1,240 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the monitor of wpantund DBus signals
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common/code_utils.hpp"
+
+#include "dbus_get.hpp"
+#include "dbus_monitor.hpp"
+#include "dbus_scan.hpp"
+
+#define OT_MONITOR_DISPATCH_TIMEOUT_IN_MILLISECONDS 1000
+
+namespace ot {
+namespace Dbus {
+
+DBusMonitor::DBusMonitor(void) :
+    mConnection(NULL),
+    mRunning(false),
+    mPropertyChangedHandler(NULL),
+    mPropertyChangedContext(NULL),
+    mPropertyNames(NULL),
+    mPropertyCount(0),
+    mScanBeaconHandler(NULL),
+    mScanBeaconContext(NULL)
+{
+    mMatchRule[0] = '\0';
+}
+
+DBusMonitor::~DBusMonitor(void)
+{
+    Stop();
+}
+
+void DBusMonitor::SetPropertyChangedHandler(PropertyChangedHandler aHandler, void *aContext,
+                                            const char *const *aNames, size_t aCount)
+{
+    mPropertyChangedHandler = aHandler;
+    mPropertyChangedContext = aContext;
+    mPropertyNames = aNames;
+    mPropertyCount = aCount;
+}
+
+void DBusMonitor::SetScanBeaconHandler(ScanBeaconHandler aHandler, void *aContext)
+{
+    mScanBeaconHandler = aHandler;
+    mScanBeaconContext = aContext;
+}
+
+int DBusMonitor::Start(const char *aInterfaceName)
+{
+    int       ret = kWpantundStatus_Ok;
+    DBusError error;
+
+    dbus_error_init(&error);
+    VerifyOrExit(aInterfaceName != NULL, ret = kWpantundStatus_InvalidArgument);
+    VerifyOrExit(mConnection == NULL);
+
+    // The monitor thread and the request handlers use libdbus concurrently.
+    dbus_threads_init_default();
+
+    mConnection = dbus_bus_get_private(DBUS_BUS_STARTER, &error);
+    if (mConnection == NULL)
+    {
+        dbus_error_free(&error);
+        dbus_error_init(&error);
+        mConnection = dbus_bus_get_private(DBUS_BUS_SYSTEM, &error);
+    }
+    VerifyOrExit(mConnection != NULL, ret = kWpantundStatus_InvalidConnection);
+    dbus_connection_set_exit_on_disconnect(mConnection, FALSE);
+
+    // Only signals of this interface, i.e. from its object path or any path below it.
+    snprintf(mMatchRule, sizeof(mMatchRule),
+             "type='signal',interface='%s',path_namespace='%s/%s'",
+             WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_DBUS_PATH, aInterfaceName);
+    dbus_bus_add_match(mConnection, mMatchRule, &error);
+    VerifyOrExit(!dbus_error_is_set(&error), ret = kWpantundStatus_Failure);
+    VerifyOrExit(dbus_connection_add_filter(mConnection, HandleSignal, this, NULL),
+                 ret = kWpantundStatus_Failure);
+
+    mRunning = true;
+    mThread = std::thread(&DBusMonitor::Run, this);
+
+exit:
+    if (dbus_error_is_set(&error))
+    {
+        syslog(LOG_ERR, "monitor error: %s", error.message);
+        dbus_error_free(&error);
+    }
+    if (ret != kWpantundStatus_Ok && mConnection != NULL)
+    {
+        dbus_connection_close(mConnection);
+        dbus_connection_unref(mConnection);
+        mConnection = NULL;
+    }
+    return ret;
+}
+
+void DBusMonitor::Stop(void)
+{
+    VerifyOrExit(mConnection != NULL);
+
+    mRunning = false;
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+
+    dbus_connection_remove_filter(mConnection, HandleSignal, this);
+    dbus_bus_remove_match(mConnection, mMatchRule, NULL);
+    dbus_connection_close(mConnection);
+    dbus_connection_unref(mConnection);
+    mConnection = NULL;
+
+exit:
+    return;
+}
+
+void DBusMonitor::Run(void)
+{
+    while (mRunning &&
+           dbus_connection_read_write_dispatch(mConnection, OT_MONITOR_DISPATCH_TIMEOUT_IN_MILLISECONDS))
+    {
+    }
+
+    if (mRunning)
+    {
+        syslog(LOG_ERR, "monitor disconnected from DBus");
+        mRunning = false;
+    }
+}
+
+DBusHandlerResult DBusMonitor::HandleSignal(DBusConnection *aConnection, DBusMessage *aMessage, void *aContext)
+{
+    (void)aConnection;
+    return static_cast<DBusMonitor *>(aContext)->HandleSignal(*aMessage);
+}
+
+DBusHandlerResult DBusMonitor::HandleSignal(DBusMessage &aMessage)
+{
+    DBusHandlerResult result = DBUS_HANDLER_RESULT_HANDLED;
+
+    if (dbus_message_is_signal(&aMessage, WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_SIGNAL_PROP_CHANGED))
+    {
+        HandlePropertyChanged(aMessage);
+    }
+    else if (dbus_message_is_signal(&aMessage, WPANTUND_DBUS_APIv1_INTERFACE, WPANTUND_IF_SIGNAL_NET_SCAN_BEACON))
+    {
+        HandleScanBeacon(aMessage);
+    }
+    else
+    {
+        result = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+
+    return result;
+}
+
+void DBusMonitor::HandlePropertyChanged(DBusMessage &aMessage)
+{
+    DBusMessageIter iter;
+    const char     *name = NULL;
+    char            value[OT_PROPERTY_VALUE_SIZE];
+
+    VerifyOrExit(mPropertyChangedHandler != NULL);
+    VerifyOrExit(dbus_message_iter_init(&aMessage, &iter));
+    VerifyOrExit(dbus_message_iter_get_arg_type(&iter) == DBUS_TYPE_STRING);
+    dbus_message_iter_get_basic(&iter, &name);
+    VerifyOrExit(IsPropertyReported(name));
+    VerifyOrExit(dbus_message_iter_next(&iter));
+
+    memset(value, 0, sizeof(value));
+    DumpInfoFromIter(value, &iter, 0, false);
+    mPropertyChangedHandler(mPropertyChangedContext, name, value);
+
+exit:
+    return;
+}
+
+bool DBusMonitor::IsPropertyReported(const char *aName) const
+{
+    for (size_t i = 0; i < mPropertyCount; i++)
+    {
+        if (strcmp(mPropertyNames[i], aName) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void DBusMonitor::HandleScanBeacon(DBusMessage &aMessage)
+{
+    DBusMessageIter iter;
+    WpanNetworkInfo network;
+
+    VerifyOrExit(mScanBeaconHandler != NULL);
+    VerifyOrExit(dbus_message_iter_init(&aMessage, &iter));
+    VerifyOrExit(DBusScan::ParseNetworkInfoFromIter(&network, &iter) == 0);
+    VerifyOrExit(network.mNetworkName[0] != '\0');
+    mScanBeaconHandler(mScanBeaconContext, network);
+
+exit:
+    return;
+}
+
+} //namespace Dbus
+} //namespace ot
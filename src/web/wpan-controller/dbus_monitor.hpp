@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file implements the monitor of wpantund DBus signals
+ */
+
+#ifndef DBUS_MONITOR_HPP
+#define DBUS_MONITOR_HPP
+
+#include <atomic>
+#include <thread>
+
+#include <dbus/dbus.h>
+
+#include "wpan_controller.hpp"
+
+namespace ot {
+namespace Dbus {
+
+/**
+ * This function pointer is called when a wpantund property of the monitored interface changes.
+ *
+ * @param[in]  aContext  A pointer to application-specific context.
+ * @param[in]  aName     A pointer to the property name.
+ * @param[in]  aValue    A pointer to the property value, formatted the same way as WPANController::Get().
+ *
+ */
+typedef void (*PropertyChangedHandler)(void *aContext, const char *aName, const char *aValue);
+
+/**
+ * This function pointer is called when a beacon is received during a scan on the monitored interface.
+ *
+ * @param[in]  aContext  A pointer to application-specific context.
+ * @param[in]  aNetwork  A reference to the network the beacon advertises.
+ *
+ */
+typedef void (*ScanBeaconHandler)(void *aContext, const WpanNetworkInfo &aNetwork);
+
+/**
+ * This class listens to the signals wpantund emits for one interface.
+ *
+ * Signals are received on a private DBus connection and dispatched on a dedicated thread, so
+ * handlers are called on that thread and must synchronize on their own.
+ *
+ */
+class DBusMonitor
+{
+public:
+    DBusMonitor(void);
+    ~DBusMonitor(void);
+
+    /**
+     * This method starts monitoring the given interface.
+     *
+     * @param[in]  aInterfaceName  A pointer to the interface name of the wpantund.
+     *
+     * @retval kWpantundStatus_Ok                 Successfully started monitoring.
+     * @retval kWpantundStatus_InvalidConnection  The DBus connection is invalid.
+     * @retval kWpantundStatus_Failure            Failed to subscribe the signals.
+     *
+     */
+    int Start(const char *aInterfaceName);
+
+    /**
+     * This method stops monitoring and joins the dispatch thread.
+     *
+     */
+    void Stop(void);
+
+    /**
+     * This method sets the handler of property changes. It must be called before Start().
+     *
+     * wpantund signals every property it changes, including counters and tables, so only
+     * the given properties are reported.
+     *
+     * @param[in]  aHandler  The handler to be called on every PropChanged signal of the given properties.
+     * @param[in]  aContext  A pointer to application-specific context.
+     * @param[in]  aNames    A pointer to the names of the properties to report.
+     * @param[in]  aCount    The number of names in aNames.
+     *
+     */
+    void SetPropertyChangedHandler(PropertyChangedHandler aHandler, void *aContext, const char *const *aNames,
+                                   size_t aCount);
+
+    /**
+     * This method sets the handler of scan beacons. It must be called before Start().
+     *
+     * @param[in]  aHandler  The handler to be called on every NetScanBeacon signal.
+     * @param[in]  aContext  A pointer to application-specific context.
+     *
+     */
+    void SetScanBeaconHandler(ScanBeaconHandler aHandler, void *aContext);
+
+    /**
+     * This method indicates whether the monitor is receiving signals.
+     *
+     * @returns Whether the monitor is running.
+     *
+     */
+    bool IsRunning(void) const { return mRunning; }
+
+private:
+    static DBusHandlerResult HandleSignal(DBusConnection *aConnection, DBusMessage *aMessage, void *aContext);
+    DBusHandlerResult HandleSignal(DBusMessage &aMessage);
+    void HandlePropertyChanged(DBusMessage &aMessage);
+    void HandleScanBeacon(DBusMessage &aMessage);
+    bool IsPropertyReported(const char *aName) const;
+    void Run(void);
+
+    DBusConnection        *mConnection;
+    std::thread            mThread;
+    std::atomic<bool>      mRunning;
+    char                   mMatchRule[DBUS_MAXIMUM_MATCH_RULE_LENGTH];
+
+    PropertyChangedHandler mPropertyChangedHandler;
+    void                  *mPropertyChangedContext;
+    const char *const     *mPropertyNames;
+    size_t                 mPropertyCount;
+    ScanBeaconHandler      mScanBeaconHandler;
+    void                  *mScanBeaconContext;
+};
+
+} //namespace Dbus
+} //namespace ot
+#endif  //DBUS_MONITOR_HPP
@@ -49,7 +49,9 @@ int DBusScan::ProcessReply(void)
     DBusMessage      *reply = NULL;
     DBusConnection   *dbusConnection = NULL;
     DBusPendingCall  *pending = NULL;
-    static const char dbusObjectManagerMatchString[] = "type='signal'";
+    static const char dbusObjectManagerMatchString[] = "type='signal',interface='" WPANTUND_DBUS_APIv1_INTERFACE "',"
+                                                       "member='" WPANTUND_IF_SIGNAL_NET_SCAN_BEACON "'";
+    bool              isFilterAdded = false;
     DBusMessageIter   iter;
     DBusError         error;
 
@@ -61,7 +63,9 @@ int DBusScan::ProcessReply(void)
     memset(mAvailableNetworks, 0, sizeof(mAvailableNetworks));
     mAvailableNetworksCnt = 0;
 
-    dbus_connection_add_filter(dbusConnection, &DbusBeaconHandler, NULL, NULL);
+    VerifyOrExit(dbus_connection_add_filter(dbusConnection, &DbusBeaconHandler, NULL, NULL),
+                 ret = kWpantundStatus_Failure);
+    isFilterAdded = true;
     SetMethod(method);
     VerifyOrExit((messsage = GetMessage()) != NULL, ret = kWpantundStatus_InvalidMessage);
     dbus_message_append_args(messsage, DBUS_TYPE_UINT32, &mChannelMask,
@@ -82,6 +86,23 @@ int DBusScan::ProcessReply(void)
     // Get return code
     dbus_message_iter_get_basic(&iter, &ret);
 exit:
+    // The connection is shared, so leave no match or filter behind for the next scan to duplicate.
+    if (dbusConnection != NULL)
+    {
+        if (isFilterAdded)
+        {
+            dbus_connection_remove_filter(dbusConnection, &DbusBeaconHandler, NULL);
+        }
+        dbus_bus_remove_match(dbusConnection, dbusObjectManagerMatchString, NULL);
+    }
+    if (reply != NULL)
+    {
+        dbus_message_unref(reply);
+    }
+    if (pending != NULL)
+    {
+        dbus_pending_call_unref(pending);
+    }
     if (dbus_error_is_set(&error))
     {
         syslog(LOG_ERR, "scan error: %s", error.message);
@@ -107,7 +128,24 @@ DBusHandlerResult DBusScan::DbusBeaconHandler(DBusConnection *aConnection,
 
     if (networkInfo.mNetworkName[0])
     {
-        if (mAvailableNetworksCnt < OT_SCANNED_NET_BUFFER_SIZE)
+        int i;
+
+        // The same network may beacon on every scanned channel pass, keep its best RSSI only.
+        for (i = 0; i < mAvailableNetworksCnt; i++)
+        {
+            if (mAvailableNetworks[i].mExtPanId == networkInfo.mExtPanId &&
+                memcmp(mAvailableNetworks[i].mHardwareAddress, networkInfo.mHardwareAddress,
+                       sizeof(networkInfo.mHardwareAddress)) == 0)
+            {
+                if (networkInfo.mRssi > mAvailableNetworks[i].mRssi)
+                {
+                    mAvailableNetworks[i] = networkInfo;
+                }
+                break;
+            }
+        }
+
+        if (i == mAvailableNetworksCnt && mAvailableNetworksCnt < OT_SCANNED_NET_BUFFER_SIZE)
         {
             mAvailableNetworks[mAvailableNetworksCnt++] = networkInfo;
         }
@@ -65,12 +65,12 @@ public:
     {
         return mAvailableNetworksCnt;
     }
+    static int ParseNetworkInfoFromIter(WpanNetworkInfo *aNetworkInfo,
+                                        DBusMessageIter *aIter);
 
 private:
     static DBusHandlerResult DbusBeaconHandler(DBusConnection *aConnection,
                                                DBusMessage *aMessage, void *aUserData);
-    static int ParseNetworkInfoFromIter(WpanNetworkInfo *aNetworkInfo,
-                                        DBusMessageIter *aIter);
 
     uint32_t               mChannelMask;
     static WpanNetworkInfo mAvailableNetworks[OT_SCANNED_NET_BUFFER_SIZE];
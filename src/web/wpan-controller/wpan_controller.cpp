@@ -94,8 +94,11 @@ const char *WPANController::GetDBusInterfaceName(void) const
 
     dbusIfName.SetInterfaceName(mIfName);
     VerifyOrExit(dbusIfName.ProcessReply() == kWpantundStatus_Ok, ret = kWpantundStatus_InvalidDBusName);
+    // The name must outlive dbusIfName.
+    strncpy(mDBusName, dbusIfName.GetDBusName(), sizeof(mDBusName) - 1);
+    mDBusName[sizeof(mDBusName) - 1] = '\0';
 exit:
-    return ret ? NULL : dbusIfName.GetDBusName();
+    return ret ? NULL : mDBusName;
 }
 
 int WPANController::Leave(void)
@@ -187,6 +190,31 @@ exit:
     return ret ? "" : getProp.GetPropertyValue(aPropertyName);
 }
 
+int WPANController::GetProperties(WpanPropertyValue *aProperties, int aCount) const
+{
+    DBusGet     getProp;
+    int         ret = kWpantundStatus_Ok;
+    char        path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    const char *destination = NULL;
+
+    VerifyOrExit(aProperties != NULL && aCount > 0, ret = kWpantundStatus_InvalidArgument);
+    VerifyOrExit((destination = GetDBusInterfaceName()) != NULL, ret = kWpantundStatus_InvalidDBusName);
+    getProp.SetInterfaceName(mIfName);
+    snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH,
+             mIfName);
+    getProp.SetInterface(WPANTUND_DBUS_APIv1_INTERFACE);
+    getProp.SetPath(path);
+    getProp.SetDestination(destination);
+    ret = getProp.GetPropertyValues(aProperties, aCount);
+
+exit:
+    if (ret != kWpantundStatus_Ok)
+    {
+        syslog(LOG_ERR, "error: %d", ret);
+    }
+    return ret;
+}
+
 int WPANController::Set(uint8_t aType, const char *aPropertyName, const char *aPropertyValue)
 {
     DBusSet setProp;
@@ -253,6 +281,31 @@ exit:
     return ret;
 }
 
+int WPANController::ConfigureGateways(WpanGatewayOperation *aOperations, int aCount)
+{
+    DBusGateway gateway;
+    int         ret = kWpantundStatus_Ok;
+    char        path[DBUS_MAXIMUM_NAME_LENGTH + 1];
+    const char *destination = NULL;
+
+    VerifyOrExit(aOperations != NULL && aCount > 0, ret = kWpantundStatus_InvalidArgument);
+    VerifyOrExit((destination = GetDBusInterfaceName()) != NULL, ret = kWpantundStatus_InvalidDBusName);
+    gateway.SetInterfaceName(mIfName);
+    snprintf(path, sizeof(path), "%s/%s", WPANTUND_DBUS_PATH,
+             mIfName);
+    gateway.SetPath(path);
+    gateway.SetInterface(WPANTUND_DBUS_APIv1_INTERFACE);
+    gateway.SetDestination(destination);
+    ret = gateway.ProcessOperations(aOperations, aCount);
+
+exit:
+    if (ret != kWpantundStatus_Ok)
+    {
+        syslog(LOG_ERR, "error: %d", ret);
+    }
+    return ret;
+}
+
 void WPANController::SetInterfaceName(const char *aIfName)
 {
     strncpy(mIfName, aIfName, sizeof(mIfName));
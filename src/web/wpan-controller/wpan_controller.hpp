@@ -39,6 +39,7 @@
 #define OT_NETWORK_NAME_MAX_SIZE 17
 #define OT_HARDWARE_ADDRESS_SIZE 8
 #define OT_PREFIX_SIZE 8
+#define OT_PROPERTY_VALUE_SIZE 512
 #define OT_ROUTER_ROLE 2
 
 #include <net/if.h>
@@ -74,6 +75,7 @@ enum
     kWpantundStatus_InvalidReply      = 12,
     kWpantundStatus_InvalidPending    = 13,
     kWpantundStatus_InvalidDBusName   = 14,
+    kWpantundStatus_GetFailed         = 15,
 };
 
 struct WpanNetworkInfo
@@ -88,6 +90,31 @@ struct WpanNetworkInfo
     uint8_t     mPrefix[OT_PREFIX_SIZE];
 };
 
+struct WpanPropertyValue
+{
+    const char *mName;
+    int         mStatus;
+    char        mValue[OT_PROPERTY_VALUE_SIZE];
+};
+
+enum
+{
+    kGatewayOperation_AddPrefix    = 0,
+    kGatewayOperation_RemovePrefix = 1,
+    kGatewayOperation_AddRoute     = 2,
+    kGatewayOperation_RemoveRoute  = 3,
+};
+
+struct WpanGatewayOperation
+{
+    uint8_t mType;            ///< One of kGatewayOperation_*.
+    uint8_t mPrefix[16];      ///< The prefix, the bits past mPrefixLength are zero.
+    uint8_t mPrefixLength;    ///< The prefix length in bits, on-mesh prefixes are always /64.
+    bool    mIsDefaultRoute;  ///< Whether the on-mesh prefix offers a default route.
+    int16_t mPreference;      ///< The preference of the route, negative for low and positive for high.
+    int     mStatus;          ///< The result of the operation.
+};
+
 class WPANController
 {
 public:
@@ -178,6 +205,21 @@ public:
      */
     const char *Get(const char *aPropertyName) const;
 
+    /**
+     * This method gets several properties of the Thread Network in one pipelined batch.
+     *
+     * @param[inout]  aProperties  A pointer to the properties, each with mName set. On return
+     *                             mStatus and mValue of each property are filled.
+     * @param[in]     aCount       The number of properties.
+     *
+     * @retval kWpantundStatus_Ok                 Successfully got all the properties.
+     * @retval kWpantundStatus_GetFailed          At least one property failed, see mStatus of each.
+     * @retval kWpantundStatus_InvalidConnection  The DBus connection is invalid.
+     * @retval kWpantundStatus_InvalidArgument    The aProperties or aCount is invalid.
+     *
+     */
+    int GetProperties(WpanPropertyValue *aProperties, int aCount) const;
+
     /**
      * This method sets the Thread Network property.
      *
@@ -223,6 +265,22 @@ public:
      */
     int RemoveGateway(const char *aPrefix);
 
+    /**
+     * This method adds and removes several on-mesh prefixes and external routes in one pipelined batch.
+     *
+     * The operations are all sent before any reply is waited for, wpantund still applies them in order.
+     *
+     * @param[inout]  aOperations  A pointer to the operations. On return mStatus of each is filled.
+     * @param[in]     aCount       The number of operations.
+     *
+     * @retval kWpantundStatus_Ok                 Successfully applied all the operations.
+     * @retval kWpantundStatus_SetGatewayFailed   At least one operation failed, see mStatus of each.
+     * @retval kWpantundStatus_InvalidConnection  The DBus connection is invalid.
+     * @retval kWpantundStatus_InvalidArgument    The aOperations or aCount is invalid.
+     *
+     */
+    int ConfigureGateways(WpanGatewayOperation *aOperations, int aCount);
+
     /**
      * This method sets the interface name of the wpantund.
      *
@@ -234,6 +292,7 @@ public:
 private:
 
     char            mIfName[IFNAMSIZ];
+    mutable char    mDBusName[DBUS_MAXIMUM_NAME_LENGTH + 1];
     WpanNetworkInfo mScannedNetworks[OT_SCANNED_NET_BUFFER_SIZE];
     int             mScannedNetworkCount = 0;
 
@@ -0,0 +1,228 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file compares the native CoAP agent with the libcoap-based one on the messages of the border agent.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "coap_libcoap.hpp"
+#include "coap_native.hpp"
+
+namespace {
+
+using ot::BorderRouter::Coap::Agent;
+using ot::BorderRouter::Coap::AgentLibcoap;
+using ot::BorderRouter::Coap::AgentNative;
+using ot::BorderRouter::Coap::Message;
+using ot::BorderRouter::Coap::Resource;
+
+enum
+{
+    kIterations  = 200000,
+    kPayloadSize = 64,     ///< Like a relayed joiner record or a commissioner dataset.
+};
+
+const uint8_t kPeer[16] = { 0xfd, 0xde, 0xad, 0x00, 0xbe, 0xef, 0, 0, 0, 0, 0, 0xff, 0xfe, 0, 0xfc, 0x00 };
+const uint8_t kToken[]  = { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0 };
+uint8_t       sPayload[kPayloadSize];
+
+unsigned long sSent;
+unsigned long sRequests;
+unsigned long sResponses;
+uint8_t       sLastSent[4];
+
+ssize_t HandleSend(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort, void *aContext)
+{
+    (void)aIp6;
+    (void)aPort;
+    (void)aContext;
+
+    memcpy(sLastSent, aBuffer, sizeof(sLastSent));
+    sSent++;
+    return aLength;
+}
+
+void HandleRequest(const Resource &aResource, const Message &aRequest, Message &aResponse, const uint8_t *aIp6,
+                   uint16_t aPort, void *aContext)
+{
+    // A commissioner petition is answered with its state and session id.
+    const uint8_t  state[] = { 0x10, 0x01, 0x01, 0x0b, 0x02, 0x12, 0x34 };
+    const uint8_t *payload;
+    uint16_t       length;
+
+    (void)aResource;
+    (void)aIp6;
+    (void)aPort;
+    (void)aContext;
+
+    payload = aRequest.GetPayload(length);
+    sRequests += (payload != NULL && length == kPayloadSize);
+    aResponse.SetCode(Message::kCoapResponseChanged);
+    aResponse.SetPayload(state, sizeof(state));
+}
+
+void HandleResponse(const Message &aMessage, void *aContext)
+{
+    (void)aContext;
+
+    sResponses += (aMessage.GetCode() == Message::kCoapResponseChanged);
+}
+
+const Resource kResources[] =
+{
+    { "c/lp", HandleRequest },
+    { 0, 0 },
+};
+
+double Now(void)
+{
+    timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+/**
+ * This function measures confirmable requests received and answered with a piggybacked response.
+ *
+ */
+double ServeRequests(Agent &aAgent)
+{
+    uint8_t request[12 + kPayloadSize] = { 0x42, 0x02, 0x00, 0x00, 0x12, 0x34, 0xb1, 'c', 0x02, 'l', 'p', 0xff };
+    double  start = Now();
+
+    memcpy(request + 12, sPayload, kPayloadSize);
+
+    for (unsigned long i = 0; i < kIterations; i++)
+    {
+        request[2] = static_cast<uint8_t>(i >> 8);
+        request[3] = static_cast<uint8_t>(i & 0xff);
+        aAgent.Input(request, sizeof(request), kPeer, 61631);
+    }
+
+    return Now() - start;
+}
+
+/**
+ * This function measures non-confirmable requests built and sent, like relayed joiner messages.
+ *
+ */
+double SendRequests(Agent &aAgent)
+{
+    double start = Now();
+
+    for (unsigned long i = 0; i < kIterations; i++)
+    {
+        Message *message = aAgent.NewMessage(Message::kCoapTypeNonConfirmable, Message::kCoapRequestPost, kToken,
+                                             sizeof(kToken));
+
+        message->SetPath("c/rx");
+        message->SetPayload(sPayload, kPayloadSize);
+        aAgent.Send(*message, kPeer, 61631, NULL);
+        aAgent.FreeMessage(message);
+    }
+
+    return Now() - start;
+}
+
+/**
+ * This function measures confirmable requests sent and their piggybacked responses received, like forwarded
+ * commissioner requests.
+ *
+ */
+double ExchangeRequests(Agent &aAgent)
+{
+    uint8_t response[12] = { 0x68, 0x44, 0x00, 0x00, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0 };
+    double  start = Now();
+
+    for (unsigned long i = 0; i < kIterations; i++)
+    {
+        Message *message = aAgent.NewMessage(Message::kCoapTypeConfirmable, Message::kCoapRequestPost, kToken,
+                                             sizeof(kToken));
+
+        message->SetPath("c/lp");
+        message->SetPayload(sPayload, kPayloadSize);
+        aAgent.Send(*message, kPeer, 61631, HandleResponse);
+        aAgent.FreeMessage(message);
+
+        response[2] = sLastSent[2];
+        response[3] = sLastSent[3];
+        aAgent.Input(response, sizeof(response), kPeer, 61631);
+    }
+
+    return Now() - start;
+}
+
+void Report(const char *aName, double aLibcoap, double aNative)
+{
+    printf("%-22s libcoap %6.2f us %9.0f/s | native %6.2f us %9.0f/s | %5.1fx\n", aName, aLibcoap / kIterations,
+           kIterations / aLibcoap * 1e6, aNative / kIterations, kIterations / aNative * 1e6, aLibcoap / aNative);
+}
+
+} // namespace
+
+int main(void)
+{
+    AgentLibcoap libcoap(HandleSend, kResources, NULL);
+    AgentNative  native(HandleSend, kResources, NULL);
+    double       libcoapTime;
+    double       nativeTime;
+    int          ret = EXIT_SUCCESS;
+
+    for (int i = 0; i < kPayloadSize; i++)
+    {
+        sPayload[i] = static_cast<uint8_t>(i);
+    }
+
+    libcoapTime = ServeRequests(libcoap);
+    nativeTime = ServeRequests(native);
+    Report("serve CON requests", libcoapTime, nativeTime);
+
+    libcoapTime = SendRequests(libcoap);
+    nativeTime = SendRequests(native);
+    Report("send NON requests", libcoapTime, nativeTime);
+
+    libcoapTime = ExchangeRequests(libcoap);
+    nativeTime = ExchangeRequests(native);
+    Report("exchange CON requests", libcoapTime, nativeTime);
+
+    // Each agent must have handled every message, or the comparison is meaningless.
+    if (sRequests != 2 * kIterations || sResponses != 2 * kIterations || sSent != 6 * kIterations)
+    {
+        fprintf(stderr, "messages lost: %lu requests, %lu responses, %lu sent\n", sRequests, sResponses, sSent);
+        ret = EXIT_FAILURE;
+    }
+
+    return ret;
+}
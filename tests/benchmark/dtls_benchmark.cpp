@@ -0,0 +1,339 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file measures the border agent DTLS server over loopback: the rate and CPU cost of commissioner handshakes,
+ *   then the CPU cost of the records relayed on an established session.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+#include <sys/select.h>
+
+#include "dtls_mbedtls.hpp"
+#include "common/code_utils.hpp"
+
+namespace {
+
+using ot::BorderRouter::Dtls::Server;
+using ot::BorderRouter::Dtls::Session;
+
+enum
+{
+    kHandshakes = 200,
+    kRecords    = 20000,
+    kBatchSize  = 32,    ///< Records written before the server reads them.
+    kPort       = 49200,
+};
+
+const uint8_t  kPSKc[] =
+{
+    0xee, 0x49, 0xa9, 0x05, 0x63, 0x7b, 0xbe, 0x26, 0x08, 0xdd, 0xe3, 0xdc, 0x35, 0x76, 0xe1, 0x88,
+};
+const int      kCipherSuites[] = { MBEDTLS_TLS_ECJPAKE_WITH_AES_128_CCM_8, 0 };
+const uint8_t  kSeed[] = "dtls benchmark";
+
+// Relayed joiner flights and commissioning messages, up to a full datagram.
+const uint16_t kRecordSizes[] = { 64, 128, 256, 1024 };
+
+unsigned      sServerReady = 0;
+unsigned      sServerFailed = 0;
+unsigned long sRecordsReceived = 0;
+
+/**
+ * This structure represents the commissioner side of a session.
+ *
+ */
+struct Client
+{
+    mbedtls_net_context          mNet;
+    mbedtls_ssl_context          mSsl;
+    mbedtls_timing_delay_context mTimer;
+};
+
+double Now(clockid_t aClock)
+{
+    timespec now;
+
+    clock_gettime(aClock, &now);
+    return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+
+void HandleData(const uint8_t *aBuffer, uint16_t aLength, void *aContext)
+{
+    sRecordsReceived++;
+
+    (void)aBuffer;
+    (void)aLength;
+    (void)aContext;
+}
+
+void HandleSessionState(Session &aSession, Session::State aState, void *aContext)
+{
+    switch (aState)
+    {
+    case Session::kStateReady:
+        sServerReady++;
+        aSession.SetDataHandler(HandleData, NULL);
+        break;
+
+    case Session::kStateError:
+        sServerFailed++;
+        break;
+
+    default:
+        break;
+    }
+
+    (void)aContext;
+}
+
+/**
+ * This function lets the server process what the client sent, and measures the CPU it takes.
+ *
+ */
+void ProcessServer(Server &aServer, int aClientFd, double &aCpu)
+{
+    fd_set  readFdSet;
+    fd_set  writeFdSet;
+    int     maxFd = aClientFd;
+    timeval timeout = { 0, 10000 };
+    double  start;
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+
+    if (aClientFd >= 0)
+    {
+        FD_SET(aClientFd, &readFdSet);
+    }
+
+    aServer.UpdateFdSet(readFdSet, writeFdSet, maxFd, timeout);
+
+    if (select(maxFd + 1, &readFdSet, &writeFdSet, NULL, &timeout) >= 0)
+    {
+        start = Now(CLOCK_THREAD_CPUTIME_ID);
+        aServer.Process(readFdSet, writeFdSet);
+        aCpu += Now(CLOCK_THREAD_CPUTIME_ID) - start;
+    }
+}
+
+/**
+ * This function performs a handshake as a commissioner.
+ *
+ * On success, the session is left open for the caller to close.
+ *
+ * @returns 0 on success, otherwise an mbedtls error.
+ *
+ */
+int Handshake(Server &aServer, mbedtls_ssl_config &aConfig, Client &aClient, double &aClientCpu, double &aServerCpu)
+{
+    int      ret = 0;
+    unsigned ready = sServerReady;
+    double   start;
+    char     port[6];
+
+    mbedtls_net_init(&aClient.mNet);
+    mbedtls_ssl_init(&aClient.mSsl);
+
+    sprintf(port, "%u", kPort);
+    SuccessOrExit(ret = mbedtls_net_connect(&aClient.mNet, "127.0.0.1", port, MBEDTLS_NET_PROTO_UDP));
+    SuccessOrExit(ret = mbedtls_net_set_nonblock(&aClient.mNet));
+    SuccessOrExit(ret = mbedtls_ssl_setup(&aClient.mSsl, &aConfig));
+    SuccessOrExit(ret = mbedtls_ssl_set_hs_ecjpake_password(&aClient.mSsl, kPSKc, sizeof(kPSKc)));
+    mbedtls_ssl_set_bio(&aClient.mSsl, &aClient.mNet, mbedtls_net_send, mbedtls_net_recv, NULL);
+    mbedtls_ssl_set_timer_cb(&aClient.mSsl, &aClient.mTimer, mbedtls_timing_set_delay, mbedtls_timing_get_delay);
+
+    do
+    {
+        start = Now(CLOCK_THREAD_CPUTIME_ID);
+        ret = mbedtls_ssl_handshake(&aClient.mSsl);
+        aClientCpu += Now(CLOCK_THREAD_CPUTIME_ID) - start;
+
+        VerifyOrExit(ret == 0 || ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+        ProcessServer(aServer, aClient.mNet.fd, aServerCpu);
+    }
+    while (ret != 0 || sServerReady == ready);
+
+exit:
+    if (ret)
+    {
+        mbedtls_ssl_free(&aClient.mSsl);
+        mbedtls_net_free(&aClient.mNet);
+    }
+
+    return ret;
+}
+
+/**
+ * This function closes the session of a commissioner, and lets the server end its side.
+ *
+ */
+void Close(Server &aServer, Client &aClient, double &aServerCpu)
+{
+    mbedtls_ssl_close_notify(&aClient.mSsl);
+    mbedtls_ssl_free(&aClient.mSsl);
+    mbedtls_net_free(&aClient.mNet);
+
+    // The session goes back to the pool once the server has seen the close notify.
+    while (aServer.GetSessionCount() > 0)
+    {
+        ProcessServer(aServer, -1, aServerCpu);
+    }
+}
+
+/**
+ * This function sends records of the same size from the commissioner, and measures the CPU it takes each side to
+ * protect and verify them.
+ *
+ * @returns 0 on success, otherwise an mbedtls error.
+ *
+ */
+int SendRecords(Server &aServer, Client &aClient, uint16_t aSize, unsigned long aCount, double &aClientCpu,
+                double &aServerCpu)
+{
+    int           ret = 0;
+    uint8_t       payload[1024];
+    unsigned long sent = 0;
+    double        start;
+
+    memset(payload, 0x5a, sizeof(payload));
+    sRecordsReceived = 0;
+
+    while (sent < aCount)
+    {
+        for (unsigned i = 0; i < kBatchSize && sent < aCount; i++, sent++)
+        {
+            start = Now(CLOCK_THREAD_CPUTIME_ID);
+            ret = mbedtls_ssl_write(&aClient.mSsl, payload, aSize);
+            aClientCpu += Now(CLOCK_THREAD_CPUTIME_ID) - start;
+            VerifyOrExit(ret == aSize);
+        }
+
+        // Loopback does not lose datagrams, every record sent is eventually read.
+        while (sRecordsReceived < sent)
+        {
+            ProcessServer(aServer, -1, aServerCpu);
+            VerifyOrExit(sServerFailed == 0, ret = MBEDTLS_ERR_SSL_INVALID_RECORD);
+        }
+    }
+
+    ret = 0;
+
+exit:
+    return ret;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int                      ret = EXIT_FAILURE;
+    unsigned long            count = (argc > 1 ? strtoul(argv[1], NULL, 0) : static_cast<unsigned long>(kHandshakes));
+    double                   clientCpu = 0;
+    double                   serverCpu = 0;
+    double                   start;
+    double                   elapsed;
+    Server                  *server = Server::Create(kPort, HandleSessionState, NULL);
+    mbedtls_entropy_context  entropy;
+    mbedtls_ctr_drbg_context ctrDrbg;
+    mbedtls_ssl_config       config;
+    Client                   client;
+
+    // The server logs every record, which would be measured too.
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&ctrDrbg);
+    mbedtls_ssl_config_init(&config);
+
+    VerifyOrExit(mbedtls_ctr_drbg_seed(&ctrDrbg, mbedtls_entropy_func, &entropy, kSeed, sizeof(kSeed)) == 0 &&
+                 mbedtls_ssl_config_defaults(&config, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
+                                             MBEDTLS_SSL_PRESET_DEFAULT) == 0,
+                 fprintf(stderr, "failed to configure the client\n"));
+
+    mbedtls_ssl_conf_rng(&config, mbedtls_ctr_drbg_random, &ctrDrbg);
+    mbedtls_ssl_conf_min_version(&config, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+    mbedtls_ssl_conf_max_version(&config, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+    mbedtls_ssl_conf_authmode(&config, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_ciphersuites(&config, kCipherSuites);
+
+    server->SetPSK(kPSKc, sizeof(kPSKc));
+    server->Start();
+
+    start = Now(CLOCK_MONOTONIC);
+
+    for (unsigned long i = 0; i < count; i++)
+    {
+        int error = Handshake(*server, config, client, clientCpu, serverCpu);
+
+        VerifyOrExit(error == 0 && sServerFailed == 0, fprintf(stderr, "handshake %lu failed: -0x%x\n", i, -error));
+        Close(*server, client, serverCpu);
+    }
+
+    elapsed = Now(CLOCK_MONOTONIC) - start;
+
+    printf("handshakes %lu in %.0f ms, %.1f/s\n", count, elapsed, count * 1e3 / elapsed);
+    printf("server     %.2f ms CPU per handshake\n", serverCpu / count);
+    printf("client     %.2f ms CPU per handshake\n", clientCpu / count);
+
+    VerifyOrExit(Handshake(*server, config, client, clientCpu, serverCpu) == 0,
+                 fprintf(stderr, "handshake failed\n"));
+
+    for (size_t i = 0; i < sizeof(kRecordSizes) / sizeof(kRecordSizes[0]); i++)
+    {
+        int error;
+
+        clientCpu = 0;
+        serverCpu = 0;
+        error = SendRecords(*server, client, kRecordSizes[i], kRecords, clientCpu, serverCpu);
+
+        VerifyOrExit(error == 0, fprintf(stderr, "records of %u bytes failed: -0x%x\n", kRecordSizes[i], -error));
+
+        printf("records of %4u bytes: server %.2f us CPU, %.0f/s | client %.2f us CPU, %.0f/s\n", kRecordSizes[i],
+               serverCpu * 1e3 / kRecords, kRecords * 1e3 / serverCpu, clientCpu * 1e3 / kRecords,
+               kRecords * 1e3 / clientCpu);
+    }
+
+    Close(*server, client, serverCpu);
+
+    ret = EXIT_SUCCESS;
+
+exit:
+    mbedtls_ssl_config_free(&config);
+    mbedtls_ctr_drbg_free(&ctrDrbg);
+    mbedtls_entropy_free(&entropy);
+    delete server;
+
+    return ret;
+}
@@ -0,0 +1,312 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   This file compares the streaming JSON writer and reader with boost::property_tree
+ *   on the payloads of the web service.
+ */
+
+#include <new>
+#include <sstream>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include "utils/json.hpp"
+
+static unsigned long sAllocations = 0;
+
+// Not inlined, so that the compiler does not pair the malloc() and free() below with new and delete expressions.
+__attribute__((noinline)) void *operator new(size_t aSize)
+{
+    void *p = malloc(aSize ? aSize : 1);
+
+    if (p == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    sAllocations++;
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void *aPointer) throw()
+{
+    free(aPointer);
+}
+
+namespace {
+
+enum
+{
+    kNetworksCount   = 50,
+    kPropertiesCount = 14,
+    kIterations      = 20000,
+};
+
+const char kFormRequest[] = "{\"networkKey\":\"00112233445566778899aabbccddeeff\",\"prefix\":\"fd11:22::\","
+                            "\"defaultRoute\":true,\"extPanId\":\"1111111122222222\",\"panId\":\"0x1234\","
+                            "\"passphrase\":\"123456\",\"networkName\":\"OpenThreadDemo\",\"channel\":15}";
+
+const char *const kProperties[kPropertiesCount][2] =
+{
+    { "NCP:State", "associated" },
+    { "Daemon:Enabled", "true" },
+    { "NCP:Version", "OPENTHREAD/20170716-00650-g1ea7c7c; NRF52840; Jan 31 2018 12:00:00" },
+    { "Daemon:Version", "0.08.00d (0.07.01-191-g63265f7; Jan 31 2018 12:00:00)" },
+    { "Config:NCP:DriverName", "spinel" },
+    { "NCP:HardwareAddress", "18B4300000000002" },
+    { "NCP:Channel", "15" },
+    { "Network:NodeType", "leader" },
+    { "Network:Name", "OpenThreadDemo" },
+    { "Network:XPANID", "0x1111111122222222" },
+    { "Network:PANID", "0x1234" },
+    { "IPv6:LinkLocalAddress", "fe80::1cb5:8c7e:a8b6:a2ee" },
+    { "IPv6:MeshLocalAddress", "fdde:ad00:beef:0:6c4c:9e7e:a8b6:a2ee" },
+    { "IPv6:MeshLocalPrefix", "fdde:ad00:beef::/64" },
+};
+
+struct Result
+{
+    double        mMicroseconds;
+    unsigned long mAllocations;
+};
+
+double Now(void)
+{
+    timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+void Report(const char *aName, const Result &aPtree, const Result &aStreaming)
+{
+    printf("%-22s ptree %8.2f us %6.1f allocs | streaming %8.2f us %6.1f allocs | %5.1fx\n", aName,
+           aPtree.mMicroseconds / kIterations, static_cast<double>(aPtree.mAllocations) / kIterations,
+           aStreaming.mMicroseconds / kIterations, static_cast<double>(aStreaming.mAllocations) / kIterations,
+           aPtree.mMicroseconds / aStreaming.mMicroseconds);
+}
+
+std::string WriteScanPtree(void)
+{
+    boost::property_tree::ptree root, networks;
+    std::stringstream           ss;
+
+    for (int i = 0; i < kNetworksCount; i++)
+    {
+        boost::property_tree::ptree network;
+
+        network.put("nn", "OpenThreadDemo");
+        network.put("xp", "1111111122222222");
+        network.put("pi", "0x1234");
+        network.put("ch", 11 + i % 16);
+        network.put("ha", "18B4300000000002");
+        network.put("rssi", -40 - i);
+        networks.push_back(std::make_pair("", network));
+    }
+    root.add_child("result", networks);
+    root.put("total", static_cast<int>(kNetworksCount));
+    root.put("scanning", false);
+    root.put("error", 0);
+    write_json(ss, root, false);
+    return ss.str();
+}
+
+void WriteScanStreaming(std::string &aBuffer)
+{
+    ot::Utils::JsonWriter writer(aBuffer);
+
+    aBuffer.clear();
+    writer.BeginObject().Key("result").BeginArray();
+    for (int i = 0; i < kNetworksCount; i++)
+    {
+        writer.BeginObject()
+        .Key("nn").String("OpenThreadDemo")
+        .Key("xp").String("1111111122222222")
+        .Key("pi").String("0x1234")
+        .Key("ch").Uint(11 + i % 16)
+        .Key("ha").String("18B4300000000002")
+        .Key("rssi").Int(-40 - i)
+        .EndObject();
+    }
+    writer.EndArray()
+    .Key("total").Int(static_cast<int>(kNetworksCount))
+    .Key("scanning").Bool(false)
+    .Key("error").Int(0)
+    .EndObject();
+}
+
+std::string WritePropertiesPtree(void)
+{
+    boost::property_tree::ptree root, result;
+    std::stringstream           ss;
+
+    for (int i = 0; i < kPropertiesCount; i++)
+    {
+        // Property names contain no '.', so put() does not create nested nodes.
+        result.put(kProperties[i][0], kProperties[i][1]);
+    }
+    root.add_child("result", result);
+    root.put("error", 0);
+    write_json(ss, root, false);
+    return ss.str();
+}
+
+void WritePropertiesStreaming(std::string &aBuffer)
+{
+    ot::Utils::JsonWriter writer(aBuffer);
+
+    aBuffer.clear();
+    writer.BeginObject().Key("result").BeginObject();
+    for (int i = 0; i < kPropertiesCount; i++)
+    {
+        writer.Key(kProperties[i][0]).String(kProperties[i][1]);
+    }
+    writer.EndObject().Key("error").Int(0).EndObject();
+}
+
+size_t ReadFormPtree(void)
+{
+    boost::property_tree::ptree root;
+    std::stringstream           ss(kFormRequest);
+
+    read_json(ss, root);
+    return root.get<std::string>("networkKey").size() + root.get<uint16_t>("channel") +
+           root.get<bool>("defaultRoute");
+}
+
+size_t ReadFormStreaming(std::string &aNetworkKey, std::string &aPrefix, std::string &aName, std::string &aPassphrase,
+                         std::string &aPanId, std::string &aExtPanId)
+{
+    uint64_t                   channel = 0;
+    bool                       defaultRoute = false;
+    ot::Utils::JsonReader      reader(kFormRequest, sizeof(kFormRequest) - 1);
+    const ot::Utils::JsonField fields[] =
+    {
+        ot::Utils::JsonField::String("networkKey", aNetworkKey),
+        ot::Utils::JsonField::String("prefix", aPrefix),
+        ot::Utils::JsonField::Uint("channel", channel),
+        ot::Utils::JsonField::String("networkName", aName),
+        ot::Utils::JsonField::String("passphrase", aPassphrase),
+        ot::Utils::JsonField::String("panId", aPanId),
+        ot::Utils::JsonField::String("extPanId", aExtPanId),
+        ot::Utils::JsonField::Bool("defaultRoute", defaultRoute),
+    };
+
+    if (!reader.ReadObject(fields, sizeof(fields) / sizeof(fields[0])))
+    {
+        fprintf(stderr, "failed to read the form request: %s\n", reader.GetError());
+        exit(EXIT_FAILURE);
+    }
+    return aNetworkKey.size() + channel + defaultRoute;
+}
+
+size_t ReadScanPtree(const std::string &aJson)
+{
+    boost::property_tree::ptree root;
+    std::stringstream           ss(aJson);
+
+    read_json(ss, root);
+    return root.get_child("result").size();
+}
+
+size_t ReadScanStreaming(const std::string &aJson)
+{
+    ot::Utils::JsonReader reader(aJson.data(), aJson.size());
+    size_t                count = 0;
+    ot::Utils::JsonReader::Token token;
+
+    while ((token = reader.Next()) != ot::Utils::JsonReader::kTokenEnd)
+    {
+        if (token == ot::Utils::JsonReader::kTokenError)
+        {
+            fprintf(stderr, "failed to read the scan result: %s\n", reader.GetError());
+            exit(EXIT_FAILURE);
+        }
+        count += (token == ot::Utils::JsonReader::kTokenBeginObject);
+    }
+    return count - 1;
+}
+
+} // namespace
+
+int main(void)
+{
+    Result      ptree, streaming;
+    std::string buffer, networkKey, prefix, name, passphrase, panId, extPanId;
+    std::string scanJson;
+    size_t      checksum = 0;
+    double      start;
+
+    WriteScanStreaming(scanJson);
+
+#define MEASURE(aResult, aStatement)                   \
+    do                                                 \
+    {                                                  \
+        unsigned long allocations = sAllocations;      \
+        start = Now();                                 \
+        for (int i = 0; i < kIterations; i++)          \
+        {                                              \
+            aStatement;                                \
+        }                                              \
+        aResult.mMicroseconds = Now() - start;         \
+        aResult.mAllocations = sAllocations - allocations; \
+    } while (0)
+
+    // One warm-up round so the reused buffers of the streaming side have grown already.
+    WriteScanStreaming(buffer);
+    ReadFormStreaming(networkKey, prefix, name, passphrase, panId, extPanId);
+
+    MEASURE(ptree, checksum += WriteScanPtree().size());
+    MEASURE(streaming, WriteScanStreaming(buffer); checksum += buffer.size());
+    Report("write scan result", ptree, streaming);
+
+    MEASURE(ptree, checksum += WritePropertiesPtree().size());
+    MEASURE(streaming, WritePropertiesStreaming(buffer); checksum += buffer.size());
+    Report("write properties", ptree, streaming);
+
+    MEASURE(ptree, checksum += ReadScanPtree(scanJson));
+    MEASURE(streaming, checksum += ReadScanStreaming(scanJson));
+    Report("read scan result", ptree, streaming);
+
+    MEASURE(ptree, checksum += ReadFormPtree());
+    MEASURE(streaming, checksum += ReadFormStreaming(networkKey, prefix, name, passphrase, panId, extPanId));
+    Report("read form request", ptree, streaming);
+
+#undef MEASURE
+
+    printf("checksum %zu\n", checksum);
+    return 0;
+}
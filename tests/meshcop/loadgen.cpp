@@ -0,0 +1,1013 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements a commissioner and joiner load generator for the border agent.
+ *
+ *   N commissioner sessions handshake with the border agent, petition, and keep alive at a configured interval.
+ *   M simulated joiners run EC-JPAKE handshakes with the joiner DTLS server of this process at a configured rate,
+ *   and every flight the server sends to a joiner is relayed through a commissioner session as RLY_TX.ntf, as a real
+ *   commissioner would do. Without a Thread network, the flights from joiners cannot arrive as RLY_RX.ntf from the
+ *   border agent, so they are delivered to the joiner DTLS server directly.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/timing.h>
+
+#include "agent/coap.hpp"
+#include "agent/dtls.hpp"
+#include "agent/uris.hpp"
+#include "common/code_utils.hpp"
+#include "common/time.hpp"
+#include "common/tlv.hpp"
+#include "utils/hex.hpp"
+
+#define SYSLOG_IDENT "otbr-loadgen"
+
+using namespace ot;
+using namespace ot::BorderRouter;
+
+const uint8_t kSeed[] = "LoadGenerator";
+const uint8_t kPSKd[] = "123456";
+const char    kCommissionerId[] = "OpenThread";
+const char    kJoinerAddress[] = "127.0.0.1";
+const char    kJoinerPort[] = "49192";
+const int     kCipherSuites[] = {
+    MBEDTLS_TLS_ECJPAKE_WITH_AES_128_CCM_8,
+    0
+};
+
+/**
+ * Constants
+ */
+enum
+{
+    kPortJoinerSession   = 49192,
+    kSizeMaxPacket       = 1500,
+    kJoinerRouterLocator = 0x0400,   ///< RLOC16 the simulated joiners are relayed to.
+    kPollInterval        = 10000,    ///< Max time between two steps of the event loop, in microseconds.
+    kRequestTimeout      = 5000000,  ///< Timeout of a petition or keep-alive, in microseconds.
+    kRetryDelay          = 1000000,  ///< Delay before a failed commissioner reconnects, in microseconds.
+    kJoinerTimeout       = 30000000, ///< Timeout of a joiner handshake, in microseconds.
+};
+
+typedef std::vector<uint64_t> Samples;
+
+/**
+ * This structure contains the load generator results.
+ *
+ */
+struct Statistics
+{
+    Statistics(void) :
+        mHandshakes(0),
+        mHandshakeFailures(0),
+        mPetitionsAccepted(0),
+        mPetitionsRejected(0),
+        mPetitionTimeouts(0),
+        mKeepAlivesAccepted(0),
+        mKeepAlivesRejected(0),
+        mKeepAliveTimeouts(0),
+        mJoinersStarted(0),
+        mJoinersCommissioned(0),
+        mJoinersFailed(0),
+        mRelayedFlights(0),
+        mRelayedBytes(0)
+    {
+    }
+
+    unsigned long mHandshakes;
+    unsigned long mHandshakeFailures;
+    unsigned long mPetitionsAccepted;
+    unsigned long mPetitionsRejected;
+    unsigned long mPetitionTimeouts;
+    unsigned long mKeepAlivesAccepted;
+    unsigned long mKeepAlivesRejected;
+    unsigned long mKeepAliveTimeouts;
+    unsigned long mJoinersStarted;
+    unsigned long mJoinersCommissioned;
+    unsigned long mJoinersFailed;
+    unsigned long mRelayedFlights;
+    unsigned long mRelayedBytes;
+
+    Samples       mHandshakeLatency;
+    Samples       mPetitionLatency;
+    Samples       mKeepAliveLatency;
+    Samples       mJoinerLatency;
+};
+
+/**
+ * This structure contains the load generator options.
+ *
+ */
+struct Options
+{
+    const char   *mAgentAddress;
+    const char   *mAgentPort;
+    uint8_t       mPSKc[16];
+    unsigned long mCommissioners;
+    unsigned long mJoiners;
+    unsigned long mJoinerRate;
+    unsigned long mKeepAliveInterval;
+    unsigned long mDuration;
+};
+
+inline uint16_t LengthOf(const void *aStart, const void *aEnd)
+{
+    return static_cast<const uint8_t *>(aEnd) - static_cast<const uint8_t *>(aStart);
+}
+
+inline bool IsWouldBlock(int aError)
+{
+    return aError == MBEDTLS_ERR_SSL_WANT_READ || aError == MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+/**
+ * This class implements a commissioner session driven by the event loop.
+ *
+ */
+class Commissioner
+{
+public:
+    Commissioner(const Options &aOptions, mbedtls_ssl_config &aConfig, Statistics &aStatistics);
+    ~Commissioner(void);
+
+    /**
+     * This method advances the session: handshaking, reading responses and sending keep-alives.
+     *
+     */
+    void Process(uint64_t aNow);
+
+    /**
+     * This method sends a DTLS flight for a joiner to the border agent as RLY_TX.ntf.
+     *
+     */
+    void Relay(const uint8_t *aFlight, uint16_t aLength, uint16_t aJoinerPort, const uint8_t *aJoinerIid);
+
+    bool IsActive(void) const { return mState == kStateActive; }
+    int GetFd(void) const { return mState == kStateIdle ? -1 : mNet.fd; }
+
+private:
+    enum State
+    {
+        kStateIdle,
+        kStateHandshaking,
+        kStatePetitioning,
+        kStateActive,
+        kStateFailed,
+    };
+
+    void Start(uint64_t aNow);
+    void Stop(uint64_t aNow);
+    void Receive(void);
+    void SendRequest(const char *aPath, const uint8_t *aPayload, uint16_t aLength, Coap::ResponseHandler aHandler);
+    void SendPetition(uint64_t aNow);
+    void SendKeepAlive(uint64_t aNow);
+    bool GetState(const Coap::Message &aMessage);
+
+    static ssize_t SendCoap(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort,
+                            void *aContext);
+    static void HandlePetitionResponse(const Coap::Message &aMessage, void *aContext);
+    static void HandleKeepAliveResponse(const Coap::Message &aMessage, void *aContext);
+
+    const Options                &mOptions;
+    mbedtls_ssl_config           &mConfig;
+    Statistics                   &mStatistics;
+    State                         mState;
+    mbedtls_net_context           mNet;
+    mbedtls_ssl_context           mSsl;
+    mbedtls_timing_delay_context  mTimer;
+    Coap::Agent                  *mCoap;
+    uint16_t                      mToken;
+    uint16_t                      mSessionId;
+    uint64_t                      mStateTime;
+    uint64_t                      mRequestTime;
+    uint64_t                      mNextKeepAlive;
+    bool                          mRequestPending;
+};
+
+/**
+ * This class implements a simulated joiner driven by the event loop.
+ *
+ */
+class Joiner
+{
+public:
+    Joiner(uint16_t aIndex, mbedtls_ssl_config &aConfig, Statistics &aStatistics);
+    ~Joiner(void);
+
+    /**
+     * This method starts a joiner handshake relayed through @p aCommissioner.
+     *
+     */
+    int Start(Commissioner &aCommissioner, uint64_t aNow);
+
+    /**
+     * This method advances the handshake.
+     *
+     */
+    void Process(uint64_t aNow);
+
+    bool IsBusy(void) const { return mCommissioner != NULL; }
+    int GetFd(void) const { return mNet.fd; }
+
+private:
+    void Stop(void);
+
+    static int HandleSend(void *aContext, const unsigned char *aBuffer, size_t aLength);
+    static int HandleReceive(void *aContext, unsigned char *aBuffer, size_t aLength);
+
+    mbedtls_ssl_config           &mConfig;
+    Statistics                   &mStatistics;
+    Commissioner                 *mCommissioner;
+    mbedtls_net_context           mNet;
+    mbedtls_ssl_context           mSsl;
+    mbedtls_timing_delay_context  mTimer;
+    uint64_t                      mStartTime;
+    uint16_t                      mPort;
+    uint8_t                       mIid[8];
+};
+
+Commissioner::Commissioner(const Options &aOptions, mbedtls_ssl_config &aConfig, Statistics &aStatistics) :
+    mOptions(aOptions),
+    mConfig(aConfig),
+    mStatistics(aStatistics),
+    mState(kStateIdle),
+    mCoap(NULL),
+    mToken(0),
+    mSessionId(0),
+    mStateTime(0),
+    mRequestTime(0),
+    mNextKeepAlive(0),
+    mRequestPending(false)
+{
+    mbedtls_net_init(&mNet);
+    mbedtls_ssl_init(&mSsl);
+}
+
+Commissioner::~Commissioner(void)
+{
+    Stop(0);
+}
+
+void Commissioner::Start(uint64_t aNow)
+{
+    int ret = 0;
+
+    mbedtls_net_init(&mNet);
+    mbedtls_ssl_init(&mSsl);
+
+    SuccessOrExit(ret = mbedtls_net_connect(&mNet, mOptions.mAgentAddress, mOptions.mAgentPort,
+                                            MBEDTLS_NET_PROTO_UDP));
+    SuccessOrExit(ret = mbedtls_net_set_nonblock(&mNet));
+    SuccessOrExit(ret = mbedtls_ssl_setup(&mSsl, &mConfig));
+
+    mbedtls_ssl_set_bio(&mSsl, &mNet, mbedtls_net_send, mbedtls_net_recv, NULL);
+    mbedtls_ssl_set_timer_cb(&mSsl, &mTimer, mbedtls_timing_set_delay, mbedtls_timing_get_delay);
+    SuccessOrExit(ret = mbedtls_ssl_set_hs_ecjpake_password(&mSsl, mOptions.mPSKc, sizeof(mOptions.mPSKc)));
+
+    mState = kStateHandshaking;
+    mStateTime = aNow;
+
+exit:
+    if (ret)
+    {
+        mStatistics.mHandshakeFailures++;
+        mState = kStateHandshaking;
+        Stop(aNow);
+    }
+}
+
+void Commissioner::Stop(uint64_t aNow)
+{
+    if (mState == kStateIdle)
+    {
+        return;
+    }
+
+    if (mState != kStateHandshaking)
+    {
+        mbedtls_ssl_close_notify(&mSsl);
+    }
+
+    if (mCoap != NULL)
+    {
+        Coap::Agent::Destroy(mCoap);
+        mCoap = NULL;
+    }
+
+    mbedtls_ssl_free(&mSsl);
+    mbedtls_net_free(&mNet);
+
+    mState = kStateIdle;
+    mStateTime = aNow + kRetryDelay;
+    mRequestPending = false;
+}
+
+void Commissioner::Process(uint64_t aNow)
+{
+    int ret;
+
+    switch (mState)
+    {
+    case kStateIdle:
+        if (aNow >= mStateTime)
+        {
+            Start(aNow);
+        }
+        break;
+
+    case kStateHandshaking:
+        ret = mbedtls_ssl_handshake(&mSsl);
+
+        if (ret == 0)
+        {
+            mStatistics.mHandshakes++;
+            mStatistics.mHandshakeLatency.push_back(aNow - mStateTime);
+            mCoap = Coap::Agent::Create(SendCoap, NULL, this);
+            SendPetition(aNow);
+        }
+        else if (!IsWouldBlock(ret))
+        {
+            mStatistics.mHandshakeFailures++;
+            Stop(aNow);
+        }
+        break;
+
+    case kStatePetitioning:
+    case kStateActive:
+        Receive();
+
+        if (mState == kStateFailed)
+        {
+            Stop(aNow);
+        }
+        else if (mRequestPending && aNow - mRequestTime > kRequestTimeout)
+        {
+            if (mState == kStatePetitioning)
+            {
+                mStatistics.mPetitionTimeouts++;
+                Stop(aNow);
+            }
+            else
+            {
+                mStatistics.mKeepAliveTimeouts++;
+                mRequestPending = false;
+            }
+        }
+
+        if (mState == kStateActive && !mRequestPending && aNow >= mNextKeepAlive)
+        {
+            SendKeepAlive(aNow);
+        }
+        break;
+
+    case kStateFailed:
+        Stop(aNow);
+        break;
+    }
+}
+
+void Commissioner::Receive(void)
+{
+    uint8_t buffer[kSizeMaxPacket];
+    int     ret;
+
+    while ((ret = mbedtls_ssl_read(&mSsl, buffer, sizeof(buffer))) > 0)
+    {
+        mCoap->Input(buffer, static_cast<uint16_t>(ret), NULL, 0);
+    }
+
+    if (!IsWouldBlock(ret) && ret != MBEDTLS_ERR_SSL_TIMEOUT)
+    {
+        mState = kStateFailed;
+    }
+}
+
+void Commissioner::SendRequest(const char *aPath, const uint8_t *aPayload, uint16_t aLength,
+                               Coap::ResponseHandler aHandler)
+{
+    Coap::Message *message;
+    uint16_t       token = htons(++mToken);
+
+    message = mCoap->NewMessage(aHandler ? Coap::Message::kCoapTypeConfirmable :
+                                Coap::Message::kCoapTypeNonConfirmable,
+                                Coap::Message::kCoapRequestPost, reinterpret_cast<const uint8_t *>(&token),
+                                sizeof(token));
+    message->SetPath(aPath);
+    message->SetPayload(aPayload, aLength);
+    mCoap->Send(*message, NULL, 0, aHandler);
+    mCoap->FreeMessage(message);
+}
+
+void Commissioner::SendPetition(uint64_t aNow)
+{
+    uint8_t buffer[kSizeMaxPacket];
+    Tlv    *tlv = reinterpret_cast<Tlv *>(buffer);
+
+    tlv->SetType(Meshcop::kCommissionerId);
+    tlv->SetValue(kCommissionerId, sizeof(kCommissionerId) - 1);
+    tlv = tlv->GetNext();
+
+    mState = kStatePetitioning;
+    mRequestTime = aNow;
+    mRequestPending = true;
+    SendRequest(OPENTHREAD_URI_COMMISSIONER_PETITION, buffer, LengthOf(buffer, tlv), HandlePetitionResponse);
+}
+
+void Commissioner::SendKeepAlive(uint64_t aNow)
+{
+    uint8_t buffer[kSizeMaxPacket];
+    Tlv    *tlv = reinterpret_cast<Tlv *>(buffer);
+
+    tlv->SetType(Meshcop::kState);
+    tlv->SetValue(static_cast<uint8_t>(1));
+    tlv = tlv->GetNext();
+
+    tlv->SetType(Meshcop::kCommissionerSessionId);
+    tlv->SetValue(mSessionId);
+    tlv = tlv->GetNext();
+
+    mRequestTime = aNow;
+    mRequestPending = true;
+    mNextKeepAlive = aNow + mOptions.mKeepAliveInterval * 1000;
+    SendRequest(OPENTHREAD_URI_COMMISSIONER_KEEP_ALIVE, buffer, LengthOf(buffer, tlv), HandleKeepAliveResponse);
+}
+
+void Commissioner::Relay(const uint8_t *aFlight, uint16_t aLength, uint16_t aJoinerPort, const uint8_t *aJoinerIid)
+{
+    uint8_t buffer[kSizeMaxPacket + 64];
+    Tlv    *tlv = reinterpret_cast<Tlv *>(buffer);
+
+    VerifyOrExit(mState == kStateActive);
+    VerifyOrExit(aLength <= kSizeMaxPacket);
+
+    tlv->SetType(Meshcop::kJoinerDtlsEncapsulation);
+    tlv->SetValue(aFlight, aLength);
+    tlv = tlv->GetNext();
+
+    tlv->SetType(Meshcop::kJoinerUdpPort);
+    tlv->SetValue(aJoinerPort);
+    tlv = tlv->GetNext();
+
+    tlv->SetType(Meshcop::kJoinerIid);
+    tlv->SetValue(aJoinerIid, 8);
+    tlv = tlv->GetNext();
+
+    tlv->SetType(Meshcop::kJoinerRouterLocator);
+    tlv->SetValue(static_cast<uint16_t>(kJoinerRouterLocator));
+    tlv = tlv->GetNext();
+
+    SendRequest(OPENTHREAD_URI_RELAY_TX, buffer, LengthOf(buffer, tlv), NULL);
+    mStatistics.mRelayedFlights++;
+    mStatistics.mRelayedBytes += aLength;
+
+exit:
+    return;
+}
+
+bool Commissioner::GetState(const Coap::Message &aMessage)
+{
+    bool           accepted = false;
+    uint16_t       length;
+    const uint8_t *payload = aMessage.GetPayload(length);
+
+    for (const Tlv *tlv = reinterpret_cast<const Tlv *>(payload); LengthOf(payload, tlv) < length;
+         tlv = tlv->GetNext())
+    {
+        switch (tlv->GetType())
+        {
+        case Meshcop::kState:
+            accepted = (tlv->GetValueUInt8() == 1);
+            break;
+
+        case Meshcop::kCommissionerSessionId:
+            mSessionId = tlv->GetValueUInt16();
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return accepted;
+}
+
+ssize_t Commissioner::SendCoap(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort,
+                               void *aContext)
+{
+    Commissioner *commissioner = static_cast<Commissioner *>(aContext);
+
+    (void)aIp6;
+    (void)aPort;
+
+    return mbedtls_ssl_write(&commissioner->mSsl, aBuffer, aLength);
+}
+
+void Commissioner::HandlePetitionResponse(const Coap::Message &aMessage, void *aContext)
+{
+    Commissioner &commissioner = *static_cast<Commissioner *>(aContext);
+    uint64_t      now = GetMonotonicMicros();
+
+    VerifyOrExit(commissioner.mState == kStatePetitioning && commissioner.mRequestPending);
+    commissioner.mRequestPending = false;
+
+    if (commissioner.GetState(aMessage))
+    {
+        commissioner.mStatistics.mPetitionsAccepted++;
+        commissioner.mStatistics.mPetitionLatency.push_back(now - commissioner.mRequestTime);
+        commissioner.mState = kStateActive;
+        commissioner.mNextKeepAlive = now + commissioner.mOptions.mKeepAliveInterval * 1000;
+    }
+    else
+    {
+        commissioner.mStatistics.mPetitionsRejected++;
+        commissioner.mState = kStateFailed;
+    }
+
+exit:
+    return;
+}
+
+void Commissioner::HandleKeepAliveResponse(const Coap::Message &aMessage, void *aContext)
+{
+    Commissioner &commissioner = *static_cast<Commissioner *>(aContext);
+
+    VerifyOrExit(commissioner.mState == kStateActive && commissioner.mRequestPending);
+    commissioner.mRequestPending = false;
+
+    if (commissioner.GetState(aMessage))
+    {
+        commissioner.mStatistics.mKeepAlivesAccepted++;
+        commissioner.mStatistics.mKeepAliveLatency.push_back(GetMonotonicMicros() - commissioner.mRequestTime);
+    }
+    else
+    {
+        commissioner.mStatistics.mKeepAlivesRejected++;
+        commissioner.mState = kStateFailed;
+    }
+
+exit:
+    return;
+}
+
+Joiner::Joiner(uint16_t aIndex, mbedtls_ssl_config &aConfig, Statistics &aStatistics) :
+    mConfig(aConfig),
+    mStatistics(aStatistics),
+    mCommissioner(NULL),
+    mStartTime(0),
+    mPort(0)
+{
+    static const uint8_t kIidPrefix[] = { 0x18, 0xb4, 0x30, 0x00, 0x00, 0x01 };
+
+    memcpy(mIid, kIidPrefix, sizeof(kIidPrefix));
+    mIid[6] = static_cast<uint8_t>(aIndex >> 8);
+    mIid[7] = static_cast<uint8_t>(aIndex & 0xff);
+
+    mbedtls_net_init(&mNet);
+    mbedtls_ssl_init(&mSsl);
+}
+
+Joiner::~Joiner(void)
+{
+    Stop();
+}
+
+int Joiner::Start(Commissioner &aCommissioner, uint64_t aNow)
+{
+    int         ret = 0;
+    sockaddr_in addr;
+    socklen_t   addrLength = sizeof(addr);
+
+    mbedtls_net_init(&mNet);
+    mbedtls_ssl_init(&mSsl);
+    mCommissioner = &aCommissioner;
+    mStartTime = aNow;
+    mStatistics.mJoinersStarted++;
+
+    SuccessOrExit(ret = mbedtls_net_connect(&mNet, kJoinerAddress, kJoinerPort, MBEDTLS_NET_PROTO_UDP));
+    SuccessOrExit(ret = mbedtls_net_set_nonblock(&mNet));
+    SuccessOrExit(ret = getsockname(mNet.fd, reinterpret_cast<sockaddr *>(&addr), &addrLength));
+    mPort = ntohs(addr.sin_port);
+
+    SuccessOrExit(ret = mbedtls_ssl_setup(&mSsl, &mConfig));
+    mbedtls_ssl_set_bio(&mSsl, this, HandleSend, HandleReceive, NULL);
+    mbedtls_ssl_set_timer_cb(&mSsl, &mTimer, mbedtls_timing_set_delay, mbedtls_timing_get_delay);
+    SuccessOrExit(ret = mbedtls_ssl_set_hs_ecjpake_password(&mSsl, kPSKd, sizeof(kPSKd) - 1));
+
+exit:
+    if (ret)
+    {
+        mStatistics.mJoinersFailed++;
+        Stop();
+    }
+
+    return ret;
+}
+
+void Joiner::Stop(void)
+{
+    VerifyOrExit(mCommissioner != NULL);
+
+    mbedtls_ssl_free(&mSsl);
+    mbedtls_net_free(&mNet);
+    mCommissioner = NULL;
+
+exit:
+    return;
+}
+
+void Joiner::Process(uint64_t aNow)
+{
+    int ret;
+
+    VerifyOrExit(mCommissioner != NULL);
+
+    ret = mbedtls_ssl_handshake(&mSsl);
+
+    if (ret == 0)
+    {
+        mStatistics.mJoinersCommissioned++;
+        mStatistics.mJoinerLatency.push_back(aNow - mStartTime);
+        mbedtls_ssl_close_notify(&mSsl);
+        Stop();
+    }
+    else if (!IsWouldBlock(ret) || aNow - mStartTime > kJoinerTimeout)
+    {
+        mStatistics.mJoinersFailed++;
+        Stop();
+    }
+
+exit:
+    return;
+}
+
+int Joiner::HandleSend(void *aContext, const unsigned char *aBuffer, size_t aLength)
+{
+    return mbedtls_net_send(&static_cast<Joiner *>(aContext)->mNet, aBuffer, aLength);
+}
+
+int Joiner::HandleReceive(void *aContext, unsigned char *aBuffer, size_t aLength)
+{
+    Joiner &joiner = *static_cast<Joiner *>(aContext);
+    int     ret = mbedtls_net_recv(&joiner.mNet, aBuffer, aLength);
+
+    // Flights from the joiner DTLS server travel through the border agent, as they would to a real joiner.
+    if (ret > 0)
+    {
+        joiner.mCommissioner->Relay(aBuffer, static_cast<uint16_t>(ret), joiner.mPort, joiner.mIid);
+    }
+
+    return ret;
+}
+
+void HandleJoinerSessionState(Dtls::Session &aSession, Dtls::Session::State aState, void *aContext)
+{
+    (void)aSession;
+    (void)aState;
+    (void)aContext;
+}
+
+uint64_t GetPercentile(const Samples &aSorted, unsigned aPerMille)
+{
+    size_t index = (aSorted.size() * aPerMille + 999) / 1000;
+
+    return aSorted[index > 0 ? index - 1 : 0];
+}
+
+void PrintLatency(const char *aName, Samples &aSamples)
+{
+    if (aSamples.empty())
+    {
+        printf("%-24s no samples\n", aName);
+        return;
+    }
+
+    std::sort(aSamples.begin(), aSamples.end());
+    printf("%-24s n=%zu p50=%.3fms p99=%.3fms p999=%.3fms max=%.3fms\n", aName, aSamples.size(),
+           GetPercentile(aSamples, 500) / 1000.0, GetPercentile(aSamples, 990) / 1000.0,
+           GetPercentile(aSamples, 999) / 1000.0, aSamples.back() / 1000.0);
+}
+
+void PrintReport(Statistics &aStatistics, uint64_t aElapsed)
+{
+    double        seconds = aElapsed / 1000000.0;
+    unsigned long joinersDone = aStatistics.mJoinersCommissioned + aStatistics.mJoinersFailed;
+
+    printf("duration                 %.1fs\n", seconds);
+    printf("commissioner handshakes  %lu succeeded, %lu failed\n", aStatistics.mHandshakes,
+           aStatistics.mHandshakeFailures);
+    printf("petitions                %lu accepted, %lu rejected, %lu timed out\n", aStatistics.mPetitionsAccepted,
+           aStatistics.mPetitionsRejected, aStatistics.mPetitionTimeouts);
+    printf("keep-alives              %lu accepted, %lu rejected, %lu timed out\n", aStatistics.mKeepAlivesAccepted,
+           aStatistics.mKeepAlivesRejected, aStatistics.mKeepAliveTimeouts);
+    printf("joiners                  %lu started, %lu commissioned, %lu failed (%.2f%%), %lu unfinished\n",
+           aStatistics.mJoinersStarted, aStatistics.mJoinersCommissioned, aStatistics.mJoinersFailed,
+           joinersDone ? aStatistics.mJoinersFailed * 100.0 / joinersDone : 0.0,
+           aStatistics.mJoinersStarted - joinersDone);
+    printf("joiner throughput        %.1f/min\n", aStatistics.mJoinersCommissioned * 60.0 / seconds);
+    printf("relayed                  %lu flights, %lu bytes, %.1f flights/s\n", aStatistics.mRelayedFlights,
+           aStatistics.mRelayedBytes, aStatistics.mRelayedFlights / seconds);
+
+    PrintLatency("commissioner handshake", aStatistics.mHandshakeLatency);
+    PrintLatency("petition", aStatistics.mPetitionLatency);
+    PrintLatency("keep-alive", aStatistics.mKeepAliveLatency);
+    PrintLatency("joiner handshake", aStatistics.mJoinerLatency);
+}
+
+int Run(const Options &aOptions)
+{
+    int                       ret = 0;
+    Statistics                statistics;
+    mbedtls_entropy_context   entropy;
+    mbedtls_ctr_drbg_context  ctrDrbg;
+    mbedtls_ssl_config        config;
+    Dtls::Server             *server = NULL;
+    std::vector<Commissioner *> commissioners;
+    std::vector<Joiner *>       joiners;
+    size_t                    nextCommissioner = 0;
+    uint64_t                  start;
+    uint64_t                  end;
+    uint64_t                  nextJoiner;
+    uint64_t                  now;
+
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&ctrDrbg);
+    mbedtls_ssl_config_init(&config);
+
+    SuccessOrExit(ret = mbedtls_ctr_drbg_seed(&ctrDrbg, mbedtls_entropy_func, &entropy, kSeed, sizeof(kSeed)));
+    SuccessOrExit(ret = mbedtls_ssl_config_defaults(&config, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_DATAGRAM,
+                                                    MBEDTLS_SSL_PRESET_DEFAULT));
+
+    // Commissioners and joiners share the configuration; only the EC-JPAKE password differs.
+    mbedtls_ssl_conf_rng(&config, mbedtls_ctr_drbg_random, &ctrDrbg);
+    mbedtls_ssl_conf_min_version(&config, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+    mbedtls_ssl_conf_max_version(&config, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+    mbedtls_ssl_conf_authmode(&config, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_ciphersuites(&config, kCipherSuites);
+    mbedtls_ssl_conf_handshake_timeout(&config, 1000, 16000);
+
+    if (aOptions.mJoiners > 0)
+    {
+        server = Dtls::Server::Create(kPortJoinerSession, HandleJoinerSessionState, NULL);
+        server->SetPSK(kPSKd, sizeof(kPSKd) - 1);
+        server->Start();
+    }
+
+    for (unsigned long i = 0; i < aOptions.mCommissioners; i++)
+    {
+        commissioners.push_back(new Commissioner(aOptions, config, statistics));
+    }
+
+    for (unsigned long i = 0; i < aOptions.mJoiners; i++)
+    {
+        joiners.push_back(new Joiner(static_cast<uint16_t>(i), config, statistics));
+    }
+
+    start = GetMonotonicMicros();
+    end = start + aOptions.mDuration * 1000000;
+    nextJoiner = start;
+
+    for (now = start; now < end; now = GetMonotonicMicros())
+    {
+        fd_set  readFdSet;
+        fd_set  writeFdSet;
+        int     maxFd = -1;
+        timeval timeout = { 0, kPollInterval };
+
+        FD_ZERO(&readFdSet);
+        FD_ZERO(&writeFdSet);
+
+        for (size_t i = 0; i < commissioners.size(); i++)
+        {
+            int fd = commissioners[i]->GetFd();
+
+            if (fd >= 0)
+            {
+                FD_SET(fd, &readFdSet);
+                maxFd = std::max(maxFd, fd);
+            }
+        }
+
+        for (size_t i = 0; i < joiners.size(); i++)
+        {
+            if (joiners[i]->IsBusy())
+            {
+                FD_SET(joiners[i]->GetFd(), &readFdSet);
+                maxFd = std::max(maxFd, joiners[i]->GetFd());
+            }
+        }
+
+        if (server != NULL)
+        {
+            server->UpdateFdSet(readFdSet, writeFdSet, maxFd, timeout);
+        }
+
+        if (select(maxFd + 1, &readFdSet, &writeFdSet, NULL, &timeout) < 0 && errno != EINTR)
+        {
+            perror("select");
+            ExitNow(ret = -1);
+        }
+
+        now = GetMonotonicMicros();
+
+        if (server != NULL)
+        {
+            server->Process(readFdSet, writeFdSet);
+        }
+
+        for (size_t i = 0; i < commissioners.size(); i++)
+        {
+            commissioners[i]->Process(now);
+        }
+
+        // Start joiners on free slots at the configured rate, each relayed through the next active commissioner.
+        for (size_t i = 0; i < joiners.size() && (aOptions.mJoinerRate == 0 || nextJoiner <= now); i++)
+        {
+            Commissioner *commissioner = NULL;
+
+            if (joiners[i]->IsBusy())
+            {
+                continue;
+            }
+
+            for (size_t j = 0; j < commissioners.size() && commissioner == NULL; j++)
+            {
+                nextCommissioner = (nextCommissioner + 1) % commissioners.size();
+
+                if (commissioners[nextCommissioner]->IsActive())
+                {
+                    commissioner = commissioners[nextCommissioner];
+                }
+            }
+
+            if (commissioner == NULL)
+            {
+                break;
+            }
+
+            joiners[i]->Start(*commissioner, now);
+
+            if (aOptions.mJoinerRate != 0)
+            {
+                nextJoiner += 1000000 / aOptions.mJoinerRate;
+            }
+        }
+
+        for (size_t i = 0; i < joiners.size(); i++)
+        {
+            joiners[i]->Process(now);
+        }
+    }
+
+    PrintReport(statistics, now - start);
+
+exit:
+    for (size_t i = 0; i < joiners.size(); i++)
+    {
+        delete joiners[i];
+    }
+
+    for (size_t i = 0; i < commissioners.size(); i++)
+    {
+        delete commissioners[i];
+    }
+
+    if (server != NULL)
+    {
+        Dtls::Server::Destroy(server);
+    }
+
+    mbedtls_ssl_config_free(&config);
+    mbedtls_ctr_drbg_free(&ctrDrbg);
+    mbedtls_entropy_free(&entropy);
+
+    return ret;
+}
+
+int ParseNumber(const char *aString, unsigned long &aValue)
+{
+    char *end = NULL;
+
+    aValue = strtoul(aString, &end, 0);
+
+    return (*aString != '\0' && *end == '\0') ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    int     ret = 0;
+    int     opt;
+    Options options;
+
+    memset(&options, 0, sizeof(options));
+    options.mAgentAddress = "127.0.0.1";
+    options.mAgentPort = "49191";
+    options.mCommissioners = 1;
+    options.mKeepAliveInterval = 1000;
+    options.mDuration = 60;
+
+    while ((opt = getopt(argc, argv, "a:p:c:j:r:k:d:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'a':
+            options.mAgentAddress = optarg;
+            break;
+
+        case 'p':
+            options.mAgentPort = optarg;
+            break;
+
+        case 'c':
+            SuccessOrExit(ret = ParseNumber(optarg, options.mCommissioners));
+            break;
+
+        case 'j':
+            SuccessOrExit(ret = ParseNumber(optarg, options.mJoiners));
+            break;
+
+        case 'r':
+            SuccessOrExit(ret = ParseNumber(optarg, options.mJoinerRate));
+            break;
+
+        case 'k':
+            SuccessOrExit(ret = ParseNumber(optarg, options.mKeepAliveInterval));
+            break;
+
+        case 'd':
+            SuccessOrExit(ret = ParseNumber(optarg, options.mDuration));
+            break;
+
+        default:
+            ExitNow(ret = -1);
+            break;
+        }
+    }
+
+    VerifyOrExit(optind + 1 == argc && options.mCommissioners > 0 && options.mJoiners <= 0xffff, ret = -1);
+    VerifyOrExit(ot::Utils::Hex2Bytes(argv[optind], options.mPSKc, sizeof(options.mPSKc)) ==
+                 static_cast<int>(sizeof(options.mPSKc)), ret = -1);
+
+    openlog(SYSLOG_IDENT, LOG_CONS | LOG_PID, LOG_USER);
+    ret = Run(options);
+    closelog();
+
+exit:
+    if (ret == -1 && optind <= argc)
+    {
+        fprintf(stderr,
+                "Usage: %s [-a agentAddress] [-p agentPort] [-c commissioners] [-j joiners] [-r joinersPerSecond]\n"
+                "       [-k keepAliveIntervalMs] [-d durationSeconds] PSKc\n", argv[0]);
+    }
+
+    return ret == 0 ? 0 : 1;
+}
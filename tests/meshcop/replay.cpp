@@ -0,0 +1,437 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *   The file implements a driver replaying a border agent trace.
+ *
+ *   The driver links the real border agent against the stub NCP controller and DTLS server below, so a trace recorded
+ *   with `otbr-agent -T` is fed into the border agent without wpantund, a radio or a commissioner.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "agent/border_agent.hpp"
+#include "agent/dtls.hpp"
+#include "agent/ncp.hpp"
+#include "agent/trace.hpp"
+#include "common/code_utils.hpp"
+#include "common/time.hpp"
+#include "common/types.hpp"
+
+namespace ot {
+
+namespace BorderRouter {
+
+namespace Ncp {
+
+/**
+ * This class implements a NCP controller whose events come from a trace.
+ *
+ */
+class ReplayController : public Controller
+{
+public:
+    ReplayController(PSKcHandler aPSKcHandler, PacketHandler aPacketHandler, void *aContext) :
+        mPSKcHandler(aPSKcHandler),
+        mPacketHandler(aPacketHandler),
+        mContext(aContext),
+        mNetworkDataHandler(NULL),
+        mNetworkDataContext(NULL),
+        mSentPackets(0),
+        mSentBytes(0)
+    {
+        memset(mPSKc, 0, sizeof(mPSKc));
+        memset(mEui64, 0, sizeof(mEui64));
+    }
+
+    virtual int BorderAgentProxyStart(void) { return 0; }
+    virtual int BorderAgentProxyStop(void) { return 0; }
+
+    virtual int BorderAgentProxySend(const uint8_t *aBuffer, uint16_t aLength, uint16_t, uint16_t)
+    {
+        uint8_t tokenLength = aBuffer[0] & 0x0f;
+
+        mSentPackets++;
+        mSentBytes += aLength;
+
+        // Remember the message ID of each confirmable request to answer it with the recorded response.
+        if (aLength >= kCoapHeaderLength + tokenLength && (aBuffer[0] >> 4) == kCoapConfirmable)
+        {
+            std::string token(reinterpret_cast<const char *>(aBuffer + kCoapHeaderLength), tokenLength);
+
+            mMessageIds[token] = static_cast<uint16_t>(aBuffer[2] << 8 | aBuffer[3]);
+        }
+
+        return 0;
+    }
+
+    virtual void UpdateFdSet(fd_set &, fd_set &, fd_set &, int &, timeval &) {}
+    virtual void Process(const fd_set &, const fd_set &, const fd_set &) {}
+    virtual const uint8_t *GetPSKc(void) { return mPSKc; }
+    virtual const uint8_t *GetEui64(void) { return mEui64; }
+    virtual void SetReadyHandler(ReadyHandler, void *) {}
+
+    virtual void SetNetworkDataHandler(NetworkDataHandler aHandler, void *aContext)
+    {
+        mNetworkDataHandler = aHandler;
+        mNetworkDataContext = aContext;
+    }
+
+    void FeedPacket(const TraceRecord &aRecord)
+    {
+        std::vector<uint8_t> packet(aRecord.mData, aRecord.mData + aRecord.mLength);
+        uint8_t              tokenLength = packet.empty() ? 0 : packet[0] & 0x0f;
+
+        // The border agent picks new message IDs on every run, so the recorded acknowledgments are matched to
+        // the requests of this run by token.
+        if (packet.size() >= static_cast<size_t>(kCoapHeaderLength + tokenLength) &&
+            (packet[0] >> 4) == kCoapAcknowledgment)
+        {
+            std::string            token(reinterpret_cast<const char *>(&packet[kCoapHeaderLength]), tokenLength);
+            MessageIdMap::iterator it = mMessageIds.find(token);
+
+            if (it != mMessageIds.end())
+            {
+                packet[2] = static_cast<uint8_t>(it->second >> 8);
+                packet[3] = static_cast<uint8_t>(it->second & 0xff);
+                mMessageIds.erase(it);
+            }
+        }
+
+        mPacketHandler(packet.empty() ? NULL : &packet[0], aRecord.mLength, aRecord.mLocator, aRecord.mPort,
+                       mContext);
+    }
+
+    void FeedPSKc(const TraceRecord &aRecord)
+    {
+        VerifyOrExit(aRecord.mLength == sizeof(mPSKc));
+        memcpy(mPSKc, aRecord.mData, sizeof(mPSKc));
+        mPSKcHandler(mPSKc, mContext);
+
+exit:
+        return;
+    }
+
+    void FeedNetworkData(void)
+    {
+        if (mNetworkDataHandler != NULL)
+        {
+            mNetworkDataHandler(mNetworkDataContext);
+        }
+    }
+
+    unsigned long GetSentPackets(void) const { return mSentPackets; }
+    unsigned long GetSentBytes(void) const { return mSentBytes; }
+
+private:
+    enum
+    {
+        kCoapHeaderLength   = 4,
+        kCoapConfirmable    = 0x4, ///< Version 1, type CON.
+        kCoapAcknowledgment = 0x6, ///< Version 1, type ACK.
+    };
+
+    typedef std::map<std::string, uint16_t> MessageIdMap;
+
+    PSKcHandler        mPSKcHandler;
+    PacketHandler      mPacketHandler;
+    void              *mContext;
+    NetworkDataHandler mNetworkDataHandler;
+    void              *mNetworkDataContext;
+    uint8_t            mPSKc[kSizePSKc];
+    uint8_t            mEui64[kSizeEui64];
+    unsigned long      mSentPackets;
+    unsigned long      mSentBytes;
+    MessageIdMap       mMessageIds;
+};
+
+static ReplayController *sController = NULL;
+
+Controller *Controller::Create(const char *, PSKcHandler aPSKcHandler, PacketHandler aPacketHandler, void *aContext)
+{
+    sController = new ReplayController(aPSKcHandler, aPacketHandler, aContext);
+    return sController;
+}
+
+void Controller::Destroy(Controller *aController)
+{
+    delete static_cast<ReplayController *>(aController);
+    sController = NULL;
+}
+
+} // namespace Ncp
+
+namespace Dtls {
+
+/**
+ * This class implements a DTLS session whose payloads come from a trace.
+ *
+ */
+class ReplaySession : public Session
+{
+public:
+    ReplaySession(void) :
+        mDataHandler(NULL),
+        mContext(NULL),
+        mSentPackets(0),
+        mSentBytes(0)
+    {
+        memset(mKek, 0, sizeof(mKek));
+    }
+
+    virtual void SetDataHandler(DataHandler aDataHandler, void *aContext)
+    {
+        mDataHandler = aDataHandler;
+        mContext = aContext;
+    }
+
+    virtual ssize_t Write(const uint8_t *, uint16_t aLength)
+    {
+        mSentPackets++;
+        mSentBytes += aLength;
+        return aLength;
+    }
+
+    virtual const uint8_t *GetKek(void) { return mKek; }
+    virtual void Close(void) {}
+
+    void FeedPayload(const TraceRecord &aRecord)
+    {
+        if (mDataHandler != NULL)
+        {
+            mDataHandler(aRecord.mData, aRecord.mLength, mContext);
+        }
+    }
+
+    unsigned long GetSentPackets(void) const { return mSentPackets; }
+    unsigned long GetSentBytes(void) const { return mSentBytes; }
+
+private:
+    DataHandler   mDataHandler;
+    void         *mContext;
+    uint8_t       mKek[32];
+    unsigned long mSentPackets;
+    unsigned long mSentBytes;
+};
+
+/**
+ * This class implements a DTLS server with the only session of a trace.
+ *
+ */
+class ReplayServer : public Server
+{
+public:
+    ReplayServer(StateHandler aStateHandler, void *aContext) :
+        mStateHandler(aStateHandler),
+        mContext(aContext)
+    {
+    }
+
+    virtual void SetPSK(const uint8_t *, uint8_t) {}
+    virtual void SetSeed(const uint8_t *, uint16_t) {}
+    virtual void Start(void) {}
+    virtual size_t GetSessionCount(void) const { return 0; }
+    virtual void UpdateFdSet(fd_set &, fd_set &, int &, timeval &) {}
+    virtual void Process(const fd_set &, const fd_set &) {}
+    virtual void HandOver(std::vector<uint8_t> &, std::vector<int> &) {}
+    virtual int  Resume(const std::vector<uint8_t> &, const std::vector<int> &) { return 0; }
+
+    void FeedState(const TraceRecord &aRecord)
+    {
+        mStateHandler(mSession, static_cast<Session::State>(aRecord.mState), mContext);
+    }
+
+    ReplaySession &GetSession(void) { return mSession; }
+
+private:
+    StateHandler  mStateHandler;
+    void         *mContext;
+    ReplaySession mSession;
+};
+
+static ReplayServer *sServer = NULL;
+
+Server *Server::Create(uint16_t, StateHandler aStateHandler, void *aContext)
+{
+    sServer = new ReplayServer(aStateHandler, aContext);
+    return sServer;
+}
+
+void Server::Destroy(Server *aServer)
+{
+    delete static_cast<ReplayServer *>(aServer);
+    sServer = NULL;
+}
+
+} // namespace Dtls
+
+} // namespace BorderRouter
+
+} // namespace ot
+
+using namespace ot::BorderRouter;
+
+/**
+ * This function lets the border agent run its timers, as the main loop would between two events.
+ *
+ */
+static void Poll(BorderAgent &aBorderAgent)
+{
+    fd_set  readFdSet;
+    fd_set  writeFdSet;
+    fd_set  errorFdSet;
+    int     maxFd = -1;
+    timeval timeout = { 0, 0 };
+
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+
+    aBorderAgent.UpdateFdSet(readFdSet, writeFdSet, errorFdSet, maxFd, timeout);
+    FD_ZERO(&readFdSet);
+    FD_ZERO(&writeFdSet);
+    FD_ZERO(&errorFdSet);
+    aBorderAgent.Process(readFdSet, writeFdSet, errorFdSet);
+}
+
+static int Replay(TraceReader &aReader, bool aPaced)
+{
+    int           ret = 0;
+    unsigned long records = 0;
+    uint64_t      start;
+    uint64_t      elapsed;
+    TraceRecord   record;
+    BorderAgent   borderAgent("replay");
+
+    start = GetMonotonicMicros();
+
+    while ((ret = aReader.Read(record)) > 0)
+    {
+        if (aPaced && record.mDelay > 0)
+        {
+            usleep(record.mDelay);
+        }
+
+        switch (record.mType)
+        {
+        case kTraceProxyStream:
+            Ncp::sController->FeedPacket(record);
+            break;
+
+        case kTraceDtlsPayload:
+            Dtls::sServer->GetSession().FeedPayload(record);
+            break;
+
+        case kTraceDtlsState:
+            Dtls::sServer->FeedState(record);
+            break;
+
+        case kTracePSKc:
+            Ncp::sController->FeedPSKc(record);
+            break;
+
+        case kTraceNetworkData:
+            Ncp::sController->FeedNetworkData();
+            break;
+
+        default:
+            fprintf(stderr, "skipping record of unknown type %d\n", record.mType);
+            break;
+        }
+
+        Poll(borderAgent);
+        records++;
+    }
+
+    VerifyOrExit(ret == 0, fprintf(stderr, "trace corrupted after %lu records\n", records));
+
+    elapsed = GetMonotonicMicros() - start;
+    printf("%lu records in %llu us", records, static_cast<unsigned long long>(elapsed));
+
+    if (elapsed > 0)
+    {
+        printf(", %.0f records/s", records * 1000000.0 / elapsed);
+    }
+
+    printf("\nsent %lu packets (%lu bytes) to the proxy, %lu packets (%lu bytes) on the DTLS session\n",
+           Ncp::sController->GetSentPackets(), Ncp::sController->GetSentBytes(),
+           Dtls::sServer->GetSession().GetSentPackets(), Dtls::sServer->GetSession().GetSentBytes());
+
+exit:
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    int         ret = 0;
+    int         opt;
+    bool        paced = false;
+    TraceReader reader;
+
+    while ((opt = getopt(argc, argv, "p")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            paced = true;
+            break;
+
+        default:
+            ExitNow(ret = -1);
+            break;
+        }
+    }
+
+    VerifyOrExit(optind + 1 == argc, ret = -1);
+    VerifyOrExit(reader.Open(argv[optind]) == 0, fprintf(stderr, "failed to open trace %s\n", argv[optind]), ret = -2);
+
+    openlog("otbr-replay", LOG_PERROR, LOG_USER);
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    ret = Replay(reader, paced);
+
+    closelog();
+
+exit:
+    if (ret == -1)
+    {
+        fprintf(stderr, "Usage: %s [-p] tracePath\n"
+                "  -p  replay at the recorded pace instead of as fast as possible\n", argv[0]);
+    }
+
+    return ret == 0 ? 0 : 1;
+}
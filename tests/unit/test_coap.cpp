@@ -0,0 +1,243 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+#include "coap_codec.hpp"
+
+using namespace ot::BorderRouter::Coap;
+
+namespace {
+
+struct Sent
+{
+    uint8_t  mBuffer[64];
+    uint16_t mLength;
+    int      mCount;
+};
+
+ssize_t SendTo(const uint8_t *aBuffer, uint16_t aLength, const uint8_t *aIp6, uint16_t aPort, void *aContext)
+{
+    Sent &sent = *static_cast<Sent *>(aContext);
+
+    (void)aIp6;
+    (void)aPort;
+
+    memcpy(sent.mBuffer, aBuffer, aLength);
+    sent.mLength = aLength;
+    sent.mCount++;
+    return aLength;
+}
+
+int sRequests;
+int sResponses;
+
+void HandleRequest(const Resource &aResource, const Message &aRequest, Message &aResponse, const uint8_t *aIp6,
+                   uint16_t aPort, void *aContext)
+{
+    const uint8_t payload[] = { 0x10, 0x01, 0x01 };
+
+    (void)aResource;
+    (void)aRequest;
+    (void)aIp6;
+    (void)aPort;
+    (void)aContext;
+
+    sRequests++;
+    aResponse.SetCode(Message::kCoapResponseChanged);
+    aResponse.SetPayload(payload, sizeof(payload));
+}
+
+void HandleResponse(const Message &aMessage, void *aContext)
+{
+    (void)aContext;
+
+    CHECK_EQUAL(Message::kCoapResponseChanged, aMessage.GetCode());
+    sResponses++;
+}
+
+const Resource kResources[] =
+{
+    { "c/lp", HandleRequest },
+    { 0, 0 },
+};
+
+} // namespace
+
+TEST_GROUP(Coap)
+{
+    void setup(void)
+    {
+        memset(&mSent, 0, sizeof(mSent));
+        sRequests = 0;
+        sResponses = 0;
+        mAgent = Agent::Create(SendTo, kResources, &mSent);
+    }
+
+    void teardown(void)
+    {
+        Agent::Destroy(mAgent);
+    }
+
+    Sent   mSent;
+    Agent *mAgent;
+};
+
+TEST(Coap, WriteAndParseRequest)
+{
+    const uint8_t  token[] = { 0x01, 0x02 };
+    const uint8_t  payload[] = { 0xaa, 0xbb };
+    const uint8_t  expected[] = { 0x42, 0x02, 0x12, 0x34, 0x01, 0x02, 0xb1, 'c', 0x02, 'c', 'p', 0xff, 0xaa, 0xbb };
+    uint8_t        buffer[64];
+    MessageWriter  writer(buffer, sizeof(buffer));
+    MessageReader  reader;
+    const uint8_t *value;
+    uint8_t        tokenLength;
+    uint16_t       payloadLength;
+
+    CHECK_EQUAL(0, writer.Init(Message::kCoapTypeConfirmable, Message::kCoapRequestPost, 0x1234, token,
+                               sizeof(token)));
+    // Options go in front of a payload set before them.
+    CHECK_EQUAL(0, writer.SetPayload(payload, sizeof(payload)));
+    CHECK_EQUAL(0, writer.AppendPath("c/cp"));
+    CHECK_EQUAL(sizeof(expected), writer.GetLength());
+    MEMCMP_EQUAL(expected, buffer, sizeof(expected));
+
+    CHECK_EQUAL(0, reader.Parse(buffer, writer.GetLength()));
+    CHECK_EQUAL(Message::kCoapTypeConfirmable, reader.GetType());
+    CHECK_EQUAL(Message::kCoapRequestPost, reader.GetCode());
+    CHECK_EQUAL(0x1234, reader.GetMessageId());
+    value = reader.GetToken(tokenLength);
+    CHECK_EQUAL(sizeof(token), tokenLength);
+    MEMCMP_EQUAL(token, value, sizeof(token));
+    value = reader.GetPayload(payloadLength);
+    CHECK_EQUAL(sizeof(payload), payloadLength);
+    MEMCMP_EQUAL(payload, value, sizeof(payload));
+
+    CHECK_TRUE(reader.IsPath("c/cp"));
+    CHECK_TRUE(reader.IsPath("/c/cp"));
+    CHECK_FALSE(reader.IsPath("c"));
+    CHECK_FALSE(reader.IsPath("c/c"));
+    CHECK_FALSE(reader.IsPath("c/cp/x"));
+}
+
+TEST(Coap, WriteExtendedOptions)
+{
+    char          path[13 + 1 + 300 + 1];
+    uint8_t       buffer[400];
+    MessageWriter writer(buffer, sizeof(buffer));
+    MessageReader reader;
+
+    memset(path, 'a', sizeof(path) - 1);
+    path[13] = '/';
+    path[sizeof(path) - 1] = '\0';
+
+    CHECK_EQUAL(0, writer.Init(Message::kCoapTypeNonConfirmable, Message::kCoapRequestPost, 1, NULL, 0));
+    CHECK_EQUAL(0, writer.AppendPath(path));
+
+    // The length of 13 takes one more byte, the length of 300 two more.
+    CHECK_EQUAL(0xbd, buffer[4]);
+    CHECK_EQUAL(0x00, buffer[5]);
+    CHECK_EQUAL(0x0e, buffer[6 + 13]);
+    CHECK_EQUAL(0x00, buffer[7 + 13]);
+    CHECK_EQUAL(300 - 269, buffer[8 + 13]);
+
+    CHECK_EQUAL(0, reader.Parse(buffer, writer.GetLength()));
+    CHECK_TRUE(reader.IsPath(path));
+    path[sizeof(path) - 2] = 'b';
+    CHECK_FALSE(reader.IsPath(path));
+
+    CHECK_EQUAL(-1, writer.SetPayload(buffer, sizeof(buffer)));
+    CHECK_TRUE(writer.HasFailed());
+}
+
+TEST(Coap, RejectMalformedMessages)
+{
+    const uint8_t version[] = { 0x80, 0x02, 0x00, 0x01 };
+    const uint8_t token[] = { 0x49, 0x02, 0x00, 0x01, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    const uint8_t truncated[] = { 0x42, 0x02, 0x00, 0x01, 0x01 };
+    const uint8_t empty[] = { 0x41, 0x00, 0x00, 0x01, 0x01 };
+    const uint8_t option[] = { 0x40, 0x02, 0x00, 0x01, 0xb3, 'c' };
+    const uint8_t reserved[] = { 0x40, 0x02, 0x00, 0x01, 0xf1, 'c' };
+    const uint8_t marker[] = { 0x40, 0x02, 0x00, 0x01, 0xff };
+    MessageReader reader;
+
+    CHECK_EQUAL(-1, reader.Parse(version, sizeof(version)));
+    CHECK_EQUAL(-1, reader.Parse(token, sizeof(token)));
+    CHECK_EQUAL(-1, reader.Parse(truncated, sizeof(truncated)));
+    CHECK_EQUAL(-1, reader.Parse(empty, sizeof(empty)));
+    CHECK_EQUAL(-1, reader.Parse(option, sizeof(option)));
+    CHECK_EQUAL(-1, reader.Parse(reserved, sizeof(reserved)));
+    CHECK_EQUAL(-1, reader.Parse(marker, sizeof(marker)));
+}
+
+TEST(Coap, AnswerDuplicateRequestOnce)
+{
+    const uint8_t request[] = { 0x41, 0x02, 0x00, 0x07, 0x55, 0xb1, 'c', 0x02, 'l', 'p' };
+    const uint8_t expected[] = { 0x61, 0x44, 0x00, 0x07, 0x55, 0xff, 0x10, 0x01, 0x01 };
+
+    mAgent->Input(request, sizeof(request), NULL, 0);
+    mAgent->Input(request, sizeof(request), NULL, 0);
+
+    CHECK_EQUAL(1, sRequests);
+    CHECK_EQUAL(2, mSent.mCount);
+    CHECK_EQUAL(sizeof(expected), mSent.mLength);
+    MEMCMP_EQUAL(expected, mSent.mBuffer, sizeof(expected));
+}
+
+TEST(Coap, MatchSeparateResponse)
+{
+    const uint8_t token[] = { 0x66 };
+    Message      *message;
+    uint8_t       ack[] = { 0x60, 0x00, 0x00, 0x00 };
+    uint8_t       response[] = { 0x41, 0x44, 0x00, 0x09, 0x66 };
+    const uint8_t expected[] = { 0x60, 0x00, 0x00, 0x09 };
+
+    message = mAgent->NewMessage(Message::kCoapTypeConfirmable, Message::kCoapRequestPost, token, sizeof(token));
+    message->SetPath("c/lp");
+    mAgent->Send(*message, NULL, 0, HandleResponse);
+    mAgent->FreeMessage(message);
+    CHECK_EQUAL(1, mSent.mCount);
+
+    ack[2] = mSent.mBuffer[2];
+    ack[3] = mSent.mBuffer[3];
+    mAgent->Input(ack, sizeof(ack), NULL, 0);
+    CHECK_EQUAL(0, sResponses);
+
+    mAgent->Input(response, sizeof(response), NULL, 0);
+    CHECK_EQUAL(1, sResponses);
+    CHECK_EQUAL(2, mSent.mCount);
+    MEMCMP_EQUAL(expected, mSent.mBuffer, sizeof(expected));
+
+    // The response received again is only acknowledged again.
+    mAgent->Input(response, sizeof(response), NULL, 0);
+    CHECK_EQUAL(1, sResponses);
+    CHECK_EQUAL(3, mSent.mCount);
+}
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <string.h>
+
+#include "utils/json.hpp"
+
+using ot::Utils::JsonField;
+using ot::Utils::JsonReader;
+using ot::Utils::JsonWriter;
+
+TEST_GROUP(Json)
+{
+};
+
+TEST(Json, WriteNestedValues)
+{
+    std::string json;
+    JsonWriter  writer(json);
+
+    writer.BeginObject()
+    .Key("nn").String("Open\"Thread\"\n")
+    .Key("ch").Uint(15)
+    .Key("rssi").Int(-70)
+    .Key("list").BeginArray().Bool(true).Null().BeginObject().EndObject().EndArray()
+    .Key("empty").BeginArray().EndArray()
+    .EndObject();
+
+    STRCMP_EQUAL("{\"nn\":\"Open\\\"Thread\\\"\\n\",\"ch\":15,\"rssi\":-70,\"list\":[true,null,{}],\"empty\":[]}",
+                 json.c_str());
+}
+
+TEST(Json, ReadObjectFields)
+{
+    const char  request[] = "{\"networkKey\":\"00112233\",\"skipped\":{\"a\":[1,{\"b\":null}]},"
+                            "\"channel\":\"15\",\"defaultRoute\":true,\"name\":\"\\u00e9\\ud83d\\ude00\"}";
+    std::string networkKey, name;
+    uint64_t    channel = 0;
+    bool        defaultRoute = false;
+    JsonReader  reader(request, strlen(request));
+    JsonField   fields[] =
+    {
+        JsonField::String("networkKey", networkKey),
+        JsonField::Uint("channel", channel),
+        JsonField::Bool("defaultRoute", defaultRoute),
+        JsonField::String("name", name),
+    };
+
+    CHECK_TRUE(reader.ReadObject(fields, sizeof(fields) / sizeof(fields[0])));
+    STRCMP_EQUAL("00112233", networkKey.c_str());
+    CHECK_EQUAL(15U, channel);
+    CHECK_TRUE(defaultRoute);
+    STRCMP_EQUAL("\xc3\xa9\xf0\x9f\x98\x80", name.c_str());
+    CHECK_EQUAL(JsonReader::kTokenEnd, reader.Next());
+}
+
+TEST(Json, RejectInvalidInput)
+{
+    const char *const invalid[] =
+    {
+        "", "{", "{\"a\":1,}", "{\"a\" 1}", "{\"a\":01}", "{\"a\":tru}", "{\"a\":\"b}", "{\"prefix\":1}", "{}",
+    };
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        std::string prefix;
+        JsonReader  reader(invalid[i], strlen(invalid[i]));
+        JsonField   field = JsonField::String("prefix", prefix);
+
+        CHECK_FALSE(reader.ReadObject(&field, 1));
+        CHECK(reader.GetError() != NULL);
+    }
+}
+
+TEST(Json, ReadArrayOfObjects)
+{
+    const char         json[] = "[{\"op\":\"add\"},{\"op\":\"delete\",\"extra\":[1,{}]}]";
+    JsonReader         reader(json, sizeof(json) - 1);
+    JsonReader::Token  token;
+    std::string        op;
+    JsonField          field = JsonField::String("op", op);
+    std::string        ops;
+
+    CHECK_EQUAL(JsonReader::kTokenBeginArray, reader.Next());
+    while ((token = reader.Next()) == JsonReader::kTokenBeginObject)
+    {
+        CHECK_TRUE(reader.ReadMembers(&field, 1));
+        ops += op + ";";
+    }
+    CHECK_EQUAL(JsonReader::kTokenEndArray, token);
+    STRCMP_EQUAL("add;delete;", ops.c_str());
+    CHECK_EQUAL(JsonReader::kTokenEnd, reader.Next());
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2017, The OpenThread Authors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the
+ *     names of its contributors may be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include "common/metrics.hpp"
+
+TEST_GROUP(Metrics)
+{
+};
+
+TEST(Metrics, CounterAndGauge)
+{
+    ot::Metrics::Counter counter("test_requests_total", "Requests.");
+    ot::Metrics::Gauge   gauge("test_sessions", "Sessions.");
+    std::string          output;
+
+    counter.Increment();
+    counter.Increment(41);
+    gauge.Add(3);
+    gauge.Add(-5);
+
+    CHECK_EQUAL(42, counter.Get());
+    CHECK_EQUAL(-2, gauge.Get());
+
+    ot::Metrics::Metric::FormatAll(output);
+    CHECK(output.find("# TYPE test_requests_total counter\ntest_requests_total 42\n") != std::string::npos);
+    CHECK(output.find("# TYPE test_sessions gauge\ntest_sessions -2\n") != std::string::npos);
+}
+
+TEST(Metrics, HistogramBuckets)
+{
+    using ot::Metrics::Histogram;
+
+    CHECK_EQUAL(0, Histogram::GetBucketIndex(0));
+    CHECK_EQUAL(3, Histogram::GetBucketIndex(3));
+    CHECK_EQUAL(4, Histogram::GetBucketIndex(4));
+    CHECK_EQUAL(8, Histogram::GetBucketIndex(8));
+    CHECK_EQUAL(8, Histogram::GetBucketIndex(9));
+    CHECK_EQUAL(Histogram::kBucketCount - 1, Histogram::GetBucketIndex((1ULL << Histogram::kMaxExponent) - 1));
+    CHECK_EQUAL(Histogram::kBucketCount, Histogram::GetBucketIndex(1ULL << Histogram::kMaxExponent));
+
+    // Every duration falls into the first bucket whose upper bound is not below it.
+    for (uint64_t value = 0; value < 100000; value += 7)
+    {
+        int index = Histogram::GetBucketIndex(value);
+
+        CHECK(value <= Histogram::GetBucketUpperBound(index));
+        CHECK(index == 0 || value > Histogram::GetBucketUpperBound(index - 1));
+    }
+}
+
+TEST(Metrics, HistogramFormat)
+{
+    ot::Metrics::Histogram histogram("test_latency_seconds", "Latency.");
+    std::string            output;
+
+    histogram.Record(5);
+    histogram.Record(1500000);
+    histogram.Record(1ULL << 40);
+
+    CHECK_EQUAL(3, histogram.GetCount());
+
+    histogram.Format(output);
+    CHECK(output.find("test_latency_seconds_bucket{le=\"0.000005\"} 1\n") != std::string::npos);
+    CHECK(output.find("test_latency_seconds_bucket{le=\"1.572863\"} 2\n") != std::string::npos);
+    CHECK(output.find("test_latency_seconds_bucket{le=\"+Inf\"} 3\n") != std::string::npos);
+    CHECK(output.find("test_latency_seconds_count 3\n") != std::string::npos);
+}